@@ -1309,6 +1309,9 @@ nm_device_bridge_class_init(NMDeviceBridgeClass *klass)
 
     device_class->connection_type_supported = NM_SETTING_BRIDGE_SETTING_NAME;
     device_class->link_types                = NM_DEVICE_DEFINE_LINK_TYPES(NM_LINK_TYPE_BRIDGE);
+    device_class->connection_types_check_compatible =
+        NM_DEVICE_DEFINE_CONNECTION_TYPES(NM_SETTING_BRIDGE_SETTING_NAME,
+                                          NM_SETTING_BLUETOOTH_SETTING_NAME);
 
     device_class->is_controller               = TRUE;
     device_class->mtu_force_set               = TRUE;
@@ -2051,12 +2051,17 @@ nm_device_ethernet_class_init(NMDeviceEthernetClass *klass)
 
     device_class->connection_type_supported = NM_SETTING_WIRED_SETTING_NAME;
     device_class->link_types                = NM_DEVICE_DEFINE_LINK_TYPES(NM_LINK_TYPE_ETHERNET);
+    device_class->connection_types_check_compatible =
+        NM_DEVICE_DEFINE_CONNECTION_TYPES(NM_SETTING_WIRED_SETTING_NAME,
+                                          NM_SETTING_PPPOE_SETTING_NAME);
 
     device_class->get_generic_capabilities    = get_generic_capabilities;
     device_class->check_connection_compatible = check_connection_compatible;
     device_class->complete_connection         = complete_connection;
     device_class->new_default_connection      = new_default_connection;
 
+    device_class->check_connection_compatible_wired_hwaddr = TRUE;
+
     device_class->act_stage1_prepare_also_for_external_or_assume = TRUE;
     device_class->act_stage1_prepare                             = act_stage1_prepare;
     device_class->act_stage1_prepare_set_hwaddr_ethernet         = TRUE;
@@ -154,6 +154,16 @@ void nm_device_commit_mtu(NMDevice *self);
         _types;                                                                 \
     }))
 
+#define NM_DEVICE_DEFINE_CONNECTION_TYPES(...)                              \
+    ({                                                                      \
+        static const char *const _types[NM_NARG(__VA_ARGS__) + 1] = {       \
+            __VA_ARGS__,                                                    \
+            NULL,                                                           \
+        };                                                                  \
+                                                                            \
+        _types;                                                             \
+    })
+
 gboolean _nm_device_hash_check_invalid_keys(GHashTable        *hash,
                                             const char        *setting_name,
                                             GError           **error,
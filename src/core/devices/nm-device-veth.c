@@ -195,6 +195,10 @@ nm_device_veth_class_init(NMDeviceVethClass *klass)
 
     device_class->connection_type_supported = NULL;
     device_class->link_types                = NM_DEVICE_DEFINE_LINK_TYPES(NM_LINK_TYPE_VETH);
+    device_class->connection_types_check_compatible =
+        NM_DEVICE_DEFINE_CONNECTION_TYPES(NM_SETTING_WIRED_SETTING_NAME,
+                                          NM_SETTING_PPPOE_SETTING_NAME,
+                                          NM_SETTING_VETH_SETTING_NAME);
 
     device_class->can_unmanaged_external_down = can_unmanaged_external_down;
     device_class->link_changed                = link_changed;
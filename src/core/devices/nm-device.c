@@ -25,6 +25,7 @@
 #include <libudev.h>
 
 #include "libnm-std-aux/unaligned.h"
+#include "libnm-std-aux/nm-usdt.h"
 #include "libnm-glib-aux/nm-uuid.h"
 #include "libnm-glib-aux/nm-dedup-multi.h"
 #include "libnm-glib-aux/nm-random-utils.h"
@@ -50,6 +51,7 @@
 #include "dhcp/nm-dhcp-utils.h"
 #include "nm-act-request.h"
 #include "nm-pacrunner-manager.h"
+#include "dhcp/nm-dhcp-server.h"
 #include "dnsmasq/nm-dnsmasq-manager.h"
 #include "nm-ip-config.h"
 #include "nm-dhcp-config.h"
@@ -265,6 +267,7 @@ typedef struct {
     union {
         struct {
             NMDnsMasqManager      *dnsmasq_manager;
+            NMDhcpServer          *dhcp_server;
             NMNetnsSharedIPHandle *shared_ip_handle;
             NMFirewallConfig      *firewall_config;
             gulong                 dnsmasq_state_id;
@@ -509,8 +512,9 @@ typedef struct _NMDevicePrivate {
 
     guint64 udi_id;
 
-    GHashTable *available_connections;
-    char       *hw_addr;
+    GHashTable            *available_connections;
+    NMSettingsConnection **available_connections_sorted;
+    char                  *hw_addr;
     char       *hw_addr_perm;
     char       *hw_addr_initial;
     char       *physical_port_id;
@@ -766,10 +770,11 @@ typedef struct _NMDevicePrivate {
     guint sriov_reset_pending;
 
     struct {
-        GSource *timeout_source;
-        guint    refresh_rate_ms;
-        guint64  tx_bytes;
-        guint64  rx_bytes;
+        gint64  next_msec;
+        guint   refresh_rate_ms;
+        guint   refresh_rate_real_ms;
+        guint64 tx_bytes;
+        guint64 rx_bytes;
     } stats;
 
     bool mtu_force_set_done : 1;
@@ -862,7 +867,7 @@ static void
 _dev_unmanaged_check_external_down(NMDevice *self, gboolean only_if_unmanaged, gboolean now);
 
 static void _dev_ipshared4_start(NMDevice *self);
-static void _dev_ipshared4_spawn_dnsmasq(NMDevice *self);
+static void _dev_ipshared4_spawn_dhcp_server(NMDevice *self);
 
 static void _dev_ipshared6_start(NMDevice *self);
 
@@ -880,6 +885,7 @@ static void device_ifindex_changed_cb(NMManager *manager, NMDevice *device_chang
 static gboolean device_link_changed(gpointer user_data);
 static gboolean _get_maybe_ipv6_disabled(NMDevice *self);
 static void     deactivate_ready(NMDevice *self, NMDeviceStateReason reason);
+static void     _available_connections_recheck_flush(NMDevice *self);
 
 /*****************************************************************************/
 
@@ -4656,8 +4662,9 @@ _dev_l3_cfg_notify_cb(NML3Cfg *l3cfg, const NML3ConfigNotifyData *notify_data, N
     }
     case NM_L3_CONFIG_NOTIFY_TYPE_POST_COMMIT:
         if (priv->ipshared_data_4.state == NM_DEVICE_IP_STATE_PENDING
-            && !priv->ipshared_data_4.v4.dnsmasq_manager && priv->ipshared_data_4.v4.l3cd) {
-            _dev_ipshared4_spawn_dnsmasq(self);
+            && !priv->ipshared_data_4.v4.dnsmasq_manager && !priv->ipshared_data_4.v4.dhcp_server
+            && priv->ipshared_data_4.v4.l3cd) {
+            _dev_ipshared4_spawn_dhcp_server(self);
         }
         _dev_ip_state_check_async(self, AF_UNSPEC);
         _dev_ipmanual_check_ready(self);
@@ -5322,22 +5329,133 @@ _stats_update_counters_from_pllink(NMDevice *self, const NMPlatformLink *pllink)
     _stats_update_counters(self, pllink->tx_bytes, pllink->rx_bytes);
 }
 
+/* All devices with a statistics refresh rate share one timer. Their ticks
+ * are aligned to multiples of their refresh rate, so that devices with the
+ * same rate are due at the same time and get refreshed together. */
+static struct {
+    CList    stats_lst_head;
+    GSource *timeout_source;
+    gint64   timeout_msec;
+} _stats_global = {
+    .stats_lst_head = C_LIST_INIT(_stats_global.stats_lst_head),
+};
+
+static gboolean _stats_timeout_cb(gpointer user_data);
+
+static void
+_stats_global_reschedule(gint64 now_msec)
+{
+    NMDevice *device;
+    gint64    next_msec = G_MAXINT64;
+
+    c_list_for_each_entry (device, &_stats_global.stats_lst_head, stats_lst)
+        next_msec = NM_MIN(next_msec, NM_DEVICE_GET_PRIVATE(device)->stats.next_msec);
+
+    if (next_msec == G_MAXINT64) {
+        nm_clear_g_source_inst(&_stats_global.timeout_source);
+        return;
+    }
+
+    if (_stats_global.timeout_source && _stats_global.timeout_msec == next_msec)
+        return;
+
+    nm_clear_g_source_inst(&_stats_global.timeout_source);
+    _stats_global.timeout_msec   = next_msec;
+    _stats_global.timeout_source = nm_g_timeout_add_source(NM_MAX(next_msec - now_msec, 0),
+                                                           _stats_timeout_cb,
+                                                           NULL);
+}
+
 static gboolean
 _stats_timeout_cb(gpointer user_data)
 {
-    NMDevice *self = user_data;
-    int       ifindex;
+    gs_unref_ptrarray GPtrArray *due = NULL;
+    const NMDedupMultiHeadEntry *head;
+    NMPlatform                  *platform;
+    NMDevice                    *device;
+    gint64                       now_msec = nm_utils_get_monotonic_timestamp_msec();
+    guint                        i;
 
-    ifindex = nm_device_get_ip_ifindex(self);
+    nm_clear_g_source_inst(&_stats_global.timeout_source);
 
-    _LOGT(LOGD_DEVICE, "stats: refresh %d", ifindex);
+    c_list_for_each_entry (device, &_stats_global.stats_lst_head, stats_lst) {
+        NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE(device);
 
-    if (ifindex > 0)
+        if (priv->stats.next_msec > now_msec)
+            continue;
+
+        priv->stats.next_msec =
+            nm_utils_stats_next_refresh_msec(now_msec, priv->stats.refresh_rate_real_ms);
+
+        if (nm_device_get_ip_ifindex(device) <= 0)
+            continue;
+
+        if (!due)
+            due = g_ptr_array_new_with_free_func(g_object_unref);
+        g_ptr_array_add(due, g_object_ref(device));
+    }
+
+    _stats_global_reschedule(now_msec);
+
+    if (!due)
+        return G_SOURCE_CONTINUE;
+
+    /* The updated counters reach the devices via the link-changed signals
+     * of the platform, see device_link_changed(). */
+    platform = nm_device_get_platform(due->pdata[0]);
+    head     = nm_platform_lookup_obj_type(platform, NMP_OBJECT_TYPE_LINK);
+    if (nm_utils_stats_refresh_use_dump(due->len, head ? head->len : 0u)) {
+        nm_log_trace(LOGD_DEVICE,
+                     "stats: refresh all %u links for %u devices",
+                     head ? head->len : 0u,
+                     due->len);
+        nm_platform_refresh_all(platform, NMP_OBJECT_TYPE_LINK);
+    } else
+        platform = NULL;
+
+    for (i = 0; i < due->len; i++) {
+        NMDevice *self = due->pdata[i];
+        int       ifindex;
+
+        /* already refreshed by the dump. */
+        if (nm_device_get_platform(self) == platform)
+            continue;
+
+        ifindex = nm_device_get_ip_ifindex(self);
+        if (ifindex <= 0)
+            continue;
+
+        _LOGT(LOGD_DEVICE, "stats: refresh %d", ifindex);
         nm_platform_link_refresh(nm_device_get_platform(self), ifindex);
+    }
 
     return G_SOURCE_CONTINUE;
 }
 
+static void
+_stats_schedule(NMDevice *self, guint refresh_rate_ms)
+{
+    NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE(self);
+    gint64           now_msec;
+
+    priv->stats.refresh_rate_real_ms = refresh_rate_ms;
+
+    if (refresh_rate_ms == 0) {
+        if (!c_list_is_linked(&self->stats_lst))
+            return;
+        c_list_unlink(&self->stats_lst);
+        if (c_list_is_empty(&_stats_global.stats_lst_head))
+            nm_clear_g_source_inst(&_stats_global.timeout_source);
+        return;
+    }
+
+    now_msec              = nm_utils_get_monotonic_timestamp_msec();
+    priv->stats.next_msec = nm_utils_stats_next_refresh_msec(now_msec, refresh_rate_ms);
+    if (!c_list_is_linked(&self->stats_lst))
+        c_list_link_tail(&_stats_global.stats_lst_head, &self->stats_lst);
+    _stats_global_reschedule(now_msec);
+}
+
 static guint
 _stats_refresh_rate_real(guint refresh_rate_ms)
 {
@@ -5380,7 +5498,7 @@ _stats_set_refresh_rate(NMDevice *self, guint refresh_rate_ms)
     if (_stats_refresh_rate_real(old_rate) == refresh_rate_ms)
         return;
 
-    nm_clear_g_source_inst(&priv->stats.timeout_source);
+    _stats_schedule(self, refresh_rate_ms);
 
     if (!refresh_rate_ms)
         return;
@@ -5391,8 +5509,6 @@ _stats_set_refresh_rate(NMDevice *self, guint refresh_rate_ms)
     ifindex = nm_device_get_ip_ifindex(self);
     if (ifindex > 0)
         nm_platform_link_refresh(nm_device_get_platform(self), ifindex);
-
-    priv->stats.timeout_source = nm_g_timeout_add_source(refresh_rate_ms, _stats_timeout_cb, self);
 }
 
 /*****************************************************************************/
@@ -8022,7 +8138,6 @@ realize_start_setup(NMDevice             *self,
     NMPlatform          *platform;
     NMDeviceCapabilities capabilities = 0;
     NMConfig            *config;
-    guint                refresh_rate_ms;
     gboolean             unmanaged;
 
     /* plink is a NMPlatformLink type, however, we require it to come from the platform
@@ -8126,12 +8241,8 @@ realize_start_setup(NMDevice             *self,
 
     nm_device_set_carrier_from_platform(self);
 
-    nm_assert(!priv->stats.timeout_source);
-    refresh_rate_ms = _stats_refresh_rate_real(priv->stats.refresh_rate_ms);
-    if (refresh_rate_ms > 0) {
-        priv->stats.timeout_source =
-            nm_g_timeout_add_source(refresh_rate_ms, _stats_timeout_cb, self);
-    }
+    nm_assert(!c_list_is_linked(&self->stats_lst));
+    _stats_schedule(self, _stats_refresh_rate_real(priv->stats.refresh_rate_ms));
 
     klass->realize_start_notify(self, plink);
 
@@ -8205,6 +8316,8 @@ available_connections_check_delete_unrealized_on_idle(gpointer user_data)
 
     priv->check_delete_unrealized_id = 0;
 
+    _available_connections_recheck_flush(self);
+
     if (g_hash_table_size(priv->available_connections) == 0 && !nm_device_is_real(self))
         g_signal_emit(self, signals[REMOVED], 0);
 
@@ -8306,7 +8419,7 @@ nm_device_unrealize(NMDevice *self, gboolean remove_resources, GError **error)
         _notify(self, PROP_PHYSICAL_PORT_ID);
     }
 
-    nm_clear_g_source_inst(&priv->stats.timeout_source);
+    _stats_schedule(self, 0);
     _stats_update_counters(self, 0, 0);
 
     priv->hw_addr_len_ = 0;
@@ -8368,6 +8481,7 @@ nm_device_notify_availability_maybe_changed(NMDevice *self)
      * want to register with a network server that now become
      * available. */
     nm_device_recheck_available_connections(self);
+    _available_connections_recheck_flush(self);
     if (g_hash_table_size(priv->available_connections) > 0)
         nm_device_recheck_auto_activate_schedule(self);
 }
@@ -11253,6 +11367,7 @@ _dev_ipdhcpx_start(NMDevice *self, int addr_family)
             .vendor_class_identifier = vendor_class_identifier,
             .use_fqdn                = hostname_is_fqdn,
             .reject_servers          = reject_servers,
+            .default_route           = !nm_setting_ip_config_get_never_default(s_ip),
             .v4 =
                 {
                     .request_broadcast = request_broadcast,
@@ -11289,6 +11404,7 @@ _dev_ipdhcpx_start(NMDevice *self, int addr_family)
             .mud_url         = _prop_get_connection_mud_url(self, s_con),
             .timeout         = no_lease_timeout_sec,
             .anycast_address = _device_get_dhcp_anycast_address(self),
+            .default_route   = !nm_setting_ip_config_get_never_default(s_ip),
             .v6 =
                 {
                     .enforce_duid  = enforce_duid,
@@ -13111,6 +13227,8 @@ _dev_ipsharedx_cleanup(NMDevice *self, int addr_family)
             g_clear_object(&priv->ipshared_data_4.v4.dnsmasq_manager);
         }
 
+        nm_clear_pointer(&priv->ipshared_data_4.v4.dhcp_server, nm_dhcp_server_destroy);
+
         if (priv->ipshared_data_4.v4.firewall_config) {
             nm_firewall_config_apply_sync(priv->ipshared_data_4.v4.firewall_config, FALSE);
             nm_clear_pointer(&priv->ipshared_data_4.v4.firewall_config, nm_firewall_config_free);
@@ -13234,6 +13352,60 @@ _dev_ipshared4_dnsmasq_state_changed_cb(NMDnsMasqManager *manager, guint status,
     _dev_ip_state_check_async(self, AF_INET);
 }
 
+static void
+_dev_ipshared4_dhcp_server_notify_cb(NMDhcpServer *dhcp_server, gpointer user_data)
+{
+    NMDevice *self = NM_DEVICE(user_data);
+
+    _dev_ipsharedx_set_state(self, AF_INET, NM_DEVICE_IP_STATE_FAILED);
+    _dev_ip_state_check_async(self, AF_INET);
+}
+
+static gboolean
+_dev_ipshared4_use_internal_dhcp_server(NMDevice *self)
+{
+    const char *value;
+
+    value = nm_config_data_get_device_config_by_device(
+        NM_CONFIG_GET_DATA,
+        NM_CONFIG_KEYFILE_KEY_DEVICE_SHARING_DHCP_SERVER,
+        self,
+        NULL);
+    return nm_streq0(value, "internal");
+}
+
+static const NML3ConfigData *
+_dev_ipshared4_get_upstream_l3cd(NMDevice *self)
+{
+    const NML3ConfigData *best_l3cd   = NULL;
+    gint64                best_metric = G_MAXINT64;
+    const CList          *tmp_lst;
+    NMDevice             *dev;
+
+    /* The internal DHCP server does not proxy DNS requests. Find the device with the
+     * best IPv4 default route, so that we can hand out its name servers instead. */
+    nm_manager_for_each_device (nm_device_get_manager(self), dev, tmp_lst) {
+        const NMPObject      *r;
+        const NML3ConfigData *l3cd;
+
+        if (dev == self)
+            continue;
+
+        r = nm_device_get_best_default_route(dev, AF_INET);
+        if (!r || NMP_OBJECT_CAST_IP_ROUTE(r)->metric >= best_metric)
+            continue;
+
+        l3cd = nm_device_get_l3cd(dev, TRUE);
+        if (!l3cd)
+            continue;
+
+        best_metric = NMP_OBJECT_CAST_IP_ROUTE(r)->metric;
+        best_l3cd   = l3cd;
+    }
+
+    return best_l3cd;
+}
+
 static void
 _dev_ipshared4_start(NMDevice *self)
 {
@@ -13248,6 +13420,7 @@ _dev_ipshared4_start(NMDevice *self)
 
     nm_assert(!priv->ipshared_data_4.v4.firewall_config);
     nm_assert(!priv->ipshared_data_4.v4.dnsmasq_manager);
+    nm_assert(!priv->ipshared_data_4.v4.dhcp_server);
     nm_assert(priv->ipshared_data_4.v4.dnsmasq_state_id == 0);
 
     ip_iface = nm_device_get_ip_iface(self);
@@ -13274,7 +13447,7 @@ _dev_ipshared4_start(NMDevice *self)
     priv->ipshared_data_4.v4.l3cd = nm_l3_config_data_ref(l3cd);
     _dev_l3_register_l3cds_set_one(self, L3_CONFIG_DATA_TYPE_SHARED_4, l3cd, FALSE);
 
-    /* Wait that the address gets committed before spawning dnsmasq */
+    /* Wait that the address gets committed before starting the DHCP server */
     return;
 out_fail:
     _dev_ipsharedx_set_state(self, AF_INET, NM_DEVICE_IP_STATE_FAILED);
@@ -13282,7 +13455,7 @@ out_fail:
 }
 
 static void
-_dev_ipshared4_spawn_dnsmasq(NMDevice *self)
+_dev_ipshared4_spawn_dhcp_server(NMDevice *self)
 {
     NMDevicePrivate       *priv = NM_DEVICE_GET_PRIVATE(self);
     const char            *ip_iface;
@@ -13296,6 +13469,7 @@ _dev_ipshared4_spawn_dnsmasq(NMDevice *self)
     nm_assert(priv->ipshared_data_4.v4.firewall_config);
     nm_assert(priv->ipshared_data_4.v4.dnsmasq_state_id == 0);
     nm_assert(!priv->ipshared_data_4.v4.dnsmasq_manager);
+    nm_assert(!priv->ipshared_data_4.v4.dhcp_server);
     nm_assert(priv->ipshared_data_4.v4.l3cd);
 
     ready = nm_l3cfg_check_ready(priv->l3cfg,
@@ -13337,6 +13511,23 @@ _dev_ipshared4_spawn_dnsmasq(NMDevice *self)
         break;
     }
 
+    if (_dev_ipshared4_use_internal_dhcp_server(self)) {
+        priv->ipshared_data_4.v4.dhcp_server =
+            nm_dhcp_server_new(nm_device_get_ip_ifindex(self),
+                               ip_iface,
+                               priv->ipshared_data_4.v4.l3cd,
+                               _dev_ipshared4_get_upstream_l3cd(self),
+                               announce_android_metered,
+                               _dev_ipshared4_dhcp_server_notify_cb,
+                               self,
+                               &error);
+        if (!priv->ipshared_data_4.v4.dhcp_server) {
+            _LOGW_ipshared(AF_INET, "could not start DHCP server: %s", error->message);
+            goto out_fail;
+        }
+        goto out_ready;
+    }
+
     priv->ipshared_data_4.v4.dnsmasq_manager = nm_dnsmasq_manager_new(ip_iface);
     if (!nm_dnsmasq_manager_start(priv->ipshared_data_4.v4.dnsmasq_manager,
                                   priv->ipshared_data_4.v4.l3cd,
@@ -13352,6 +13543,7 @@ _dev_ipshared4_spawn_dnsmasq(NMDevice *self)
                          G_CALLBACK(_dev_ipshared4_dnsmasq_state_changed_cb),
                          self);
 
+out_ready:
     _dev_ipsharedx_set_state(self, AF_INET, NM_DEVICE_IP_STATE_READY);
     _dev_ip_state_check_async(self, AF_INET);
     nm_clear_l3cd(&priv->ipshared_data_4.v4.l3cd);
@@ -15965,6 +16157,7 @@ available_connections_del_all(NMDevice *self)
 {
     if (g_hash_table_size(self->_priv->available_connections) == 0)
         return FALSE;
+    nm_clear_g_free(&self->_priv->available_connections_sorted);
     g_hash_table_remove_all(self->_priv->available_connections);
     return TRUE;
 }
@@ -15972,13 +16165,79 @@ available_connections_del_all(NMDevice *self)
 static gboolean
 available_connections_add(NMDevice *self, NMSettingsConnection *sett_conn)
 {
-    return g_hash_table_add(self->_priv->available_connections, g_object_ref(sett_conn));
+    if (!g_hash_table_add(self->_priv->available_connections, g_object_ref(sett_conn)))
+        return FALSE;
+    nm_clear_g_free(&self->_priv->available_connections_sorted);
+    return TRUE;
 }
 
 static gboolean
 available_connections_del(NMDevice *self, NMSettingsConnection *sett_conn)
 {
-    return g_hash_table_remove(self->_priv->available_connections, sett_conn);
+    if (!g_hash_table_remove(self->_priv->available_connections, sett_conn))
+        return FALSE;
+    nm_clear_g_free(&self->_priv->available_connections_sorted);
+    return TRUE;
+}
+
+/**
+ * nm_device_get_available_connections_sorted_by_autoconnect_priority:
+ * @self: the #NMDevice
+ * @out_len: (out) (optional): the number of returned connections.
+ *
+ * Returns the profiles that are currently available on @self (see
+ * #NMDevice:available-connections), sorted by autoconnect priority.
+ * These are the candidates for autoconnect on this device.
+ *
+ * The list is cached and only rebuilt when the set of available
+ * connections changes. Like nm_settings_get_connections_sorted_by_autoconnect_priority(),
+ * the sort order of the profiles is not monitored, so it gets checked
+ * (and restored if necessary) on every call, which is cheap for the
+ * few profiles that are available on one device.
+ *
+ * Returns: (transfer none): the NULL terminated list of connections, or
+ *   %NULL if there are none. The list is only valid until the next
+ *   change of the available connections.
+ */
+NMSettingsConnection *const *
+nm_device_get_available_connections_sorted_by_autoconnect_priority(NMDevice *self,
+                                                                   guint    *out_len)
+{
+    NMDevicePrivate *priv;
+    guint            len;
+
+    g_return_val_if_fail(NM_IS_DEVICE(self), NULL);
+
+    priv = NM_DEVICE_GET_PRIVATE(self);
+
+    _available_connections_recheck_flush(self);
+
+    len = g_hash_table_size(priv->available_connections);
+
+    if (!priv->available_connections_sorted) {
+        priv->available_connections_sorted = (NMSettingsConnection **) nm_utils_hash_keys_to_array(
+            priv->available_connections,
+            nm_settings_connection_cmp_autoconnect_priority_p_with_data,
+            NULL,
+            NULL);
+    } else if (len > 1
+               && !nm_utils_ptrarray_is_sorted(
+                   (gconstpointer *) priv->available_connections_sorted,
+                   len,
+                   FALSE,
+                   nm_settings_connection_cmp_autoconnect_priority_with_data,
+                   NULL)) {
+        g_qsort_with_data(priv->available_connections_sorted,
+                          len,
+                          sizeof(NMSettingsConnection *),
+                          nm_settings_connection_cmp_autoconnect_priority_p_with_data,
+                          NULL);
+    }
+
+    nm_assert(len == NM_PTRARRAY_LEN(priv->available_connections_sorted));
+
+    NM_SET_OUT(out_len, len);
+    return priv->available_connections_sorted;
 }
 
 static gboolean
@@ -16029,20 +16288,32 @@ check_connection_available(NMDevice                      *self,
     return FALSE;
 }
 
-void
-nm_device_recheck_available_connections(NMDevice *self)
+/* Devices whose available connections need a recheck. They are all
+ * handled by one idle source. The counters are only for logging. */
+static struct {
+    CList    dirty_lst_head;
+    GSource *idle_source;
+    guint64  n_requested;
+    guint64  n_rechecked;
+} _recheck_global = {
+    .dirty_lst_head = C_LIST_INIT(_recheck_global.dirty_lst_head),
+};
+
+static void
+_available_connections_recheck_now(NMDevice *self)
 {
-    NMDevicePrivate               *priv;
+    NMDevicePrivate               *priv = NM_DEVICE_GET_PRIVATE(self);
+    NMDeviceClass                 *klass = NM_DEVICE_GET_CLASS(self);
     NMSettingsConnection *const   *connections;
-    gboolean                       changed = FALSE;
+    gs_unref_ptrarray GPtrArray   *candidates = NULL;
+    gboolean                       changed    = FALSE;
     GHashTableIter                 h_iter;
     NMSettingsConnection          *sett_conn;
+    const char                    *hwaddr;
     guint                          i;
     gs_unref_hashtable GHashTable *prune_list = NULL;
 
-    g_return_if_fail(NM_IS_DEVICE(self));
-
-    priv = NM_DEVICE_GET_PRIVATE(self);
+    _recheck_global.n_rechecked++;
 
     if (g_hash_table_size(priv->available_connections) > 0) {
         prune_list = g_hash_table_new(nm_direct_hash, NULL);
@@ -16051,7 +16322,34 @@ nm_device_recheck_available_connections(NMDevice *self)
             g_hash_table_add(prune_list, sett_conn);
     }
 
-    connections = nm_settings_get_connections(priv->settings, NULL);
+    /* check_connection_compatible() rejects all profiles that don't match
+     * the device class' connection types, interface name or MAC address.
+     * Only consider the candidates from the settings' index. */
+    if (klass->connection_type_check_compatible || klass->connection_types_check_compatible) {
+        hwaddr     = klass->check_connection_compatible_wired_hwaddr
+                         ? nm_device_get_permanent_hw_address(self)
+                         : NULL;
+        candidates = g_ptr_array_new();
+        if (klass->connection_type_check_compatible) {
+            nm_settings_get_connection_candidates(priv->settings,
+                                                  klass->connection_type_check_compatible,
+                                                  nm_device_get_iface(self),
+                                                  hwaddr,
+                                                  candidates);
+        }
+        for (i = 0; klass->connection_types_check_compatible
+                    && klass->connection_types_check_compatible[i];
+             i++) {
+            nm_settings_get_connection_candidates(priv->settings,
+                                                  klass->connection_types_check_compatible[i],
+                                                  nm_device_get_iface(self),
+                                                  hwaddr,
+                                                  candidates);
+        }
+        g_ptr_array_add(candidates, NULL);
+        connections = (NMSettingsConnection *const *) candidates->pdata;
+    } else
+        connections = nm_settings_get_connections(priv->settings, NULL);
     for (i = 0; connections[i]; i++) {
         sett_conn = connections[i];
 
@@ -16080,6 +16378,75 @@ nm_device_recheck_available_connections(NMDevice *self)
     available_connections_check_delete_unrealized(self);
 }
 
+static gboolean
+_available_connections_recheck_idle_cb(gpointer user_data)
+{
+    NMDevice *self;
+    guint     n_devices = 0;
+
+    nm_clear_g_source_inst(&_recheck_global.idle_source);
+
+    while ((self = c_list_first_entry(&_recheck_global.dirty_lst_head,
+                                      NMDevice,
+                                      available_connections_recheck_lst))) {
+        gs_unref_object NMDevice *self_keep_alive = g_object_ref(self);
+
+        c_list_unlink(&self->available_connections_recheck_lst);
+        _available_connections_recheck_now(self);
+        n_devices++;
+    }
+
+    nm_log_trace(LOGD_DEVICE,
+                 "device: rechecked available connections of %u devices (%" G_GUINT64_FORMAT
+                 " of %" G_GUINT64_FORMAT " requests coalesced so far)",
+                 n_devices,
+                 _recheck_global.n_requested - _recheck_global.n_rechecked,
+                 _recheck_global.n_requested);
+
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+_available_connections_recheck_flush(NMDevice *self)
+{
+    if (!c_list_is_linked(&self->available_connections_recheck_lst))
+        return;
+
+    c_list_unlink(&self->available_connections_recheck_lst);
+    if (c_list_is_empty(&_recheck_global.dirty_lst_head))
+        nm_clear_g_source_inst(&_recheck_global.idle_source);
+
+    _available_connections_recheck_now(self);
+}
+
+/**
+ * nm_device_recheck_available_connections:
+ * @self: the #NMDevice
+ *
+ * Marks the available connections of @self as outdated. The actual
+ * recheck of all profiles happens once on idle, for all devices that
+ * were marked in the meantime, so that a burst of events (scan results,
+ * carrier or state changes, settings reloads) costs one pass per device.
+ *
+ * Readers of the available connections flush a pending recheck first,
+ * so they never see a stale list.
+ */
+void
+nm_device_recheck_available_connections(NMDevice *self)
+{
+    g_return_if_fail(NM_IS_DEVICE(self));
+
+    _recheck_global.n_requested++;
+
+    if (c_list_is_linked(&self->available_connections_recheck_lst))
+        return;
+
+    c_list_link_tail(&_recheck_global.dirty_lst_head, &self->available_connections_recheck_lst);
+    if (!_recheck_global.idle_source)
+        _recheck_global.idle_source = nm_g_idle_add_source(_available_connections_recheck_idle_cb,
+                                                           NULL);
+}
+
 /**
  * nm_device_get_best_connection:
  * @self: the #NMDevice
@@ -16100,6 +16467,8 @@ nm_device_get_best_connection(NMDevice *self, const char *specific_object, GErro
     guint64               best_timestamp = 0;
     GHashTableIter        iter;
 
+    _available_connections_recheck_flush(self);
+
     g_hash_table_iter_init(&iter, priv->available_connections);
     while (g_hash_table_iter_next(&iter, (gpointer) &candidate, NULL)) {
         guint64 candidate_timestamp = 0;
@@ -16760,6 +17129,13 @@ _set_state_full(NMDevice *self, NMDeviceState state, NMDeviceStateReason reason,
           nm_device_state_reason_to_string_a(reason),
           nm_device_managed_type_to_string(priv->managed_type));
 
+    NM_USDT(device_state_change,
+            nm_device_get_ip_ifindex(self),
+            priv->iface,
+            (int) old_state,
+            (int) state,
+            (int) reason);
+
     /* in order to prevent triggering any callback caused
      * by the device not having any pending action anymore
      * we add one here that gets removed at the end of the function */
@@ -18549,6 +18925,7 @@ get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
         g_value_set_string(value, priv->type_desc);
         break;
     case PROP_AVAILABLE_CONNECTIONS:
+        _available_connections_recheck_flush(self);
         nm_dbus_utils_g_value_set_object_path_from_hash(value, priv->available_connections, TRUE);
         break;
     case PROP_PHYSICAL_PORT_ID:
@@ -18712,6 +19089,8 @@ nm_device_init(NMDevice *self)
     c_list_init(&self->devices_lst);
     c_list_init(&self->devcon_dev_lst_head);
     c_list_init(&self->policy_auto_activate_lst);
+    c_list_init(&self->available_connections_recheck_lst);
+    c_list_init(&self->stats_lst);
     c_list_init(&priv->ports);
 
     priv->ipdhcp_data_6.v6.mode = NM_NDISC_DHCP_LEVEL_NONE;
@@ -18840,6 +19219,12 @@ dispose(GObject *object)
     nm_assert(c_list_is_empty(&self->policy_auto_activate_lst));
     nm_assert(!self->policy_auto_activate_idle_source);
 
+    if (c_list_is_linked(&self->available_connections_recheck_lst)) {
+        c_list_unlink(&self->available_connections_recheck_lst);
+        if (c_list_is_empty(&_recheck_global.dirty_lst_head))
+            nm_clear_g_source_inst(&_recheck_global.idle_source);
+    }
+
     while ((con_handle = c_list_first_entry(&priv->concheck_lst_head,
                                             NMDeviceConnectivityHandle,
                                             concheck_lst))) {
@@ -18882,7 +19267,7 @@ dispose(GObject *object)
 
     nm_clear_g_source(&priv->check_delete_unrealized_id);
 
-    nm_clear_g_source_inst(&priv->stats.timeout_source);
+    _stats_schedule(self, 0);
 
     carrier_disconnected_action_cancel(self);
 
@@ -18955,6 +19340,7 @@ finalize(GObject *object)
 
     g_hash_table_unref(priv->ip6_saved_properties);
     g_hash_table_unref(priv->available_connections);
+    g_free(priv->available_connections_sorted);
 
     nm_dbus_track_obj_path_deinit(&priv->parent_device);
     nm_dbus_track_obj_path_deinit(&priv->act_request);
@@ -19068,9 +19454,10 @@ static const NMDBusInterfaceInfoExtended interface_info_device = {
                                                            NM_DEVICE_PHYSICAL_PORT_ID),
             NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("Mtu", "u", NM_DEVICE_MTU),
             NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("Metered", "u", NM_DEVICE_METERED),
-            NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("LldpNeighbors",
-                                                           "aa{sv}",
-                                                           NM_DEVICE_LLDP_NEIGHBORS),
+            NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_RATE_LIMITED("LldpNeighbors",
+                                                                        "aa{sv}",
+                                                                        NM_DEVICE_LLDP_NEIGHBORS,
+                                                                        1000),
             NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("Real", "b", NM_DEVICE_REAL),
             NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("Ip4Connectivity",
                                                            "u",
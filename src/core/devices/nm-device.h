@@ -147,6 +147,9 @@ struct _NMDevice {
 
     CList    policy_auto_activate_lst;
     GSource *policy_auto_activate_idle_source;
+
+    CList available_connections_recheck_lst;
+    CList stats_lst;
 };
 
 /* The flags have an relaxing meaning, that means, specifying more flags, can make
@@ -180,6 +183,11 @@ typedef struct _NMDeviceClass {
      * is the connection.type setting, as checked by nm_device_check_connection_compatible() */
     const char *connection_type_check_compatible;
 
+    /* device types that handle profiles of several types in their check_connection_compatible()
+     * implementation list them here (NULL terminated). Like connection_type_check_compatible,
+     * this lets nm_device_recheck_available_connections() only look at profiles of these types. */
+    const char *const *connection_types_check_compatible;
+
     const NMLinkType *link_types;
 
     /* if the device MTU is set based on parent's one, this specifies
@@ -211,6 +219,10 @@ typedef struct _NMDeviceClass {
 
     bool can_reapply_change_ovs_external_ids : 1;
 
+    /* check_connection_compatible() rejects profiles whose 802-3-ethernet.mac-address
+     * does not match the permanent MAC address of the device. */
+    bool check_connection_compatible_wired_hwaddr : 1;
+
     bool allow_autoconnect_on_external : 1;
 
     NMRfkillType rfkill_type : 4;
@@ -766,6 +778,10 @@ nm_device_has_pending_action(NMDevice *device)
 NMSettingsConnection *
 nm_device_get_best_connection(NMDevice *device, const char *specific_object, GError **error);
 
+NMSettingsConnection *const *
+nm_device_get_available_connections_sorted_by_autoconnect_priority(NMDevice *self,
+                                                                   guint    *out_len);
+
 gboolean nm_device_check_connection_available(NMDevice                      *device,
                                               NMConnection                  *connection,
                                               NMDeviceCheckConAvailableFlags flags,
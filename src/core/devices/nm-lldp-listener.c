@@ -45,10 +45,13 @@ struct _NMLldpListener {
 /*****************************************************************************/
 
 typedef struct {
+    /* the variant is only created when the neighbors are requested,
+     * and then cached for as long as the neighbor stays unchanged. */
     GVariant       *variant;
     NMLldpNeighbor *neighbor_nm;
     char           *chassis_id;
     char           *port_id;
+    guint           raw_hash;
     guint8          chassis_id_type;
     guint8          port_id_type;
 } LldpNeighbor;
@@ -134,6 +137,19 @@ lldp_neighbor_id_get(NMLldpNeighbor *neighbor_nm,
     return TRUE;
 }
 
+static guint
+lldp_neighbor_raw_hash(NMLldpNeighbor *neighbor_nm)
+{
+    gconstpointer raw_data = NULL;
+    gsize         raw_len  = 0;
+    int           r;
+
+    r = nm_lldp_neighbor_get_raw(neighbor_nm, &raw_data, &raw_len);
+    nm_assert(r >= 0);
+
+    return nm_hash_mem(1160354851u, raw_data, raw_len);
+}
+
 static guint
 lldp_neighbor_id_hash(const LldpNeighbor *neigh)
 {
@@ -180,18 +196,23 @@ lldp_neighbor_freep(LldpNeighbor **ptr)
 }
 
 static gboolean
-lldp_neighbor_equal(LldpNeighbor *a, LldpNeighbor *b)
+lldp_neighbor_equal_raw(LldpNeighbor *neigh, NMLldpNeighbor *neighbor_nm, guint raw_hash)
 {
     const guint8 *raw_data_a;
-    const guint8 *raw_data_b;
+    gconstpointer raw_data_b = NULL;
     gsize         raw_len_a;
-    gsize         raw_len_b;
+    gsize         raw_len_b = 0;
+    int           r;
 
-    if (a->neighbor_nm == b->neighbor_nm)
+    if (neigh->neighbor_nm == neighbor_nm)
         return TRUE;
 
-    lldp_neighbor_get_raw(a, &raw_data_a, &raw_len_a);
-    lldp_neighbor_get_raw(b, &raw_data_b, &raw_len_b);
+    if (neigh->raw_hash != raw_hash)
+        return FALSE;
+
+    lldp_neighbor_get_raw(neigh, &raw_data_a, &raw_len_a);
+    r = nm_lldp_neighbor_get_raw(neighbor_nm, &raw_data_b, &raw_len_b);
+    nm_assert(r >= 0);
     return raw_len_a == raw_len_b && (memcmp(raw_data_a, raw_data_b, raw_len_a) == 0);
 }
 
@@ -332,7 +353,7 @@ format_string_cp(const guint8 *data, gsize len, gboolean allow_trim)
 }
 
 static LldpNeighbor *
-lldp_neighbor_new(NMLldpNeighbor *neighbor_nm)
+lldp_neighbor_new(NMLldpNeighbor *neighbor_nm, guint raw_hash)
 {
     LldpNeighbor *neigh;
     guint8        chassis_id_type;
@@ -399,6 +420,7 @@ lldp_neighbor_new(NMLldpNeighbor *neighbor_nm)
     neigh  = g_slice_new(LldpNeighbor);
     *neigh = (LldpNeighbor){
         .neighbor_nm     = nm_lldp_neighbor_ref(neighbor_nm),
+        .raw_hash        = raw_hash,
         .chassis_id_type = chassis_id_type,
         .chassis_id      = g_steal_pointer(&s_chassis_id),
         .port_id_type    = port_id_type,
@@ -730,7 +752,7 @@ nmtst_lldp_parse_from_raw(const guint8 *raw_data, gsize raw_len)
     neighbor_nm = nm_lldp_neighbor_new_from_raw(lldp_rx, raw_data, raw_len);
     g_assert(neighbor_nm);
 
-    neigh = lldp_neighbor_new(neighbor_nm);
+    neigh = lldp_neighbor_new(neighbor_nm, lldp_neighbor_raw_hash(neighbor_nm));
     g_assert(neigh);
 
     variant = lldp_neighbor_to_variant(neigh);
@@ -787,8 +809,9 @@ data_changed_schedule(NMLldpListener *self)
 static void
 process_lldp_neighbor(NMLldpListener *self, NMLldpNeighbor *neighbor_nm, gboolean remove)
 {
-    nm_auto(lldp_neighbor_freep) LldpNeighbor *neigh = NULL;
-    LldpNeighbor                              *neigh_old;
+    LldpNeighbor *neigh;
+    LldpNeighbor *neigh_old;
+    guint         raw_hash;
 
     nm_assert(self);
     nm_assert(self->lldp_rx);
@@ -796,17 +819,16 @@ process_lldp_neighbor(NMLldpListener *self, NMLldpNeighbor *neighbor_nm, gboolea
 
     g_return_if_fail(neighbor_nm);
 
-    neigh = lldp_neighbor_new(neighbor_nm);
-    if (!neigh) {
-        _LOGT("process: failed to parse neighbor");
-        return;
-    }
-
-    neigh_old = g_hash_table_lookup(self->lldp_neighbors, neigh);
+    /* The neighbors are indexed by the ID of their NMLldpNeighbor, which
+     * allows to look them up without parsing the frame first. */
+    neigh_old = g_hash_table_lookup(self->lldp_neighbors,
+                                    &((const LldpNeighbor){
+                                        .neighbor_nm = neighbor_nm,
+                                    }));
 
     if (remove) {
         if (neigh_old) {
-            _LOGT("process: %s neigh: " LOG_NEIGH_FMT, "remove", LOG_NEIGH_ARG(neigh));
+            _LOGT("process: %s neigh: " LOG_NEIGH_FMT, "remove", LOG_NEIGH_ARG(neigh_old));
 
             g_hash_table_remove(self->lldp_neighbors, neigh_old);
             goto handle_changed;
@@ -814,12 +836,25 @@ process_lldp_neighbor(NMLldpListener *self, NMLldpNeighbor *neighbor_nm, gboolea
         return;
     }
 
-    if (neigh_old && lldp_neighbor_equal(neigh_old, neigh))
+    if (neigh_old && neigh_old->neighbor_nm == neighbor_nm) {
+        /* The same frame was received again, which only refreshes the TTL. */
+        return;
+    }
+
+    raw_hash = lldp_neighbor_raw_hash(neighbor_nm);
+
+    if (neigh_old && lldp_neighbor_equal_raw(neigh_old, neighbor_nm, raw_hash))
         return;
 
+    neigh = lldp_neighbor_new(neighbor_nm, raw_hash);
+    if (!neigh) {
+        _LOGT("process: failed to parse neighbor");
+        return;
+    }
+
     _LOGD("process: %s neigh: " LOG_NEIGH_FMT, neigh_old ? "update" : "new", LOG_NEIGH_ARG(neigh));
 
-    g_hash_table_add(self->lldp_neighbors, g_steal_pointer(&neigh));
+    g_hash_table_add(self->lldp_neighbors, neigh);
 
 handle_changed:
     data_changed_schedule(self);
@@ -56,6 +56,7 @@ typedef struct {
     GDBusProxy                   *dbus_ap_proxy;
     GDBusProxy                   *dbus_adhoc_proxy;
     CList                         aps_lst_head;
+    NMWifiAPDelta                 aps_delta;
     NMWifiAP                     *current_ap;
     GCancellable                 *cancellable;
     _NMDeviceWifiCapabilities     capabilities;
@@ -144,7 +145,7 @@ ap_add_remove(NMDeviceIwd *self,
         c_list_link_tail(&priv->aps_lst_head, &ap->aps_lst);
         nm_dbus_object_export(NM_DBUS_OBJECT(ap));
         _ap_dump(self, LOGL_DEBUG, ap, "added");
-        nm_device_wifi_emit_signal_access_point(NM_DEVICE(self), ap, TRUE);
+        nm_device_wifi_emit_signal_access_point(NM_DEVICE(self), &priv->aps_delta, ap, TRUE);
     } else {
         ap->wifi_device = NULL;
         c_list_unlink(&ap->aps_lst);
@@ -154,7 +155,7 @@ ap_add_remove(NMDeviceIwd *self,
     _notify(self, PROP_ACCESS_POINTS);
 
     if (!is_adding) {
-        nm_device_wifi_emit_signal_access_point(NM_DEVICE(self), ap, FALSE);
+        nm_device_wifi_emit_signal_access_point(NM_DEVICE(self), &priv->aps_delta, ap, FALSE);
         nm_dbus_object_clear_and_unexport(&ap);
     }
 
@@ -3862,6 +3863,8 @@ dispose(GObject *object)
 
     nm_assert(c_list_is_empty(&priv->aps_lst_head));
 
+    nm_wifi_ap_delta_clear(&priv->aps_delta);
+
     g_clear_object(&priv->manager);
 }
 
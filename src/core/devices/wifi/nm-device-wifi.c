@@ -41,6 +41,7 @@
 #include "nm-wifi-common.h"
 #include "libnm-core-intern/nm-core-internal.h"
 #include "nm-config.h"
+#include "nm-manager.h"
 
 #define _NMLOG_DEVICE_TYPE NMDeviceWifi
 #include "devices/nm-device-logging.h"
@@ -81,6 +82,8 @@ typedef struct {
     CList       aps_lst_head;
     GHashTable *aps_idx_by_supplicant_path;
 
+    NMWifiAPDelta aps_delta;
+
     CList scanning_prohibited_lst_head;
 
     GCancellable *scan_request_cancellable;
@@ -826,7 +829,7 @@ ap_add_remove(NMDeviceWifi *self,
             nm_assert_not_reached();
         nm_dbus_object_export(NM_DBUS_OBJECT(ap));
         _ap_dump(self, LOGL_DEBUG, ap, "added", 0);
-        nm_device_wifi_emit_signal_access_point(NM_DEVICE(self), ap, TRUE);
+        nm_device_wifi_emit_signal_access_point(NM_DEVICE(self), &priv->aps_delta, ap, TRUE);
     } else {
         ap->wifi_device = NULL;
         c_list_unlink(&ap->aps_lst);
@@ -839,7 +842,7 @@ ap_add_remove(NMDeviceWifi *self,
     _notify(self, PROP_ACCESS_POINTS);
 
     if (!is_adding) {
-        nm_device_wifi_emit_signal_access_point(NM_DEVICE(self), ap, FALSE);
+        nm_device_wifi_emit_signal_access_point(NM_DEVICE(self), &priv->aps_delta, ap, FALSE);
         nm_dbus_object_clear_and_unexport(&ap);
     }
 
@@ -1729,6 +1732,53 @@ _scan_kickoff_timeout_cb(gpointer user_data)
     return G_SOURCE_CONTINUE;
 }
 
+static NMDeviceWifi *
+_scan_find_scanning_sibling(NMDeviceWifi *self, gint64 now_msec, int *out_phy)
+{
+    NMPlatform  *platform = nm_device_get_platform(NM_DEVICE(self));
+    NMDevice    *device;
+    const CList *tmp_lst;
+    int          ifindex;
+    int          phy;
+
+    /* wpa_supplicant shares the scan results of a radio with all interfaces
+     * on it. If another interface on the same wiphy is already scanning
+     * (or just did), we also get those results and don't need to scan on
+     * our own. */
+    ifindex = nm_device_get_ifindex(NM_DEVICE(self));
+    if (ifindex <= 0)
+        return NULL;
+
+    phy = nm_platform_wifi_get_phy(platform, ifindex);
+    if (phy < 0)
+        return NULL;
+
+    nm_manager_for_each_device (nm_device_get_manager(NM_DEVICE(self)), device, tmp_lst) {
+        NMDeviceWifiPrivate *sibling_priv;
+        int                  sibling_ifindex;
+
+        if (device == (NMDevice *) self || !NM_IS_DEVICE_WIFI(device))
+            continue;
+
+        sibling_priv = NM_DEVICE_WIFI_GET_PRIVATE(device);
+        if (!sibling_priv->scan_request_cancellable && !sibling_priv->scan_is_scanning
+            && (sibling_priv->scan_last_request_started_at_msec == 0
+                || sibling_priv->scan_last_request_started_at_msec
+                           + (SCAN_INTERVAL_SEC_MIN * 1000)
+                       <= now_msec))
+            continue;
+
+        sibling_ifindex = nm_device_get_ifindex(device);
+        if (sibling_ifindex <= 0 || nm_platform_wifi_get_phy(platform, sibling_ifindex) != phy)
+            continue;
+
+        *out_phy = phy;
+        return NM_DEVICE_WIFI(device);
+    }
+
+    return NULL;
+}
+
 static void
 _scan_kickoff(NMDeviceWifi *self)
 {
@@ -1831,6 +1881,34 @@ _scan_kickoff(NMDeviceWifi *self)
             return;
         }
 
+        ssids = _scan_request_ssids_build_hidden(self, now_msec, &has_hidden_profiles);
+
+        if (!ssids) {
+            NMDeviceWifi *sibling;
+            int           phy;
+
+            /* Explicit scans and probe scans for hidden SSIDs are always done, the
+             * former because the requester waits for our LastScan to change.
+             *
+             * A skipped scan is not a scan, so check this before backing off
+             * and retry with the same interval. */
+            sibling = _scan_find_scanning_sibling(self, now_msec, &phy);
+            if (sibling) {
+                guint interval_sec =
+                    NM_MAX(priv->scan_periodic_interval_sec, (guint) SCAN_INTERVAL_SEC_MIN);
+
+                _LOGT_scan("kickoff: don't scan (%s on the same phy%d scans, retry in %u sec)",
+                           nm_device_get_iface(NM_DEVICE(sibling)),
+                           phy,
+                           interval_sec);
+                priv->scan_periodic_next_msec = now_msec + 1000 * interval_sec;
+                nm_clear_g_source_inst(&priv->scan_kickoff_timeout_source);
+                priv->scan_kickoff_timeout_source =
+                    nm_g_timeout_add_seconds_source(interval_sec, _scan_kickoff_timeout_cb, self);
+                return;
+            }
+        }
+
         priv->scan_periodic_interval_sec =
             NM_CLAMP(((int) priv->scan_periodic_interval_sec) * 3 / 2,
                      SCAN_INTERVAL_SEC_MIN,
@@ -1838,7 +1916,8 @@ _scan_kickoff(NMDeviceWifi *self)
         priv->scan_periodic_next_msec = now_msec + 1000 * priv->scan_periodic_interval_sec;
     }
 
-    ssids = _scan_request_ssids_build_hidden(self, now_msec, &has_hidden_profiles);
+    if (is_explict)
+        ssids = _scan_request_ssids_build_hidden(self, now_msec, &has_hidden_profiles);
     if (has_hidden_profiles) {
         if (priv->hidden_probe_scan_warn) {
             priv->hidden_probe_scan_warn = FALSE;
@@ -1987,6 +2066,11 @@ supplicant_iface_bss_changed_cb(NMSupplicantInterface *iface,
 
     found_ap = g_hash_table_lookup(priv->aps_idx_by_supplicant_path, bss_info->bss_path);
 
+    /* A scan result adds and removes many BSS at once. Each of them requests
+     * a recheck of the available connections, but the requests are coalesced
+     * by nm_device_recheck_available_connections(), so the whole batch costs
+     * a single recheck. */
+
     if (!is_present) {
         if (!found_ap)
             return;
@@ -3808,6 +3892,7 @@ dispose(GObject *object)
     g_clear_object(&priv->sup_mgr);
 
     remove_all_aps(self);
+    nm_wifi_ap_delta_clear(&priv->aps_delta);
 
     if (priv->p2p_device) {
         /* Destroy the P2P device. */
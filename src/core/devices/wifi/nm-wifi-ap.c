@@ -54,6 +54,9 @@ struct _NMWifiAPPrivate {
         last_seen_msec; /* Timestamp when the AP was seen lastly (in nm_utils_get_monotonic_timestamp_*() scale).
                          * Note that this value might be negative! */
 
+    /* The last_seen_msec of the scan result that the strength was taken from. */
+    gint64 strength_sync_msec;
+
     NM80211ApFlags         flags;     /* General flags */
     NM80211ApSecurityFlags wpa_flags; /* WPA-related flags */
     NM80211ApSecurityFlags rsn_flags; /* RSN (WPA2) -related flags */
@@ -354,17 +357,32 @@ nm_wifi_ap_get_flags(const NMWifiAP *ap)
     return NM_WIFI_AP_GET_PRIVATE(ap)->flags;
 }
 
+static int
+_last_seen_to_dbus(gint64 last_seen_msec)
+{
+    if (last_seen_msec == G_MININT64)
+        return -1;
+    return (int) NM_MAX(
+        nm_utils_monotonic_timestamp_as_boottime(last_seen_msec, NM_UTILS_NSEC_PER_MSEC) / 1000,
+        1);
+}
+
 static gboolean
-nm_wifi_ap_set_last_seen(NMWifiAP *ap, gint32 last_seen_msec)
+nm_wifi_ap_set_last_seen(NMWifiAP *ap, gint64 last_seen_msec)
 {
     NMWifiAPPrivate *priv = NM_WIFI_AP_GET_PRIVATE(ap);
+    int              old_dbus;
+
+    if (priv->last_seen_msec == last_seen_msec)
+        return FALSE;
 
-    if (priv->last_seen_msec != last_seen_msec) {
-        priv->last_seen_msec = last_seen_msec;
+    /* LastSeen is exposed in seconds. Don't emit a change if only the
+     * milliseconds moved, which is the case for most scan updates. */
+    old_dbus             = _last_seen_to_dbus(priv->last_seen_msec);
+    priv->last_seen_msec = last_seen_msec;
+    if (old_dbus != _last_seen_to_dbus(last_seen_msec))
         _notify(ap, PROP_LAST_SEEN);
-        return TRUE;
-    }
-    return FALSE;
+    return TRUE;
 }
 
 gboolean
@@ -387,11 +405,21 @@ nm_wifi_ap_get_rsn_flags(const NMWifiAP *self)
 
 /*****************************************************************************/
 
+/* The signal strength from scan results jitters by a few percent all the
+ * time, and every change is a property change on D-Bus. Only follow changes
+ * of at least this many percent, or the first change from a scan result that
+ * is that many milliseconds newer than the one the value was taken from, so
+ * that small drifts don't stay stale forever. The current AP gets its strength
+ * from the driver directly and is not affected. */
+#define STRENGTH_HYSTERESIS_PERCENT 5
+#define STRENGTH_RESYNC_MSEC        30000
+
 gboolean
 nm_wifi_ap_update_from_properties(NMWifiAP *ap, const NMSupplicantBssInfo *bss_info)
 {
     NMWifiAPPrivate *priv;
     gboolean         changed = FALSE;
+    gboolean         is_new;
 
     g_return_val_if_fail(NM_IS_WIFI_AP(ap), FALSE);
     g_return_val_if_fail(bss_info, FALSE);
@@ -403,14 +431,21 @@ nm_wifi_ap_update_from_properties(NMWifiAP *ap, const NMSupplicantBssInfo *bss_i
 
     g_object_freeze_notify(G_OBJECT(ap));
 
-    if (!ap->_supplicant_path) {
+    is_new = !ap->_supplicant_path;
+    if (is_new) {
         ap->_supplicant_path = nm_ref_string_ref(bss_info->bss_path);
         changed              = TRUE;
     }
 
     changed |= nm_wifi_ap_set_flags(ap, bss_info->ap_flags);
     changed |= nm_wifi_ap_set_mode(ap, bss_info->mode);
-    changed |= nm_wifi_ap_set_strength(ap, bss_info->signal_percent);
+    if (is_new
+        || ABS((int) bss_info->signal_percent - (int) priv->strength) >= STRENGTH_HYSTERESIS_PERCENT
+        || (bss_info->signal_percent != priv->strength
+            && bss_info->last_seen_msec >= priv->strength_sync_msec + STRENGTH_RESYNC_MSEC)) {
+        changed |= nm_wifi_ap_set_strength(ap, bss_info->signal_percent);
+        priv->strength_sync_msec = bss_info->last_seen_msec;
+    }
     changed |= nm_wifi_ap_set_freq(ap, bss_info->frequency);
     changed |= nm_wifi_ap_set_ssid(ap, bss_info->ssid);
 
@@ -719,14 +754,7 @@ get_property(GObject *object, guint prop_id, GValue *value, GParamSpec *pspec)
         g_value_set_uchar(value, priv->strength);
         break;
     case PROP_LAST_SEEN:
-        g_value_set_int(
-            value,
-            priv->last_seen_msec != G_MININT64
-                ? (int) NM_MAX(nm_utils_monotonic_timestamp_as_boottime(priv->last_seen_msec,
-                                                                        NM_UTILS_NSEC_PER_MSEC)
-                                   / 1000,
-                               1)
-                : -1);
+        g_value_set_int(value, _last_seen_to_dbus(priv->last_seen_msec));
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -907,7 +935,10 @@ static const NMDBusInterfaceInfoExtended interface_info_access_point = {
                                                            "u",
                                                            NM_WIFI_AP_MAX_BITRATE),
             NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("Bandwidth", "u", NM_WIFI_AP_BANDWIDTH),
-            NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("Strength", "y", NM_WIFI_AP_STRENGTH),
+            NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_RATE_LIMITED("Strength",
+                                                                        "y",
+                                                                        NM_WIFI_AP_STRENGTH,
+                                                                        1000),
             NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("LastSeen",
                                                            "i",
                                                            NM_WIFI_AP_LAST_SEEN), ), ),
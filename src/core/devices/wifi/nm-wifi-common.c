@@ -11,6 +11,8 @@
 #include "nm-wifi-ap.h"
 #include "nm-device-wifi.h"
 #include "nm-dbus-manager.h"
+#include "nm-config.h"
+#include "libnm-glib-aux/nm-ref-string.h"
 
 #if WITH_IWD
 #include "nm-device-iwd.h"
@@ -18,10 +20,120 @@
 
 /*****************************************************************************/
 
+typedef struct {
+    NMRefString *path;
+    bool         is_added;
+} APDeltaEntry;
+
+static void
+_ap_delta_entry_clear(gpointer data)
+{
+    nm_ref_string_unref(((APDeltaEntry *) data)->path);
+}
+
+static gboolean
+_ap_delta_emit_cb(gpointer user_data)
+{
+    NMWifiAPDelta  *delta = user_data;
+    GVariantBuilder added;
+    GVariantBuilder removed;
+    guint           i;
+
+    nm_clear_g_source_inst(&delta->idle_source);
+
+    if (delta->entries->len == 0)
+        return G_SOURCE_CONTINUE;
+
+    if (!nm_dbus_object_get_path(NM_DBUS_OBJECT(delta->device))) {
+        g_array_set_size(delta->entries, 0);
+        return G_SOURCE_CONTINUE;
+    }
+
+    g_variant_builder_init(&added, G_VARIANT_TYPE("ao"));
+    g_variant_builder_init(&removed, G_VARIANT_TYPE("ao"));
+    for (i = 0; i < delta->entries->len; i++) {
+        const APDeltaEntry *entry = &nm_g_array_index(delta->entries, APDeltaEntry, i);
+
+        g_variant_builder_add(entry->is_added ? &added : &removed, "o", entry->path->str);
+    }
+    g_array_set_size(delta->entries, 0);
+
+    nm_dbus_object_emit_signal(NM_DBUS_OBJECT(delta->device),
+                               &nm_interface_info_device_wireless,
+                               &nm_signal_info_wireless_access_points_changed,
+                               "(aoao)",
+                               &added,
+                               &removed);
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+_ap_delta_add(NMWifiAPDelta *delta, NMDevice *device, NMWifiAP *ap, gboolean is_added)
+{
+    nm_auto_ref_string NMRefString *path = NULL;
+    guint                           i;
+
+    nm_assert(!delta->device || delta->device == device);
+
+    /* The batched signal is opt-in, as it comes on top of the per-AP
+     * signals. The setting is checked once per batch. */
+    if (!delta->idle_source
+        && !nm_config_data_get_device_config_boolean_by_device(
+            NM_CONFIG_GET_DATA,
+            NM_CONFIG_KEYFILE_KEY_DEVICE_WIFI_ACCESS_POINTS_CHANGED_SIGNAL,
+            device,
+            FALSE,
+            FALSE))
+        return;
+
+    path = nm_ref_string_new(nm_dbus_object_get_path(NM_DBUS_OBJECT(ap)));
+
+    if (!delta->entries) {
+        delta->device  = device;
+        delta->entries = g_array_new(FALSE, FALSE, sizeof(APDeltaEntry));
+        g_array_set_clear_func(delta->entries, _ap_delta_entry_clear);
+    }
+
+    if (!is_added) {
+        /* An AP that comes and goes within the same batch is not reported.
+         * Object paths are never reused, so the path identifies the AP. */
+        for (i = delta->entries->len; i > 0; i--) {
+            const APDeltaEntry *entry = &nm_g_array_index(delta->entries, APDeltaEntry, i - 1);
+
+            if (entry->path == path) {
+                nm_assert(entry->is_added);
+                g_array_remove_index_fast(delta->entries, i - 1);
+                return;
+            }
+        }
+    }
+
+    g_array_append_val(delta->entries,
+                       ((APDeltaEntry){
+                           .path     = g_steal_pointer(&path),
+                           .is_added = is_added,
+                       }));
+
+    /* Like for the available connections, the idle priority is lower than the
+     * D-Bus signals from the supplicant. All the APs of a scan result end up
+     * in one signal. */
+    if (!delta->idle_source)
+        delta->idle_source = nm_g_idle_add_source(_ap_delta_emit_cb, delta);
+}
+
 void
-nm_device_wifi_emit_signal_access_point(NMDevice *device,
-                                        NMWifiAP *ap,
-                                        gboolean  is_added /* or else is_removed */)
+nm_wifi_ap_delta_clear(NMWifiAPDelta *delta)
+{
+    nm_clear_g_source_inst(&delta->idle_source);
+    nm_clear_pointer(&delta->entries, g_array_unref);
+    delta->device = NULL;
+}
+
+void
+nm_device_wifi_emit_signal_access_point(NMDevice      *device,
+                                        NMWifiAPDelta *delta,
+                                        NMWifiAP      *ap,
+                                        gboolean       is_added /* or else is_removed */)
 {
     nm_dbus_object_emit_signal(NM_DBUS_OBJECT(device),
                                &nm_interface_info_device_wireless,
@@ -29,6 +141,8 @@ nm_device_wifi_emit_signal_access_point(NMDevice *device,
                                         : &nm_signal_info_wireless_access_point_removed,
                                "(o)",
                                nm_dbus_object_get_path(NM_DBUS_OBJECT(ap)));
+
+    _ap_delta_add(delta, device, ap, is_added);
 }
 
 /*****************************************************************************/
@@ -124,6 +238,12 @@ const GDBusSignalInfo nm_signal_info_wireless_access_point_removed =
         "AccessPointRemoved",
         .args = NM_DEFINE_GDBUS_ARG_INFOS(NM_DEFINE_GDBUS_ARG_INFO("access_point", "o"), ), );
 
+const GDBusSignalInfo nm_signal_info_wireless_access_points_changed =
+    NM_DEFINE_GDBUS_SIGNAL_INFO_INIT(
+        "AccessPointsChanged",
+        .args = NM_DEFINE_GDBUS_ARG_INFOS(NM_DEFINE_GDBUS_ARG_INFO("added", "ao"),
+                                          NM_DEFINE_GDBUS_ARG_INFO("removed", "ao"), ), );
+
 const NMDBusInterfaceInfoExtended nm_interface_info_device_wireless = {
     .parent = NM_DEFINE_GDBUS_INTERFACE_INFO_INIT(
         NM_DBUS_INTERFACE_DEVICE_WIRELESS,
@@ -148,7 +268,8 @@ const NMDBusInterfaceInfoExtended nm_interface_info_device_wireless = {
                         NM_DEFINE_GDBUS_ARG_INFO("options", "a{sv}"), ), ),
                 .handle = impl_device_wifi_request_scan, ), ),
         .signals    = NM_DEFINE_GDBUS_SIGNAL_INFOS(&nm_signal_info_wireless_access_point_added,
-                                                &nm_signal_info_wireless_access_point_removed, ),
+                                                &nm_signal_info_wireless_access_point_removed,
+                                                &nm_signal_info_wireless_access_points_changed, ),
         .properties = NM_DEFINE_GDBUS_PROPERTY_INFOS(
             NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("HwAddress", "s", NM_DEVICE_HW_ADDRESS),
             NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE(
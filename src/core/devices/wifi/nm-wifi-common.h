@@ -11,12 +11,24 @@
 
 /*****************************************************************************/
 
-void nm_device_wifi_emit_signal_access_point(NMDevice *device,
-                                             NMWifiAP *ap,
-                                             gboolean  is_added /* or else is_removed */);
+/* The access points that were added and removed since the last
+ * "AccessPointsChanged" signal of a device. */
+typedef struct {
+    NMDevice *device;
+    GArray   *entries;
+    GSource  *idle_source;
+} NMWifiAPDelta;
+
+void nm_wifi_ap_delta_clear(NMWifiAPDelta *delta);
+
+void nm_device_wifi_emit_signal_access_point(NMDevice      *device,
+                                             NMWifiAPDelta *delta,
+                                             NMWifiAP      *ap,
+                                             gboolean       is_added /* or else is_removed */);
 
 extern const NMDBusInterfaceInfoExtended nm_interface_info_device_wireless;
 extern const GDBusSignalInfo             nm_signal_info_wireless_access_point_added;
 extern const GDBusSignalInfo             nm_signal_info_wireless_access_point_removed;
+extern const GDBusSignalInfo             nm_signal_info_wireless_access_points_changed;
 
 #endif /* __NM_WIFI_COMMON_H__ */
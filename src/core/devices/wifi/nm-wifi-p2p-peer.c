@@ -705,9 +705,10 @@ static const NMDBusInterfaceInfoExtended interface_info_p2p_peer = {
             NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("HwAddress",
                                                            "s",
                                                            NM_WIFI_P2P_PEER_HW_ADDRESS),
-            NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("Strength",
-                                                           "y",
-                                                           NM_WIFI_P2P_PEER_STRENGTH),
+            NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_RATE_LIMITED("Strength",
+                                                                        "y",
+                                                                        NM_WIFI_P2P_PEER_STRENGTH,
+                                                                        1000),
             NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE("LastSeen",
                                                            "i",
                                                            NM_WIFI_P2P_PEER_LAST_SEEN), ), ),
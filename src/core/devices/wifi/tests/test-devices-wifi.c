@@ -7,6 +7,9 @@
 
 #include "devices/wifi/nm-wifi-utils.h"
 #include "devices/wifi/nm-device-wifi.h"
+#include "devices/wifi/nm-wifi-ap.h"
+#include "supplicant/nm-supplicant-types.h"
+#include "libnm-glib-aux/nm-ref-string.h"
 #include "libnm-core-intern/nm-core-internal.h"
 
 #include "nm-test-utils-core.h"
@@ -1459,6 +1462,63 @@ test_ssids_options_to_ptrarray(void)
 
 /*****************************************************************************/
 
+static void
+_ap_update_strength(NMWifiAP *ap, NMSupplicantBssInfo *bss_info, guint8 signal_percent, gint64 msec)
+{
+    bss_info->signal_percent = signal_percent;
+    bss_info->last_seen_msec = msec;
+    nm_wifi_ap_update_from_properties(ap, bss_info);
+}
+
+static void
+test_ap_strength_hysteresis(void)
+{
+    nm_auto_ref_string NMRefString *bss_path = NULL;
+    gs_unref_object NMWifiAP       *ap       = NULL;
+    NMSupplicantBssInfo             bss_info;
+
+    bss_path = nm_ref_string_new("/fi/w1/wpa_supplicant1/Interfaces/1/BSSs/1");
+    bss_info = (NMSupplicantBssInfo){
+        .bss_path       = bss_path,
+        .bssid          = NM_ETHER_ADDR_INIT(0x00, 0x11, 0x22, 0x33, 0x44, 0x55),
+        .bssid_valid    = TRUE,
+        .mode           = _NM_802_11_MODE_INFRA,
+        .frequency      = 2412,
+        .signal_percent = 50,
+        .last_seen_msec = 1000,
+    };
+
+    /* a new AP takes the reported strength as is. */
+    ap = nm_wifi_ap_new_from_properties(&bss_info);
+    g_assert_cmpint(nm_wifi_ap_get_strength(ap), ==, 50);
+
+    /* small changes are ignored... */
+    _ap_update_strength(ap, &bss_info, 53, 2000);
+    g_assert_cmpint(nm_wifi_ap_get_strength(ap), ==, 50);
+    _ap_update_strength(ap, &bss_info, 47, 3000);
+    g_assert_cmpint(nm_wifi_ap_get_strength(ap), ==, 50);
+
+    /* ... larger ones are followed. */
+    _ap_update_strength(ap, &bss_info, 55, 4000);
+    g_assert_cmpint(nm_wifi_ap_get_strength(ap), ==, 55);
+    _ap_update_strength(ap, &bss_info, 40, 5000);
+    g_assert_cmpint(nm_wifi_ap_get_strength(ap), ==, 40);
+
+    /* a small drift is taken once the value is old enough. */
+    _ap_update_strength(ap, &bss_info, 42, 34000);
+    g_assert_cmpint(nm_wifi_ap_get_strength(ap), ==, 40);
+    _ap_update_strength(ap, &bss_info, 42, 35000);
+    g_assert_cmpint(nm_wifi_ap_get_strength(ap), ==, 42);
+    _ap_update_strength(ap, &bss_info, 43, 36000);
+    g_assert_cmpint(nm_wifi_ap_get_strength(ap), ==, 42);
+
+    /* the current AP gets its strength from the driver, without hysteresis. */
+    nm_wifi_ap_set_strength(ap, 44);
+    g_assert_cmpint(nm_wifi_ap_get_strength(ap), ==, 44);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -1469,6 +1529,7 @@ main(int argc, char **argv)
     nmtst_init_assert_logging(&argc, &argv, "INFO", "DEFAULT");
 
     g_test_add_func("/wifi/lock_bssid", test_lock_bssid);
+    g_test_add_func("/wifi/ap/strength-hysteresis", test_ap_strength_hysteresis);
 
     /* Open AP tests; make sure that connections to be completed that have
      * various security-related settings already set cause the completion
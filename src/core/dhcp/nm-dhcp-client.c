@@ -358,6 +358,14 @@ nm_dhcp_client_get_pid(NMDhcpClient *self)
     return NM_DHCP_CLIENT_GET_PRIVATE(self)->pid;
 }
 
+gboolean
+nm_dhcp_client_is_stopped(NMDhcpClient *self)
+{
+    g_return_val_if_fail(NM_IS_DHCP_CLIENT(self), TRUE);
+
+    return NM_DHCP_CLIENT_GET_PRIVATE(self)->is_stopped;
+}
+
 static void
 watch_cleanup(NMDhcpClient *self)
 {
@@ -1655,6 +1663,12 @@ nm_dhcp_client_emit_ipv6_prefix_delegated(NMDhcpClient *self, const NMPlatformIP
                  });
 }
 
+void
+nm_dhcp_client_emit_it_looks_bad(NMDhcpClient *self, const char *reason)
+{
+    _emit_notify(self, NM_DHCP_CLIENT_NOTIFY_TYPE_IT_LOOKS_BAD, .it_looks_bad.reason = reason);
+}
+
 gboolean
 nm_dhcp_client_handle_event(gpointer               unused,
                             const char            *iface,
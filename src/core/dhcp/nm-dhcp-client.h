@@ -149,6 +149,10 @@ typedef struct {
      * For DHCPv6 this is always TRUE. */
     bool use_fqdn : 1;
 
+    /* Whether the device may get the default route from this client. When
+     * DHCP starts are rate limited, such clients are started first. */
+    bool default_route : 1;
+
     union {
         struct {
             /* The address from the previous lease */
@@ -242,6 +246,8 @@ const NMDhcpClientConfig *nm_dhcp_client_get_config(NMDhcpClient *self);
 
 pid_t nm_dhcp_client_get_pid(NMDhcpClient *self);
 
+gboolean nm_dhcp_client_is_stopped(NMDhcpClient *self);
+
 const NML3ConfigData *nm_dhcp_client_get_lease(NMDhcpClient *self);
 
 void nm_dhcp_client_stop(NMDhcpClient *self, gboolean release);
@@ -274,6 +280,8 @@ gboolean nm_dhcp_client_handle_event(gpointer               unused,
 void nm_dhcp_client_emit_ipv6_prefix_delegated(NMDhcpClient               *self,
                                                const NMPlatformIP6Address *prefix);
 
+void nm_dhcp_client_emit_it_looks_bad(NMDhcpClient *self, const char *reason);
+
 gboolean nm_dhcp_client_server_id_is_rejected(NMDhcpClient *self, gconstpointer addr);
 
 int                nm_dhcp_client_get_addr_family(NMDhcpClient *self);
@@ -17,6 +17,8 @@
 #include <stdio.h>
 
 #include "libnm-glib-aux/nm-dedup-multi.h"
+#include "libnm-glib-aux/nm-io-utils.h"
+#include "libnm-glib-aux/nm-random-utils.h"
 
 #include "nm-config.h"
 #include "NetworkManagerUtils.h"
@@ -25,6 +27,31 @@
 
 typedef struct {
     const NMDhcpClientFactory *client_factory;
+
+    /* Lease files written through nm_dhcp_manager_lease_store_set(), indexed
+     * by path (LeaseStoreEntry). */
+    GHashTable *lease_store;
+    GSource    *lease_store_source;
+    bool        lease_store_busy : 1;
+
+    struct {
+        /* StartTracker of clients waiting to be started. Clients that may
+         * get the default route are queued before all others. */
+        CList queue_lst_head;
+
+        /* StartTracker of started clients that did not yet get a lease. */
+        CList started_lst_head;
+
+        GSource *source;
+
+        /* The token bucket limiting the start rate. */
+        gint64 refill_msec;
+        guint  tokens;
+
+        guint  n_leases;
+        gint64 lease_msec_sum;
+        gint64 lease_msec_max;
+    } start;
 } NMDhcpManagerPrivate;
 
 struct _NMDhcpManager {
@@ -158,6 +185,305 @@ _client_factory_get_gtype(const NMDhcpClientFactory *client_factory, int addr_fa
 
 /*****************************************************************************/
 
+/* When many devices activate at once, for example at boot, starting all
+ * DHCP clients right away floods the network and the relays with requests,
+ * which then get lost and are retransmitted. Optionally, starts are limited
+ * by a token bucket ("main.dhcp-start-rate", "main.dhcp-start-burst") and
+ * spread by a random delay ("main.dhcp-start-jitter").
+ *
+ * In any case, the time from requesting the start until the first lease is
+ * tracked for each client. */
+#define START_BURST_DEFAULT 10
+
+typedef struct {
+    CList          lst;
+    NMDhcpManager *self;
+    NMDhcpClient  *client;
+    gulong         notify_id;
+    gint64         queued_msec;
+    gint64         ready_msec;
+    gint64         started_msec;
+    bool           default_route : 1;
+} StartTracker;
+
+typedef struct {
+    guint rate;
+    guint burst;
+    guint jitter_msec;
+} StartParams;
+
+static void
+_start_params_get(StartParams *params)
+{
+    const NMConfigData *config_data = NM_CONFIG_GET_DATA;
+
+    params->rate = nm_config_data_get_value_int64(config_data,
+                                                  NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                                  NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_RATE,
+                                                  10,
+                                                  0,
+                                                  G_MAXUINT16,
+                                                  0);
+
+    params->burst = nm_config_data_get_value_int64(config_data,
+                                                   NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                                   NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_BURST,
+                                                   10,
+                                                   1,
+                                                   G_MAXUINT16,
+                                                   START_BURST_DEFAULT);
+
+    params->jitter_msec =
+        nm_config_data_get_value_int64(config_data,
+                                       NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                       NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_JITTER,
+                                       10,
+                                       0,
+                                       60000,
+                                       0);
+}
+
+static void
+_start_tracker_free(gpointer data, GClosure *closure)
+{
+    StartTracker *t = data;
+
+    c_list_unlink_stale(&t->lst);
+    nm_g_slice_free(t);
+}
+
+static void
+_start_tracker_notify_cb(NMDhcpClient                 *client,
+                         const NMDhcpClientNotifyData *notify_data,
+                         gpointer                      user_data)
+{
+    StartTracker         *t    = user_data;
+    NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE(t->self);
+    gint64                lease_msec;
+
+    if (notify_data->notify_type != NM_DHCP_CLIENT_NOTIFY_TYPE_LEASE_UPDATE
+        || !notify_data->lease_update.l3cd)
+        return;
+
+    lease_msec = nm_utils_get_monotonic_timestamp_msec() - t->queued_msec;
+
+    priv->start.n_leases++;
+    priv->start.lease_msec_sum += lease_msec;
+    priv->start.lease_msec_max = MAX(priv->start.lease_msec_max, lease_msec);
+
+    _LOGD(nm_dhcp_client_get_addr_family(client),
+          "%s: got lease %" G_GINT64_FORMAT " msec after start request (queued %" G_GINT64_FORMAT
+          " msec); %u leases, average %" G_GINT64_FORMAT " msec, max %" G_GINT64_FORMAT " msec",
+          nm_dhcp_client_get_iface(client),
+          lease_msec,
+          t->started_msec - t->queued_msec,
+          priv->start.n_leases,
+          priv->start.lease_msec_sum / priv->start.n_leases,
+          priv->start.lease_msec_max);
+
+    /* Only the first lease is of interest. This frees the tracker. */
+    g_signal_handler_disconnect(client, t->notify_id);
+}
+
+static void
+_start_refill(NMDhcpManager *self, const StartParams *params, gint64 now_msec)
+{
+    NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    gint64                n;
+
+    if (priv->start.tokens >= params->burst) {
+        priv->start.tokens      = params->burst;
+        priv->start.refill_msec = now_msec;
+        return;
+    }
+
+    n = (now_msec - priv->start.refill_msec) * params->rate / 1000;
+    if (n <= 0)
+        return;
+
+    if (priv->start.tokens + n >= params->burst) {
+        priv->start.tokens      = params->burst;
+        priv->start.refill_msec = now_msec;
+    } else {
+        priv->start.tokens += n;
+        priv->start.refill_msec += n * 1000 / params->rate;
+    }
+}
+
+static gboolean _start_timeout_cb(gpointer user_data);
+
+static void
+_start_reschedule(NMDhcpManager *self, const StartParams *params, gint64 now_msec)
+{
+    NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    StartTracker         *t;
+    gint64                next_msec = G_MAXINT64;
+
+    nm_clear_g_source_inst(&priv->start.source);
+
+    if (c_list_is_empty(&priv->start.queue_lst_head))
+        return;
+
+    c_list_for_each_entry (t, &priv->start.queue_lst_head, lst)
+        next_msec = MIN(next_msec, t->ready_msec);
+
+    if (params->rate > 0 && priv->start.tokens == 0)
+        next_msec =
+            MAX(next_msec, priv->start.refill_msec + (1000 + params->rate - 1) / params->rate);
+
+    priv->start.source =
+        nm_g_timeout_add_source(MAX(next_msec - now_msec, 0), _start_timeout_cb, self);
+}
+
+static void
+_start_client(NMDhcpManager *self, StartTracker *t, gint64 now_msec)
+{
+    NMDhcpManagerPrivate *priv   = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    NMDhcpClient         *client = t->client;
+    gs_free_error GError *error  = NULL;
+
+    t->started_msec = now_msec;
+    c_list_unlink(&t->lst);
+    c_list_link_tail(&priv->start.started_lst_head, &t->lst);
+
+    _LOGT(nm_dhcp_client_get_addr_family(client),
+          "%s: start client queued for %" G_GINT64_FORMAT " msec",
+          nm_dhcp_client_get_iface(client),
+          now_msec - t->queued_msec);
+
+    /* The tracker may be gone afterwards. */
+    if (!nm_dhcp_client_start(client, &error))
+        nm_dhcp_client_emit_it_looks_bad(client, error->message);
+}
+
+static void
+_start_process(NMDhcpManager *self, const StartParams *params, gint64 now_msec)
+{
+    NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    StartTracker         *t;
+    StartTracker         *t_safe;
+
+    /* Starting a client emits signals. The callee might stop or destroy
+     * other queued clients, so look for the next client from scratch every
+     * time. */
+    for (;;) {
+        StartTracker *next = NULL;
+
+        c_list_for_each_entry_safe (t, t_safe, &priv->start.queue_lst_head, lst) {
+            if (nm_dhcp_client_is_stopped(t->client)) {
+                /* Frees the tracker. */
+                g_signal_handler_disconnect(t->client, t->notify_id);
+                continue;
+            }
+            if (!next && t->ready_msec <= now_msec)
+                next = t;
+        }
+
+        if (!next)
+            return;
+
+        if (params->rate > 0) {
+            _start_refill(self, params, now_msec);
+            if (priv->start.tokens == 0)
+                return;
+            priv->start.tokens--;
+        }
+
+        _start_client(self, next, now_msec);
+    }
+}
+
+static gboolean
+_start_timeout_cb(gpointer user_data)
+{
+    NMDhcpManager        *self = user_data;
+    NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    StartParams           params;
+    gint64                now_msec;
+
+    nm_clear_g_source_inst(&priv->start.source);
+
+    _start_params_get(&params);
+    now_msec = nm_utils_get_monotonic_timestamp_msec();
+
+    _start_process(self, &params, now_msec);
+    _start_reschedule(self, &params, now_msec);
+
+    return G_SOURCE_CONTINUE;
+}
+
+/* Returns TRUE if the client was queued. Otherwise, the caller must start the
+ * client right away. */
+static gboolean
+_start_enqueue(NMDhcpManager *self, NMDhcpClient *client, const NMDhcpClientConfig *config)
+{
+    NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    StartTracker         *t;
+    StartTracker         *t_iter;
+    StartParams           params;
+    gint64                now_msec;
+
+    _start_params_get(&params);
+    now_msec = nm_utils_get_monotonic_timestamp_msec();
+
+    t  = g_slice_new(StartTracker);
+    *t = (StartTracker){
+        .self          = self,
+        .client        = client,
+        .queued_msec   = now_msec,
+        .ready_msec    = now_msec,
+        .default_route = config->default_route,
+    };
+    c_list_init(&t->lst);
+    t->notify_id = g_signal_connect_data(client,
+                                         NM_DHCP_CLIENT_NOTIFY,
+                                         G_CALLBACK(_start_tracker_notify_cb),
+                                         t,
+                                         _start_tracker_free,
+                                         0);
+
+    /* A client that restarts with the previous lease (during reapply) is
+     * already configured, delaying it gains nothing. */
+    if (config->previous_lease || (params.rate == 0 && params.jitter_msec == 0))
+        goto out_start;
+
+    if (params.rate > 0)
+        _start_refill(self, &params, now_msec);
+
+    if (params.jitter_msec > 0)
+        t->ready_msec += nm_random_u64_range(params.jitter_msec + 1);
+    else if (c_list_is_empty(&priv->start.queue_lst_head)
+             && (params.rate == 0 || priv->start.tokens > 0)) {
+        if (params.rate > 0)
+            priv->start.tokens--;
+        goto out_start;
+    }
+
+    if (t->default_route) {
+        c_list_for_each_entry (t_iter, &priv->start.queue_lst_head, lst) {
+            if (!t_iter->default_route)
+                break;
+        }
+        c_list_link_before(&t_iter->lst, &t->lst);
+    } else
+        c_list_link_tail(&priv->start.queue_lst_head, &t->lst);
+
+    _LOGT(config->addr_family,
+          "%s: queue client start (%u tokens left)",
+          config->iface,
+          priv->start.tokens);
+
+    _start_reschedule(self, &params, now_msec);
+    return TRUE;
+
+out_start:
+    t->started_msec = now_msec;
+    c_list_link_tail(&priv->start.started_lst_head, &t->lst);
+    return FALSE;
+}
+
+/*****************************************************************************/
+
 NMDhcpClient *
 nm_dhcp_manager_start_client(NMDhcpManager *self, NMDhcpClientConfig *config, GError **error)
 {
@@ -231,12 +557,406 @@ nm_dhcp_manager_start_client(NMDhcpManager *self, NMDhcpClientConfig *config, GE
      * default outside of NetworkManager API.
      */
 
-    if (!nm_dhcp_client_start(client, error))
-        return NULL;
+    if (!_start_enqueue(self, client, config)) {
+        if (!nm_dhcp_client_start(client, error))
+            return NULL;
+    }
 
     return g_steal_pointer(&client);
 }
 
+/*****************************************************************************/
+
+/* Lease updates are collected for a short while and then written in one
+ * batch from a worker thread. Within a batch all files are first written to
+ * temporary files, then the file system is synced once, the temporary files
+ * are renamed over the destinations and finally the directory is synced.
+ * That preserves the atomic rename semantics of nm_utils_file_set_contents(),
+ * while issuing only a constant number of syncs per batch. */
+#define LEASE_STORE_DELAY_MSEC 1000
+
+typedef struct {
+    /* must be the first field, the entry is hashed with nm_pstr_hash(). */
+    char *path;
+
+    /* The content queued for the next batch. */
+    GBytes *pending;
+
+    /* The content that is currently written by the worker thread. */
+    GBytes *in_flight;
+
+    /* The content known to be on disk. */
+    GBytes *on_disk;
+} LeaseStoreEntry;
+
+typedef struct {
+    char   *path;
+    GBytes *contents;
+    int     errsv;
+} LeaseStoreWrite;
+
+static void _lease_store_schedule(NMDhcpManager *self);
+
+static void
+_lease_store_entry_free(gpointer data)
+{
+    LeaseStoreEntry *entry = data;
+
+    g_free(entry->path);
+    nm_g_bytes_unref(entry->pending);
+    nm_g_bytes_unref(entry->in_flight);
+    nm_g_bytes_unref(entry->on_disk);
+    nm_g_slice_free(entry);
+}
+
+static void
+_lease_store_write_clear(gpointer data)
+{
+    LeaseStoreWrite *w = data;
+
+    g_free(w->path);
+    g_bytes_unref(w->contents);
+}
+
+static GBytes *
+_lease_store_entry_get_latest(const LeaseStoreEntry *entry)
+{
+    if (entry->pending)
+        return entry->pending;
+    if (entry->in_flight)
+        return entry->in_flight;
+    return entry->on_disk;
+}
+
+static LeaseStoreEntry *
+_lease_store_entry_ensure(NMDhcpManager *self, const char *path)
+{
+    NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    LeaseStoreEntry      *entry;
+
+    if (!priv->lease_store) {
+        priv->lease_store =
+            g_hash_table_new_full(nm_pstr_hash, nm_pstr_equal, _lease_store_entry_free, NULL);
+    }
+
+    entry = g_hash_table_lookup(priv->lease_store, &path);
+    if (!entry) {
+        entry  = g_slice_new(LeaseStoreEntry);
+        *entry = (LeaseStoreEntry){
+            .path = g_strdup(path),
+        };
+        g_hash_table_add(priv->lease_store, entry);
+    }
+    return entry;
+}
+
+static int
+_lease_store_write_tmp(const LeaseStoreWrite *w, char **out_tmp_name)
+{
+    gs_free char *tmp_name = NULL;
+    const char   *data;
+    gsize         len;
+    gssize        s;
+    int           fd;
+    int           r;
+
+    tmp_name = g_strdup_printf("%s.XXXXXX", w->path);
+    fd       = g_mkstemp_full(tmp_name, O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return -NM_ERRNO_NATIVE(errno);
+
+    data = g_bytes_get_data(w->contents, &len);
+    while (len > 0) {
+        s = write(fd, data, len);
+        if (s < 0) {
+            r = -NM_ERRNO_NATIVE(errno);
+            if (r == -EINTR)
+                continue;
+            nm_close(fd);
+            unlink(tmp_name);
+            return r;
+        }
+        data += s;
+        len -= s;
+    }
+
+    /* Flush the data before renaming the file over the destination. Otherwise,
+     * a crash could leave us with neither the old nor the new file on file
+     * systems that don't order data before metadata. */
+    if (fdatasync(fd) != 0) {
+        r = -NM_ERRNO_NATIVE(errno);
+        nm_close(fd);
+        unlink(tmp_name);
+        return r;
+    }
+
+    r = nm_close_with_error(fd);
+    if (r < 0) {
+        unlink(tmp_name);
+        return r;
+    }
+
+    *out_tmp_name = g_steal_pointer(&tmp_name);
+    return 0;
+}
+
+static void
+_lease_store_write_batch(GArray *writes)
+{
+    gs_unref_ptrarray GPtrArray *dirs      = g_ptr_array_new_with_free_func(g_free);
+    gs_strfreev char           **tmp_names = g_new0(char *, writes->len + 1);
+    guint                        i;
+    guint                        j;
+
+    for (i = 0; i < writes->len; i++) {
+        LeaseStoreWrite *w   = &nm_g_array_index(writes, LeaseStoreWrite, i);
+        gs_free char    *dir = NULL;
+        int              r;
+
+        r = _lease_store_write_tmp(w, &tmp_names[i]);
+        if (r < 0) {
+            w->errsv = -r;
+            continue;
+        }
+
+        dir = g_path_get_dirname(w->path);
+        for (j = 0; j < dirs->len; j++) {
+            if (nm_streq(dir, dirs->pdata[j]))
+                break;
+        }
+        if (j == dirs->len)
+            g_ptr_array_add(dirs, g_steal_pointer(&dir));
+    }
+
+    for (i = 0; i < writes->len; i++) {
+        LeaseStoreWrite *w = &nm_g_array_index(writes, LeaseStoreWrite, i);
+
+        if (!tmp_names[i])
+            continue;
+        if (rename(tmp_names[i], w->path) != 0) {
+            w->errsv = NM_ERRNO_NATIVE(errno);
+            unlink(tmp_names[i]);
+        }
+    }
+
+    /* Persist the renames, once per directory. */
+    for (j = 0; j < dirs->len; j++) {
+        nm_auto_close int dirfd = -1;
+
+        dirfd = open(dirs->pdata[j], O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirfd >= 0)
+            (void) fsync(dirfd);
+    }
+}
+
+static void
+_lease_store_write_thread_fn(GTask        *task,
+                             gpointer      source_object,
+                             gpointer      task_data,
+                             GCancellable *cancellable)
+{
+    _lease_store_write_batch(task_data);
+    g_task_return_boolean(task, TRUE);
+}
+
+static void
+_lease_store_complete(NMDhcpManager *self, GArray *writes)
+{
+    NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    guint                 i;
+
+    for (i = 0; i < writes->len; i++) {
+        LeaseStoreWrite *w = &nm_g_array_index(writes, LeaseStoreWrite, i);
+        LeaseStoreEntry *entry;
+
+        entry = g_hash_table_lookup(priv->lease_store, &w->path);
+        nm_assert(entry && entry->in_flight == w->contents);
+
+        nm_clear_pointer(&entry->in_flight, g_bytes_unref);
+        nm_clear_pointer(&entry->on_disk, g_bytes_unref);
+        if (w->errsv == 0)
+            entry->on_disk = g_bytes_ref(w->contents);
+        else {
+            _LOGW(AF_INET,
+                  "error saving lease to %s: %s",
+                  w->path,
+                  nm_strerror_native(w->errsv));
+        }
+    }
+
+    _LOGT(AF_INET, "lease-store: wrote %u lease files", writes->len);
+}
+
+static void
+_lease_store_write_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    NMDhcpManager        *self = NM_DHCP_MANAGER(source);
+    NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE(self);
+
+    _lease_store_complete(self, g_task_get_task_data(G_TASK(result)));
+
+    priv->lease_store_busy = FALSE;
+    _lease_store_schedule(self);
+}
+
+static GArray *
+_lease_store_collect(NMDhcpManager *self)
+{
+    NMDhcpManagerPrivate *priv   = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    GArray               *writes = NULL;
+    GHashTableIter        iter;
+    LeaseStoreEntry      *entry;
+
+    if (!priv->lease_store)
+        return NULL;
+
+    g_hash_table_iter_init(&iter, priv->lease_store);
+    while (g_hash_table_iter_next(&iter, (gpointer *) &entry, NULL)) {
+        if (!entry->pending)
+            continue;
+
+        nm_assert(!entry->in_flight);
+
+        if (!writes) {
+            writes = g_array_new(FALSE, FALSE, sizeof(LeaseStoreWrite));
+            g_array_set_clear_func(writes, _lease_store_write_clear);
+        }
+        g_array_append_val(writes,
+                           ((LeaseStoreWrite){
+                               .path     = g_strdup(entry->path),
+                               .contents = g_bytes_ref(entry->pending),
+                           }));
+        entry->in_flight = g_steal_pointer(&entry->pending);
+    }
+
+    return writes;
+}
+
+static gboolean
+_lease_store_timeout_cb(gpointer user_data)
+{
+    NMDhcpManager        *self   = user_data;
+    NMDhcpManagerPrivate *priv   = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    GArray               *writes = NULL;
+    GTask                *task;
+
+    nm_clear_g_source_inst(&priv->lease_store_source);
+
+    writes = _lease_store_collect(self);
+    if (!writes)
+        return G_SOURCE_CONTINUE;
+
+    /* Only one batch is in flight at a time, so that writes to the same file
+     * never race. The task also keeps the manager alive until it completes. */
+    priv->lease_store_busy = TRUE;
+    task                   = g_task_new(self, NULL, _lease_store_write_cb, NULL);
+    g_task_set_task_data(task, writes, (GDestroyNotify) g_array_unref);
+    g_task_run_in_thread(task, _lease_store_write_thread_fn);
+    g_object_unref(task);
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+_lease_store_schedule(NMDhcpManager *self)
+{
+    NMDhcpManagerPrivate *priv = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    GHashTableIter        iter;
+    LeaseStoreEntry      *entry;
+
+    if (priv->lease_store_busy || priv->lease_store_source || !priv->lease_store)
+        return;
+
+    g_hash_table_iter_init(&iter, priv->lease_store);
+    while (g_hash_table_iter_next(&iter, (gpointer *) &entry, NULL)) {
+        if (entry->pending) {
+            priv->lease_store_source =
+                nm_g_timeout_add_source(LEASE_STORE_DELAY_MSEC, _lease_store_timeout_cb, self);
+            return;
+        }
+    }
+}
+
+/**
+ * nm_dhcp_manager_lease_store_set:
+ * @self: the #NMDhcpManager
+ * @path: the path of the lease file
+ * @contents: the new content of the lease file
+ * @len: the length of @contents
+ *
+ * Queues @contents to be written to @path. The file is written
+ * asynchronously together with other pending lease files. If the
+ * content is the same as the last one stored, nothing is written.
+ */
+void
+nm_dhcp_manager_lease_store_set(NMDhcpManager *self,
+                                const char    *path,
+                                const char    *contents,
+                                gsize          len)
+{
+    LeaseStoreEntry *entry;
+    GBytes          *latest;
+
+    g_return_if_fail(NM_IS_DHCP_MANAGER(self));
+    g_return_if_fail(path);
+    g_return_if_fail(contents || len == 0);
+
+    entry  = _lease_store_entry_ensure(self, path);
+    latest = _lease_store_entry_get_latest(entry);
+    if (latest && g_bytes_get_size(latest) == len
+        && nm_memeq(g_bytes_get_data(latest, NULL), contents, len))
+        return;
+
+    nm_g_bytes_unref(entry->pending);
+    entry->pending = g_bytes_new(contents, len);
+    _lease_store_schedule(self);
+}
+
+/**
+ * nm_dhcp_manager_lease_store_get:
+ * @self: the #NMDhcpManager
+ * @path: the path of the lease file
+ *
+ * Returns: (transfer full): the content of the lease file at @path,
+ *   including updates that were not yet written. %NULL if the file
+ *   doesn't exist or cannot be read.
+ */
+char *
+nm_dhcp_manager_lease_store_get(NMDhcpManager *self, const char *path)
+{
+    LeaseStoreEntry *entry;
+    GBytes          *latest;
+    gs_free char    *contents = NULL;
+    gsize            len;
+
+    g_return_val_if_fail(NM_IS_DHCP_MANAGER(self), NULL);
+    g_return_val_if_fail(path, NULL);
+
+    entry  = _lease_store_entry_ensure(self, path);
+    latest = _lease_store_entry_get_latest(entry);
+    if (latest) {
+        const char *data = g_bytes_get_data(latest, &len);
+
+        return g_strndup(data, len);
+    }
+
+    if (nm_utils_file_get_contents(-1,
+                                   path,
+                                   64 * 1024,
+                                   NM_UTILS_FILE_GET_CONTENTS_FLAG_NONE,
+                                   &contents,
+                                   &len,
+                                   NULL,
+                                   NULL)
+        < 0)
+        return NULL;
+
+    /* Remember what is on disk, so that storing the same lease again is a no-op. */
+    entry->on_disk = g_bytes_new(contents, len);
+    return g_steal_pointer(&contents);
+}
+
+/*****************************************************************************/
+
 const char *
 nm_dhcp_manager_get_config(NMDhcpManager *self)
 {
@@ -315,6 +1035,9 @@ nm_dhcp_manager_init(NMDhcpManager *self)
         }
     }
 
+    c_list_init(&priv->start.queue_lst_head);
+    c_list_init(&priv->start.started_lst_head);
+
     g_return_if_fail(client_factory);
 
     _LOGI(AF_UNSPEC, "init: Using DHCP client '%s'", client_factory->name);
@@ -326,6 +1049,42 @@ nm_dhcp_manager_init(NMDhcpManager *self)
     priv->client_factory = client_factory;
 }
 
+static void
+dispose(GObject *object)
+{
+    NMDhcpManager        *self   = NM_DHCP_MANAGER(object);
+    NMDhcpManagerPrivate *priv   = NM_DHCP_MANAGER_GET_PRIVATE(self);
+    GArray               *writes = NULL;
+    StartTracker         *t;
+    StartTracker         *t_safe;
+
+    /* A batch in flight keeps a reference, so nothing can be busy here. */
+    nm_assert(!priv->lease_store_busy);
+
+    nm_clear_g_source_inst(&priv->lease_store_source);
+
+    writes = _lease_store_collect(self);
+    if (writes) {
+        _lease_store_write_batch(writes);
+        _lease_store_complete(self, writes);
+        g_array_unref(writes);
+    }
+
+    nm_clear_pointer(&priv->lease_store, g_hash_table_unref);
+
+    nm_clear_g_source_inst(&priv->start.source);
+    c_list_for_each_entry_safe (t, t_safe, &priv->start.queue_lst_head, lst)
+        g_signal_handler_disconnect(t->client, t->notify_id);
+    c_list_for_each_entry_safe (t, t_safe, &priv->start.started_lst_head, lst)
+        g_signal_handler_disconnect(t->client, t->notify_id);
+
+    G_OBJECT_CLASS(nm_dhcp_manager_parent_class)->dispose(object);
+}
+
 static void
 nm_dhcp_manager_class_init(NMDhcpManagerClass *manager_class)
-{}
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(manager_class);
+
+    object_class->dispose = dispose;
+}
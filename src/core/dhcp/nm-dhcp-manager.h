@@ -34,6 +34,13 @@ void nm_dhcp_manager_set_default_hostname(NMDhcpManager *manager, const char *ho
 NMDhcpClient *
 nm_dhcp_manager_start_client(NMDhcpManager *manager, NMDhcpClientConfig *config, GError **error);
 
+void nm_dhcp_manager_lease_store_set(NMDhcpManager *self,
+                                     const char    *path,
+                                     const char    *contents,
+                                     gsize          len);
+
+char *nm_dhcp_manager_lease_store_get(NMDhcpManager *self, const char *path);
+
 /* For testing only */
 extern const char *nm_dhcp_helper_path;
 
@@ -16,7 +16,6 @@
 #include "n-dhcp4/src/n-dhcp4.h"
 
 #include "libnm-glib-aux/nm-dedup-multi.h"
-#include "libnm-glib-aux/nm-io-utils.h"
 #include "libnm-glib-aux/nm-str-buf.h"
 #include "libnm-std-aux/unaligned.h"
 
@@ -25,6 +24,7 @@
 #include "nm-config.h"
 #include "nm-core-utils.h"
 #include "nm-dhcp-client-logging.h"
+#include "nm-dhcp-manager.h"
 #include "nm-dhcp-options.h"
 #include "nm-dhcp-utils.h"
 #include "nm-l3-config-data.h"
@@ -62,6 +62,7 @@ typedef struct {
 
     GSource *event_source;
     char    *lease_file;
+    bool     hub_acquired : 1;
 } NMDhcpNettoolsPrivate;
 
 struct _NMDhcpNettools {
@@ -872,10 +873,12 @@ lease_to_ip4_config(NMDhcpNettools *self, NDhcp4ClientLease *lease, GError **err
 static void
 lease_save(NMDhcpNettools *self, NDhcp4ClientLease *lease, const char *lease_file)
 {
-    struct in_addr           a_address;
-    nm_auto_str_buf NMStrBuf sbuf = NM_STR_BUF_INIT(NM_UTILS_GET_NEXT_REALLOC_SIZE_104, FALSE);
-    char                     addr_str[NM_INET_ADDRSTRLEN];
-    gs_free_error GError    *error = NULL;
+    NMDhcpManager *dhcp_manager = nm_dhcp_manager_get();
+    struct in_addr a_address;
+    guint64        nettools_lifetime;
+    gint64         remaining    = -1;
+    gs_free char  *old_contents = NULL;
+    gs_free char  *contents     = NULL;
 
     nm_assert(lease);
     nm_assert(lease_file);
@@ -884,11 +887,20 @@ lease_save(NMDhcpNettools *self, NDhcp4ClientLease *lease, const char *lease_fil
     if (a_address.s_addr == INADDR_ANY)
         return;
 
-    nm_str_buf_append(&sbuf, "# This is private data. Do not parse.\n");
-    nm_str_buf_append_printf(&sbuf, "ADDRESS=%s\n", nm_inet4_ntop(a_address.s_addr, addr_str));
+    n_dhcp4_client_lease_get_lifetime(lease, &nettools_lifetime);
+    if (nettools_lifetime != G_MAXUINT64) {
+        const guint64 now_boottime = nm_utils_clock_gettime_nsec(CLOCK_BOOTTIME);
+
+        remaining = 0;
+        if (nettools_lifetime > now_boottime)
+            remaining = (nettools_lifetime - now_boottime) / NM_UTILS_NSEC_PER_SEC;
+    }
+
+    old_contents = nm_dhcp_manager_lease_store_get(dhcp_manager, lease_file);
+    contents =
+        nm_dhcp_utils_lease_file_build(old_contents, a_address.s_addr, time(NULL), remaining);
 
-    if (!g_file_set_contents(lease_file, nm_str_buf_get_str_unsafe(&sbuf), sbuf.len, &error))
-        _LOGW("error saving lease to %s: %s", lease_file, error->message);
+    nm_dhcp_manager_lease_store_set(dhcp_manager, lease_file, contents, strlen(contents));
 }
 
 static void
@@ -1103,6 +1115,64 @@ dhcp4_event_cb(int fd, GIOCondition condition, gpointer user_data)
     return G_SOURCE_CONTINUE;
 }
 
+/*****************************************************************************/
+
+/* With "main.dhcp-shared-socket", all clients share one packet socket
+ * while they wait for their initial lease. The hub lives as long as
+ * there is a client using it. */
+static struct {
+    NDhcp4ClientHub *hub;
+    GSource         *source;
+    guint            n_users;
+} _hub_global;
+
+static gboolean
+_hub_event_cb(int fd, GIOCondition condition, gpointer user_data)
+{
+    int r;
+
+    r = n_dhcp4_client_hub_dispatch(_hub_global.hub);
+    if (r < 0)
+        nm_log_warn(LOGD_DHCP4, "dhcp4: error %d dispatching shared packet socket", r);
+
+    return G_SOURCE_CONTINUE;
+}
+
+static NDhcp4ClientHub *
+_hub_acquire(void)
+{
+    int fd;
+    int r;
+
+    if (!_hub_global.hub) {
+        r = n_dhcp4_client_hub_new(&_hub_global.hub);
+        if (r) {
+            nm_log_warn(LOGD_DHCP4,
+                        "dhcp4: failed to create shared packet socket (%d), use one per client",
+                        r);
+            return NULL;
+        }
+
+        n_dhcp4_client_hub_get_fd(_hub_global.hub, &fd);
+        _hub_global.source = nm_g_unix_fd_add_source(fd, G_IO_IN, _hub_event_cb, NULL);
+    }
+
+    _hub_global.n_users++;
+    return _hub_global.hub;
+}
+
+static void
+_hub_release(void)
+{
+    nm_assert(_hub_global.n_users > 0);
+
+    if (--_hub_global.n_users > 0)
+        return;
+
+    nm_clear_g_source_inst(&_hub_global.source);
+    nm_clear_pointer(&_hub_global.hub, n_dhcp4_client_hub_unref);
+}
+
 static gboolean
 nettools_create(NMDhcpNettools *self, GBytes **out_effective_client_id, GError **error)
 {
@@ -1122,6 +1192,7 @@ nettools_create(NMDhcpNettools *self, GBytes **out_effective_client_id, GError *
     bool                                                     send_client_id;
     int                                                      r, fd, arp_type, transport;
     const NMDhcpClientConfig                                *client_config;
+    NDhcp4ClientHub                                         *hub = NULL;
 
     client_config = nm_dhcp_client_get_config(NM_DHCP_CLIENT(self));
 
@@ -1201,14 +1272,25 @@ nettools_create(NMDhcpNettools *self, GBytes **out_effective_client_id, GError *
         return FALSE;
     }
 
+    if (nm_config_data_get_value_boolean(NM_CONFIG_GET_DATA,
+                                         NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                         NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_SHARED_SOCKET,
+                                         FALSE)) {
+        hub = _hub_acquire();
+        n_dhcp4_client_config_set_hub(config, hub);
+    }
+
     r = n_dhcp4_client_new(&client, config);
     if (r) {
+        if (hub)
+            _hub_release();
         set_error_nettools(error, r, "failed to create client");
         return FALSE;
     }
 
-    priv->client = client;
-    client       = NULL;
+    priv->client       = client;
+    client             = NULL;
+    priv->hub_acquired = !!hub;
 
     n_dhcp4_client_set_log_level(priv->client,
                                  nm_log_level_to_syslog(nm_logging_get_level(LOGD_DHCP4)));
@@ -1314,8 +1396,9 @@ ip4_start(NMDhcpClient *client, GError **error)
     NMDhcpNettoolsPrivate    *priv                = NM_DHCP_NETTOOLS_GET_PRIVATE(self);
     gs_unref_bytes GBytes    *effective_client_id = NULL;
     const NMDhcpClientConfig *client_config;
-    gs_free char             *lease_file = NULL;
-    struct in_addr            last_addr  = {0};
+    gs_free char             *lease_file  = NULL;
+    struct in_addr            last_addr   = {0};
+    gboolean                  init_reboot = TRUE;
     int                       r, i;
 
     client_config = nm_dhcp_client_get_config(client);
@@ -1348,24 +1431,19 @@ ip4_start(NMDhcpClient *client, GError **error)
         inet_pton(AF_INET, client_config->v4.last_address, &last_addr);
     else {
         gs_free char *contents = NULL;
-        gs_free char *s_addr   = NULL;
-
-        nm_utils_file_get_contents(-1,
-                                   lease_file,
-                                   64 * 1024,
-                                   NM_UTILS_FILE_GET_CONTENTS_FLAG_NONE,
-                                   &contents,
-                                   NULL,
-                                   NULL,
-                                   NULL);
-        nm_parse_env_file(contents, "ADDRESS", &s_addr);
-        if (s_addr)
-            nm_inet_parse_bin(AF_INET, s_addr, NULL, &last_addr);
+
+        contents = nm_dhcp_manager_lease_store_get(nm_dhcp_manager_get(), lease_file);
+        nm_dhcp_utils_lease_file_parse(contents, time(NULL), &last_addr.s_addr, &init_reboot);
     }
 
     if (last_addr.s_addr) {
+        char addr_str[NM_INET_ADDRSTRLEN];
+
+        _LOGD("%s previous address %s",
+              init_reboot ? "init-reboot with" : "request",
+              nm_inet4_ntop(last_addr.s_addr, addr_str));
         n_dhcp4_client_probe_config_set_requested_ip(config, last_addr);
-        n_dhcp4_client_probe_config_set_init_reboot(config, TRUE);
+        n_dhcp4_client_probe_config_set_init_reboot(config, init_reboot);
     }
 
     /* Add requested options */
@@ -1513,6 +1591,10 @@ dispose(GObject *object)
     nm_clear_l3cd(&priv->granted.lease_l3cd);
     nm_clear_pointer(&priv->probe, n_dhcp4_client_probe_free);
     nm_clear_pointer(&priv->client, n_dhcp4_client_unref);
+    if (priv->hub_acquired) {
+        priv->hub_acquired = FALSE;
+        _hub_release();
+    }
 
     G_OBJECT_CLASS(nm_dhcp_nettools_parent_class)->dispose(object);
 }
@@ -0,0 +1,492 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "src/core/nm-default-daemon.h"
+
+#include "nm-dhcp-server.h"
+
+#include <arpa/inet.h>
+
+#include "n-dhcp4/src/n-dhcp4.h"
+
+#include "libnm-core-intern/nm-core-internal.h"
+#include "libnm-glib-aux/nm-io-utils.h"
+#include "libnm-glib-aux/nm-str-buf.h"
+#include "libnm-glib-aux/nm-time-utils.h"
+#include "dnsmasq/nm-dnsmasq-utils.h"
+#include "nm-dhcp-options.h"
+#include "nm-l3-config-data.h"
+#include "nm-utils.h"
+
+/* Same lease time as we configure for dnsmasq. */
+#define LEASE_TIME_SEC ((guint32) (60 * 60))
+
+/*****************************************************************************/
+
+struct _NMDhcpServer {
+    NDhcp4Server   *server;
+    NDhcp4ServerIp *server_ip;
+    GSource        *event_source;
+    GSource        *save_source;
+    char           *iface;
+    char           *lease_file;
+
+    NMDhcpServerNotify notify_callback;
+    gpointer           notify_user_data;
+};
+
+/*****************************************************************************/
+
+#define _NMLOG_DOMAIN      LOGD_SHARING
+#define _NMLOG(level, ...)                                               \
+    nm_log((level),                                                      \
+           _NMLOG_DOMAIN,                                                \
+           (self)->iface,                                                \
+           NULL,                                                         \
+           "dhcp-server[%s]: " _NM_UTILS_MACRO_FIRST(__VA_ARGS__),       \
+           (self)->iface _NM_UTILS_MACRO_REST(__VA_ARGS__))
+
+/*****************************************************************************/
+
+/* Leases are persisted with wall-clock expiry, so that they survive a reboot
+ * just like with dnsmasq. Each line holds the expiry in seconds since the
+ * epoch, the address and the client identifier in hex. */
+
+static void
+_leases_save(NMDhcpServer *self)
+{
+    nm_auto_str_buf NMStrBuf sbuf  = NM_STR_BUF_INIT(NM_UTILS_GET_NEXT_REALLOC_SIZE_488, FALSE);
+    gs_free_error GError    *error = NULL;
+    NDhcp4ServerLease       *lease;
+    gint64                   now_boot;
+    gint64                   now_real;
+
+    now_boot = nm_utils_clock_gettime_nsec(CLOCK_BOOTTIME);
+    now_real = nm_utils_clock_gettime_nsec(CLOCK_REALTIME);
+
+    nm_str_buf_append(&sbuf, "# This is private data. Do not parse.\n");
+
+    for (lease = n_dhcp4_server_next_lease(self->server, NULL); lease;
+         lease = n_dhcp4_server_next_lease(self->server, lease)) {
+        char           addr_str[NM_INET_ADDRSTRLEN];
+        gs_free char  *id_str = NULL;
+        const uint8_t *id;
+        size_t         n_id;
+        struct in_addr addr;
+        guint64        lifetime;
+
+        n_dhcp4_server_lease_get_yiaddr(lease, &addr);
+        n_dhcp4_server_lease_get_lifetime(lease, &lifetime);
+        n_dhcp4_server_lease_get_client_id(lease, &id, &n_id);
+
+        id_str = nm_utils_bin2hexstr_full(id, n_id, '\0', FALSE, NULL);
+
+        nm_str_buf_append_printf(&sbuf,
+                                 "%" G_GINT64_FORMAT " %s %s\n",
+                                 (now_real + ((gint64) lifetime - now_boot))
+                                     / NM_UTILS_NSEC_PER_SEC,
+                                 nm_inet4_ntop(addr.s_addr, addr_str),
+                                 id_str);
+    }
+
+    if (!nm_utils_file_set_contents(self->lease_file,
+                                    nm_str_buf_get_str_unsafe(&sbuf),
+                                    sbuf.len,
+                                    0600,
+                                    NULL,
+                                    NULL,
+                                    &error))
+        _LOGW("error saving leases to %s: %s", self->lease_file, error->message);
+}
+
+static gboolean
+_leases_save_cb(gpointer user_data)
+{
+    NMDhcpServer *self = user_data;
+
+    nm_clear_g_source_inst(&self->save_source);
+    _leases_save(self);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+_leases_save_schedule(NMDhcpServer *self)
+{
+    /* coalesce a burst of lease changes into one write. */
+    if (!self->save_source)
+        self->save_source = nm_g_idle_add_source(_leases_save_cb, self);
+}
+
+static void
+_leases_load(NMDhcpServer *self)
+{
+    gs_free char        *contents = NULL;
+    gs_free const char **lines    = NULL;
+    gint64               now_boot;
+    gint64               now_real;
+    gsize                i;
+    guint                n_loaded = 0;
+
+    if (!g_file_get_contents(self->lease_file, &contents, NULL, NULL))
+        return;
+
+    now_boot = nm_utils_clock_gettime_nsec(CLOCK_BOOTTIME);
+    now_real = nm_utils_clock_gettime_nsec(CLOCK_REALTIME) / NM_UTILS_NSEC_PER_SEC;
+
+    lines = nm_strsplit_set(contents, "\n");
+    for (i = 0; lines && lines[i]; i++) {
+        gs_free const char **tokens = NULL;
+        gs_free guint8      *id     = NULL;
+        gsize                n_id;
+        gint64               expiry;
+        in_addr_t            addr;
+        int                  r;
+
+        if (lines[i][0] == '#')
+            continue;
+
+        tokens = nm_strsplit_set(lines[i], " ");
+        if (NM_PTRARRAY_LEN(tokens) != 3)
+            continue;
+
+        expiry = _nm_utils_ascii_str_to_int64(tokens[0], 10, 0, G_MAXINT64, 0);
+        if (expiry <= now_real)
+            continue;
+
+        if (!nm_inet_parse_bin(AF_INET, tokens[1], NULL, &addr))
+            continue;
+
+        id = nm_utils_hexstr2bin_alloc(tokens[2], FALSE, FALSE, NULL, 0, &n_id);
+        if (!id)
+            continue;
+
+        r = n_dhcp4_server_add_lease(self->server,
+                                     id,
+                                     n_id,
+                                     (struct in_addr){addr},
+                                     now_boot + (expiry - now_real) * NM_UTILS_NSEC_PER_SEC);
+        if (r) {
+            /* the subnet may have changed since, just drop the lease. */
+            _LOGT("ignoring persisted lease for %s (%d)", tokens[1], r);
+            continue;
+        }
+
+        n_loaded++;
+    }
+
+    _LOGD("restored %u leases from %s", n_loaded, self->lease_file);
+}
+
+/*****************************************************************************/
+
+static void
+_events_pop_all(NMDhcpServer *self)
+{
+    gboolean changed = FALSE;
+
+    for (;;) {
+        char               addr_str[NM_INET_ADDRSTRLEN];
+        NDhcp4ServerEvent *event;
+        struct in_addr     addr;
+        const char        *name;
+        int                r;
+
+        r = n_dhcp4_server_pop_event(self->server, &event);
+        if (r || !event)
+            break;
+
+        switch (event->event) {
+        case N_DHCP4_SERVER_EVENT_REQUEST:
+            name = "bound";
+            break;
+        case N_DHCP4_SERVER_EVENT_RENEW:
+            name = "renewed";
+            break;
+        case N_DHCP4_SERVER_EVENT_DECLINE:
+            name = "declined";
+            break;
+        case N_DHCP4_SERVER_EVENT_RELEASE:
+            name = "released";
+            break;
+        default:
+            continue;
+        }
+
+        /* all lease events share the same layout */
+        n_dhcp4_server_lease_get_yiaddr(event->request.lease, &addr);
+        _LOGD("lease %s: %s", name, nm_inet4_ntop(addr.s_addr, addr_str));
+        changed = TRUE;
+    }
+
+    if (changed)
+        _leases_save_schedule(self);
+}
+
+static gboolean
+_event_cb(int fd, GIOCondition condition, gpointer user_data)
+{
+    NMDhcpServer *self = user_data;
+    int           r;
+
+    r = n_dhcp4_server_dispatch(self->server);
+    if (r < 0) {
+        _LOGE("error %d dispatching requests", r);
+        nm_clear_g_source_inst(&self->event_source);
+        if (self->notify_callback)
+            self->notify_callback(self, self->notify_user_data);
+        return G_SOURCE_REMOVE;
+    }
+
+    _events_pop_all(self);
+    return G_SOURCE_CONTINUE;
+}
+
+/*****************************************************************************/
+
+static void
+_append_option(NMDhcpServer       *self,
+               NDhcp4ServerConfig *config,
+               guint8              option,
+               gconstpointer       data,
+               gsize               n_data)
+{
+    int r;
+
+    if (n_data > G_MAXUINT8) {
+        _LOGW("option %u is too long, not announcing it", option);
+        return;
+    }
+
+    r = n_dhcp4_server_config_append_option(config, option, data, n_data);
+    if (r)
+        _LOGW("failure to set option %u (%d)", option, r);
+}
+
+static gboolean
+_append_domain_search(GByteArray *arr, const char *domain)
+{
+    gs_free const char **labels = NULL;
+    gsize                i;
+
+    /* RFC 3397 encoding, without compression. */
+    labels = nm_strsplit_set(domain, ".");
+    for (i = 0; labels && labels[i]; i++) {
+        gsize  l = strlen(labels[i]);
+        guint8 len;
+
+        if (l > 63)
+            return FALSE;
+        len = l;
+        g_byte_array_append(arr, &len, 1);
+        g_byte_array_append(arr, (const guint8 *) labels[i], len);
+    }
+    g_byte_array_append(arr, (const guint8 *) "", 1);
+    return TRUE;
+}
+
+static void
+_append_nameservers(GByteArray *arr, const NML3ConfigData *l3cd)
+{
+    const char *const *strarr;
+    guint              n;
+    guint              i;
+
+    strarr = nm_l3_config_data_get_nameservers(l3cd, AF_INET, &n);
+    for (i = 0; i < n; i++) {
+        in_addr_t a;
+
+        if (!nm_utils_dnsname_parse_assert(AF_INET, strarr[i], NULL, &a, NULL))
+            continue;
+        g_byte_array_append(arr, (const guint8 *) &a, sizeof(a));
+    }
+}
+
+static void
+_config_set_options(NMDhcpServer               *self,
+                    NDhcp4ServerConfig         *config,
+                    const NML3ConfigData       *l3cd,
+                    const NML3ConfigData       *upstream_l3cd,
+                    const NMPlatformIP4Address *listen_address,
+                    gboolean                    announce_android_metered)
+{
+    gs_unref_bytearray GByteArray *arr = NULL;
+    const char *const             *strarr;
+    in_addr_t                      netmask;
+    guint                          n;
+    guint                          i;
+
+    netmask = nm_ip4_addr_netmask_from_prefix(listen_address->plen);
+    _append_option(self, config, NM_DHCP_OPTION_DHCP4_SUBNET_MASK, &netmask, sizeof(netmask));
+
+    if (nm_l3_config_data_get_best_default_route(l3cd, AF_INET)) {
+        _append_option(self,
+                       config,
+                       NM_DHCP_OPTION_DHCP4_ROUTER,
+                       &listen_address->address,
+                       sizeof(listen_address->address));
+    }
+
+    arr = g_byte_array_new();
+    _append_nameservers(arr, l3cd);
+    if (arr->len == 0 && upstream_l3cd) {
+        /* Without explicit name servers (the usual case in shared mode), hand
+         * out the upstream ones. Unlike dnsmasq, we don't run a DNS proxy, so
+         * we must never announce our own address. */
+        _append_nameservers(arr, upstream_l3cd);
+    }
+    if (arr->len > 0)
+        _append_option(self, config, NM_DHCP_OPTION_DHCP4_DOMAIN_NAME_SERVER, arr->data, arr->len);
+    nm_clear_pointer(&arr, g_byte_array_unref);
+
+    strarr = nm_l3_config_data_get_searches(l3cd, AF_INET, &n);
+    if (n > 0) {
+        arr = g_byte_array_new();
+        for (i = 0; i < n; i++) {
+            guint len = arr->len;
+
+            if (!_append_domain_search(arr, strarr[i])) {
+                _LOGW("invalid search domain '%s'", strarr[i]);
+                g_byte_array_set_size(arr, len);
+            }
+        }
+        if (arr->len > 0) {
+            _append_option(self,
+                           config,
+                           NM_DHCP_OPTION_DHCP4_DOMAIN_SEARCH_LIST,
+                           arr->data,
+                           arr->len);
+        }
+        nm_clear_pointer(&arr, g_byte_array_unref);
+    }
+
+    if (announce_android_metered) {
+        /* see nm_dnsmasq_manager_start() */
+        _append_option(self,
+                       config,
+                       NM_DHCP_OPTION_DHCP4_VENDOR_SPECIFIC,
+                       "ANDROID_METERED",
+                       NM_STRLEN("ANDROID_METERED"));
+    }
+}
+
+NMDhcpServer *
+nm_dhcp_server_new(int                   ifindex,
+                   const char           *iface,
+                   const NML3ConfigData *l3cd,
+                   const NML3ConfigData *upstream_l3cd,
+                   gboolean              announce_android_metered,
+                   NMDhcpServerNotify    notify_callback,
+                   gpointer              notify_user_data,
+                   GError              **error)
+{
+    nm_auto(n_dhcp4_server_config_freep) NDhcp4ServerConfig *config = NULL;
+    const NMPlatformIP4Address                              *listen_address;
+    gs_free char                                            *error_desc = NULL;
+    NMDhcpServer                                            *self;
+    in_addr_t                                                first;
+    in_addr_t                                                last;
+    int                                                      fd;
+    int                                                      r;
+
+    g_return_val_if_fail(ifindex > 0, NULL);
+    g_return_val_if_fail(iface, NULL);
+    g_return_val_if_fail(NM_IS_L3_CONFIG_DATA(l3cd), NULL);
+    g_return_val_if_fail(!error || !*error, NULL);
+
+    listen_address = NMP_OBJECT_CAST_IP4_ADDRESS(
+        nm_l3_config_data_get_first_obj(l3cd, NMP_OBJECT_TYPE_IP4_ADDRESS, NULL));
+    g_return_val_if_fail(listen_address, NULL);
+
+    if (!nm_dnsmasq_utils_get_range_bin(listen_address, &first, &last, &error_desc)) {
+        g_set_error_literal(error, NM_MANAGER_ERROR, NM_MANAGER_ERROR_FAILED, error_desc);
+        return NULL;
+    }
+
+    self  = g_slice_new(NMDhcpServer);
+    *self = (NMDhcpServer){
+        .iface            = g_strdup(iface),
+        .lease_file       = g_strdup_printf(NMSTATEDIR "/dhcp-server-%s.leases", iface),
+        .notify_callback  = notify_callback,
+        .notify_user_data = notify_user_data,
+    };
+
+    r = n_dhcp4_server_config_new(&config);
+    if (r) {
+        nm_utils_error_set_errno(error, r, "failed to create server config: %s");
+        goto fail;
+    }
+
+    n_dhcp4_server_config_set_ifindex(config, ifindex);
+    n_dhcp4_server_config_set_lifetime(config, LEASE_TIME_SEC);
+
+    r = n_dhcp4_server_config_set_range(config, (struct in_addr){first}, (struct in_addr){last});
+    if (r) {
+        g_set_error(error,
+                    NM_MANAGER_ERROR,
+                    NM_MANAGER_ERROR_FAILED,
+                    "invalid DHCP address range (%d)",
+                    r);
+        goto fail;
+    }
+
+    _config_set_options(self,
+                        config,
+                        l3cd,
+                        upstream_l3cd,
+                        listen_address,
+                        announce_android_metered);
+
+    r = n_dhcp4_server_new(&self->server, config);
+    if (r) {
+        if (r < 0)
+            nm_utils_error_set_errno(error, r, "failed to create server: %s");
+        else
+            g_set_error(error,
+                        NM_MANAGER_ERROR,
+                        NM_MANAGER_ERROR_FAILED,
+                        "failed to create server (%d)",
+                        r);
+        goto fail;
+    }
+
+    r = n_dhcp4_server_add_ip(self->server,
+                              &self->server_ip,
+                              (struct in_addr){listen_address->address});
+    if (r) {
+        nm_utils_error_set_errno(error, r, "failed to set server address: %s");
+        goto fail;
+    }
+
+    _leases_load(self);
+
+    n_dhcp4_server_get_fd(self->server, &fd);
+    self->event_source = nm_g_unix_fd_add_source(fd, G_IO_IN, _event_cb, self);
+
+    _LOGI("started");
+    return self;
+
+fail:
+    nm_dhcp_server_destroy(self);
+    return NULL;
+}
+
+void
+nm_dhcp_server_destroy(NMDhcpServer *self)
+{
+    if (!self)
+        return;
+
+    nm_clear_g_source_inst(&self->event_source);
+
+    if (self->save_source) {
+        nm_clear_g_source_inst(&self->save_source);
+        _leases_save(self);
+    }
+
+    /* the address must be released before the server. */
+    nm_clear_pointer(&self->server_ip, n_dhcp4_server_ip_free);
+    nm_clear_pointer(&self->server, n_dhcp4_server_unref);
+
+    g_free(self->iface);
+    g_free(self->lease_file);
+    nm_g_slice_free(self);
+}
@@ -0,0 +1,26 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#ifndef __NM_DHCP_SERVER_H__
+#define __NM_DHCP_SERVER_H__
+
+/*****************************************************************************/
+
+typedef struct _NMDhcpServer NMDhcpServer;
+
+/* Called when the server failed and stopped serving requests. */
+typedef void (*NMDhcpServerNotify)(NMDhcpServer *self, gpointer user_data);
+
+NMDhcpServer *nm_dhcp_server_new(int                   ifindex,
+                                 const char           *iface,
+                                 const NML3ConfigData *l3cd,
+                                 const NML3ConfigData *upstream_l3cd,
+                                 gboolean              announce_android_metered,
+                                 NMDhcpServerNotify    notify_callback,
+                                 gpointer              notify_user_data,
+                                 GError              **error);
+
+void nm_dhcp_server_destroy(NMDhcpServer *self);
+
+/*****************************************************************************/
+
+#endif /* __NM_DHCP_SERVER_H__ */
@@ -49,6 +49,9 @@ typedef struct {
     sd_dhcp6_client *client6;
     char            *lease_file;
 
+    /* The lease of the last reply. See nm_dhcp_utils_ip6_lease_info_to_l3cd(). */
+    NMDhcp6LeaseCache lease_cache;
+
     guint request_count;
 } NMDhcpSystemdPrivate;
 
@@ -79,131 +82,85 @@ lifetime_to_uint32(guint64 lft)
 static NML3ConfigData *
 lease_to_ip6_config(NMDhcpSystemd *self, sd_dhcp6_lease *lease, gint32 ts, GError **error)
 {
+    NMDhcpSystemdPrivate                   *priv      = NM_DHCP_SYSTEMD_GET_PRIVATE(self);
     const NMDhcpClientConfig               *config;
-    nm_auto_unref_l3cd_init NML3ConfigData *l3cd    = NULL;
-    gs_unref_hashtable GHashTable          *options = NULL;
+    nm_auto_unref_l3cd_init NML3ConfigData *l3cd      = NULL;
+    gs_unref_array GArray                  *addresses = NULL;
+    gs_unref_array GArray                  *prefixes  = NULL;
+    NMDhcp6LeaseInfo                        info;
+    NMPlatformIP6Address                    prefix    = {0};
     struct in6_addr                         tmp_addr;
-    const struct in6_addr                  *dns;
-    char                                    addr_str[NM_INET_ADDRSTRLEN];
-    char                                    iaid_buf[NM_DHCP_IAID_TO_HEXSTR_BUF_LEN];
-    char                                  **domains;
-    char                                  **ntp_fqdns;
-    const struct in6_addr                  *ntp_addrs;
-    const char                             *s;
-    nm_auto_free_gstring GString           *str = NULL;
-    int                                     num, i;
+    const struct in6_addr                  *dns       = NULL;
+    const struct in6_addr                  *ntp_addrs = NULL;
+    char                                  **domains   = NULL;
+    char                                  **ntp_fqdns = NULL;
+    const char                             *fqdn;
+    uint64_t                                lft_pref;
+    uint64_t                                lft_valid;
+    int                                     num;
 
     nm_assert(lease);
 
     config = nm_dhcp_client_get_config(NM_DHCP_CLIENT(self));
 
-    l3cd = nm_dhcp_client_create_l3cd(NM_DHCP_CLIENT(self));
-
-    options = nm_dhcp_client_create_options_dict(NM_DHCP_CLIENT(self), TRUE);
-
-    nm_dhcp_option_add_option(options,
-                              TRUE,
-                              AF_INET6,
-                              NM_DHCP_OPTION_DHCP6_NM_IAID,
-                              nm_dhcp_iaid_to_hexstr(config->v6.iaid, iaid_buf));
+    info = (NMDhcp6LeaseInfo){
+        .iaid      = config->v6.iaid,
+        .client_id = nm_dhcp_client_get_effective_client_id(NM_DHCP_CLIENT(self)),
+    };
 
     if (!config->v6.info_only) {
-        gboolean has_any_addresses = FALSE;
-        uint64_t lft_pref;
-        uint64_t lft_valid;
+        addresses = g_array_new(FALSE, FALSE, sizeof(NMPlatformIP6Address));
 
         sd_dhcp6_lease_address_iterator_reset(lease);
-        nm_gstring_prepare(&str);
         while (sd_dhcp6_lease_get_address(lease, &tmp_addr) >= 0
                && sd_dhcp6_lease_get_address_lifetime(lease, &lft_pref, &lft_valid) >= 0) {
-            NMPlatformIP6Address address = {
-                .plen        = 128,
-                .address     = tmp_addr,
-                .timestamp   = ts,
-                .lifetime    = lifetime_to_uint32(lft_valid),
-                .preferred   = lifetime_to_uint32(lft_pref),
-                .addr_source = NM_IP_CONFIG_SOURCE_DHCP,
-            };
-
-            nm_l3_config_data_add_address_6(l3cd, &address);
-
-            nm_inet6_ntop(&tmp_addr, addr_str);
-            g_string_append(nm_gstring_add_space_delimiter(str), addr_str);
-
-            has_any_addresses = TRUE;
+            g_array_append_val(addresses,
+                               ((NMPlatformIP6Address){
+                                   .plen        = 128,
+                                   .address     = tmp_addr,
+                                   .timestamp   = ts,
+                                   .lifetime    = lifetime_to_uint32(lft_valid),
+                                   .preferred   = lifetime_to_uint32(lft_pref),
+                                   .addr_source = NM_IP_CONFIG_SOURCE_DHCP,
+                               }));
             sd_dhcp6_lease_address_iterator_next(lease);
         }
 
-        if (str->len) {
-            nm_dhcp_option_add_option(options,
-                                      TRUE,
-                                      AF_INET6,
-                                      NM_DHCP_OPTION_DHCP6_NM_IP_ADDRESS,
-                                      str->str);
-        }
-
-        if (!has_any_addresses) {
+        if (addresses->len == 0) {
             g_set_error_literal(error,
                                 NM_MANAGER_ERROR,
                                 NM_MANAGER_ERROR_FAILED,
                                 "no address received in managed mode");
             return NULL;
         }
+
+        info.addresses   = nm_g_array_first_p(addresses, NMPlatformIP6Address);
+        info.n_addresses = addresses->len;
     }
 
-    num = sd_dhcp6_lease_get_dns(lease, &dns);
-    if (num > 0) {
-        nm_gstring_prepare(&str);
-        for (i = 0; i < num; i++) {
-            nm_inet6_ntop(&dns[i], addr_str);
-            g_string_append(nm_gstring_add_space_delimiter(str), addr_str);
-            nm_l3_config_data_add_nameserver_detail(l3cd, AF_INET6, &dns[i], NULL);
-        }
-        nm_dhcp_option_add_option(options,
-                                  TRUE,
-                                  AF_INET6,
-                                  NM_DHCP_OPTION_DHCP6_DNS_SERVERS,
-                                  str->str);
+    prefixes = g_array_new(FALSE, FALSE, sizeof(NMPlatformIP6Address));
+    sd_dhcp6_lease_pd_iterator_reset(lease);
+    while (!sd_dhcp6_lease_get_pd_prefix(lease, &prefix.address, &prefix.plen)) {
+        g_array_append_val(prefixes, prefix);
+        sd_dhcp6_lease_pd_iterator_next(lease);
     }
+    info.prefixes   = nm_g_array_first_p(prefixes, NMPlatformIP6Address);
+    info.n_prefixes = prefixes->len;
 
-    {
-        struct in6_addr prefix;
-        uint8_t         prefix_len;
-
-        nm_gstring_prepare(&str);
-        sd_dhcp6_lease_pd_iterator_reset(lease);
-        while (!sd_dhcp6_lease_get_pd_prefix(lease, &prefix, &prefix_len)) {
-            nm_gstring_add_space_delimiter(str);
-            nm_inet6_ntop(&prefix, addr_str);
-            g_string_append_printf(str, "%s/%u", addr_str, prefix_len);
-            sd_dhcp6_lease_pd_iterator_next(lease);
-        }
-        if (str->len > 0) {
-            nm_dhcp_option_add_option(options,
-                                      TRUE,
-                                      AF_INET6,
-                                      NM_DHCP_OPTION_DHCP6_IA_PD,
-                                      str->str);
-        }
+    num = sd_dhcp6_lease_get_dns(lease, &dns);
+    if (num > 0) {
+        info.dns   = dns;
+        info.n_dns = num;
     }
 
     num = sd_dhcp6_lease_get_domains(lease, &domains);
     if (num > 0) {
-        nm_gstring_prepare(&str);
-        for (i = 0; i < num; i++) {
-            g_string_append(nm_gstring_add_space_delimiter(str), domains[i]);
-            nm_l3_config_data_add_search(l3cd, AF_INET6, domains[i]);
-        }
-        nm_dhcp_option_add_option(options,
-                                  TRUE,
-                                  AF_INET6,
-                                  NM_DHCP_OPTION_DHCP6_DOMAIN_LIST,
-                                  str->str);
+        info.domains   = domains;
+        info.n_domains = num;
     }
 
-    if (sd_dhcp6_lease_get_fqdn(lease, &s) >= 0) {
-        nm_dhcp_option_add_option(options, TRUE, AF_INET6, NM_DHCP_OPTION_DHCP6_FQDN, s);
-    }
+    if (sd_dhcp6_lease_get_fqdn(lease, &fqdn) >= 0)
+        info.fqdn = fqdn;
 
     /* RFC 5908, section 4 states: "This option MUST include one, and only
      * one, time source suboption." It is not clear why systemd chose to
@@ -211,29 +168,21 @@ lease_to_ip6_config(NMDhcpSystemd *self, sd_dhcp6_lease *lease, gint32 ts, GErro
      * technical obstacles to including multiple options, let's just
      * pass on whatever systemd tells us.
      */
-    nm_gstring_prepare(&str);
     num = sd_dhcp6_lease_get_ntp_fqdn(lease, &ntp_fqdns);
     if (num > 0) {
-        for (i = 0; i < num; i++) {
-            g_string_append(nm_gstring_add_space_delimiter(str), ntp_fqdns[i]);
-        }
+        info.ntp_fqdns   = ntp_fqdns;
+        info.n_ntp_fqdns = num;
     }
     num = sd_dhcp6_lease_get_ntp_addrs(lease, &ntp_addrs);
     if (num > 0) {
-        for (i = 0; i < num; i++) {
-            nm_inet6_ntop(&ntp_addrs[i], addr_str);
-            g_string_append(nm_gstring_add_space_delimiter(str), addr_str);
-        }
-    }
-    if (str->len) {
-        nm_dhcp_option_add_option(options,
-                                  TRUE,
-                                  AF_INET6,
-                                  NM_DHCP_OPTION_DHCP6_NTP_SERVER,
-                                  str->str);
+        info.ntp_addrs   = ntp_addrs;
+        info.n_ntp_addrs = num;
     }
 
-    nm_l3_config_data_set_dhcp_lease_from_options(l3cd, AF_INET6, g_steal_pointer(&options));
+    l3cd = nm_dhcp_client_create_l3cd(NM_DHCP_CLIENT(self));
+
+    if (!nm_dhcp_utils_ip6_lease_info_to_l3cd(&info, &priv->lease_cache, l3cd))
+        _LOGT("lease options unchanged");
 
     return g_steal_pointer(&l3cd);
 }
@@ -486,6 +435,7 @@ dispose(GObject *object)
     NMDhcpSystemdPrivate *priv = NM_DHCP_SYSTEMD_GET_PRIVATE(object);
 
     nm_clear_g_free(&priv->lease_file);
+    nm_dhcp_utils_ip6_lease_cache_clear(&priv->lease_cache);
 
     if (priv->client6) {
         sd_dhcp6_client_stop(priv->client6);
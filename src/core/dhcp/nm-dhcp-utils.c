@@ -10,6 +10,7 @@
 
 #include "libnm-std-aux/unaligned.h"
 #include "libnm-glib-aux/nm-dedup-multi.h"
+#include "libnm-glib-aux/nm-io-utils.h"
 #include "libnm-glib-aux/nm-str-buf.h"
 #include "libnm-systemd-shared/nm-sd-utils-shared.h"
 
@@ -719,6 +720,319 @@ nm_dhcp_utils_ip6_config_from_options(NMDedupMultiIndex *multi_idx,
     return g_steal_pointer(&l3cd);
 }
 
+/*****************************************************************************/
+
+static gboolean
+_lease_file_parse(const char *contents, in_addr_t *out_address, gint64 *out_expiry)
+{
+    gs_free char *s_addr   = NULL;
+    gs_free char *s_expiry = NULL;
+    in_addr_t     address  = INADDR_ANY;
+
+    nm_parse_env_file(contents, "ADDRESS", &s_addr, "EXPIRY", &s_expiry);
+    if (!s_addr || !nm_inet_parse_bin(AF_INET, s_addr, NULL, &address) || address == INADDR_ANY)
+        return FALSE;
+
+    *out_address = address;
+    *out_expiry  = s_expiry ? _nm_utils_ascii_str_to_int64(s_expiry, 10, 0, G_MAXINT64, 0) : -1;
+    return TRUE;
+}
+
+/**
+ * nm_dhcp_utils_lease_file_parse:
+ * @contents: (nullable): the lease file of the internal DHCPv4 client.
+ * @now: the current wall clock time in seconds.
+ * @out_address: (out): the address of the lease.
+ * @out_init_reboot: (out): whether to request the address with INIT-REBOOT.
+ *
+ * A lease that is still valid (e.g. after a restart of NetworkManager) can be
+ * requested right away with INIT-REBOOT, which takes a single roundtrip. An
+ * expired one would likely be NAK'd and only delay the discovery, so it is
+ * merely a hint for the server. Lease files without expiry are from older
+ * versions, they keep using INIT-REBOOT.
+ *
+ * Returns: %TRUE if the lease file has an address.
+ */
+gboolean
+nm_dhcp_utils_lease_file_parse(const char *contents,
+                               gint64      now,
+                               in_addr_t  *out_address,
+                               gboolean   *out_init_reboot)
+{
+    in_addr_t address;
+    gint64    expiry;
+
+    if (!_lease_file_parse(contents, &address, &expiry))
+        return FALSE;
+
+    *out_address     = address;
+    *out_init_reboot = (expiry < 0 || expiry > now);
+    return TRUE;
+}
+
+/**
+ * nm_dhcp_utils_lease_file_build:
+ * @old_contents: (nullable): the current lease file.
+ * @address: the address of the lease.
+ * @now: the current wall clock time in seconds.
+ * @remaining: the remaining lifetime of the lease in seconds, or -1 if
+ *   the lease does not expire.
+ *
+ * The expiry is stored in wall clock time, so that it is still meaningful
+ * after a restart or reboot. Each renewal moves it forward, but rewriting the
+ * file every time defeats that the lease store skips unchanged files. So, the
+ * previous expiry is kept while it still lies a quarter of the lease time ahead.
+ * It is never later than the actual expiry.
+ *
+ * Returns: the new content of the lease file.
+ */
+char *
+nm_dhcp_utils_lease_file_build(const char *old_contents,
+                               in_addr_t   address,
+                               gint64      now,
+                               gint64      remaining)
+{
+    nm_auto_str_buf NMStrBuf sbuf = NM_STR_BUF_INIT(NM_UTILS_GET_NEXT_REALLOC_SIZE_104, FALSE);
+    char                     addr_str[NM_INET_ADDRSTRLEN];
+
+    nm_str_buf_append(&sbuf, "# This is private data. Do not parse.\n");
+    nm_str_buf_append_printf(&sbuf, "ADDRESS=%s\n", nm_inet4_ntop(address, addr_str));
+
+    if (remaining >= 0) {
+        gint64    expiry = now + remaining;
+        in_addr_t old_address;
+        gint64    old_expiry;
+
+        if (_lease_file_parse(old_contents, &old_address, &old_expiry) && old_address == address
+            && old_expiry <= expiry && old_expiry - now >= remaining / 4)
+            expiry = old_expiry;
+
+        nm_str_buf_append_printf(&sbuf, "EXPIRY=%" G_GINT64_FORMAT "\n", expiry);
+    }
+
+    return nm_str_buf_finalize(&sbuf, NULL);
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_dhcp_utils_ip6_lease_info_add_to_l3cd:
+ * @info: the typed content of a DHCPv6 lease
+ * @l3cd: the configuration to fill
+ *
+ * Adds the addresses, name servers and search domains of @info to @l3cd.
+ * Contrary to nm_dhcp_utils_ip6_config_from_options(), this works on the
+ * typed lease and does not go through string options.
+ */
+void
+nm_dhcp_utils_ip6_lease_info_add_to_l3cd(const NMDhcp6LeaseInfo *info, NML3ConfigData *l3cd)
+{
+    guint i;
+
+    for (i = 0; i < info->n_addresses; i++)
+        nm_l3_config_data_add_address_6(l3cd, &info->addresses[i]);
+
+    for (i = 0; i < info->n_dns; i++)
+        nm_l3_config_data_add_nameserver_detail(l3cd, AF_INET6, &info->dns[i], NULL);
+
+    for (i = 0; i < info->n_domains; i++)
+        nm_l3_config_data_add_search(l3cd, AF_INET6, info->domains[i]);
+}
+
+static void
+_str_buf_append_in6_addrs(NMStrBuf *strbuf, const struct in6_addr *addrs, guint n)
+{
+    nm_str_buf_append_len(strbuf, (const char *) &n, sizeof(n));
+    nm_str_buf_append_len(strbuf, (const char *) addrs, n * sizeof(struct in6_addr));
+}
+
+static void
+_str_buf_append_strv(NMStrBuf *strbuf, char *const *strv, guint n)
+{
+    guint i;
+
+    nm_str_buf_append_len(strbuf, (const char *) &n, sizeof(n));
+    for (i = 0; i < n; i++)
+        nm_str_buf_append_len(strbuf, strv[i], strlen(strv[i]) + 1u);
+}
+
+/**
+ * nm_dhcp_utils_ip6_lease_info_append_key:
+ * @info: the typed content of a DHCPv6 lease
+ * @strbuf: the buffer to append to
+ *
+ * Appends a binary key to @strbuf that is equal for two leases exactly
+ * if nm_dhcp_utils_ip6_lease_info_to_options() gives the same options
+ * for them. Lifetimes are not part of the options, hence a renewal that
+ * only extends the lifetimes yields the same key.
+ */
+void
+nm_dhcp_utils_ip6_lease_info_append_key(const NMDhcp6LeaseInfo *info, NMStrBuf *strbuf)
+{
+    gconstpointer client_id     = NULL;
+    gsize         client_id_len = 0;
+    guint         i;
+
+    nm_str_buf_append_len(strbuf, (const char *) &info->iaid, sizeof(info->iaid));
+
+    if (info->client_id)
+        client_id = g_bytes_get_data(info->client_id, &client_id_len);
+    nm_str_buf_append_len(strbuf, (const char *) &client_id_len, sizeof(client_id_len));
+    nm_str_buf_append_len(strbuf, client_id, client_id_len);
+
+    nm_str_buf_append_len(strbuf, (const char *) &info->n_addresses, sizeof(info->n_addresses));
+    for (i = 0; i < info->n_addresses; i++) {
+        nm_str_buf_append_len(strbuf,
+                              (const char *) &info->addresses[i].address,
+                              sizeof(struct in6_addr));
+    }
+
+    nm_str_buf_append_len(strbuf, (const char *) &info->n_prefixes, sizeof(info->n_prefixes));
+    for (i = 0; i < info->n_prefixes; i++) {
+        nm_str_buf_append_len(strbuf,
+                              (const char *) &info->prefixes[i].address,
+                              sizeof(struct in6_addr));
+        nm_str_buf_append_c(strbuf, info->prefixes[i].plen);
+    }
+
+    _str_buf_append_in6_addrs(strbuf, info->dns, info->n_dns);
+    _str_buf_append_strv(strbuf, info->domains, info->n_domains);
+    _str_buf_append_strv(strbuf, info->ntp_fqdns, info->n_ntp_fqdns);
+    _str_buf_append_in6_addrs(strbuf, info->ntp_addrs, info->n_ntp_addrs);
+
+    if (info->fqdn) {
+        nm_str_buf_append_c(strbuf, '\1');
+        nm_str_buf_append_len(strbuf, info->fqdn, strlen(info->fqdn) + 1u);
+    } else
+        nm_str_buf_append_c(strbuf, '\0');
+}
+
+static void
+_options_add_from_sbuf(GHashTable *options, NMStrBuf *sbuf, guint option)
+{
+    if (sbuf->len > 0)
+        nm_dhcp_option_add_option(options, TRUE, AF_INET6, option, nm_str_buf_get_str(sbuf));
+    nm_str_buf_reset(sbuf);
+}
+
+/**
+ * nm_dhcp_utils_ip6_lease_info_to_options:
+ * @info: the typed content of a DHCPv6 lease
+ * @options: the options dictionary with static keys to fill
+ *
+ * Renders @info as string options, as they are exposed on D-Bus.
+ */
+void
+nm_dhcp_utils_ip6_lease_info_to_options(const NMDhcp6LeaseInfo *info, GHashTable *options)
+{
+    nm_auto_str_buf NMStrBuf sbuf = NM_STR_BUF_INIT_A(NM_UTILS_GET_NEXT_REALLOC_SIZE_232, FALSE);
+    char                     addr_str[NM_INET_ADDRSTRLEN];
+    char                     iaid_buf[NM_DHCP_IAID_TO_HEXSTR_BUF_LEN];
+    guint                    i;
+
+    nm_dhcp_option_add_option(options,
+                              TRUE,
+                              AF_INET6,
+                              NM_DHCP_OPTION_DHCP6_NM_IAID,
+                              nm_dhcp_iaid_to_hexstr(info->iaid, iaid_buf));
+
+    if (info->client_id) {
+        nm_dhcp_option_take_option(options,
+                                   TRUE,
+                                   AF_INET6,
+                                   NM_DHCP_OPTION_DHCP6_CLIENT_ID,
+                                   nm_dhcp_utils_duid_to_string(info->client_id));
+    }
+
+    for (i = 0; i < info->n_addresses; i++) {
+        nm_str_buf_append_required_delimiter(&sbuf, ' ');
+        nm_str_buf_append(&sbuf, nm_inet6_ntop(&info->addresses[i].address, addr_str));
+    }
+    _options_add_from_sbuf(options, &sbuf, NM_DHCP_OPTION_DHCP6_NM_IP_ADDRESS);
+
+    for (i = 0; i < info->n_dns; i++) {
+        nm_str_buf_append_required_delimiter(&sbuf, ' ');
+        nm_str_buf_append(&sbuf, nm_inet6_ntop(&info->dns[i], addr_str));
+    }
+    _options_add_from_sbuf(options, &sbuf, NM_DHCP_OPTION_DHCP6_DNS_SERVERS);
+
+    for (i = 0; i < info->n_prefixes; i++) {
+        nm_str_buf_append_required_delimiter(&sbuf, ' ');
+        nm_str_buf_append_printf(&sbuf,
+                                 "%s/%u",
+                                 nm_inet6_ntop(&info->prefixes[i].address, addr_str),
+                                 info->prefixes[i].plen);
+    }
+    _options_add_from_sbuf(options, &sbuf, NM_DHCP_OPTION_DHCP6_IA_PD);
+
+    for (i = 0; i < info->n_domains; i++) {
+        nm_str_buf_append_required_delimiter(&sbuf, ' ');
+        nm_str_buf_append(&sbuf, info->domains[i]);
+    }
+    _options_add_from_sbuf(options, &sbuf, NM_DHCP_OPTION_DHCP6_DOMAIN_LIST);
+
+    if (info->fqdn)
+        nm_dhcp_option_add_option(options, TRUE, AF_INET6, NM_DHCP_OPTION_DHCP6_FQDN, info->fqdn);
+
+    for (i = 0; i < info->n_ntp_fqdns; i++) {
+        nm_str_buf_append_required_delimiter(&sbuf, ' ');
+        nm_str_buf_append(&sbuf, info->ntp_fqdns[i]);
+    }
+    for (i = 0; i < info->n_ntp_addrs; i++) {
+        nm_str_buf_append_required_delimiter(&sbuf, ' ');
+        nm_str_buf_append(&sbuf, nm_inet6_ntop(&info->ntp_addrs[i], addr_str));
+    }
+    _options_add_from_sbuf(options, &sbuf, NM_DHCP_OPTION_DHCP6_NTP_SERVER);
+}
+
+void
+nm_dhcp_utils_ip6_lease_cache_clear(NMDhcp6LeaseCache *cache)
+{
+    nm_clear_pointer(&cache->lease, nm_dhcp_lease_unref);
+    nm_clear_pointer(&cache->key, g_bytes_unref);
+}
+
+/**
+ * nm_dhcp_utils_ip6_lease_info_to_l3cd:
+ * @info: the typed content of a DHCPv6 lease
+ * @cache: the lease rendered from the previous reply
+ * @l3cd: the configuration to fill
+ *
+ * Adds @info to @l3cd, together with the lease options. Renewals usually
+ * only extend the lifetimes, which are not part of the options. Hence the
+ * options are only rendered as strings when the key of @info differs from
+ * the one in @cache. Otherwise the NMDhcpLease from @cache is shared.
+ *
+ * Returns: %TRUE if the options were rendered anew, %FALSE if the lease
+ *   from @cache was reused.
+ */
+gboolean
+nm_dhcp_utils_ip6_lease_info_to_l3cd(const NMDhcp6LeaseInfo *info,
+                                     NMDhcp6LeaseCache      *cache,
+                                     NML3ConfigData         *l3cd)
+{
+    nm_auto_str_buf NMStrBuf key = NM_STR_BUF_INIT(0, FALSE);
+    GHashTable              *options;
+    gboolean                 rendered = FALSE;
+
+    nm_dhcp_utils_ip6_lease_info_add_to_l3cd(info, l3cd);
+
+    nm_dhcp_utils_ip6_lease_info_append_key(info, &key);
+    if (!cache->lease
+        || !nm_g_bytes_equal_mem(cache->key, nm_str_buf_get_str_unsafe(&key), key.len)) {
+        options = nm_dhcp_option_create_options_dict(TRUE);
+        nm_dhcp_utils_ip6_lease_info_to_options(info, options);
+
+        nm_dhcp_utils_ip6_lease_cache_clear(cache);
+        cache->lease = nm_dhcp_lease_new_from_options(options);
+        cache->key   = nm_str_buf_finalize_to_gbytes(&key);
+        rendered     = TRUE;
+    }
+
+    nm_l3_config_data_set_dhcp_lease(l3cd, AF_INET6, cache->lease);
+    return rendered;
+}
+
 char *
 nm_dhcp_utils_duid_to_string(GBytes *duid)
 {
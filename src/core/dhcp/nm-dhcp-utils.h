@@ -41,6 +41,60 @@ gboolean nm_dhcp_utils_merge_new_dhcp6_lease(const NML3ConfigData  *l3cd_old,
 
 /*****************************************************************************/
 
+gboolean nm_dhcp_utils_lease_file_parse(const char *contents,
+                                        gint64      now,
+                                        in_addr_t  *out_address,
+                                        gboolean   *out_init_reboot);
+
+char *nm_dhcp_utils_lease_file_build(const char *old_contents,
+                                     in_addr_t   address,
+                                     gint64      now,
+                                     gint64      remaining);
+
+/*****************************************************************************/
+
+/* The typed content of a DHCPv6 lease, as received by the internal client.
+ * The arrays are owned by the caller. */
+typedef struct {
+    const NMPlatformIP6Address *addresses;
+    const NMPlatformIP6Address *prefixes;
+    const struct in6_addr      *dns;
+    const struct in6_addr      *ntp_addrs;
+    char *const                *domains;
+    char *const                *ntp_fqdns;
+    const char                 *fqdn;
+    guint                       n_addresses;
+    guint                       n_prefixes;
+    guint                       n_dns;
+    guint                       n_ntp_addrs;
+    guint                       n_domains;
+    guint                       n_ntp_fqdns;
+    guint32                     iaid;
+    GBytes                     *client_id;
+} NMDhcp6LeaseInfo;
+
+/* The NMDhcpLease that was last rendered from a NMDhcp6LeaseInfo, and the
+ * key of that info. */
+typedef struct {
+    NMDhcpLease *lease;
+    GBytes      *key;
+} NMDhcp6LeaseCache;
+
+void nm_dhcp_utils_ip6_lease_cache_clear(NMDhcp6LeaseCache *cache);
+
+void nm_dhcp_utils_ip6_lease_info_add_to_l3cd(const NMDhcp6LeaseInfo *info, NML3ConfigData *l3cd);
+
+void nm_dhcp_utils_ip6_lease_info_append_key(const NMDhcp6LeaseInfo *info,
+                                             struct _NMStrBuf       *strbuf);
+
+void nm_dhcp_utils_ip6_lease_info_to_options(const NMDhcp6LeaseInfo *info, GHashTable *options);
+
+gboolean nm_dhcp_utils_ip6_lease_info_to_l3cd(const NMDhcp6LeaseInfo *info,
+                                              NMDhcp6LeaseCache      *cache,
+                                              NML3ConfigData         *l3cd);
+
+/*****************************************************************************/
+
 static inline gboolean
 nm_dhcp_lease_data_consume(const uint8_t **datap, size_t *n_datap, void *out, size_t n_out)
 {
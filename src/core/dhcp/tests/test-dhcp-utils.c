@@ -10,11 +10,13 @@
 #include <linux/rtnetlink.h>
 
 #include "libnm-glib-aux/nm-dedup-multi.h"
+#include "libnm-glib-aux/nm-str-buf.h"
 #include "nm-utils.h"
 
 #include "dhcp/nm-dhcp-utils.h"
 #include "dhcp/nm-dhcp-options.h"
 #include "libnm-platform/nm-platform.h"
+#include "NetworkManagerUtils.h"
 
 #include "nm-test-utils-core.h"
 
@@ -747,6 +749,306 @@ test_dhcp_opt_list(gconstpointer test_data)
 
 /*****************************************************************************/
 
+static void
+_ip6_lease_info_init(NMDhcp6LeaseInfo     *info,
+                     NMPlatformIP6Address *addresses,
+                     NMPlatformIP6Address *prefixes,
+                     struct in6_addr      *dns,
+                     guint32               lifetime)
+{
+    static char *const domains[]   = {"example.com", "lab.example.com"};
+    static char *const ntp_fqdns[] = {"ntp.example.com"};
+    guint              i;
+
+    for (i = 0; i < 2; i++) {
+        addresses[i] = (NMPlatformIP6Address){
+            .address     = nmtst_inet6_from_string(i == 0 ? "2001:db8::10" : "2001:db8::11"),
+            .plen        = 128,
+            .lifetime    = lifetime,
+            .preferred   = lifetime / 2,
+            .addr_source = NM_IP_CONFIG_SOURCE_DHCP,
+        };
+        dns[i] = nmtst_inet6_from_string(i == 0 ? "2001:db8::53" : "2001:db8::54");
+    }
+    prefixes[0] = (NMPlatformIP6Address){
+        .address   = nmtst_inet6_from_string("2001:db8:100::"),
+        .plen      = 56,
+        .lifetime  = lifetime,
+        .preferred = lifetime / 2,
+    };
+
+    *info = (NMDhcp6LeaseInfo){
+        .iaid        = 0x0a0b0c0d,
+        .addresses   = addresses,
+        .n_addresses = 2,
+        .prefixes    = prefixes,
+        .n_prefixes  = 1,
+        .dns         = dns,
+        .n_dns       = 2,
+        .domains     = domains,
+        .n_domains   = G_N_ELEMENTS(domains),
+        .ntp_fqdns   = ntp_fqdns,
+        .n_ntp_fqdns = G_N_ELEMENTS(ntp_fqdns),
+        .fqdn        = "host.example.com",
+    };
+}
+
+static GBytes *
+_ip6_lease_info_key(const NMDhcp6LeaseInfo *info)
+{
+    nm_auto_str_buf NMStrBuf key = NM_STR_BUF_INIT(0, FALSE);
+
+    nm_dhcp_utils_ip6_lease_info_append_key(info, &key);
+    return nm_str_buf_finalize_to_gbytes(&key);
+}
+
+static void
+test_ip6_lease_info(void)
+{
+    gs_unref_hashtable GHashTable *options = nm_dhcp_option_create_options_dict(TRUE);
+    gs_unref_bytes GBytes         *key1    = NULL;
+    gs_unref_bytes GBytes         *key2    = NULL;
+    gs_unref_bytes GBytes         *key3    = NULL;
+    gs_unref_bytes GBytes         *key4    = NULL;
+    gs_unref_bytes GBytes         *duid1   = NULL;
+    gs_unref_bytes GBytes         *duid2   = NULL;
+    NMPlatformIP6Address           addresses[2];
+    NMPlatformIP6Address           prefixes[1];
+    struct in6_addr                dns[2];
+    NMDhcp6LeaseInfo               info;
+
+    duid1 = nmtst_gbytes_from_arr(0x00, 0x04, 0x01);
+    duid2 = nmtst_gbytes_from_arr(0x00, 0x04, 0x02);
+
+    _ip6_lease_info_init(&info, addresses, prefixes, dns, 3600);
+    info.client_id = duid1;
+
+    nm_dhcp_utils_ip6_lease_info_to_options(&info, options);
+
+#define _assert_option(option, expected)                                                    \
+    g_assert_cmpstr(                                                                        \
+        g_hash_table_lookup(options, nm_dhcp_option_request_string(AF_INET6, (option))), \
+        ==,                                                                                 \
+        (expected))
+
+    _assert_option(NM_DHCP_OPTION_DHCP6_NM_IAID, "0a:0b:0c:0d");
+    _assert_option(NM_DHCP_OPTION_DHCP6_CLIENT_ID, "00:04:01");
+    _assert_option(NM_DHCP_OPTION_DHCP6_NM_IP_ADDRESS, "2001:db8::10 2001:db8::11");
+    _assert_option(NM_DHCP_OPTION_DHCP6_IA_PD, "2001:db8:100::/56");
+    _assert_option(NM_DHCP_OPTION_DHCP6_DNS_SERVERS, "2001:db8::53 2001:db8::54");
+    _assert_option(NM_DHCP_OPTION_DHCP6_DOMAIN_LIST, "example.com lab.example.com");
+    _assert_option(NM_DHCP_OPTION_DHCP6_FQDN, "host.example.com");
+    _assert_option(NM_DHCP_OPTION_DHCP6_NTP_SERVER, "ntp.example.com");
+
+#undef _assert_option
+
+    key1 = _ip6_lease_info_key(&info);
+
+    /* a renewal only extends the lifetimes, which are not part of the options. */
+    _ip6_lease_info_init(&info, addresses, prefixes, dns, 7200);
+    info.client_id = duid1;
+    key2           = _ip6_lease_info_key(&info);
+    g_assert(g_bytes_equal(key1, key2));
+
+    /* the client-id is part of the options. */
+    info.client_id = duid2;
+    key3           = _ip6_lease_info_key(&info);
+    g_assert(!g_bytes_equal(key1, key3));
+
+    info.client_id = duid1;
+    info.n_dns     = 1;
+    key4           = _ip6_lease_info_key(&info);
+    g_assert(!g_bytes_equal(key1, key4));
+}
+
+static void
+test_ip6_lease_info_to_l3cd(void)
+{
+    nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = nm_dedup_multi_index_new();
+    nm_auto_unref_l3cd NML3ConfigData                 *l3cd_1    = NULL;
+    nm_auto_unref_l3cd NML3ConfigData                 *l3cd_2    = NULL;
+    nm_auto_unref_l3cd NML3ConfigData                 *l3cd_3    = NULL;
+    gs_unref_bytes GBytes                             *duid1     = NULL;
+    gs_unref_bytes GBytes                             *duid2     = NULL;
+    NMDhcp6LeaseCache                                  cache     = {};
+    NMPlatformIP6Address                               addresses[2];
+    NMPlatformIP6Address                               prefixes[1];
+    struct in6_addr                                    dns[2];
+    NMDhcp6LeaseInfo                                   info;
+    NMDhcpLease                                       *lease;
+
+    duid1 = nmtst_gbytes_from_arr(0x00, 0x04, 0x01);
+    duid2 = nmtst_gbytes_from_arr(0x00, 0x04, 0x02);
+
+    _ip6_lease_info_init(&info, addresses, prefixes, dns, 3600);
+    info.client_id = duid1;
+    l3cd_1         = nm_l3_config_data_new(multi_idx, 1, NM_IP_CONFIG_SOURCE_DHCP);
+    g_assert(nm_dhcp_utils_ip6_lease_info_to_l3cd(&info, &cache, l3cd_1));
+    lease = cache.lease;
+    g_assert(lease);
+    g_assert(nm_l3_config_data_get_dhcp_lease(l3cd_1, AF_INET6) == lease);
+    g_assert_cmpint(nm_l3_config_data_get_num_addresses(l3cd_1, AF_INET6), ==, 2);
+
+    /* a renewal that only extends the lifetimes shares the lease. */
+    _ip6_lease_info_init(&info, addresses, prefixes, dns, 7200);
+    info.client_id = duid1;
+    l3cd_2         = nm_l3_config_data_new(multi_idx, 1, NM_IP_CONFIG_SOURCE_DHCP);
+    g_assert(!nm_dhcp_utils_ip6_lease_info_to_l3cd(&info, &cache, l3cd_2));
+    g_assert(cache.lease == lease);
+    g_assert(nm_l3_config_data_get_dhcp_lease(l3cd_2, AF_INET6) == lease);
+
+    /* with another DUID, the options get rendered anew. */
+    info.client_id = duid2;
+    l3cd_3         = nm_l3_config_data_new(multi_idx, 1, NM_IP_CONFIG_SOURCE_DHCP);
+    g_assert(nm_dhcp_utils_ip6_lease_info_to_l3cd(&info, &cache, l3cd_3));
+    g_assert(cache.lease != lease);
+    g_assert_cmpstr(
+        nm_dhcp_lease_lookup_option(cache.lease,
+                                    nm_dhcp_option_request_string(AF_INET6,
+                                                                  NM_DHCP_OPTION_DHCP6_CLIENT_ID)),
+        ==,
+        "00:04:02");
+
+    nm_dhcp_utils_ip6_lease_cache_clear(&cache);
+}
+
+#define IP6_LEASE_BENCHMARK_N 100000u
+
+static void
+test_ip6_lease_info_benchmark(void)
+{
+    nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = nm_dedup_multi_index_new();
+    gs_unref_bytes GBytes                             *duid      = NULL;
+    NMPlatformIP6Address                               addresses[2];
+    NMPlatformIP6Address                               prefixes[1];
+    struct in6_addr                                    dns[2];
+    NMDhcp6LeaseInfo                                   info;
+    gint64                                             elapsed_nsec[2];
+    guint                                              pass;
+    guint                                              i;
+
+    if (nmtst_test_quick()) {
+        g_print("Skipping test: don't run long running test %s (NMTST_DEBUG=slow)\n",
+                g_get_prgname() ?: "test-dhcp-utils");
+        g_test_skip("Skip long running test");
+        return;
+    }
+
+    duid = nmtst_gbytes_from_arr(0x00, 0x04, 0x01);
+
+    /* Process many replies of a renewing client, whose lease only changes in
+     * the lifetimes. The first pass drops the cached lease before every reply,
+     * so that the options are rendered every time. The second pass keeps it. */
+    for (pass = 0; pass < 2; pass++) {
+        NMDhcp6LeaseCache cache      = {};
+        guint             n_rendered = 0;
+        gint64            start_nsec;
+
+        start_nsec = nm_utils_get_monotonic_timestamp_nsec();
+        for (i = 0; i < IP6_LEASE_BENCHMARK_N; i++) {
+            nm_auto_unref_l3cd_init NML3ConfigData *l3cd = NULL;
+
+            _ip6_lease_info_init(&info, addresses, prefixes, dns, 3600 + i);
+            info.client_id = duid;
+
+            if (pass == 0)
+                nm_dhcp_utils_ip6_lease_cache_clear(&cache);
+
+            l3cd = nm_l3_config_data_new(multi_idx, 1, NM_IP_CONFIG_SOURCE_DHCP);
+            if (nm_dhcp_utils_ip6_lease_info_to_l3cd(&info, &cache, l3cd))
+                n_rendered++;
+        }
+        elapsed_nsec[pass] = nm_utils_get_monotonic_timestamp_nsec() - start_nsec;
+
+        g_assert_cmpint(n_rendered, ==, pass == 0 ? IP6_LEASE_BENCHMARK_N : 1u);
+        nm_dhcp_utils_ip6_lease_cache_clear(&cache);
+    }
+
+    for (pass = 0; pass < 2; pass++) {
+        g_print(">>> %-16s: %u replies in %ld.%09ld seconds (%.0f replies/sec)\n",
+                pass == 0 ? "render options" : "reuse lease",
+                IP6_LEASE_BENCHMARK_N,
+                (long) (elapsed_nsec[pass] / NM_UTILS_NSEC_PER_SEC),
+                (long) (elapsed_nsec[pass] % NM_UTILS_NSEC_PER_SEC),
+                ((double) IP6_LEASE_BENCHMARK_N) * NM_UTILS_NSEC_PER_SEC
+                    / ((double) NM_MAX(elapsed_nsec[pass], 1)));
+    }
+}
+
+/*****************************************************************************/
+
+#define LEASE_FILE_HEADER "# This is private data. Do not parse.\n"
+
+static void
+test_lease_file(void)
+{
+    const gint64  now       = 1700000000;
+    const char   *s_address = "192.168.1.5";
+    gs_free char *contents  = NULL;
+    gs_free char *contents2 = NULL;
+    in_addr_t     address;
+    in_addr_t     a;
+    gboolean      init_reboot;
+
+    address = nmtst_inet4_from_string(s_address);
+
+    g_assert(!nm_dhcp_utils_lease_file_parse(NULL, now, &a, &init_reboot));
+    g_assert(!nm_dhcp_utils_lease_file_parse(LEASE_FILE_HEADER, now, &a, &init_reboot));
+    g_assert(!nm_dhcp_utils_lease_file_parse("ADDRESS=0.0.0.0\n", now, &a, &init_reboot));
+
+    /* Lease files of older versions have no expiry and use INIT-REBOOT. */
+    init_reboot = FALSE;
+    g_assert(nm_dhcp_utils_lease_file_parse("ADDRESS=192.168.1.5\n", now, &a, &init_reboot));
+    g_assert_cmpint(a, ==, address);
+    g_assert(init_reboot);
+
+    contents = nm_dhcp_utils_lease_file_build(NULL, address, now, 3600);
+    g_assert_cmpstr(contents,
+                    ==,
+                    LEASE_FILE_HEADER "ADDRESS=192.168.1.5\n"
+                                      "EXPIRY=1700003600\n");
+
+    /* Only a lease that did not expire yet uses INIT-REBOOT. */
+    g_assert(nm_dhcp_utils_lease_file_parse(contents, now + 3599, &a, &init_reboot));
+    g_assert_cmpint(a, ==, address);
+    g_assert(init_reboot);
+    g_assert(nm_dhcp_utils_lease_file_parse(contents, now + 3600, &a, &init_reboot));
+    g_assert_cmpint(a, ==, address);
+    g_assert(!init_reboot);
+
+    /* A renewal keeps the previous expiry, so that the file does not change... */
+    contents2 = nm_dhcp_utils_lease_file_build(contents, address, now + 1800, 3600);
+    g_assert_cmpstr(contents2, ==, contents);
+    nm_clear_g_free(&contents2);
+
+    /* ... until it is less than a quarter of the lease time ahead. */
+    contents2 = nm_dhcp_utils_lease_file_build(contents, address, now + 3000, 3600);
+    g_assert_cmpstr(contents2,
+                    ==,
+                    LEASE_FILE_HEADER "ADDRESS=192.168.1.5\n"
+                                      "EXPIRY=1700006600\n");
+    nm_clear_g_free(&contents2);
+
+    /* A new address gets its own expiry. */
+    contents2 = nm_dhcp_utils_lease_file_build(contents,
+                                               nmtst_inet4_from_string("192.168.1.6"),
+                                               now + 1800,
+                                               3600);
+    g_assert_cmpstr(contents2,
+                    ==,
+                    LEASE_FILE_HEADER "ADDRESS=192.168.1.6\n"
+                                      "EXPIRY=1700005400\n");
+    nm_clear_g_free(&contents2);
+
+    /* Infinite leases have no expiry. */
+    contents2 = nm_dhcp_utils_lease_file_build(contents, address, now, -1);
+    g_assert_cmpstr(contents2, ==, LEASE_FILE_HEADER "ADDRESS=192.168.1.5\n");
+    g_assert(nm_dhcp_utils_lease_file_parse(contents2, now + 100000, &a, &init_reboot));
+    g_assert(init_reboot);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -785,6 +1087,10 @@ main(int argc, char **argv)
     g_test_add_func("/dhcp/parse-search-list", test_parse_search_list);
     g_test_add_data_func("/dhcp/test_dhcp_opt_list/IPv4", GINT_TO_POINTER(0), test_dhcp_opt_list);
     g_test_add_data_func("/dhcp/test_dhcp_opt_list/IPv6", GINT_TO_POINTER(1), test_dhcp_opt_list);
+    g_test_add_func("/dhcp/lease-file", test_lease_file);
+    g_test_add_func("/dhcp/ip6-lease-info", test_ip6_lease_info);
+    g_test_add_func("/dhcp/ip6-lease-info-to-l3cd", test_ip6_lease_info_to_l3cd);
+    g_test_add_func("/dhcp/ip6-lease-info-benchmark", test_ip6_lease_info_benchmark);
 
     return g_test_run();
 }
@@ -13,10 +13,10 @@
 #include "nm-utils.h"
 
 gboolean
-nm_dnsmasq_utils_get_range(const NMPlatformIP4Address *addr,
-                           char                       *out_first,
-                           char                       *out_last,
-                           char                      **out_error_desc)
+nm_dnsmasq_utils_get_range_bin(const NMPlatformIP4Address *addr,
+                               in_addr_t                  *out_first,
+                               in_addr_t                  *out_last,
+                               char                      **out_error_desc)
 {
     guint32       host   = addr->address;
     guint8        prefix = addr->plen;
@@ -93,11 +93,27 @@ nm_dnsmasq_utils_get_range(const NMPlatformIP4Address *addr,
         last     = NM_MIN(last, first < 0xFFFFFFFF - NUM ? first + NUM : 0xFFFFFFFF);
     }
 
-    first = htonl(first);
-    last  = htonl(last);
+    *out_first = htonl(first);
+    *out_last  = htonl(last);
+    return TRUE;
+}
+
+gboolean
+nm_dnsmasq_utils_get_range(const NMPlatformIP4Address *addr,
+                           char                       *out_first,
+                           char                       *out_last,
+                           char                      **out_error_desc)
+{
+    in_addr_t first;
+    in_addr_t last;
+
+    g_return_val_if_fail(out_first, FALSE);
+    g_return_val_if_fail(out_last, FALSE);
+
+    if (!nm_dnsmasq_utils_get_range_bin(addr, &first, &last, out_error_desc))
+        return FALSE;
 
     nm_inet4_ntop(first, out_first);
     nm_inet4_ntop(last, out_last);
-
     return TRUE;
 }
@@ -8,6 +8,11 @@
 
 #include "libnm-platform/nm-platform.h"
 
+gboolean nm_dnsmasq_utils_get_range_bin(const NMPlatformIP4Address *addr,
+                                        in_addr_t                  *out_first,
+                                        in_addr_t                  *out_last,
+                                        char                      **out_error_desc);
+
 gboolean nm_dnsmasq_utils_get_range(const NMPlatformIP4Address *addr,
                                     char                       *out_first,
                                     char                       *out_last,
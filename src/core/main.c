@@ -43,6 +43,8 @@
 
 #define NM_DEFAULT_PID_FILE NMRUNDIR "/NetworkManager.pid"
 
+#define NM_FLIGHT_RECORDER_FILE NMRUNDIR "/flight-recorder.log"
+
 #define CONFIG_ATOMIC_SECTION_PREFIXES ((char **) NULL)
 
 static GMainLoop *main_loop          = NULL;
@@ -130,6 +132,15 @@ nm_main_config_reload(int signal)
         g_return_if_reached();
     }
 
+    if (signal == SIGUSR2) {
+        gs_free_error GError *error = NULL;
+
+        if (nm_logging_recorder_dump(NM_FLIGHT_RECORDER_FILE, &error))
+            nm_log_info(LOGD_CORE, "flight recorder dumped to " NM_FLIGHT_RECORDER_FILE);
+        else
+            nm_log_dbg(LOGD_CORE, "flight recorder not dumped: %s", error->message);
+    }
+
     nm_log_info(LOGD_CORE, "reload configuration (signal %s)...", strsignal(signal));
 
     /* The signal handler thread is only installed after
@@ -141,6 +152,48 @@ nm_main_config_reload(int signal)
     nm_config_reload(nm_config_get(), reload_flags, TRUE);
 }
 
+static void
+_logging_recorder_setup(const NMConfigData *config_data)
+{
+    const NMConfigGetValueFlags flags   = NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY;
+    gs_free char               *level   = NULL;
+    gs_free char               *domains = NULL;
+    gs_free_error GError       *error   = NULL;
+    gint64                      size;
+
+    level   = nm_config_data_get_value(config_data,
+                                       NM_CONFIG_KEYFILE_GROUP_LOGGING,
+                                       NM_CONFIG_KEYFILE_KEY_LOGGING_RECORDER_LEVEL,
+                                       flags);
+    domains = nm_config_data_get_value(config_data,
+                                       NM_CONFIG_KEYFILE_GROUP_LOGGING,
+                                       NM_CONFIG_KEYFILE_KEY_LOGGING_RECORDER_DOMAINS,
+                                       flags);
+    size    = nm_config_data_get_value_int64(config_data,
+                                             NM_CONFIG_KEYFILE_GROUP_LOGGING,
+                                             NM_CONFIG_KEYFILE_KEY_LOGGING_RECORDER_SIZE,
+                                             10,
+                                             0,
+                                             G_MAXINT32,
+                                             0);
+
+    /* Without level, this disables the recorder. Unless the size changes, the
+     * recorded messages are kept. */
+    if (!nm_logging_recorder_setup(level, domains, size, &error))
+        nm_log_warn(LOGD_CORE, "config: invalid flight recorder configuration: %s", error->message);
+}
+
+static void
+_config_changed_cb(NMConfig           *config,
+                   NMConfigData       *config_data,
+                   NMConfigChangeFlags changes,
+                   NMConfigData       *old_data,
+                   gpointer            user_data)
+{
+    if (NM_FLAGS_HAS(changes, NM_CONFIG_CHANGE_VALUES))
+        _logging_recorder_setup(config_data);
+}
+
 static void
 manager_configure_quit(NMManager *manager, gpointer user_data)
 {
@@ -422,6 +475,12 @@ main(int argc, char *argv[])
         nm_logging_init(v, nm_config_get_is_debug(config));
     }
 
+    _logging_recorder_setup(nm_config_get_data_orig(config));
+    g_signal_connect(config,
+                     NM_CONFIG_SIGNAL_CONFIG_CHANGED,
+                     G_CALLBACK(_config_changed_cb),
+                     NULL);
+
     nm_log_info(LOGD_CORE,
                 "NetworkManager (version " NM_DIST_VERSION ") is starting... (%s%sboot:%s)",
                 nm_config_get_first_start(config) ? "" : "after a restart, ",
@@ -529,6 +588,8 @@ done:
 
     nm_manager_stop(manager);
 
+    nm_dispatcher_stop();
+
     nm_config_state_set(config, TRUE, TRUE);
 
     nm_dns_manager_stop(nm_dns_manager_get());
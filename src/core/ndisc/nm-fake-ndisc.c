@@ -223,6 +223,23 @@ send_rs(NMNDisc *ndisc, GError **error)
     return TRUE;
 }
 
+static gboolean receive_ra(gpointer user_data);
+
+static void
+receive_ra_schedule(NMFakeNDisc *self)
+{
+    NMFakeNDiscPrivate *priv = NM_FAKE_NDISC_GET_PRIVATE(self);
+    FakeRa             *ra   = priv->ras->data;
+
+    nm_assert(!priv->receive_ra_id);
+
+    /* RAs without delay are received right away, for benchmarks. */
+    if (ra->when == 0)
+        priv->receive_ra_id = g_idle_add(receive_ra, self);
+    else
+        priv->receive_ra_id = g_timeout_add_seconds(ra->when, receive_ra, self);
+}
+
 static gboolean
 receive_ra(gpointer user_data)
 {
@@ -311,10 +328,8 @@ receive_ra(gpointer user_data)
     nm_ndisc_ra_received(NM_NDISC(self), now_msec, changed);
 
     /* Schedule next RA */
-    if (priv->ras) {
-        ra                  = priv->ras->data;
-        priv->receive_ra_id = g_timeout_add_seconds(ra->when, receive_ra, self);
-    }
+    if (priv->ras)
+        receive_ra_schedule(self);
 
     return G_SOURCE_REMOVE;
 }
@@ -323,14 +338,11 @@ static void
 start(NMNDisc *ndisc)
 {
     NMFakeNDiscPrivate *priv = NM_FAKE_NDISC_GET_PRIVATE(ndisc);
-    FakeRa             *ra;
 
     /* Queue up the first fake RA */
     g_assert(priv->ras);
-    ra = priv->ras->data;
-
     g_assert(!priv->receive_ra_id);
-    priv->receive_ra_id = g_timeout_add_seconds(ra->when, receive_ra, ndisc);
+    receive_ra_schedule(NM_FAKE_NDISC(ndisc));
 }
 
 static void
@@ -10,6 +10,7 @@
 #include <arpa/inet.h>
 #include <stdlib.h>
 
+#include "libnm-glib-aux/nm-prioq.h"
 #include "libnm-glib-aux/nm-random-utils.h"
 #include "libnm-platform/nm-platform-utils.h"
 #include "libnm-platform/nm-platform.h"
@@ -58,6 +59,27 @@ struct _NMNDiscPrivate {
 
     GSource *timeout_expire_source;
 
+    /* The routes, indexed by network, plen, gateway and on-link flag
+     * (RouteEntry). rdata.routes is only a sorted view of them, which
+     * is rebuilt by _routes_sync() when it is dirty. */
+    GHashTable *routes_idx;
+    NMPrioq     routes_by_expiry;
+    guint64     routes_seq;
+    bool        routes_dirty : 1;
+
+    /* A lower bound for the expiry of all gateways, addresses, DNS servers
+     * and DNS domains. Until then, there is nothing to clean up. */
+    gint64 expiry_next_msec;
+
+    /* RAs that only refresh lifetimes don't emit a config change. The
+     * lifetimes of addresses however end up in the kernel, so refreshing
+     * them may only be delayed until addresses_refresh_msec. */
+    gint64 addresses_refresh_msec;
+    bool   addresses_refresh_pending : 1;
+
+    guint ra_received_n;
+    guint ra_suppressed_n;
+
     NMUtilsIPv6IfaceId iid;
     gboolean           iid_is_token;
 
@@ -265,6 +287,13 @@ expiry_next(gint64 now_msec, gint64 expiry_msec, gint64 *next_msec)
     return TRUE;
 }
 
+static void
+_expiry_next_lower(NMNDiscPrivate *priv, gint64 expiry_msec)
+{
+    if (priv->expiry_next_msec > expiry_msec)
+        priv->expiry_next_msec = expiry_msec;
+}
+
 static const char *
 _get_exp(char *buf, gsize buf_size, gint64 now_msec, gint64 expiry_time)
 {
@@ -366,39 +395,169 @@ _ASSERT_data_gateways(const NMNDiscDataInternal *data)
 }
 
 /*****************************************************************************/
-static bool
-is_duplicate_route(const NMNDiscRoute *r0, const NMNDiscRoute *r1)
+typedef struct {
+    /* must be the first field, the index hashes the route. */
+    NMNDiscRoute route;
+
+    /* Routes with the same preference are sorted by the time they
+     * were added, the latest first. */
+    guint64 seq;
+
+    unsigned prioq_idx;
+
+    /* The position in rdata.routes. Only valid while the view is not dirty. */
+    guint view_idx;
+} RouteEntry;
+
+static guint
+_route_hash(gconstpointer ptr)
+{
+    const NMNDiscRoute *r = ptr;
+    NMHashState         h;
+
+    nm_hash_init(&h, 1126720081u);
+    nm_hash_update_valp(&h, &r->network);
+    nm_hash_update_valp(&h, &r->gateway);
+    nm_hash_update_vals(&h, r->plen, (bool) r->on_link);
+    return nm_hash_complete(&h);
+}
+
+static gboolean
+_route_equal(gconstpointer a, gconstpointer b)
 {
+    const NMNDiscRoute *r0 = a;
+    const NMNDiscRoute *r1 = b;
+
+    /*
+     * It is possible that two routes have the same prefix as well as the
+     * same prefix length. One of them, however, refers to the on-link
+     * prefix, and the other one to a route from the route information
+     * field. Moreover, they might have different route preferences.
+     * Hence, routes that differ in the on-link flag are different.
+     */
+    return IN6_ARE_ADDR_EQUAL(&r0->network, &r1->network) && r0->plen == r1->plen
+           && IN6_ARE_ADDR_EQUAL(&r0->gateway, &r1->gateway) && r0->on_link == r1->on_link;
+}
+
+static guint
+_route_network_hash(gconstpointer ptr)
+{
+    const NMNDiscRoute *r = ptr;
+    NMHashState         h;
+
+    nm_hash_init(&h, 3361562249u);
+    nm_hash_update_valp(&h, &r->network);
+    nm_hash_update_val(&h, r->plen);
+    return nm_hash_complete(&h);
+}
+
+static gboolean
+_route_network_equal(gconstpointer a, gconstpointer b)
+{
+    const NMNDiscRoute *r0 = a;
+    const NMNDiscRoute *r1 = b;
+
     return IN6_ARE_ADDR_EQUAL(&r0->network, &r1->network) && r0->plen == r1->plen;
 }
 
+static int
+_route_entry_cmp_expiry(gconstpointer a, gconstpointer b)
+{
+    const RouteEntry *x = a;
+    const RouteEntry *y = b;
+
+    NM_CMP_FIELD(x, y, route.expiry_msec);
+    return 0;
+}
+
+static int
+_route_entry_cmp_order(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    const RouteEntry *x = *((const RouteEntry *const *) a);
+    const RouteEntry *y = *((const RouteEntry *const *) b);
+
+    NM_CMP_DIRECT(_preference_to_priority(y->route.preference),
+                  _preference_to_priority(x->route.preference));
+    NM_CMP_FIELD(y, x, seq);
+    return 0;
+}
+
+static void
+_route_entry_free(gpointer data)
+{
+    nm_g_slice_free((RouteEntry *) data);
+}
+
+static void
+_route_entry_remove(NMNDiscPrivate *priv, RouteEntry *entry)
+{
+    nm_prioq_remove(&priv->routes_by_expiry, entry, &entry->prioq_idx);
+    g_hash_table_remove(priv->routes_idx, entry);
+    priv->routes_dirty = TRUE;
+}
+
+static void
+_routes_clear(NMNDiscPrivate *priv)
+{
+    while (nm_prioq_pop(&priv->routes_by_expiry))
+        ;
+    g_hash_table_remove_all(priv->routes_idx);
+    g_array_set_size(priv->rdata.routes, 0);
+    priv->routes_dirty = FALSE;
+}
+
 static void
 _data_complete_prepare_routes(GArray *routes)
 {
-    guint i, j;
+    gs_unref_hashtable GHashTable *networks = NULL;
+    guint                          i;
+
+    if (routes->len > 1)
+        networks = g_hash_table_new(_route_network_hash, _route_network_equal);
 
     for (i = 0; i < routes->len; i++) {
         NMNDiscRoute *r0 = &nm_g_array_index(routes, NMNDiscRoute, i);
+        NMNDiscRoute *r1;
 
         r0->duplicate = FALSE;
+
+        if (!networks)
+            continue;
+
+        r1 = g_hash_table_lookup(networks, r0);
+        if (!r1) {
+            g_hash_table_add(networks, r0);
+            continue;
+        }
+
+        r0->duplicate = TRUE;
+        r1->duplicate = TRUE;
     }
-    for (i = 0; i < routes->len; i++) {
-        NMNDiscRoute *r0 = &nm_g_array_index(routes, NMNDiscRoute, i);
+}
 
-        for (j = i + 1; j < routes->len; j++) {
-            NMNDiscRoute *r1 = &nm_g_array_index(routes, NMNDiscRoute, j);
+static void
+_routes_sync(NMNDiscPrivate *priv)
+{
+    gs_free gpointer *entries = NULL;
+    guint             n;
+    guint             i;
 
-            if (!is_duplicate_route(r0, r1))
-                continue;
+    if (!priv->routes_dirty)
+        return;
 
-            r0->duplicate = TRUE;
-            r1->duplicate = TRUE;
+    priv->routes_dirty = FALSE;
 
-            /* Maybe after index j, there is yet another duplicate. But we
-            * will find that later, when i becomes j. */
-            break;
-        }
+    entries = nm_utils_hash_keys_to_array(priv->routes_idx, _route_entry_cmp_order, NULL, &n);
+
+    g_array_set_size(priv->rdata.routes, n);
+    for (i = 0; i < n; i++) {
+        RouteEntry *entry = entries[i];
+
+        entry->view_idx                                       = i;
+        nm_g_array_index(priv->rdata.routes, NMNDiscRoute, i) = entry->route;
     }
+
+    _data_complete_prepare_routes(priv->rdata.routes);
 }
 
 static const NMNDiscData *
@@ -406,7 +565,6 @@ _data_complete(NMNDiscDataInternal *data)
 {
     _ASSERT_data_gateways(data);
 
-    _data_complete_prepare_routes(data->routes);
 #define _SET(data, field)                                      \
     G_STMT_START                                               \
     {                                                          \
@@ -425,6 +583,29 @@ _data_complete(NMNDiscDataInternal *data)
     return &data->public;
 }
 
+static gint64
+_addresses_refresh_msec(const NMNDiscDataInternal *rdata, gint64 now_msec)
+{
+    gint64 refresh_msec = NM_NDISC_EXPIRY_INFINITY;
+    guint  i;
+
+    /* The lifetimes that we emit now get configured in the kernel. Before
+     * half of them passed, a refreshed lifetime must be emitted again. */
+    for (i = 0; i < rdata->addresses->len; i++) {
+        const NMNDiscAddress *item = &nm_g_array_index(rdata->addresses, NMNDiscAddress, i);
+
+        if (item->expiry_msec != NM_NDISC_EXPIRY_INFINITY)
+            refresh_msec = NM_MIN(refresh_msec, now_msec + (item->expiry_msec - now_msec) / 2);
+        if (item->expiry_preferred_msec != NM_NDISC_EXPIRY_INFINITY
+            && item->expiry_preferred_msec > now_msec) {
+            refresh_msec =
+                NM_MIN(refresh_msec, now_msec + (item->expiry_preferred_msec - now_msec) / 2);
+        }
+    }
+
+    return refresh_msec;
+}
+
 static void
 nm_ndisc_emit_config_change(NMNDisc *self, NMNDiscConfigMap changed)
 {
@@ -432,6 +613,15 @@ nm_ndisc_emit_config_change(NMNDisc *self, NMNDiscConfigMap changed)
     nm_auto_unref_l3cd const NML3ConfigData *l3cd = NULL;
     const NMNDiscData                       *rdata;
 
+    _routes_sync(priv);
+
+    if (priv->addresses_refresh_pending) {
+        priv->addresses_refresh_pending = FALSE;
+        changed |= NM_NDISC_CONFIG_ADDRESSES;
+    }
+    priv->addresses_refresh_msec =
+        _addresses_refresh_msec(&priv->rdata, nm_utils_get_monotonic_timestamp_msec());
+
     _config_changed_log(self, changed);
 
     rdata = _data_complete(&NM_NDISC_GET_PRIVATE(self)->rdata),
@@ -454,7 +644,8 @@ nm_ndisc_emit_config_change(NMNDisc *self, NMNDiscConfigMap changed)
 gboolean
 nm_ndisc_add_gateway(NMNDisc *ndisc, const NMNDiscGateway *new_item, gint64 now_msec)
 {
-    NMNDiscDataInternal *rdata = &NM_NDISC_GET_PRIVATE(ndisc)->rdata;
+    NMNDiscPrivate      *priv  = NM_NDISC_GET_PRIVATE(ndisc);
+    NMNDiscDataInternal *rdata = &priv->rdata;
     guint                i;
     guint                insert_idx = G_MAXUINT;
 
@@ -476,9 +667,12 @@ nm_ndisc_add_gateway(NMNDisc *ndisc, const NMNDiscGateway *new_item, gint64 now_
             if (item->expiry_msec == new_item->expiry_msec)
                 return FALSE;
 
+            /* Only the lifetime got refreshed. That does not affect the
+             * configuration, update it in place. */
             item->expiry_msec = new_item->expiry_msec;
+            _expiry_next_lower(priv, item->expiry_msec);
             _ASSERT_data_gateways(rdata);
-            return TRUE;
+            return FALSE;
         }
 
         /* Put before less preferable gateways. */
@@ -499,6 +693,7 @@ nm_ndisc_add_gateway(NMNDisc *ndisc, const NMNDiscGateway *new_item, gint64 now_
     g_array_insert_val(rdata->gateways,
                        insert_idx == G_MAXUINT ? rdata->gateways->len : insert_idx,
                        *new_item);
+    _expiry_next_lower(priv, new_item->expiry_msec);
     _ASSERT_data_gateways(rdata);
     return TRUE;
 }
@@ -567,6 +762,7 @@ nm_ndisc_add_address(NMNDisc              *ndisc,
     NMNDiscDataInternal *rdata = &priv->rdata;
     NMNDiscAddress      *new2;
     NMNDiscAddress      *existing = NULL;
+    gboolean             suppress;
     guint                i;
 
     nm_assert(new_item);
@@ -646,8 +842,23 @@ nm_ndisc_add_address(NMNDisc              *ndisc,
             return FALSE;
         }
 
+        /* An RA that extends the lifetimes of an address doesn't need to be
+         * emitted right away, unless that deprecates or un-deprecates it, or the
+         * lifetimes configured in the kernel run low. */
+        suppress = from_ra && new_expiry_msec >= existing->expiry_msec
+                   && new_expiry_preferred_msec >= existing->expiry_preferred_msec
+                   && (existing->expiry_preferred_msec > now_msec)
+                          == (new_expiry_preferred_msec > now_msec)
+                   && now_msec < priv->addresses_refresh_msec;
+
         existing->expiry_msec           = new_expiry_msec;
         existing->expiry_preferred_msec = new_expiry_preferred_msec;
+        _expiry_next_lower(priv, new_expiry_msec);
+
+        if (suppress) {
+            priv->addresses_refresh_pending = TRUE;
+            return FALSE;
+        }
         return TRUE;
     }
 
@@ -675,6 +886,7 @@ nm_ndisc_add_address(NMNDisc              *ndisc,
         }
     }
 
+    _expiry_next_lower(priv, new2->expiry_msec);
     return TRUE;
 }
 
@@ -687,11 +899,8 @@ nm_ndisc_complete_and_add_address(NMNDisc *ndisc, const NMNDiscAddress *new_item
 gboolean
 nm_ndisc_add_route(NMNDisc *ndisc, const NMNDiscRoute *new_item, gint64 now_msec)
 {
-    NMNDiscPrivate      *priv;
-    NMNDiscDataInternal *rdata;
-    guint                i;
-    guint                insert_idx = G_MAXUINT;
-    gboolean             changed    = FALSE;
+    NMNDiscPrivate *priv;
+    RouteEntry     *entry;
 
     if (new_item->plen == 0 || new_item->plen > 128) {
         /* Only expect non-default routes.  The router has no idea what the
@@ -704,62 +913,53 @@ nm_ndisc_add_route(NMNDisc *ndisc, const NMNDiscRoute *new_item, gint64 now_msec
         g_return_val_if_reached(FALSE);
     }
 
-    priv  = NM_NDISC_GET_PRIVATE(ndisc);
-    rdata = &priv->rdata;
-
-    for (i = 0; i < rdata->routes->len;) {
-        NMNDiscRoute *item = &nm_g_array_index(rdata->routes, NMNDiscRoute, i);
-
-        /*
-         * It is possible that two entries in rdata->routes have
-         * the same prefix as well as the same prefix length.
-         * One of them, however, refers to the on-link prefix,
-         * and the other one to a route from the route information field.
-         * Moreover, they might have different route preferences.
-         * Hence, if both routes differ in the on-link flag,
-         * comparison is aborted, and both routes are added.
-         */
-        if (IN6_ARE_ADDR_EQUAL(&item->network, &new_item->network) && item->plen == new_item->plen
-            && IN6_ARE_ADDR_EQUAL(&item->gateway, &new_item->gateway)
-            && item->on_link == new_item->on_link) {
-            if (new_item->expiry_msec <= now_msec) {
-                g_array_remove_index(rdata->routes, i);
-                return TRUE;
-            }
+    priv = NM_NDISC_GET_PRIVATE(ndisc);
 
-            if (item->preference != new_item->preference) {
-                g_array_remove_index(rdata->routes, i);
-                changed = TRUE;
-                continue;
-            }
+    entry = g_hash_table_lookup(priv->routes_idx, new_item);
+    if (entry) {
+        if (new_item->expiry_msec <= now_msec) {
+            _route_entry_remove(priv, entry);
+            return TRUE;
+        }
 
-            if (item->expiry_msec == new_item->expiry_msec
-                && IN6_ARE_ADDR_EQUAL(&item->gateway, &new_item->gateway))
+        if (entry->route.preference == new_item->preference) {
+            if (entry->route.expiry_msec == new_item->expiry_msec)
                 return FALSE;
 
-            item->expiry_msec = new_item->expiry_msec;
-            item->gateway     = new_item->gateway;
-            return TRUE;
+            /* Only the lifetime got refreshed. That changes neither the set of
+             * routes nor their order, so the view is updated in place and nothing
+             * needs to be emitted. */
+            entry->route.expiry_msec = new_item->expiry_msec;
+            nm_prioq_reshuffle(&priv->routes_by_expiry, entry, &entry->prioq_idx);
+            if (!priv->routes_dirty) {
+                nm_assert(entry->view_idx < priv->rdata.routes->len);
+                nm_g_array_index(priv->rdata.routes, NMNDiscRoute, entry->view_idx).expiry_msec =
+                    new_item->expiry_msec;
+            }
+            return FALSE;
         }
 
-        /* Put before less preferable routes. */
-        if (_preference_to_priority(item->preference)
-                < _preference_to_priority(new_item->preference)
-            && insert_idx == G_MAXUINT)
-            insert_idx = i;
+        /* With a different preference, the route gets re-added. */
+        _route_entry_remove(priv, entry);
+    } else {
+        if (g_hash_table_size(priv->routes_idx) >= _SIZE_MAX_ROUTES)
+            return FALSE;
 
-        i++;
+        if (new_item->expiry_msec <= now_msec)
+            return FALSE;
     }
 
-    if (rdata->routes->len >= _SIZE_MAX_ROUTES)
-        return FALSE;
-
-    if (new_item->expiry_msec <= now_msec) {
-        nm_assert(!changed);
-        return FALSE;
-    }
+    entry  = g_slice_new(RouteEntry);
+    *entry = (RouteEntry){
+        .route     = *new_item,
+        .seq       = ++priv->routes_seq,
+        .prioq_idx = NM_PRIOQ_IDX_NULL,
+    };
+    entry->route.duplicate = FALSE;
 
-    g_array_insert_val(rdata->routes, insert_idx == G_MAXUINT ? 0u : insert_idx, *new_item);
+    g_hash_table_add(priv->routes_idx, entry);
+    nm_prioq_put(&priv->routes_by_expiry, entry, &entry->prioq_idx);
+    priv->routes_dirty = TRUE;
     return TRUE;
 }
 
@@ -786,7 +986,8 @@ nm_ndisc_add_dns_server(NMNDisc *ndisc, const NMNDiscDNSServer *new_item, gint64
                 return FALSE;
 
             item->expiry_msec = new_item->expiry_msec;
-            return TRUE;
+            _expiry_next_lower(priv, item->expiry_msec);
+            return FALSE;
         }
     }
 
@@ -797,6 +998,7 @@ nm_ndisc_add_dns_server(NMNDisc *ndisc, const NMNDiscDNSServer *new_item, gint64
         return FALSE;
 
     g_array_append_val(rdata->dns_servers, *new_item);
+    _expiry_next_lower(priv, new_item->expiry_msec);
     return TRUE;
 }
 
@@ -825,7 +1027,8 @@ nm_ndisc_add_dns_domain(NMNDisc *ndisc, const NMNDiscDNSDomain *new_item, gint64
                 return FALSE;
 
             item->expiry_msec = new_item->expiry_msec;
-            return TRUE;
+            _expiry_next_lower(priv, item->expiry_msec);
+            return FALSE;
         }
     }
 
@@ -840,6 +1043,7 @@ nm_ndisc_add_dns_domain(NMNDisc *ndisc, const NMNDiscDNSDomain *new_item, gint64
         .domain      = g_strdup(new_item->domain),
         .expiry_msec = new_item->expiry_msec,
     };
+    _expiry_next_lower(priv, item->expiry_msec);
     return TRUE;
 }
 
@@ -1272,10 +1476,14 @@ nm_ndisc_stop(NMNDisc *ndisc)
 
     g_array_set_size(rdata->gateways, 0);
     g_array_set_size(rdata->addresses, 0);
-    g_array_set_size(rdata->routes, 0);
+    _routes_clear(priv);
     g_array_set_size(rdata->dns_servers, 0);
     g_array_set_size(rdata->dns_domains, 0);
     priv->rdata.public.hop_limit = 64;
+    priv->expiry_next_msec       = NM_NDISC_EXPIRY_INFINITY;
+
+    priv->addresses_refresh_pending = FALSE;
+    priv->addresses_refresh_msec    = 0;
 
     nm_clear_g_source_inst(&priv->ra_timeout_source);
     nm_clear_g_source(&priv->send_ra_id);
@@ -1500,31 +1708,16 @@ clean_addresses(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap *changed, gint
 static void
 clean_routes(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap *changed, gint64 *next_msec)
 {
-    NMNDiscDataInternal *rdata = &NM_NDISC_GET_PRIVATE(ndisc)->rdata;
-    NMNDiscRoute        *arr;
-    guint                i;
-    guint                j;
-
-    if (rdata->routes->len == 0)
-        return;
-
-    arr = &nm_g_array_first(rdata->routes, NMNDiscRoute);
+    NMNDiscPrivate *priv = NM_NDISC_GET_PRIVATE(ndisc);
+    RouteEntry     *entry;
 
-    for (i = 0, j = 0; i < rdata->routes->len; i++) {
-        if (!expiry_next(now_msec, arr[i].expiry_msec, next_msec))
-            continue;
-        if (i != j)
-            arr[j] = arr[i];
-        j++;
-    }
+    while ((entry = nm_prioq_peek(&priv->routes_by_expiry))) {
+        if (expiry_next(now_msec, entry->route.expiry_msec, next_msec))
+            break;
 
-    if (i != j) {
+        _route_entry_remove(priv, entry);
         *changed |= NM_NDISC_CONFIG_ROUTES;
-        g_array_set_size(rdata->routes, j);
     }
-
-    if (_array_set_size_max(rdata->gateways, _SIZE_MAX_ROUTES))
-        *changed |= NM_NDISC_CONFIG_ROUTES;
 }
 
 static void
@@ -1592,19 +1785,32 @@ clean_dns_domains(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap *changed, gi
         *changed |= NM_NDISC_CONFIG_DNS_DOMAINS;
 }
 
-static void
+static NMNDiscConfigMap
 check_timestamps(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap changed)
 {
-    NMNDiscPrivate *priv      = NM_NDISC_GET_PRIVATE(ndisc);
-    gint64          next_msec = G_MAXINT64;
+    NMNDiscPrivate *priv = NM_NDISC_GET_PRIVATE(ndisc);
+    gint64          next_msec;
 
     _LOGT("router-data: check for changed router advertisement data");
 
-    clean_gateways(ndisc, now_msec, &changed, &next_msec);
-    clean_addresses(ndisc, now_msec, &changed, &next_msec);
+    if (priv->expiry_next_msec <= now_msec) {
+        next_msec = NM_NDISC_EXPIRY_INFINITY;
+        clean_gateways(ndisc, now_msec, &changed, &next_msec);
+        clean_addresses(ndisc, now_msec, &changed, &next_msec);
+        clean_dns_servers(ndisc, now_msec, &changed, &next_msec);
+        clean_dns_domains(ndisc, now_msec, &changed, &next_msec);
+        priv->expiry_next_msec = next_msec;
+    }
+
+    next_msec = priv->expiry_next_msec;
     clean_routes(ndisc, now_msec, &changed, &next_msec);
-    clean_dns_servers(ndisc, now_msec, &changed, &next_msec);
-    clean_dns_domains(ndisc, now_msec, &changed, &next_msec);
+
+    if (priv->addresses_refresh_pending) {
+        if (priv->addresses_refresh_msec <= now_msec)
+            changed |= NM_NDISC_CONFIG_ADDRESSES;
+        else
+            next_msec = NM_MIN(next_msec, priv->addresses_refresh_msec);
+    }
 
     nm_assert(next_msec > now_msec);
 
@@ -1628,6 +1834,8 @@ check_timestamps(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap changed)
 
     if (changed != NM_NDISC_CONFIG_NONE)
         nm_ndisc_emit_config_change(ndisc, changed);
+
+    return changed;
 }
 
 static gboolean
@@ -1671,6 +1879,8 @@ calc_pre_expiry_rs_msec(NMNDisc *ndisc)
     NMNDiscPrivate      *priv        = NM_NDISC_GET_PRIVATE(ndisc);
     NMNDiscDataInternal *rdata       = &priv->rdata;
     gint64               expiry_msec = NM_NDISC_EXPIRY_INFINITY;
+    GHashTableIter       iter;
+    const RouteEntry    *entry;
     guint                i;
 
     for (i = 0; i < rdata->gateways->len; i++) {
@@ -1687,12 +1897,9 @@ calc_pre_expiry_rs_msec(NMNDisc *ndisc)
             nm_g_array_index(rdata->addresses, NMNDiscAddress, i).expiry_msec);
     }
 
-    for (i = 0; i < rdata->routes->len; i++) {
-        _calc_pre_expiry_rs_msec_worker(
-            &expiry_msec,
-            priv->last_rs_msec,
-            nm_g_array_index(rdata->routes, NMNDiscRoute, i).expiry_msec);
-    }
+    g_hash_table_iter_init(&iter, priv->routes_idx);
+    while (g_hash_table_iter_next(&iter, (gpointer *) &entry, NULL))
+        _calc_pre_expiry_rs_msec_worker(&expiry_msec, priv->last_rs_msec, entry->route.expiry_msec);
 
     for (i = 0; i < rdata->dns_servers->len; i++) {
         _calc_pre_expiry_rs_msec_worker(
@@ -1720,7 +1927,14 @@ nm_ndisc_ra_received(NMNDisc *ndisc, gint64 now_msec, NMNDiscConfigMap changed)
 
     nm_clear_g_source_inst(&priv->ra_timeout_source);
     nm_clear_g_free(&priv->last_error);
-    check_timestamps(ndisc, now_msec, changed);
+
+    priv->ra_received_n++;
+    if (check_timestamps(ndisc, now_msec, changed) == NM_NDISC_CONFIG_NONE) {
+        priv->ra_suppressed_n++;
+        _LOGT("router-data: RA did not change the configuration (%u of %u RAs suppressed)",
+              priv->ra_suppressed_n,
+              priv->ra_received_n);
+    }
 
     /* When we receive an RA, we don't disable solicitations.
      *
@@ -1926,6 +2140,10 @@ nm_ndisc_init(NMNDisc *ndisc)
     rdata->dns_domains = g_array_new(FALSE, FALSE, sizeof(NMNDiscDNSDomain));
     g_array_set_clear_func(rdata->dns_domains, dns_domain_free);
     priv->rdata.public.hop_limit = 64;
+
+    priv->routes_idx = g_hash_table_new_full(_route_hash, _route_equal, _route_entry_free, NULL);
+    nm_prioq_init(&priv->routes_by_expiry, _route_entry_cmp_expiry);
+    priv->expiry_next_msec = NM_NDISC_EXPIRY_INFINITY;
 }
 
 static void
@@ -1954,6 +2172,8 @@ finalize(GObject *object)
     g_array_unref(rdata->gateways);
     g_array_unref(rdata->addresses);
     g_array_unref(rdata->routes);
+    nm_prioq_destroy(&priv->routes_by_expiry);
+    g_hash_table_unref(priv->routes_idx);
     g_array_unref(rdata->dns_servers);
     g_array_unref(rdata->dns_domains);
 
@@ -656,6 +656,319 @@ test_dns_solicit_loop(void)
 
 /*****************************************************************************/
 
+static void
+test_refresh_suppressed_cb(NMNDisc              *ndisc,
+                           const NMNDiscData    *rdata,
+                           guint                 changed_i,
+                           const NML3ConfigData *l3cd,
+                           TestData             *data)
+{
+    NMNDiscConfigMap changed = changed_i;
+
+    if (data->counter == 1) {
+        /* The second RA only refreshed the lifetimes and was not emitted. The
+         * refreshed lifetime of the address comes with the next change. */
+        g_assert_cmpint(changed, ==, NM_NDISC_CONFIG_ADDRESSES | NM_NDISC_CONFIG_DNS_SERVERS);
+
+        match_gateway(rdata,
+                      0,
+                      "fe80::1",
+                      data->timestamp_msec_1 + 21000,
+                      NM_ICMPV6_ROUTER_PREF_MEDIUM);
+        match_address(rdata,
+                      0,
+                      "2001:db8:a:a::1",
+                      data->timestamp_msec_1 + 21000,
+                      data->timestamp_msec_1 + 21000);
+        match_route(rdata, 0, "2001:db8:a:a::", 64, "fe80::1", data->timestamp_msec_1 + 21000, 10);
+        g_assert_cmpint(rdata->dns_servers_n, ==, 2);
+        match_dns_server(rdata, 0, "2001:db8:c:c::1", data->timestamp_msec_1 + 21000);
+        match_dns_server(rdata, 1, "2001:db8:c:c::2", data->timestamp_msec_1 + 20000);
+
+        g_assert(nm_fake_ndisc_done(NM_FAKE_NDISC(ndisc)));
+        g_main_loop_quit(data->loop);
+    }
+
+    data->counter++;
+}
+
+static void
+test_refresh_suppressed(void)
+{
+    nm_auto_unref_gmainloop GMainLoop *loop     = g_main_loop_new(NULL, FALSE);
+    gs_unref_object NMFakeNDisc       *ndisc    = ndisc_new();
+    const gint64                       now_msec = nm_utils_get_monotonic_timestamp_msec();
+    TestData                           data     = {
+                                      .loop             = loop,
+                                      .timestamp_msec_1 = now_msec,
+    };
+    guint id;
+    guint i;
+
+    /* A router that periodically sends the same RA only refreshes the
+     * lifetimes. That must not emit a config change. */
+
+    for (i = 0; i < 2; i++) {
+        const gint64 expiry_msec = now_msec + 20000 + i * 1000;
+
+        id = nm_fake_ndisc_add_ra(ndisc, 1, NM_NDISC_DHCP_LEVEL_NONE, 4, 1500);
+        g_assert(id);
+        nm_fake_ndisc_add_gateway(ndisc, id, "fe80::1", expiry_msec, NM_ICMPV6_ROUTER_PREF_MEDIUM);
+        nm_fake_ndisc_add_prefix(ndisc,
+                                 id,
+                                 "2001:db8:a:a::",
+                                 64,
+                                 "fe80::1",
+                                 expiry_msec,
+                                 expiry_msec,
+                                 10);
+        nm_fake_ndisc_add_dns_server(ndisc, id, "2001:db8:c:c::1", expiry_msec);
+    }
+
+    id = nm_fake_ndisc_add_ra(ndisc, 1, NM_NDISC_DHCP_LEVEL_NONE, 4, 1500);
+    g_assert(id);
+    nm_fake_ndisc_add_dns_server(ndisc, id, "2001:db8:c:c::2", now_msec + 20000);
+
+    g_signal_connect(ndisc,
+                     NM_NDISC_CONFIG_RECEIVED,
+                     G_CALLBACK(test_refresh_suppressed_cb),
+                     &data);
+
+    nm_ndisc_start(NM_NDISC(ndisc));
+    nmtst_main_loop_run_assert(data.loop, 15000);
+    g_assert_cmpint(data.counter, ==, 2);
+}
+
+/*****************************************************************************/
+
+#define TEST_MANY_ROUTES_N 300
+
+static void
+test_many_routes_cb(NMNDisc              *ndisc,
+                    const NMNDiscData    *rdata,
+                    guint                 changed_i,
+                    const NML3ConfigData *l3cd,
+                    TestData             *data)
+{
+    guint i;
+
+    if (data->counter == 1) {
+        g_assert_cmpint(rdata->routes_n, ==, 2 * TEST_MANY_ROUTES_N);
+
+        /* The newest route with the highest preference comes first. */
+        match_route(rdata,
+                    0,
+                    "2001:db8:12b::",
+                    48,
+                    "fe80::2",
+                    data->timestamp_msec_1 + 11000,
+                    NM_ICMPV6_ROUTER_PREF_HIGH);
+        match_route(rdata,
+                    1,
+                    "2001:db8:128::",
+                    48,
+                    "fe80::2",
+                    data->timestamp_msec_1 + 11000,
+                    NM_ICMPV6_ROUTER_PREF_HIGH);
+        match_route(rdata,
+                    TEST_MANY_ROUTES_N / 3,
+                    "2001:db8:12b::",
+                    48,
+                    "fe80::1",
+                    data->timestamp_msec_1 + 10000,
+                    NM_ICMPV6_ROUTER_PREF_HIGH);
+        match_route(rdata,
+                    2 * TEST_MANY_ROUTES_N - 1,
+                    "2001:db8::",
+                    48,
+                    "fe80::1",
+                    data->timestamp_msec_1 + 10000,
+                    NM_ICMPV6_ROUTER_PREF_LOW);
+
+        for (i = 0; i < rdata->routes_n; i++) {
+            const NMNDiscRoute *r = &rdata->routes[i];
+
+            /* Both routers announce every prefix. */
+            g_assert(r->duplicate);
+
+            if (i > 0) {
+                const NMNDiscRoute *r_prev = &rdata->routes[i - 1];
+
+                if (r->preference == NM_ICMPV6_ROUTER_PREF_HIGH)
+                    g_assert_cmpint(r_prev->preference, ==, NM_ICMPV6_ROUTER_PREF_HIGH);
+                if (r_prev->preference == NM_ICMPV6_ROUTER_PREF_LOW)
+                    g_assert_cmpint(r->preference, ==, NM_ICMPV6_ROUTER_PREF_LOW);
+            }
+        }
+
+        g_assert(nm_fake_ndisc_done(NM_FAKE_NDISC(ndisc)));
+        g_main_loop_quit(data->loop);
+    }
+
+    data->counter++;
+}
+
+static void
+test_many_routes(void)
+{
+    static const NMIcmpv6RouterPref prefs[] = {
+        NM_ICMPV6_ROUTER_PREF_LOW,
+        NM_ICMPV6_ROUTER_PREF_MEDIUM,
+        NM_ICMPV6_ROUTER_PREF_HIGH,
+    };
+    nm_auto_unref_gmainloop GMainLoop *loop     = g_main_loop_new(NULL, FALSE);
+    gs_unref_object NMFakeNDisc       *ndisc    = ndisc_new();
+    const gint64                       now_msec = nm_utils_get_monotonic_timestamp_msec();
+    TestData                           data     = {
+                                      .loop             = loop,
+                                      .timestamp_msec_1 = now_msec,
+    };
+    guint id;
+    guint j;
+    guint i;
+
+    /* Two routers announce the same large set of routes with mixed
+     * preferences. All routes are kept, ordered by preference and
+     * marked as duplicates. */
+
+    for (j = 0; j < 2; j++) {
+        const char  *gateway     = j == 0 ? "fe80::1" : "fe80::2";
+        const gint64 expiry_msec = now_msec + (j == 0 ? 10000 : 11000);
+
+        id = nm_fake_ndisc_add_ra(ndisc, 1, NM_NDISC_DHCP_LEVEL_NONE, 4, 1500);
+        g_assert(id);
+        nm_fake_ndisc_add_gateway(ndisc, id, gateway, expiry_msec, NM_ICMPV6_ROUTER_PREF_MEDIUM);
+        for (i = 0; i < TEST_MANY_ROUTES_N; i++) {
+            char network[NM_INET_ADDRSTRLEN];
+
+            nm_sprintf_buf(network, "2001:db8:%x::", i);
+            nm_fake_ndisc_add_prefix(ndisc,
+                                     id,
+                                     network,
+                                     48,
+                                     gateway,
+                                     expiry_msec,
+                                     expiry_msec,
+                                     prefs[i % G_N_ELEMENTS(prefs)]);
+        }
+    }
+
+    g_signal_connect(ndisc, NM_NDISC_CONFIG_RECEIVED, G_CALLBACK(test_many_routes_cb), &data);
+
+    nm_ndisc_start(NM_NDISC(ndisc));
+    nmtst_main_loop_run_assert(data.loop, 15000);
+    g_assert_cmpint(data.counter, ==, 2);
+}
+
+/*****************************************************************************/
+
+#define BENCHMARK_ROUTES_N 200
+#define BENCHMARK_RAS_N    1000
+
+typedef struct {
+    GMainLoop *loop;
+    guint      counter;
+    gint64     expiry_msec[2];
+} BenchmarkData;
+
+static void
+test_many_routes_benchmark_cb(NMNDisc              *ndisc,
+                              const NMNDiscData    *rdata,
+                              guint                 changed_i,
+                              const NML3ConfigData *l3cd,
+                              BenchmarkData        *data)
+{
+    const struct in6_addr *gateway_1 = nmtst_inet6_from_string_p("fe80::1");
+    guint                  i;
+
+    data->counter++;
+
+    /* Only the first RA of each router and the last RA change the
+     * configuration. */
+    if (!nm_fake_ndisc_done(NM_FAKE_NDISC(ndisc)))
+        return;
+
+    g_assert_cmpint(rdata->routes_n, ==, 2 * BENCHMARK_ROUTES_N);
+
+    /* The lifetimes got refreshed, without rebuilding the routes. */
+    for (i = 0; i < rdata->routes_n; i++) {
+        const NMNDiscRoute *r = &rdata->routes[i];
+        guint               j = IN6_ARE_ADDR_EQUAL(&r->gateway, gateway_1) ? 0 : 1;
+
+        g_assert_cmpint(r->expiry_msec, ==, data->expiry_msec[j]);
+    }
+
+    g_main_loop_quit(data->loop);
+}
+
+static void
+test_many_routes_benchmark(void)
+{
+    nm_auto_unref_gmainloop GMainLoop *loop     = g_main_loop_new(NULL, FALSE);
+    gs_unref_object NMFakeNDisc       *ndisc    = ndisc_new();
+    const gint64                       now_msec = nm_utils_get_monotonic_timestamp_msec();
+    BenchmarkData                      data     = {
+                                       .loop = loop,
+    };
+    gint64 start_nsec;
+    gint64 elapsed_nsec;
+    guint  id;
+    guint  i;
+    guint  k;
+
+    /* Two routers alternately send RAs with many routes, which only refresh
+     * the lifetimes. */
+
+    for (k = 0; k < BENCHMARK_RAS_N; k++) {
+        const guint j           = k % 2;
+        const char *gateway     = j == 0 ? "fe80::1" : "fe80::2";
+        gint64      expiry_msec = now_msec + 600000 + k;
+
+        id = nm_fake_ndisc_add_ra(ndisc, 0, NM_NDISC_DHCP_LEVEL_NONE, 4, 1500);
+        g_assert(id);
+        nm_fake_ndisc_add_gateway(ndisc, id, gateway, expiry_msec, NM_ICMPV6_ROUTER_PREF_MEDIUM);
+        for (i = 0; i < BENCHMARK_ROUTES_N; i++) {
+            char network[NM_INET_ADDRSTRLEN];
+
+            nm_sprintf_buf(network, "2001:db8:%x::", i);
+            nm_fake_ndisc_add_prefix(ndisc,
+                                     id,
+                                     network,
+                                     48,
+                                     gateway,
+                                     expiry_msec,
+                                     expiry_msec,
+                                     NM_ICMPV6_ROUTER_PREF_MEDIUM);
+        }
+        data.expiry_msec[j] = expiry_msec;
+
+        /* The last RA adds a DNS server, so that a change gets emitted. */
+        if (k == BENCHMARK_RAS_N - 1)
+            nm_fake_ndisc_add_dns_server(ndisc, id, "2001:db8:c:c::1", expiry_msec);
+    }
+
+    g_signal_connect(ndisc,
+                     NM_NDISC_CONFIG_RECEIVED,
+                     G_CALLBACK(test_many_routes_benchmark_cb),
+                     &data);
+
+    start_nsec = nm_utils_get_monotonic_timestamp_nsec();
+    nm_ndisc_start(NM_NDISC(ndisc));
+    nmtst_main_loop_run_assert(data.loop, 60000);
+    elapsed_nsec = nm_utils_get_monotonic_timestamp_nsec() - start_nsec;
+
+    /* The first RA of each router adds routes. */
+    g_assert_cmpint(data.counter, ==, 3);
+
+    g_print(">>> %u RAs with %u routes in %ld.%06ld seconds\n",
+            (guint) BENCHMARK_RAS_N,
+            (guint) BENCHMARK_ROUTES_N,
+            (long) (elapsed_nsec / NM_UTILS_NSEC_PER_SEC),
+            (long) ((elapsed_nsec % NM_UTILS_NSEC_PER_SEC) / 1000));
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -676,6 +989,9 @@ main(int argc, char **argv)
     g_test_add_func("/ndisc/preference-order", test_preference_order);
     g_test_add_func("/ndisc/preference-changed", test_preference_changed);
     g_test_add_func("/ndisc/dns-solicit-loop", test_dns_solicit_loop);
+    g_test_add_func("/ndisc/many-routes", test_many_routes);
+    g_test_add_func("/ndisc/refresh-suppressed", test_refresh_suppressed);
+    g_test_add_func("/ndisc/many-routes-benchmark", test_many_routes_benchmark);
 
     return g_test_run();
 }
@@ -56,9 +56,17 @@ struct _NMCheckpointPrivate {
     /* private members */
     NMManager              *manager;
     NMCheckpointCreateFlags flags;
-    GHashTable             *connection_uuids;
     gulong                  dev_removed_id;
 
+    /* For NM_CHECKPOINT_CREATE_FLAG_DELETE_NEW_CONNECTIONS. Instead of recording
+     * all profiles on creation, only track the profiles added since then, and
+     * the profiles from before that got removed (and might get re-added). */
+    NMSettings *settings;
+    GHashTable *new_connection_uuids;
+    GHashTable *removed_connection_uuids;
+    gulong      con_added_id;
+    gulong      con_removed_id;
+
     NMCheckpointTimeoutCallback timeout_cb;
     gpointer                    timeout_data;
 
@@ -214,8 +222,11 @@ find_settings_connection(NMCheckpoint                    *self,
     uuid      = nm_connection_get_uuid(dev_checkpoint->settings_connection);
     sett_conn = nm_settings_get_connection_by_uuid(NM_SETTINGS_GET, uuid);
 
-    /* Check if the connection changed */
+    /* Check if the connection changed. The profile of a settings connection is
+     * never modified in place, so if it is still the same instance as in the
+     * checkpoint, there is nothing to compare. */
     if (sett_conn
+        && nm_settings_connection_get_connection(sett_conn) != dev_checkpoint->settings_connection
         && !nm_connection_compare(dev_checkpoint->settings_connection,
                                   nm_settings_connection_get_connection(sett_conn),
                                   NM_SETTING_COMPARE_FLAG_IGNORE_TIMESTAMP)) {
@@ -579,7 +590,7 @@ next_dev:
         NMSettingsConnection          *con;
         gs_free NMSettingsConnection **list = NULL;
 
-        g_return_val_if_fail(priv->connection_uuids, NULL);
+        g_return_val_if_fail(priv->new_connection_uuids, NULL);
         list = nm_settings_get_connections_clone(
             NM_SETTINGS_GET,
             NULL,
@@ -588,10 +599,10 @@ next_dev:
             nm_settings_connection_cmp_autoconnect_priority_p_with_data,
             NULL);
 
-        for (i = 0; list[i]; i++) {
+        for (i = 0; list[i] && g_hash_table_size(priv->new_connection_uuids) > 0; i++) {
             con = list[i];
-            if (!g_hash_table_contains(priv->connection_uuids,
-                                       nm_settings_connection_get_uuid(con))) {
+            if (g_hash_table_contains(priv->new_connection_uuids,
+                                      nm_settings_connection_get_uuid(con))) {
                 _LOGD("rollback: deleting new connection %s", nm_settings_connection_get_uuid(con));
                 nm_settings_connection_delete(con, FALSE);
             }
@@ -738,9 +749,15 @@ device_checkpoint_create(NMCheckpoint *self, NMDevice *device)
         settings_connection = nm_act_request_get_settings_connection(act_request);
         applied_connection  = nm_act_request_get_applied_connection(act_request);
 
+        /* The applied connection can be modified in place (for example, by
+         * a reapply), so we need our own copy.
+         *
+         * The connection of the settings connection is immutable. On update, it
+         * gets replaced by a new instance. It's thus sufficient to keep a reference,
+         * which is shared with the settings connection and other checkpoints. */
         dev_checkpoint->applied_connection  = nm_simple_connection_new_clone(applied_connection);
-        dev_checkpoint->settings_connection = nm_simple_connection_new_clone(
-            nm_settings_connection_get_connection(settings_connection));
+        dev_checkpoint->settings_connection =
+            g_object_ref(nm_settings_connection_get_connection(settings_connection));
         dev_checkpoint->ac_version_id =
             nm_active_connection_version_id_get(NM_ACTIVE_CONNECTION(act_request));
         dev_checkpoint->activation_reason =
@@ -863,6 +880,28 @@ nm_checkpoint_init(NMCheckpoint *self)
     priv->devices = g_hash_table_new_full(nm_direct_hash, NULL, NULL, device_checkpoint_destroy);
 }
 
+static void
+_connection_added(NMSettings *settings, NMSettingsConnection *sett_conn, gpointer user_data)
+{
+    NMCheckpointPrivate *priv = NM_CHECKPOINT_GET_PRIVATE(user_data);
+    const char          *uuid = nm_settings_connection_get_uuid(sett_conn);
+
+    /* A profile that existed when the checkpoint was created and
+     * got re-added is not new. */
+    if (!g_hash_table_contains(priv->removed_connection_uuids, uuid))
+        g_hash_table_add(priv->new_connection_uuids, g_strdup(uuid));
+}
+
+static void
+_connection_removed(NMSettings *settings, NMSettingsConnection *sett_conn, gpointer user_data)
+{
+    NMCheckpointPrivate *priv = NM_CHECKPOINT_GET_PRIVATE(user_data);
+    const char          *uuid = nm_settings_connection_get_uuid(sett_conn);
+
+    if (!g_hash_table_remove(priv->new_connection_uuids, uuid))
+        g_hash_table_add(priv->removed_connection_uuids, g_strdup(uuid));
+}
+
 static void
 _device_removed(NMManager *manager, NMDevice *device, gpointer user_data)
 {
@@ -877,7 +916,6 @@ nm_checkpoint_new(NMManager              *manager,
 {
     NMCheckpoint                *self;
     NMCheckpointPrivate         *priv;
-    NMSettingsConnection *const *con;
     gint64                       rollback_timeout_ms;
     guint                        i;
 
@@ -900,11 +938,18 @@ nm_checkpoint_new(NMManager              *manager,
     }
 
     if (NM_FLAGS_HAS(flags, NM_CHECKPOINT_CREATE_FLAG_DELETE_NEW_CONNECTIONS)) {
-        priv->connection_uuids = g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, NULL);
-        for (con = nm_settings_get_connections(NM_SETTINGS_GET, NULL); *con; con++) {
-            g_hash_table_add(priv->connection_uuids,
-                             g_strdup(nm_settings_connection_get_uuid(*con)));
-        }
+        priv->settings             = g_object_ref(NM_SETTINGS_GET);
+        priv->new_connection_uuids = g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, NULL);
+        priv->removed_connection_uuids =
+            g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, NULL);
+        priv->con_added_id   = g_signal_connect(priv->settings,
+                                              NM_SETTINGS_SIGNAL_CONNECTION_ADDED,
+                                              G_CALLBACK(_connection_added),
+                                              self);
+        priv->con_removed_id = g_signal_connect(priv->settings,
+                                                NM_SETTINGS_SIGNAL_CONNECTION_REMOVED,
+                                                G_CALLBACK(_connection_removed),
+                                                self);
     }
 
     for (i = 0; i < devices->len; i++) {
@@ -945,7 +990,11 @@ dispose(GObject *object)
     nm_assert(c_list_is_empty(&self->checkpoints_lst));
 
     nm_clear_pointer(&priv->devices, g_hash_table_unref);
-    nm_clear_pointer(&priv->connection_uuids, g_hash_table_unref);
+    nm_clear_g_signal_handler(priv->settings, &priv->con_added_id);
+    nm_clear_g_signal_handler(priv->settings, &priv->con_removed_id);
+    g_clear_object(&priv->settings);
+    nm_clear_pointer(&priv->new_connection_uuids, g_hash_table_unref);
+    nm_clear_pointer(&priv->removed_connection_uuids, g_hash_table_unref);
     nm_clear_pointer(&priv->removed_devices, g_ptr_array_unref);
     nm_global_dns_config_free(priv->global_dns_config);
 
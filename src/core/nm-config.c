@@ -825,6 +825,7 @@ _setting_is_string_list(const char *group, const char *key)
     return _IS(NM_CONFIG_KEYFILE_GROUP_MAIN, NM_CONFIG_KEYFILE_KEY_MAIN_PLUGINS)
            || _IS(NM_CONFIG_KEYFILE_GROUP_MAIN, NM_CONFIG_KEYFILE_KEY_MAIN_DEBUG)
            || _IS(NM_CONFIG_KEYFILE_GROUP_LOGGING, NM_CONFIG_KEYFILE_KEY_LOGGING_DOMAINS)
+           || _IS(NM_CONFIG_KEYFILE_GROUP_LOGGING, NM_CONFIG_KEYFILE_KEY_LOGGING_RECORDER_DOMAINS)
            || NM_STR_HAS_PREFIX(group, NM_CONFIG_KEYFILE_GROUPPREFIX_TEST_APPEND_STRINGLIST);
 #undef _IS
 }
@@ -848,8 +849,13 @@ static const ConfigGroup config_groups[] = {
                              NM_CONFIG_KEYFILE_KEY_MAIN_CONFIGURE_AND_QUIT,
                              NM_CONFIG_KEYFILE_KEY_MAIN_DEBUG,
                              NM_CONFIG_KEYFILE_KEY_MAIN_DHCP,
+                             NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_SHARED_SOCKET,
+                             NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_BURST,
+                             NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_JITTER,
+                             NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_RATE,
                              NM_CONFIG_KEYFILE_KEY_MAIN_DNS,
                              NM_CONFIG_KEYFILE_KEY_MAIN_FIREWALL_BACKEND,
+                             NM_CONFIG_KEYFILE_KEY_MAIN_FIREWALLD_MAX_REQUESTS,
                              NM_CONFIG_KEYFILE_KEY_MAIN_HOSTNAME_MODE,
                              NM_CONFIG_KEYFILE_KEY_MAIN_IGNORE_CARRIER,
                              NM_CONFIG_KEYFILE_KEY_MAIN_IWD_CONFIG_PATH,
@@ -865,7 +871,10 @@ static const ConfigGroup config_groups[] = {
         .keys  = NM_MAKE_STRV(NM_CONFIG_KEYFILE_KEY_LOGGING_AUDIT,
                              NM_CONFIG_KEYFILE_KEY_LOGGING_BACKEND,
                              NM_CONFIG_KEYFILE_KEY_LOGGING_DOMAINS,
-                             NM_CONFIG_KEYFILE_KEY_LOGGING_LEVEL, ),
+                             NM_CONFIG_KEYFILE_KEY_LOGGING_LEVEL,
+                             NM_CONFIG_KEYFILE_KEY_LOGGING_RECORDER_DOMAINS,
+                             NM_CONFIG_KEYFILE_KEY_LOGGING_RECORDER_LEVEL,
+                             NM_CONFIG_KEYFILE_KEY_LOGGING_RECORDER_SIZE, ),
     },
     {
         .group = NM_CONFIG_KEYFILE_GROUP_CONNECTIVITY,
@@ -899,6 +908,8 @@ static const ConfigGroup config_groups[] = {
                              NM_CONFIG_KEYFILE_KEY_DEVICE_WIFI_SCAN_RAND_MAC_ADDRESS,
                              NM_CONFIG_KEYFILE_KEY_DEVICE_WIFI_SCAN_GENERATE_MAC_ADDRESS_MASK,
                              NM_CONFIG_KEYFILE_KEY_DEVICE_WIFI_IWD_AUTOCONNECT,
+                             NM_CONFIG_KEYFILE_KEY_DEVICE_WIFI_ACCESS_POINTS_CHANGED_SIGNAL,
+                             NM_CONFIG_KEYFILE_KEY_DEVICE_SHARING_DHCP_SERVER,
                              NM_CONFIG_KEYFILE_KEY_MATCH_DEVICE,
                              NM_CONFIG_KEYFILE_KEY_STOP_MATCH, ),
     },
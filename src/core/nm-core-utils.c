@@ -5480,3 +5480,86 @@ nm_utils_shorten_hostname(const char *hostname, char **shortened)
     *shortened = g_steal_pointer(&s);
     return TRUE;
 }
+
+/*****************************************************************************/
+
+/**
+ * nm_utils_stats_next_refresh_msec:
+ * @now_msec: the current monotonic timestamp
+ * @refresh_rate_ms: the refresh rate of the statistics
+ *
+ * Returns: the next multiple of @refresh_rate_ms after @now_msec. Devices
+ *   with the same refresh rate are thus due at the same time, regardless
+ *   of when they subscribed.
+ */
+gint64
+nm_utils_stats_next_refresh_msec(gint64 now_msec, guint refresh_rate_ms)
+{
+    nm_assert(now_msec >= 0);
+    nm_assert(refresh_rate_ms > 0);
+
+    return (now_msec / refresh_rate_ms + 1) * refresh_rate_ms;
+}
+
+/* Dump all links when at least this fraction (1/N) of the cached links is
+ * due. Below that, requesting the links one by one is cheaper than parsing
+ * all of them. */
+#define STATS_REFRESH_DUMP_FRACTION 4
+
+/**
+ * nm_utils_stats_refresh_use_dump:
+ * @n_due: the number of links whose statistics are due
+ * @n_links: the number of links in the platform cache
+ *
+ * Returns: whether to refresh the @n_due links with one dump of all links,
+ *   instead of requesting each of them.
+ */
+gboolean
+nm_utils_stats_refresh_use_dump(guint n_due, guint n_links)
+{
+    /* for a single link, a dump is never cheaper. */
+    if (n_due < 2)
+        return FALSE;
+
+    return ((guint64) n_due) * STATS_REFRESH_DUMP_FRACTION >= n_links;
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_utils_call_queue_pop:
+ * @queue: the #NMUtilsCallQueue
+ * @max_in_flight: the maximum number of requests in flight
+ *
+ * Unlinks the oldest queued request and accounts it as in flight, unless
+ * there are already @max_in_flight requests in flight. The caller must start
+ * the request and call nm_utils_call_queue_complete() once it completes or
+ * gets cancelled. Queued requests that get cancelled before they are started
+ * are just unlinked by the caller.
+ *
+ * Returns: the CList of the request to start, or %NULL.
+ */
+CList *
+nm_utils_call_queue_pop(NMUtilsCallQueue *queue, guint max_in_flight)
+{
+    CList *lst;
+
+    if (queue->n_in_flight >= max_in_flight)
+        return NULL;
+
+    lst = c_list_first(&queue->lst_head);
+    if (!lst)
+        return NULL;
+
+    c_list_unlink(lst);
+    queue->n_in_flight++;
+    return lst;
+}
+
+void
+nm_utils_call_queue_complete(NMUtilsCallQueue *queue)
+{
+    nm_assert(queue->n_in_flight > 0);
+
+    queue->n_in_flight--;
+}
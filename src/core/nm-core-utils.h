@@ -14,6 +14,7 @@
 #include "nm-connection.h"
 
 #include "libnm-glib-aux/nm-time-utils.h"
+#include "c-list/src/c-list.h"
 
 /*****************************************************************************/
 
@@ -490,4 +491,40 @@ uid_t nm_utils_get_nm_uid(void);
 
 gid_t nm_utils_get_nm_gid(void);
 
+/*****************************************************************************/
+
+gint64   nm_utils_stats_next_refresh_msec(gint64 now_msec, guint refresh_rate_ms);
+gboolean nm_utils_stats_refresh_use_dump(guint n_due, guint n_links);
+
+/*****************************************************************************/
+
+/* A FIFO of requests, of which only a limited number may be in flight at the
+ * same time. The requests embed a CList to link them into the queue. */
+typedef struct {
+    CList lst_head;
+    guint n_in_flight;
+} NMUtilsCallQueue;
+
+static inline void
+nm_utils_call_queue_init(NMUtilsCallQueue *queue)
+{
+    c_list_init(&queue->lst_head);
+    queue->n_in_flight = 0;
+}
+
+static inline void
+nm_utils_call_queue_push(NMUtilsCallQueue *queue, CList *lst)
+{
+    c_list_link_tail(&queue->lst_head, lst);
+}
+
+static inline gboolean
+nm_utils_call_queue_is_idle(const NMUtilsCallQueue *queue)
+{
+    return queue->n_in_flight == 0 && c_list_is_empty(&queue->lst_head);
+}
+
+CList *nm_utils_call_queue_pop(NMUtilsCallQueue *queue, guint max_in_flight);
+void   nm_utils_call_queue_complete(NMUtilsCallQueue *queue);
+
 #endif /* __NM_CORE_UTILS_H__ */
@@ -17,6 +17,7 @@
 #include "nm-dbus-interface.h"
 #include "libnm-core-intern/nm-core-internal.h"
 #include "libnm-std-aux/nm-dbus-compat.h"
+#include "libnm-std-aux/nm-usdt.h"
 #include "nm-dbus-object.h"
 #include "NetworkManagerUtils.h"
 #include "libnm-core-aux-intern/nm-auth-subject.h"
@@ -850,6 +851,8 @@ dbus_vtable_method_call(GDBusConnection       *connection,
         return;
     }
 
+    NM_USDT(dbus_method_call, obj->internal.path, interface_name, method_name);
+
     method_info->handle(reg_data->obj,
                         interface_info,
                         method_info,
@@ -1198,6 +1201,9 @@ _nm_dbus_manager_obj_notify(NMDBusObject *obj, guint n_pspecs, const GParamSpec
                 if (!nm_streq(property_info->property_name, pspec->name))
                     continue;
 
+                if (!_nm_dbus_object_notify_throttle_check(obj, property_info))
+                    continue;
+
                 value = _obj_get_property(reg_data, i, TRUE);
 
                 if (!has_properties) {
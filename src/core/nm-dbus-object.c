@@ -34,6 +34,13 @@ G_DEFINE_ABSTRACT_TYPE(NMDBusObject, nm_dbus_object, G_TYPE_OBJECT);
 
 /*****************************************************************************/
 
+typedef struct {
+    const NMDBusPropertyInfoExtended *property_info;
+    NMDBusNotifyThrottle              throttle;
+} NotifyThrottleData;
+
+/*****************************************************************************/
+
 static void
 _emit_exported_changed(NMDBusObject *self)
 {
@@ -143,6 +150,9 @@ nm_dbus_object_unexport(gpointer /* (NMDBusObject *) */ self)
 
     _nm_dbus_manager_obj_unexport(self1);
 
+    nm_clear_g_source_inst(&self1->internal.notify_throttle_source);
+    nm_clear_pointer(&self1->internal.notify_throttle_arr, g_array_unref);
+
     nm_clear_g_free(&self1->internal.path);
     self1->internal.export_version_id = 0;
 
@@ -244,6 +254,192 @@ nm_dbus_object_emit_signal(NMDBusObject                      *self,
 
 /*****************************************************************************/
 
+/**
+ * nm_dbus_notify_throttle_check:
+ * @throttle: the state of the property
+ * @rate_limit_msec: the minimal interval between two notifications
+ * @now_msec: the current timestamp
+ *
+ * Returns: %TRUE if the change can be announced now. Otherwise, the
+ *   change is remembered as pending, and nm_dbus_notify_throttle_expire()
+ *   tells when to announce it.
+ */
+gboolean
+nm_dbus_notify_throttle_check(NMDBusNotifyThrottle *throttle,
+                              guint                 rate_limit_msec,
+                              gint64                now_msec)
+{
+    if (throttle->pending)
+        return FALSE;
+
+    if (throttle->last_emit_msec != 0 && now_msec < throttle->last_emit_msec + rate_limit_msec) {
+        throttle->pending = TRUE;
+        return FALSE;
+    }
+
+    throttle->last_emit_msec = now_msec;
+    return TRUE;
+}
+
+/**
+ * nm_dbus_notify_throttle_get_due_msec:
+ * @throttle: the state of the property
+ * @rate_limit_msec: the minimal interval between two notifications
+ *
+ * Returns: the timestamp when the pending change is due, or %G_MAXINT64
+ *   if there is none.
+ */
+gint64
+nm_dbus_notify_throttle_get_due_msec(const NMDBusNotifyThrottle *throttle, guint rate_limit_msec)
+{
+    if (!throttle->pending)
+        return G_MAXINT64;
+    return throttle->last_emit_msec + rate_limit_msec;
+}
+
+/**
+ * nm_dbus_notify_throttle_expire:
+ * @throttle: the state of the property
+ * @rate_limit_msec: the minimal interval between two notifications
+ * @now_msec: the current timestamp
+ *
+ * Returns: %TRUE if a pending change is due. The caller must notify the
+ *   property then, and the next nm_dbus_notify_throttle_check() lets that
+ *   notification pass.
+ */
+gboolean
+nm_dbus_notify_throttle_expire(NMDBusNotifyThrottle *throttle,
+                               guint                 rate_limit_msec,
+                               gint64                now_msec)
+{
+    if (now_msec < nm_dbus_notify_throttle_get_due_msec(throttle, rate_limit_msec))
+        return FALSE;
+
+    throttle->pending        = FALSE;
+    throttle->last_emit_msec = 0;
+    return TRUE;
+}
+
+static gboolean _notify_throttle_timeout_cb(gpointer user_data);
+
+static void
+_notify_throttle_schedule(NMDBusObject *self, gint64 now_msec)
+{
+    gint64 next_msec = G_MAXINT64;
+    guint  i;
+
+    for (i = 0; i < self->internal.notify_throttle_arr->len; i++) {
+        const NotifyThrottleData *data =
+            &nm_g_array_index(self->internal.notify_throttle_arr, NotifyThrottleData, i);
+
+        next_msec = NM_MIN(next_msec,
+                           nm_dbus_notify_throttle_get_due_msec(
+                               &data->throttle,
+                               data->property_info->notify_rate_limit_msec));
+    }
+
+    nm_clear_g_source_inst(&self->internal.notify_throttle_source);
+
+    if (next_msec == G_MAXINT64)
+        return;
+
+    self->internal.notify_throttle_source =
+        nm_g_timeout_add_source(NM_MAX(next_msec - now_msec, 0), _notify_throttle_timeout_cb, self);
+}
+
+static gboolean
+_notify_throttle_timeout_cb(gpointer user_data)
+{
+    NMDBusObject *self     = user_data;
+    gint64        now_msec = nm_utils_get_monotonic_timestamp_msec();
+    guint         i;
+
+    nm_clear_g_source_inst(&self->internal.notify_throttle_source);
+
+    g_object_freeze_notify(G_OBJECT(self));
+
+    for (i = 0; i < self->internal.notify_throttle_arr->len; i++) {
+        NotifyThrottleData *data =
+            &nm_g_array_index(self->internal.notify_throttle_arr, NotifyThrottleData, i);
+
+        /* the interval expired. Let the notification pass this time. */
+        if (nm_dbus_notify_throttle_expire(&data->throttle,
+                                           data->property_info->notify_rate_limit_msec,
+                                           now_msec))
+            g_object_notify(G_OBJECT(self), data->property_info->property_name);
+    }
+
+    _notify_throttle_schedule(self, now_msec);
+
+    g_object_thaw_notify(G_OBJECT(self));
+
+    return G_SOURCE_CONTINUE;
+}
+
+/**
+ * _nm_dbus_object_notify_throttle_check:
+ * @self: the exported #NMDBusObject
+ * @property_info: the property that changed
+ *
+ * Enforces the notify_rate_limit_msec of @property_info. If a notification
+ * for the property was sent less than that interval ago, the change is
+ * remembered and notified again when the interval expires.
+ *
+ * Returns: whether the change of the property can be announced now.
+ */
+gboolean
+_nm_dbus_object_notify_throttle_check(NMDBusObject                     *self,
+                                      const NMDBusPropertyInfoExtended *property_info)
+{
+    NotifyThrottleData *data = NULL;
+    gint64              now_msec;
+    gboolean            was_pending;
+    guint               i;
+
+    nm_assert(NM_IS_DBUS_OBJECT(self));
+    nm_assert(self->internal.path);
+
+    if (property_info->notify_rate_limit_msec == 0)
+        return TRUE;
+
+    if (!self->internal.notify_throttle_arr)
+        self->internal.notify_throttle_arr = g_array_new(FALSE, FALSE, sizeof(NotifyThrottleData));
+
+    for (i = 0; i < self->internal.notify_throttle_arr->len; i++) {
+        data = &nm_g_array_index(self->internal.notify_throttle_arr, NotifyThrottleData, i);
+        if (data->property_info == property_info)
+            break;
+        data = NULL;
+    }
+
+    if (!data) {
+        data  = nm_g_array_append_new(self->internal.notify_throttle_arr, NotifyThrottleData);
+        *data = (NotifyThrottleData){
+            .property_info = property_info,
+        };
+    }
+
+    now_msec    = nm_utils_get_monotonic_timestamp_msec();
+    was_pending = data->throttle.pending;
+
+    if (nm_dbus_notify_throttle_check(&data->throttle,
+                                      property_info->notify_rate_limit_msec,
+                                      now_msec))
+        return TRUE;
+
+    if (!was_pending) {
+        _LOG2T("%s: rate limited, notify in %" G_GINT64_FORMAT " msec",
+               property_info->parent.name,
+               nm_dbus_notify_throttle_get_due_msec(&data->throttle,
+                                                    property_info->notify_rate_limit_msec)
+                   - now_msec);
+        _notify_throttle_schedule(self, now_msec);
+    }
+    return FALSE;
+}
+
+/*****************************************************************************/
+
 static void
 dispatch_properties_changed(GObject *object, guint n_pspecs, GParamSpec **pspecs)
 {
@@ -308,6 +504,9 @@ dispose(GObject *object)
         nm_dbus_object_unexport(self);
     }
 
+    nm_assert(!self->internal.notify_throttle_source);
+    nm_assert(!self->internal.notify_throttle_arr);
+
     G_OBJECT_CLASS(nm_dbus_object_parent_class)->dispose(object);
 
     g_clear_object(&self->internal.bus_manager);
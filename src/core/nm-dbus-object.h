@@ -73,6 +73,10 @@ struct _NMDBusObjectInternal {
      * to fail the request. For that, we keep track of a version id.  */
     guint64 export_version_id;
     bool    is_unexporting : 1;
+
+    /* state for properties with a notify_rate_limit_msec. */
+    GArray  *notify_throttle_arr;
+    GSource *notify_throttle_source;
 };
 
 struct _NMDBusObject {
@@ -160,6 +164,25 @@ gboolean _nm_dbus_object_clear_and_unexport(NMDBusObject **location);
 #define nm_dbus_object_clear_and_unexport(location) \
     _nm_dbus_object_clear_and_unexport(NM_CAST_PPTR(NMDBusObject, (location)))
 
+gboolean _nm_dbus_object_notify_throttle_check(NMDBusObject                     *self,
+                                               const NMDBusPropertyInfoExtended *property_info);
+
+/* The state of one rate limited property. A zero-initialized instance never
+ * notified the property. */
+typedef struct {
+    gint64 last_emit_msec;
+    bool   pending : 1;
+} NMDBusNotifyThrottle;
+
+gboolean nm_dbus_notify_throttle_check(NMDBusNotifyThrottle *throttle,
+                                       guint                 rate_limit_msec,
+                                       gint64                now_msec);
+gint64 nm_dbus_notify_throttle_get_due_msec(const NMDBusNotifyThrottle *throttle,
+                                            guint                       rate_limit_msec);
+gboolean nm_dbus_notify_throttle_expire(NMDBusNotifyThrottle *throttle,
+                                        guint                 rate_limit_msec,
+                                        gint64                now_msec);
+
 void nm_dbus_object_emit_signal_variant(NMDBusObject                      *self,
                                         const NMDBusInterfaceInfoExtended *interface_info,
                                         const GDBusSignalInfo             *signal_info,
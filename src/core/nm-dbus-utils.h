@@ -14,6 +14,12 @@ struct _NMDBusMethodInfoExtended;
 struct _NMDBusPropertyInfoExtendedBase {
     GDBusPropertyInfo _parent;
     const char       *property_name;
+
+    /* if set, PropertiesChanged signals for this property are sent at most
+     * once per this many milliseconds. Changes in between are combined and
+     * announced when the interval expires. This is for properties that can
+     * change very frequently. */
+    guint notify_rate_limit_msec;
 };
 
 struct _NMDBusPropertyInfoExtendedReadWritable {
@@ -38,12 +44,16 @@ typedef struct {
         struct {
             GDBusPropertyInfo parent;
             const char       *property_name;
+            guint             notify_rate_limit_msec;
         };
     };
 } NMDBusPropertyInfoExtended;
 
 G_STATIC_ASSERT(G_STRUCT_OFFSET(NMDBusPropertyInfoExtended, property_name)
                 == G_STRUCT_OFFSET(struct _NMDBusPropertyInfoExtendedBase, property_name));
+G_STATIC_ASSERT(G_STRUCT_OFFSET(NMDBusPropertyInfoExtended, notify_rate_limit_msec)
+                == G_STRUCT_OFFSET(struct _NMDBusPropertyInfoExtendedBase,
+                                   notify_rate_limit_msec));
 
 extern const GDBusAnnotationInfo _nm_gdbus_annotation_info_deprecated;
 
@@ -79,6 +89,21 @@ extern const GDBusAnnotationInfo *const _nm_gdbus_annotation_info_list_deprecate
         .property_name = m_property_name,                                                         \
     }))
 
+#define NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READABLE_RATE_LIMITED(m_name,            \
+                                                                    m_signature,       \
+                                                                    m_property_name,   \
+                                                                    m_rate_limit_msec, \
+                                                                    ...)               \
+    ((GDBusPropertyInfo *) &((const struct _NMDBusPropertyInfoExtendedBase){           \
+        ._parent                = {.ref_count = -1,                                    \
+                                   .name      = m_name,                                \
+                                   .signature = m_signature,                           \
+                                   .flags     = G_DBUS_PROPERTY_INFO_FLAGS_READABLE,   \
+                                   __VA_ARGS__},                                       \
+        .property_name          = m_property_name,                                     \
+        .notify_rate_limit_msec = m_rate_limit_msec,                                   \
+    }))
+
 #define NM_DEFINE_DBUS_PROPERTY_INFO_EXTENDED_READWRITABLE(m_name,                   \
                                                            m_signature,              \
                                                            m_property_name,          \
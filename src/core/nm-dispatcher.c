@@ -8,6 +8,8 @@
 
 #include "nm-dispatcher.h"
 
+#include <sys/stat.h>
+
 #include "libnm-glib-aux/nm-dbus-aux.h"
 #include "libnm-core-aux-extern/nm-dispatcher-api.h"
 #include "NetworkManagerUtils.h"
@@ -72,6 +74,23 @@ struct NMDispatcherCallId {
 
 /*****************************************************************************/
 
+typedef enum {
+    SCRIPT_DIR_MAIN,
+    SCRIPT_DIR_PRE_UP,
+    SCRIPT_DIR_PRE_DOWN,
+    _SCRIPT_DIR_NUM,
+} ScriptDir;
+
+static const char *const script_dir_subdirs[_SCRIPT_DIR_NUM] = {
+    [SCRIPT_DIR_MAIN]     = NULL,
+    [SCRIPT_DIR_PRE_UP]   = "pre-up.d",
+    [SCRIPT_DIR_PRE_DOWN] = "pre-down.d",
+};
+
+static const char *const script_dir_bases[] = {NMLIBDIR, NMCONFDIR};
+
+/*****************************************************************************/
+
 /* FIXME(shutdown): on shutdown, we should not run dispatcher scripts synchronously.
  *   Instead, we should of course still run them asynchronously.
  *
@@ -84,6 +103,18 @@ static struct {
     GDBusConnection *dbus_connection;
     GHashTable      *requests;
     guint            request_id_counter;
+
+    /* The dispatcher service looks up the scripts for an action in the
+     * directories below. We watch them, so that we can avoid building
+     * the arguments and calling the service when there is nothing to run.
+     * @has_scripts is %NM_TERNARY_DEFAULT when the directories need to be
+     * scanned again. If any of the monitors could not be created, we
+     * always call the dispatcher. */
+    struct {
+        GFileMonitor *monitors[G_N_ELEMENTS(script_dir_bases)];
+        NMTernary     has_scripts;
+        bool          unmonitored : 1;
+    } script_dirs[_SCRIPT_DIR_NUM];
 } gl;
 
 /*****************************************************************************/
@@ -163,6 +194,124 @@ dispatcher_call_id_free(NMDispatcherCallId *call_id)
 
 /*****************************************************************************/
 
+static void
+_script_dir_changed(GFileMonitor     *monitor,
+                    GFile            *file,
+                    GFile            *other_file,
+                    GFileMonitorEvent event_type,
+                    gpointer          user_data)
+{
+    ScriptDir script_dir = GPOINTER_TO_INT(user_data);
+
+    nm_assert((guint) script_dir < _SCRIPT_DIR_NUM);
+
+    gl.script_dirs[script_dir].has_scripts = NM_TERNARY_DEFAULT;
+}
+
+static void
+_init_script_dirs(void)
+{
+    ScriptDir script_dir;
+    guint     i;
+
+    for (script_dir = 0; script_dir < _SCRIPT_DIR_NUM; script_dir++) {
+        gl.script_dirs[script_dir].has_scripts = NM_TERNARY_DEFAULT;
+
+        for (i = 0; i < G_N_ELEMENTS(script_dir_bases); i++) {
+            gs_unref_object GFile *file    = NULL;
+            gs_free char          *dirname = NULL;
+            GFileMonitor          *monitor;
+
+            dirname = g_build_filename(script_dir_bases[i],
+                                       "dispatcher.d",
+                                       script_dir_subdirs[script_dir],
+                                       NULL);
+            file    = g_file_new_for_path(dirname);
+            monitor = g_file_monitor_directory(file, G_FILE_MONITOR_NONE, NULL, NULL);
+            if (!monitor) {
+                _LOGD("cannot watch directory '%s' for dispatcher scripts", dirname);
+                gl.script_dirs[script_dir].unmonitored = TRUE;
+                continue;
+            }
+            g_signal_connect(monitor,
+                             "changed",
+                             G_CALLBACK(_script_dir_changed),
+                             GINT_TO_POINTER(script_dir));
+            gl.script_dirs[script_dir].monitors[i] = monitor;
+        }
+    }
+}
+
+static void
+_clear_script_dirs(void)
+{
+    ScriptDir script_dir;
+    guint     i;
+
+    for (script_dir = 0; script_dir < _SCRIPT_DIR_NUM; script_dir++) {
+        for (i = 0; i < G_N_ELEMENTS(script_dir_bases); i++) {
+            GFileMonitor *monitor = g_steal_pointer(&gl.script_dirs[script_dir].monitors[i]);
+
+            if (!monitor)
+                continue;
+            g_signal_handlers_disconnect_by_func(monitor,
+                                                 G_CALLBACK(_script_dir_changed),
+                                                 GINT_TO_POINTER(script_dir));
+            g_file_monitor_cancel(monitor);
+            g_object_unref(monitor);
+        }
+
+        /* without monitors, we no longer know whether there are scripts. */
+        gl.script_dirs[script_dir].has_scripts = NM_TERNARY_DEFAULT;
+        gl.script_dirs[script_dir].unmonitored = TRUE;
+    }
+}
+
+static gboolean
+_script_dir_has_scripts(ScriptDir script_dir)
+{
+    guint i;
+
+    /* This only needs to be a cheap approximation of find_scripts() of the
+     * dispatcher service. In doubt (for example, for a backup file that the
+     * service would ignore), we claim to have scripts and call the service. */
+    for (i = 0; i < G_N_ELEMENTS(script_dir_bases); i++) {
+        gs_free char *dirname = NULL;
+        const char   *filename;
+        GDir         *dir;
+
+        dirname = g_build_filename(script_dir_bases[i],
+                                   "dispatcher.d",
+                                   script_dir_subdirs[script_dir],
+                                   NULL);
+        dir     = g_dir_open(dirname, 0, NULL);
+        if (!dir)
+            continue;
+
+        while ((filename = g_dir_read_name(dir))) {
+            gs_free char *path        = NULL;
+            gs_free char *link_target = NULL;
+            struct stat   st;
+
+            if (filename[0] == '.')
+                continue;
+
+            path        = g_build_filename(dirname, filename, NULL);
+            link_target = g_file_read_link(path, NULL);
+            if (nm_streq0(link_target, "/dev/null"))
+                continue;
+            if (stat(path, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0)
+                continue;
+
+            g_dir_close(dir);
+            return TRUE;
+        }
+        g_dir_close(dir);
+    }
+
+    return FALSE;
+}
+
 static void
 _init_dispatcher(void)
 {
@@ -172,11 +321,48 @@ _init_dispatcher(void)
 
         if (!gl.dbus_connection)
             _LOGD("No D-Bus connection to talk with NetworkManager-dispatcher service");
+        else
+            _init_script_dirs();
     }
 }
 
 /*****************************************************************************/
 
+static ScriptDir
+action_to_script_dir(NMDispatcherAction action)
+{
+    if (NM_IN_SET(action, NM_DISPATCHER_ACTION_PRE_UP, NM_DISPATCHER_ACTION_VPN_PRE_UP))
+        return SCRIPT_DIR_PRE_UP;
+    if (NM_IN_SET(action, NM_DISPATCHER_ACTION_PRE_DOWN, NM_DISPATCHER_ACTION_VPN_PRE_DOWN))
+        return SCRIPT_DIR_PRE_DOWN;
+    return SCRIPT_DIR_MAIN;
+}
+
+/* Returns %FALSE, if we know that the dispatcher service would not run any
+ * script for @action. In that case, there is no need to call it. */
+static gboolean
+action_has_scripts(NMDispatcherAction action)
+{
+    ScriptDir script_dir;
+
+    /* Device-handlers are looked up by name from the profile and they
+     * report a result back. Always call the service. */
+    if (action_is_device_handler(action))
+        return TRUE;
+
+    script_dir = action_to_script_dir(action);
+
+    if (gl.script_dirs[script_dir].unmonitored)
+        return TRUE;
+
+    if (gl.script_dirs[script_dir].has_scripts == NM_TERNARY_DEFAULT)
+        gl.script_dirs[script_dir].has_scripts = _script_dir_has_scripts(script_dir);
+
+    return gl.script_dirs[script_dir].has_scripts;
+}
+
+/*****************************************************************************/
+
 static void
 dump_proxy_to_props(const NML3ConfigData *l3cd, GVariantBuilder *builder)
 {
@@ -798,6 +984,11 @@ _dispatcher_call(NMDispatcherAction    action,
     if (!gl.dbus_connection)
         return FALSE;
 
+    if (!action_has_scripts(action)) {
+        _LOGT("skip action '%s' as there are no dispatcher scripts", action_to_string(action));
+        return FALSE;
+    }
+
     log_ifname = device ? nm_device_get_iface(device) : NULL;
     log_con_uuid =
         settings_connection ? nm_settings_connection_get_uuid(settings_connection) : NULL;
@@ -1255,3 +1446,15 @@ nm_dispatcher_call_cancel(NMDispatcherCallId *call_id)
     _LOG3D(call_id, "cancelling dispatcher callback action");
     call_id->callback = NULL;
 }
+
+/**
+ * nm_dispatcher_stop:
+ *
+ * Releases the watches on the script directories. Called on shutdown.
+ * Dispatcher calls still work afterwards, but always call the service.
+ */
+void
+nm_dispatcher_stop(void)
+{
+    _clear_script_dirs();
+}
@@ -90,4 +90,6 @@ gboolean nm_dispatcher_call_dns_change(void);
 
 void nm_dispatcher_call_cancel(NMDispatcherCallId *call_id);
 
+void nm_dispatcher_stop(void);
+
 #endif /* __NM_DISPATCHER_H__ */
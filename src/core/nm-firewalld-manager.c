@@ -8,16 +8,30 @@
 #include "nm-firewalld-manager.h"
 
 #include "libnm-glib-aux/nm-dbus-aux.h"
+#include "libnm-glib-aux/nm-str-buf.h"
 #include "c-list/src/c-list.h"
 
 #include "NetworkManagerUtils.h"
 #include "nm-dbus-manager.h"
+#include "nm-config.h"
 
 #define FIREWALL_DBUS_SERVICE        "org.fedoraproject.FirewallD1"
 #define FIREWALL_DBUS_PATH           "/org/fedoraproject/FirewallD1"
 #define FIREWALL_DBUS_INTERFACE      "org.fedoraproject.FirewallD1"
 #define FIREWALL_DBUS_INTERFACE_ZONE "org.fedoraproject.FirewallD1.zone"
 
+/* firewalld handles one request at a time. If we start a request for every
+ * device right away, the requests at the end of a long queue run into the
+ * D-Bus timeout before firewalld gets to them. Limit the number of requests
+ * in flight, the others wait in a FIFO queue. The limit can be changed with
+ * the "firewalld-max-requests" option. */
+#define DBUS_CALLS_MAX_IN_FLIGHT_DEFAULT 16
+
+/* Latency buckets for requests: bucket 0 counts requests that completed within
+ * the same millisecond, bucket i those that took [2^(i-1), 2^i) milliseconds.
+ * The last bucket counts everything above. */
+#define LATENCY_HIST_LEN 16
+
 /*****************************************************************************/
 
 enum { STATE_CHANGED, LAST_SIGNAL };
@@ -31,8 +45,13 @@ typedef struct {
 
     CList pending_calls;
 
+    /* D-Bus requests that wait for a free slot or for the name owner. */
+    NMUtilsCallQueue dbus_queue;
+
     char *name_owner;
 
+    guint latency_hist[LATENCY_HIST_LEN];
+
     guint reloaded_id;
     guint name_owner_changed_id;
 
@@ -68,8 +87,12 @@ typedef enum {
 struct _NMFirewalldManagerCallId {
     CList lst;
 
+    CList dbus_queue_lst;
+
     NMFirewalldManager *self;
 
+    gint64 start_msec;
+
     char *iface;
 
     NMFirewalldManagerAddRemoveCallback callback;
@@ -197,6 +220,8 @@ _cb_info_create(NMFirewalldManager                 *self,
     call_id->callback  = callback;
     call_id->user_data = user_data;
 
+    c_list_init(&call_id->dbus_queue_lst);
+
     if (_get_running(priv)) {
         call_id->is_idle  = FALSE;
         call_id->dbus.arg = g_variant_new("(ss)", zone ?: "", iface);
@@ -212,6 +237,12 @@ static void
 _cb_info_complete(NMFirewalldManagerCallId *call_id, GError *error)
 {
     c_list_unlink(&call_id->lst);
+    c_list_unlink(&call_id->dbus_queue_lst);
+
+    if (!call_id->is_idle && call_id->dbus.cancellable) {
+        /* the request is still in flight and gets cancelled. */
+        nm_utils_call_queue_complete(&NM_FIREWALLD_MANAGER_GET_PRIVATE(call_id->self)->dbus_queue);
+    }
 
     if (call_id->callback)
         call_id->callback(call_id->self, call_id, error, call_id->user_data);
@@ -264,13 +295,60 @@ _handle_idle_start(NMFirewalldManager *self, NMFirewalldManagerCallId *call_id)
     return TRUE;
 }
 
+static void _handle_dbus_queue_process(NMFirewalldManager *self);
+
+static void
+_latency_hist_add(NMFirewalldManagerPrivate *priv, gint64 msec)
+{
+    guint idx;
+
+    idx = msec > 0 ? (guint) g_bit_storage((gulong) msec) : 0u;
+    priv->latency_hist[NM_MIN(idx, (guint) (LATENCY_HIST_LEN - 1))]++;
+}
+
+static void
+_latency_hist_log_and_reset(NMFirewalldManager *self)
+{
+    NMFirewalldManagerPrivate *priv = NM_FIREWALLD_MANAGER_GET_PRIVATE(self);
+    nm_auto_str_buf NMStrBuf   strbuf = NM_STR_BUF_INIT(0, FALSE);
+    guint                      n      = 0;
+    guint                      i;
+
+    if (!_LOGT_ENABLED())
+        goto out;
+
+    for (i = 0; i < LATENCY_HIST_LEN; i++) {
+        if (priv->latency_hist[i] == 0)
+            continue;
+        n += priv->latency_hist[i];
+        if (i == 0)
+            nm_str_buf_append_printf(&strbuf, " 0:%u", priv->latency_hist[i]);
+        else if (i == LATENCY_HIST_LEN - 1)
+            nm_str_buf_append_printf(&strbuf, " >=%u:%u", 1u << (i - 1), priv->latency_hist[i]);
+        else
+            nm_str_buf_append_printf(&strbuf, " <%u:%u", 1u << i, priv->latency_hist[i]);
+    }
+
+    if (n > 0) {
+        _LOGT(NULL,
+              "%u requests completed, latency histogram (msec):%s",
+              n,
+              nm_str_buf_get_str(&strbuf));
+    }
+
+out:
+    memset(priv->latency_hist, 0, sizeof(priv->latency_hist));
+}
+
 static void
 _handle_dbus_cb(GObject *source, GAsyncResult *result, gpointer user_data)
 {
-    NMFirewalldManager        *self;
-    NMFirewalldManagerCallId  *call_id;
-    gs_free_error GError      *error = NULL;
-    gs_unref_variant GVariant *ret   = NULL;
+    NMFirewalldManager                            *self;
+    NMFirewalldManagerPrivate                     *priv;
+    NMFirewalldManagerCallId                      *call_id;
+    _nm_unused gs_unref_object NMFirewalldManager *self_keep_alive = NULL;
+    gs_free_error GError                          *error           = NULL;
+    gs_unref_variant GVariant                     *ret             = NULL;
 
     ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source), result, &error);
 
@@ -285,7 +363,9 @@ _handle_dbus_cb(GObject *source, GAsyncResult *result, gpointer user_data)
     nm_assert(c_list_contains(&NM_FIREWALLD_MANAGER_GET_PRIVATE(call_id->self)->pending_calls,
                               &call_id->lst));
 
-    self = call_id->self;
+    self            = call_id->self;
+    priv            = NM_FIREWALLD_MANAGER_GET_PRIVATE(self);
+    self_keep_alive = g_object_ref(self);
 
     if (error) {
         const char *non_error = NULL;
@@ -313,9 +393,14 @@ _handle_dbus_cb(GObject *source, GAsyncResult *result, gpointer user_data)
     } else
         _LOGD(call_id, "complete: success");
 
+    nm_utils_call_queue_complete(&priv->dbus_queue);
     g_clear_object(&call_id->dbus.cancellable);
 
+    _latency_hist_add(priv, nm_utils_get_monotonic_timestamp_msec() - call_id->start_msec);
+
     _cb_info_complete(call_id, error);
+
+    _handle_dbus_queue_process(self);
 }
 
 static void
@@ -365,6 +450,36 @@ _handle_dbus_start(NMFirewalldManager *self, NMFirewalldManagerCallId *call_id)
                            call_id);
 }
 
+static guint
+_max_in_flight_get(void)
+{
+    return nm_config_data_get_value_int64(NM_CONFIG_GET_DATA,
+                                          NM_CONFIG_KEYFILE_GROUP_MAIN,
+                                          NM_CONFIG_KEYFILE_KEY_MAIN_FIREWALLD_MAX_REQUESTS,
+                                          10,
+                                          1,
+                                          G_MAXUINT16,
+                                          DBUS_CALLS_MAX_IN_FLIGHT_DEFAULT);
+}
+
+static void
+_handle_dbus_queue_process(NMFirewalldManager *self)
+{
+    NMFirewalldManagerPrivate *priv = NM_FIREWALLD_MANAGER_GET_PRIVATE(self);
+    CList                     *lst;
+
+    if (priv->name_owner) {
+        guint max_in_flight = _max_in_flight_get();
+
+        while ((lst = nm_utils_call_queue_pop(&priv->dbus_queue, max_in_flight))) {
+            _handle_dbus_start(self, c_list_entry(lst, NMFirewalldManagerCallId, dbus_queue_lst));
+        }
+    }
+
+    if (nm_utils_call_queue_is_idle(&priv->dbus_queue))
+        _latency_hist_log_and_reset(self);
+}
+
 static NMFirewalldManagerCallId *
 _start_request(NMFirewalldManager                 *self,
                OpsType                             ops_type,
@@ -375,6 +490,7 @@ _start_request(NMFirewalldManager                 *self,
 {
     NMFirewalldManagerPrivate *priv;
     NMFirewalldManagerCallId  *call_id;
+    const char                *msg;
 
     g_return_val_if_fail(NM_IS_FIREWALLD_MANAGER(self), NULL);
     g_return_val_if_fail(iface && *iface, NULL);
@@ -383,17 +499,26 @@ _start_request(NMFirewalldManager                 *self,
 
     call_id = _cb_info_create(self, ops_type, iface, zone, callback, user_data);
 
+    if (call_id->is_idle)
+        msg = " (not running, simulate success)";
+    else if (!priv->name_owner)
+        msg = " (waiting to initialize)";
+    else if (priv->dbus_queue.n_in_flight >= _max_in_flight_get())
+        msg = " (queued)";
+    else
+        msg = "";
+
     _LOGD(call_id,
           "firewall zone %s %s:%s%s%s%s",
           _ops_type_to_string(call_id->ops_type),
           iface,
           NM_PRINT_FMT_QUOTED(zone, "\"", zone, "\"", "default"),
-          call_id->is_idle ? " (not running, simulate success)"
-                           : (!priv->name_owner ? " (waiting to initialize)" : ""));
+          msg);
 
     if (!call_id->is_idle) {
-        if (priv->name_owner)
-            _handle_dbus_start(self, call_id);
+        call_id->start_msec = nm_utils_get_monotonic_timestamp_msec();
+        nm_utils_call_queue_push(&priv->dbus_queue, &call_id->dbus_queue_lst);
+        _handle_dbus_queue_process(self);
         if (!call_id->callback) {
             /* if the user did not provide a callback, the call_id is useless.
              * Especially, the user cannot use the call-id to cancel the request,
@@ -462,6 +587,8 @@ nm_firewalld_manager_cancel_call(NMFirewalldManagerCallId *call_id)
     _LOGD(call_id, "complete: cancel (%s)", error->message);
 
     _cb_info_complete(call_id, error);
+
+    _handle_dbus_queue_process(self);
 }
 
 /*****************************************************************************/
@@ -491,11 +618,11 @@ name_owner_changed(NMFirewalldManager *self, const char *owner)
 
     now_running = _get_running(priv);
 
-    if (just_initied) {
+    if (!c_list_is_empty(&priv->dbus_queue.lst_head)) {
         NMFirewalldManagerCallId *call_id_safe;
         NMFirewalldManagerCallId *call_id;
 
-        /* We kick of the requests that we have pending. Note that this is
+        /* We kick of the requests that we have queued. Note that this is
          * entirely asynchronous and also we don't invoke any callbacks for
          * the user.
          * Even _handle_idle_start() just schedules an idle handler. That is,
@@ -503,24 +630,32 @@ name_owner_changed(NMFirewalldManager *self, const char *owner)
          * DISCONNECTED signal below. Also, emitting callbacks means the user
          * can call back to modify the list of pending-calls and we'd have
          * to handle reentrancy. */
-        c_list_for_each_entry_safe (call_id, call_id_safe, &priv->pending_calls, lst) {
+        c_list_for_each_entry_safe (call_id,
+                                    call_id_safe,
+                                    &priv->dbus_queue.lst_head,
+                                    dbus_queue_lst) {
             nm_assert(!call_id->is_idle);
             nm_assert(call_id->dbus.arg);
 
             if (priv->name_owner) {
-                _LOGD(call_id, "initalizing: make D-Bus call");
-                _handle_dbus_start(self, call_id);
+                if (just_initied)
+                    _LOGD(call_id, "initalizing: make D-Bus call");
             } else {
                 /* we don't want to invoke callbacks to the user right away. That is because
                  * the user might schedule/cancel more calls, which messes up the order.
                  *
-                 * Instead, convert the pending calls to idle requests... */
+                 * Instead, convert the queued calls to idle requests... */
+                c_list_unlink(&call_id->dbus_queue_lst);
                 nm_clear_pointer(&call_id->dbus.arg, g_variant_unref);
                 call_id->is_idle = TRUE;
-                _LOGD(call_id, "initializing: fake success on idle");
+                _LOGD(call_id,
+                      "%s: fake success on idle",
+                      just_initied ? "initializing" : "firewall stopped");
                 _handle_idle_start(self, call_id);
             }
         }
+
+        _handle_dbus_queue_process(self);
     }
 
     if (just_initied)
@@ -594,6 +729,7 @@ nm_firewalld_manager_init(NMFirewalldManager *self)
     NMFirewalldManagerPrivate *priv = NM_FIREWALLD_MANAGER_GET_PRIVATE(self);
 
     c_list_init(&priv->pending_calls);
+    nm_utils_call_queue_init(&priv->dbus_queue);
 
     priv->dbus_connection = nm_g_object_ref(NM_MAIN_DBUS_CONNECTION_GET);
 
@@ -5,6 +5,7 @@
 #include "nm-l3cfg.h"
 
 #include "libnm-std-aux/nm-linux-compat.h"
+#include "libnm-std-aux/nm-usdt.h"
 
 #include <net/if.h>
 #include "nm-compat-headers/linux/if_addr.h"
@@ -5155,6 +5156,8 @@ _l3_commit(NML3Cfg *self, NML3CfgCommitType commit_type, gboolean is_idle)
     if (commit_type <= NM_L3_CFG_COMMIT_TYPE_NONE)
         return;
 
+    NM_USDT(l3cfg_commit_start, self->priv.ifindex, (int) commit_type);
+
     self->priv.p->commit_reentrant_count++;
 
     _l3cfg_update_combined_config(self,
@@ -5178,6 +5181,8 @@ _l3_commit(NML3Cfg *self, NML3CfgCommitType commit_type, gboolean is_idle)
     self->priv.p->commit_reentrant_count--;
 
     _nm_l3cfg_emit_signal_notify_simple(self, NM_L3_CONFIG_NOTIFY_TYPE_POST_COMMIT);
+
+    NM_USDT(l3cfg_commit_end, self->priv.ifindex, (int) commit_type);
 }
 
 NML3CfgBlockHandle *
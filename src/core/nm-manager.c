@@ -1216,6 +1216,20 @@ _get_activatable_connections_filter(NMSettings           *settings,
                                    NULL);
 }
 
+gboolean
+nm_manager_connection_is_activatable(NMManager            *manager,
+                                     NMSettingsConnection *sett_conn,
+                                     gboolean              for_auto_activation)
+{
+    NMManagerPrivate                         *priv = NM_MANAGER_GET_PRIVATE(manager);
+    const GetActivatableConnectionsFilterData d    = {
+           .self                = manager,
+           .for_auto_activation = for_auto_activation,
+    };
+
+    return _get_activatable_connections_filter(priv->settings, sett_conn, (gpointer) &d);
+}
+
 NMSettingsConnection **
 nm_manager_get_activatable_connections(NMManager *manager,
                                        gboolean   for_auto_activation,
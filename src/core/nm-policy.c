@@ -1428,14 +1428,15 @@ pending_ac_state_changed(NMActiveConnection *ac, guint state, guint reason, NMPo
 static void
 _auto_activate_device(NMPolicy *self, NMDevice *device)
 {
-    NMPolicyPrivate               *priv;
-    NMSettingsConnection          *best_connection;
-    gs_free char                  *specific_object = NULL;
-    gs_free NMSettingsConnection **connections     = NULL;
-    guint                          i, len;
-    gs_free_error GError          *error   = NULL;
-    gs_unref_object NMAuthSubject *subject = NULL;
-    NMActiveConnection            *ac;
+    NMPolicyPrivate                      *priv;
+    gs_unref_object NMSettingsConnection *best_connection = NULL;
+    gs_free char                         *specific_object = NULL;
+    NMSettingsConnection *const          *connections_cached;
+    gs_unref_ptrarray GPtrArray          *connections = NULL;
+    guint                                 i, len;
+    gs_free_error GError                 *error   = NULL;
+    gs_unref_object NMAuthSubject        *subject = NULL;
+    NMActiveConnection                   *ac;
 
     nm_assert(NM_IS_POLICY(self));
     nm_assert(NM_IS_DEVICE(device));
@@ -1460,14 +1461,23 @@ _auto_activate_device(NMPolicy *self, NMDevice *device)
     if (!nm_device_autoconnect_allowed(device))
         return;
 
-    connections = nm_manager_get_activatable_connections(priv->manager, TRUE, TRUE, &len);
-    if (!connections[0])
+    /* Only profiles that are available on the device can autoconnect on it. The
+     * device keeps those sorted by autoconnect priority, so we don't need to
+     * filter and sort all profiles for each device. */
+    connections_cached =
+        nm_device_get_available_connections_sorted_by_autoconnect_priority(device, &len);
+    if (len == 0)
         return;
 
+    /* The cached list is only valid until the available connections change,
+     * which the checks below can trigger. Iterate over our own references. */
+    connections = g_ptr_array_new_full(len, g_object_unref);
+    for (i = 0; i < len; i++)
+        g_ptr_array_add(connections, g_object_ref(connections_cached[i]));
+
     /* Find the first connection that should be auto-activated */
-    best_connection = NULL;
     for (i = 0; i < len; i++) {
-        NMSettingsConnection *candidate = connections[i];
+        NMSettingsConnection *candidate = connections->pdata[i];
         NMConnection         *cand_conn;
         NMSettingConnection  *s_con;
         const char           *permission;
@@ -1475,6 +1485,9 @@ _auto_activate_device(NMPolicy *self, NMDevice *device)
         if (nm_manager_devcon_autoconnect_is_blocked(priv->manager, device, candidate))
             continue;
 
+        if (!nm_manager_connection_is_activatable(priv->manager, candidate, TRUE))
+            continue;
+
         cand_conn = nm_settings_connection_get_connection(candidate);
 
         s_con = nm_connection_get_setting_connection(cand_conn);
@@ -1486,7 +1499,7 @@ _auto_activate_device(NMPolicy *self, NMDevice *device)
             continue;
 
         if (nm_device_can_auto_connect(device, candidate, &specific_object)) {
-            best_connection = candidate;
+            best_connection = g_object_ref(candidate);
             break;
         }
     }
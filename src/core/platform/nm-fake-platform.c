@@ -907,6 +907,12 @@ wifi_get_frequency(NMPlatform *platform, int ifindex)
     return 0;
 }
 
+static int
+wifi_get_phy(NMPlatform *platform, int ifindex)
+{
+    return -1;
+}
+
 static int
 wifi_get_quality(NMPlatform *platform, int ifindex)
 {
@@ -1451,6 +1457,7 @@ nm_fake_platform_class_init(NMFakePlatformClass *klass)
     platform_class->wifi_get_capabilities            = wifi_get_capabilities;
     platform_class->wifi_get_bssid                   = wifi_get_bssid;
     platform_class->wifi_get_frequency               = wifi_get_frequency;
+    platform_class->wifi_get_phy                     = wifi_get_phy;
     platform_class->wifi_get_quality                 = wifi_get_quality;
     platform_class->wifi_get_rate                    = wifi_get_rate;
     platform_class->wifi_get_mode                    = wifi_get_mode;
@@ -931,6 +931,39 @@ test_external(void)
 
 /*****************************************************************************/
 
+static void
+test_refresh_all(void)
+{
+    const NMPlatformLink *pllink;
+    int                   ifindex;
+
+    /* The link is created behind the back of the platform, and its netlink
+     * events are not processed. Only the dump brings it into the cache. */
+    nmtstp_run_command_check("ip link add %s type %s", DEVICE_NAME, "dummy");
+    g_assert(!nm_platform_link_get_by_ifname(NM_PLATFORM_GET, DEVICE_NAME));
+
+    nm_platform_refresh_all(NM_PLATFORM_GET, NMP_OBJECT_TYPE_LINK);
+
+    pllink = nm_platform_link_get_by_ifname(NM_PLATFORM_GET, DEVICE_NAME);
+    g_assert(pllink);
+    g_assert_cmpint(pllink->type, ==, NM_LINK_TYPE_DUMMY);
+    ifindex = pllink->ifindex;
+    g_assert_cmpint(ifindex, >, 0);
+
+    /* The dump also updates the cached links. */
+    nmtstp_run_command_check("ip link set %s up", DEVICE_NAME);
+    g_assert(!nm_platform_link_is_up(NM_PLATFORM_GET, ifindex));
+    nm_platform_refresh_all(NM_PLATFORM_GET, NMP_OBJECT_TYPE_LINK);
+    g_assert(nm_platform_link_is_up(NM_PLATFORM_GET, ifindex));
+
+    /* ... and drops the ones that are gone. */
+    nmtstp_run_command_check("ip link del %s", DEVICE_NAME);
+    nm_platform_refresh_all(NM_PLATFORM_GET, NMP_OBJECT_TYPE_LINK);
+    g_assert(!nm_platform_link_get(NM_PLATFORM_GET, ifindex));
+}
+
+/*****************************************************************************/
+
 static guint8 *
 _copy_base64(guint8 *dst, gsize dst_len, const char *base64_src)
 {
@@ -4082,6 +4115,7 @@ _nmtstp_setup_tests(void)
 
     if (nmtstp_is_root_test()) {
         g_test_add_func("/link/external", test_external);
+        g_test_add_func("/link/refresh-all", test_refresh_all);
 
         test_software_detect_add("/link/software/detect/bridge", NM_LINK_TYPE_BRIDGE, 0);
         test_software_detect_add("/link/software/detect/gre", NM_LINK_TYPE_GRE, 0);
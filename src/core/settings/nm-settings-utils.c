@@ -159,3 +159,304 @@ nm_sett_util_storages_steal(NMSettUtilStorages *storages,
 
     return storage;
 }
+
+/*****************************************************************************/
+
+/* All lists are NULL terminated, so that the one with all profiles of a type
+ * can be returned as is. */
+typedef struct {
+    GPtrArray  *all;
+    GPtrArray  *iface_any;
+    GHashTable *by_iface;
+    GPtrArray  *hwaddr_any;
+    GHashTable *by_hwaddr;
+} ConnIndexType;
+
+struct _NMSettUtilConnIndex {
+    GHashTable *by_type;
+};
+
+static GPtrArray *
+_conn_index_list_new(void)
+{
+    GPtrArray *arr;
+
+    arr = g_ptr_array_new();
+    g_ptr_array_add(arr, NULL);
+    return arr;
+}
+
+static void
+_conn_index_list_add(GPtrArray *arr, gpointer item)
+{
+    arr->pdata[arr->len - 1u] = item;
+    g_ptr_array_add(arr, NULL);
+}
+
+static GPtrArray *
+_conn_index_bucket_get(GHashTable *buckets, const char *key)
+{
+    GPtrArray *arr;
+
+    arr = g_hash_table_lookup(buckets, key);
+    if (!arr) {
+        arr = _conn_index_list_new();
+        g_hash_table_insert(buckets, g_strdup(key), arr);
+    }
+    return arr;
+}
+
+static guint
+_conn_index_bucket_len(GHashTable *buckets, const char *key)
+{
+    GPtrArray *arr;
+
+    if (!key)
+        return 0;
+    arr = g_hash_table_lookup(buckets, key);
+    return arr ? arr->len - 1u : 0u;
+}
+
+static void
+_conn_index_list_append_to(GPtrArray *arr, GPtrArray *out)
+{
+    guint i;
+
+    if (!arr)
+        return;
+    for (i = 0; i + 1u < arr->len; i++)
+        g_ptr_array_add(out, arr->pdata[i]);
+}
+
+static void
+_conn_index_type_free(ConnIndexType *t)
+{
+    g_ptr_array_unref(t->all);
+    g_ptr_array_unref(t->iface_any);
+    g_hash_table_destroy(t->by_iface);
+    g_ptr_array_unref(t->hwaddr_any);
+    g_hash_table_destroy(t->by_hwaddr);
+    nm_g_slice_free(t);
+}
+
+/* Returns the permanent MAC address that the 802-3-ethernet setting of the
+ * profile restricts it to, in canonical form. Profiles with s390 subchannels
+ * might skip the MAC address check, they are not restricted. */
+static char *
+_conn_index_get_hwaddr(NMConnection *connection)
+{
+    NMSettingWired    *s_wired;
+    const char *const *subchans;
+    const char        *mac;
+
+    s_wired = nm_connection_get_setting_wired(connection);
+    if (!s_wired)
+        return NULL;
+
+    mac = nm_setting_wired_get_mac_address(s_wired);
+    if (!mac)
+        return NULL;
+
+    subchans = nm_setting_wired_get_s390_subchannels(s_wired);
+    if (subchans && subchans[0])
+        return NULL;
+
+    return nm_utils_hwaddr_canonical(mac, -1);
+}
+
+/**
+ * nm_sett_util_conn_index_new:
+ *
+ * Creates an index of profiles by connection type. Within one type, the
+ * profiles are further bucketed by the "connection.interface-name" and by the
+ * MAC address of the "802-3-ethernet" setting. Profiles without those
+ * properties are kept in extra buckets, as they match any device.
+ *
+ * The index does not track changes to the profiles. The caller must
+ * drop it when profiles get added or removed, or when
+ * nm_sett_util_conn_index_keys_equal() says that a profile changed
+ * in a relevant way.
+ *
+ * Returns: (transfer full): the new, empty index.
+ */
+NMSettUtilConnIndex *
+nm_sett_util_conn_index_new(void)
+{
+    NMSettUtilConnIndex *idx;
+
+    idx  = g_slice_new(NMSettUtilConnIndex);
+    *idx = (NMSettUtilConnIndex){
+        .by_type = g_hash_table_new_full(nm_str_hash,
+                                         g_str_equal,
+                                         g_free,
+                                         (GDestroyNotify) _conn_index_type_free),
+    };
+    return idx;
+}
+
+void
+nm_sett_util_conn_index_free(NMSettUtilConnIndex *idx)
+{
+    if (!idx)
+        return;
+    g_hash_table_destroy(idx->by_type);
+    nm_g_slice_free(idx);
+}
+
+void
+nm_sett_util_conn_index_add(NMSettUtilConnIndex *idx, gpointer item, NMConnection *connection)
+{
+    gs_free char  *hwaddr = NULL;
+    ConnIndexType *t;
+    const char    *type;
+    const char    *iface;
+
+    nm_assert(idx);
+    nm_assert(item);
+    nm_assert(NM_IS_CONNECTION(connection));
+
+    type = nm_connection_get_connection_type(connection);
+    if (!type)
+        return;
+
+    t = g_hash_table_lookup(idx->by_type, type);
+    if (!t) {
+        t  = g_slice_new(ConnIndexType);
+        *t = (ConnIndexType){
+            .all        = _conn_index_list_new(),
+            .iface_any  = _conn_index_list_new(),
+            .by_iface   = g_hash_table_new_full(nm_str_hash,
+                                              g_str_equal,
+                                              g_free,
+                                              (GDestroyNotify) g_ptr_array_unref),
+            .hwaddr_any = _conn_index_list_new(),
+            .by_hwaddr  = g_hash_table_new_full(nm_str_hash,
+                                               g_str_equal,
+                                               g_free,
+                                               (GDestroyNotify) g_ptr_array_unref),
+        };
+        g_hash_table_insert(idx->by_type, g_strdup(type), t);
+    }
+
+    _conn_index_list_add(t->all, item);
+
+    iface = nm_connection_get_interface_name(connection);
+    if (iface)
+        _conn_index_list_add(_conn_index_bucket_get(t->by_iface, iface), item);
+    else
+        _conn_index_list_add(t->iface_any, item);
+
+    hwaddr = _conn_index_get_hwaddr(connection);
+    if (hwaddr)
+        _conn_index_list_add(_conn_index_bucket_get(t->by_hwaddr, hwaddr), item);
+    else
+        _conn_index_list_add(t->hwaddr_any, item);
+}
+
+/**
+ * nm_sett_util_conn_index_keys_equal:
+ * @a: a profile
+ * @b: another profile
+ *
+ * Returns: %TRUE if both profiles would land in the same buckets of
+ *   a #NMSettUtilConnIndex.
+ */
+gboolean
+nm_sett_util_conn_index_keys_equal(NMConnection *a, NMConnection *b)
+{
+    gs_free char *hwaddr_a = NULL;
+    gs_free char *hwaddr_b = NULL;
+
+    if (!nm_streq0(nm_connection_get_connection_type(a), nm_connection_get_connection_type(b)))
+        return FALSE;
+    if (!nm_streq0(nm_connection_get_interface_name(a), nm_connection_get_interface_name(b)))
+        return FALSE;
+
+    hwaddr_a = _conn_index_get_hwaddr(a);
+    hwaddr_b = _conn_index_get_hwaddr(b);
+    return nm_streq0(hwaddr_a, hwaddr_b);
+}
+
+/**
+ * nm_sett_util_conn_index_get_by_type:
+ * @idx: the #NMSettUtilConnIndex
+ * @type: the connection type
+ * @out_len: (out) (optional): the number of returned items
+ *
+ * Returns: (transfer none): the NULL terminated list of all items of
+ *   type @type. It is never %NULL and stays valid until the next
+ *   change of @idx.
+ */
+gpointer const *
+nm_sett_util_conn_index_get_by_type(NMSettUtilConnIndex *idx, const char *type, guint *out_len)
+{
+    static gpointer const empty[1] = {NULL};
+    ConnIndexType        *t;
+
+    nm_assert(idx);
+    nm_assert(type);
+
+    t = g_hash_table_lookup(idx->by_type, type);
+    if (!t) {
+        NM_SET_OUT(out_len, 0);
+        return empty;
+    }
+
+    NM_SET_OUT(out_len, t->all->len - 1u);
+    return (gpointer const *) t->all->pdata;
+}
+
+/**
+ * nm_sett_util_conn_index_get_candidates:
+ * @idx: the #NMSettUtilConnIndex
+ * @type: the connection type
+ * @iface: (nullable): the interface name of the device
+ * @hwaddr: (nullable): the permanent MAC address of the device, if the
+ *   device only accepts profiles whose "802-3-ethernet.mac-address" matches
+ *   it. Pass %NULL to not filter by MAC address.
+ * @out: the array to append the items to
+ *
+ * Appends the items of type @type that a device with @iface and @hwaddr
+ * might accept. These are the profiles without interface name and those
+ * with interface name @iface, or if that is more selective, the profiles
+ * without MAC address and those with MAC address @hwaddr. The result is
+ * a superset of the compatible profiles, the caller still must check each
+ * of them.
+ */
+void
+nm_sett_util_conn_index_get_candidates(NMSettUtilConnIndex *idx,
+                                       const char          *type,
+                                       const char          *iface,
+                                       const char          *hwaddr,
+                                       GPtrArray           *out)
+{
+    gs_free char  *hwaddr_canonical = NULL;
+    ConnIndexType *t;
+    guint          n_iface;
+    guint          n_hwaddr;
+
+    nm_assert(idx);
+    nm_assert(type);
+    nm_assert(out);
+
+    t = g_hash_table_lookup(idx->by_type, type);
+    if (!t)
+        return;
+
+    n_iface = t->iface_any->len - 1u + _conn_index_bucket_len(t->by_iface, iface);
+
+    if (hwaddr)
+        hwaddr_canonical = nm_utils_hwaddr_canonical(hwaddr, -1);
+    if (hwaddr_canonical) {
+        n_hwaddr = t->hwaddr_any->len - 1u + _conn_index_bucket_len(t->by_hwaddr, hwaddr_canonical);
+        if (n_hwaddr < n_iface) {
+            _conn_index_list_append_to(t->hwaddr_any, out);
+            _conn_index_list_append_to(g_hash_table_lookup(t->by_hwaddr, hwaddr_canonical), out);
+            return;
+        }
+    }
+
+    _conn_index_list_append_to(t->iface_any, out);
+    if (iface)
+        _conn_index_list_append_to(g_hash_table_lookup(t->by_iface, iface), out);
+}
@@ -88,4 +88,25 @@ typedef struct {
 
 gboolean nm_sett_util_allow_filename_cb(const char *filename, gpointer user_data);
 
+/*****************************************************************************/
+
+typedef struct _NMSettUtilConnIndex NMSettUtilConnIndex;
+
+NMSettUtilConnIndex *nm_sett_util_conn_index_new(void);
+
+void nm_sett_util_conn_index_free(NMSettUtilConnIndex *idx);
+
+void nm_sett_util_conn_index_add(NMSettUtilConnIndex *idx, gpointer item, NMConnection *connection);
+
+gboolean nm_sett_util_conn_index_keys_equal(NMConnection *a, NMConnection *b);
+
+gpointer const *
+nm_sett_util_conn_index_get_by_type(NMSettUtilConnIndex *idx, const char *type, guint *out_len);
+
+void nm_sett_util_conn_index_get_candidates(NMSettUtilConnIndex *idx,
+                                            const char          *type,
+                                            const char          *iface,
+                                            const char          *hwaddr,
+                                            GPtrArray           *out);
+
 #endif /* __NM_SETTINGS_UTILS_H__ */
@@ -53,6 +53,7 @@
 #include "devices/nm-device-ethernet.h"
 #include "nm-settings-connection.h"
 #include "nm-settings-plugin.h"
+#include "nm-settings-utils.h"
 #include "nm-dbus-manager.h"
 #include "nm-auth-utils.h"
 #include "libnm-core-aux-intern/nm-auth-subject.h"
@@ -384,6 +385,7 @@ typedef struct {
 
     NMSettingsConnection **connections_cached_list;
     NMSettingsConnection **connections_cached_list_sorted_by_autoconnect_priority;
+    NMSettUtilConnIndex   *connections_cached_index;
 
     GSList *unmanaged_specs;
     GSList *unrecognized_specs;
@@ -1102,6 +1104,9 @@ _connection_changed_update(NMSettings                      *self,
 
     _nm_settings_connection_set_connection(sett_conn, connection, &connection_old, update_reason);
 
+    if (connection_old && !nm_sett_util_conn_index_keys_equal(connection_old, connection))
+        nm_clear_pointer(&priv->connections_cached_index, nm_sett_util_conn_index_free);
+
     if (is_new) {
         _nm_settings_connection_register_kf_dbs(sett_conn,
                                                 priv->kf_db_timestamps,
@@ -3084,6 +3089,7 @@ _clear_connections_cached_list(NMSettingsPrivate *priv)
 
         nm_clear_g_free(&priv->connections_cached_list_sorted_by_autoconnect_priority);
     }
+    nm_clear_pointer(&priv->connections_cached_index, nm_sett_util_conn_index_free);
 }
 
 static void
@@ -3222,6 +3228,79 @@ nm_settings_get_connections(NMSettings *self, guint *out_len)
     return priv->connections_cached_list;
 }
 
+static NMSettUtilConnIndex *
+_connections_get_index(NMSettings *self)
+{
+    NMSettingsPrivate    *priv = NM_SETTINGS_GET_PRIVATE(self);
+    NMSettingsConnection *con;
+
+    if (G_UNLIKELY(!priv->connections_cached_index)) {
+        priv->connections_cached_index = nm_sett_util_conn_index_new();
+        c_list_for_each_entry (con, &priv->connections_lst_head, _connections_lst) {
+            nm_sett_util_conn_index_add(priv->connections_cached_index,
+                                        con,
+                                        nm_settings_connection_get_connection(con));
+        }
+    }
+    return priv->connections_cached_index;
+}
+
+/**
+ * nm_settings_get_connections_by_type:
+ * @self: the #NMSettings
+ * @type: the connection type, as in #NMSettingConnection:type
+ * @out_len: (out) (optional): returns the number of returned
+ *   connections.
+ *
+ * Like nm_settings_get_connections(), but only returns the profiles
+ * of connection type @type. The index is built on first use with
+ * one pass over all profiles and is dropped whenever a profile gets
+ * added, removed or changes its indexed properties.
+ *
+ * Returns: (transfer none): a list of NMSettingsConnections. The list is
+ * unsorted and NULL terminated. The result is never %NULL, in case of no
+ * connections, it returns an empty list.
+ * The returned list is cached internally, only valid until the next
+ * NMSettings operation.
+ */
+NMSettingsConnection *const *
+nm_settings_get_connections_by_type(NMSettings *self, const char *type, guint *out_len)
+{
+    g_return_val_if_fail(NM_IS_SETTINGS(self), NULL);
+    g_return_val_if_fail(type, NULL);
+
+    return (NMSettingsConnection *const *)
+        nm_sett_util_conn_index_get_by_type(_connections_get_index(self), type, out_len);
+}
+
+/**
+ * nm_settings_get_connection_candidates:
+ * @self: the #NMSettings
+ * @type: the connection type, as in #NMSettingConnection:type
+ * @iface: (nullable): the interface name of the device
+ * @hwaddr: (nullable): the permanent MAC address of the device, if
+ *   the device only accepts profiles with matching "802-3-ethernet.mac-address".
+ * @out: the #GPtrArray to append the #NMSettingsConnection to
+ *
+ * Appends the profiles of type @type that a device with interface name
+ * @iface and permanent MAC address @hwaddr might be compatible with.
+ * This skips profiles bound to other interface names or MAC addresses,
+ * using the same index as nm_settings_get_connections_by_type().
+ */
+void
+nm_settings_get_connection_candidates(NMSettings *self,
+                                      const char *type,
+                                      const char *iface,
+                                      const char *hwaddr,
+                                      GPtrArray  *out)
+{
+    g_return_if_fail(NM_IS_SETTINGS(self));
+    g_return_if_fail(type);
+    g_return_if_fail(out);
+
+    nm_sett_util_conn_index_get_candidates(_connections_get_index(self), type, iface, hwaddr, out);
+}
+
 NMSettingsConnection *const *
 nm_settings_get_connections_sorted_by_autoconnect_priority(NMSettings *self, guint *out_len)
 {
@@ -82,6 +82,15 @@ void nm_settings_add_connection_dbus(NMSettings                     *self,
 
 NMSettingsConnection *const *nm_settings_get_connections(NMSettings *settings, guint *out_len);
 
+NMSettingsConnection *const *
+nm_settings_get_connections_by_type(NMSettings *self, const char *type, guint *out_len);
+
+void nm_settings_get_connection_candidates(NMSettings *self,
+                                           const char *type,
+                                           const char *iface,
+                                           const char *hwaddr,
+                                           GPtrArray  *out);
+
 NMSettingsConnection *const *
 nm_settings_get_connections_sorted_by_autoconnect_priority(NMSettings *self, guint *out_len);
 
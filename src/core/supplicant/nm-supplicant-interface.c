@@ -793,36 +793,44 @@ _bss_info_properties_changed(NMSupplicantInterface *self,
     _bss_info_changed_emit(self, bss_info, TRUE);
 }
 
+static void
+_bss_info_init_complete(NMSupplicantInterface *self,
+                        NMSupplicantBssInfo   *bss_info,
+                        GVariant              *properties)
+{
+    NMSupplicantInterfacePrivate *priv = NM_SUPPLICANT_INTERFACE_GET_PRIVATE(self);
+
+    nm_clear_g_cancellable(&bss_info->_init_cancellable);
+    nm_c_list_move_tail(&priv->bss_lst_head, &bss_info->_bss_lst);
+
+    _bss_info_properties_changed(self, bss_info, properties, TRUE);
+
+    _starting_check_ready(self);
+
+    _notify_maybe_scanning(self);
+}
+
 static void
 _bss_info_get_all_cb(GVariant *result, GError *error, gpointer user_data)
 {
-    NMSupplicantBssInfo          *bss_info;
-    NMSupplicantInterface        *self;
-    NMSupplicantInterfacePrivate *priv;
-    gs_unref_variant GVariant    *properties = NULL;
+    NMSupplicantBssInfo       *bss_info;
+    gs_unref_variant GVariant *properties = NULL;
 
     if (nm_utils_error_is_cancelled(error))
         return;
 
     bss_info = user_data;
-    self     = bss_info->_self;
-    priv     = NM_SUPPLICANT_INTERFACE_GET_PRIVATE(self);
 
     g_clear_object(&bss_info->_init_cancellable);
-    nm_c_list_move_tail(&priv->bss_lst_head, &bss_info->_bss_lst);
 
     if (result)
         g_variant_get(result, "(@a{sv})", &properties);
 
-    _bss_info_properties_changed(self, bss_info, properties, TRUE);
-
-    _starting_check_ready(self);
-
-    _notify_maybe_scanning(self);
+    _bss_info_init_complete(bss_info->_self, bss_info, properties);
 }
 
 static void
-_bss_info_add(NMSupplicantInterface *self, const char *object_path)
+_bss_info_add(NMSupplicantInterface *self, const char *object_path, GVariant *properties)
 {
     NMSupplicantInterfacePrivate   *priv     = NM_SUPPLICANT_INTERFACE_GET_PRIVATE(self);
     nm_auto_ref_string NMRefString *bss_path = NULL;
@@ -832,9 +840,19 @@ _bss_info_add(NMSupplicantInterface *self, const char *object_path)
     if (!bss_path)
         return;
 
+    /* The "BSSAdded" signal carries all the properties of the BSS. In that case,
+     * there is no need for a GetAll call per BSS, which matters when a scan
+     * finds hundreds of them. */
+    if (properties && g_variant_n_children(properties) == 0)
+        properties = NULL;
+
     bss_info = g_hash_table_lookup(priv->bss_idx, &bss_path);
     if (bss_info) {
         bss_info->_bss_dirty = FALSE;
+        if (properties && bss_info->_init_cancellable) {
+            /* still waiting for GetAll. We have the properties now. */
+            _bss_info_init_complete(self, bss_info, properties);
+        }
         return;
     }
 
@@ -847,6 +865,11 @@ _bss_info_add(NMSupplicantInterface *self, const char *object_path)
     c_list_link_tail(&priv->bss_initializing_lst_head, &bss_info->_bss_lst);
     g_hash_table_add(priv->bss_idx, bss_info);
 
+    if (properties) {
+        _bss_info_init_complete(self, bss_info, properties);
+        return;
+    }
+
     nm_dbus_connection_call_get_all(priv->dbus_connection,
                                     priv->name_owner->str,
                                     bss_info->bss_path->str,
@@ -2028,7 +2051,7 @@ _properties_changed_main(NMSupplicantInterface *self, GVariant *properties)
             bss_info->_bss_dirty = TRUE;
 
         for (iter = v_strv; *iter; iter++)
-            _bss_info_add(self, *iter);
+            _bss_info_add(self, *iter, NULL);
 
         g_free(v_strv);
 
@@ -3057,11 +3080,13 @@ _signal_handle(NMSupplicantInterface *self,
             return;
 
         if (nm_streq(signal_name, "BSSAdded")) {
+            gs_unref_variant GVariant *properties = NULL;
+
             if (!g_variant_is_of_type(parameters, G_VARIANT_TYPE("(oa{sv})")))
                 return;
 
-            g_variant_get(parameters, "(&oa{sv})", &path, NULL);
-            _bss_info_add(self, path);
+            g_variant_get(parameters, "(&o@a{sv})", &path, &properties);
+            _bss_info_add(self, path, properties);
             return;
         }
 
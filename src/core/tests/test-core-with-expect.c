@@ -8,6 +8,7 @@
 #include <time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 
 #include "NetworkManagerUtils.h"
@@ -629,6 +630,224 @@ test_nmp_utils_new_vlan_name(void)
 
 /*****************************************************************************/
 
+#define LOGGING_BENCHMARK_N_THREADS 4
+#define LOGGING_BENCHMARK_N         50000u
+
+static struct {
+    const char *backend;
+    int         fd_null;
+    int         n_received;
+} _logging_benchmark;
+
+static int
+_logging_benchmark_sendv(const struct iovec *iov, int n)
+{
+    int i;
+
+    /* Instead of journald, write the messages to /dev/null. That still costs
+     * a syscall per message, like sending them to the journal socket. */
+    for (i = 0; i < n; i++) {
+        if (memmem(iov[i].iov_base,
+                   iov[i].iov_len,
+                   "logging-benchmark:",
+                   NM_STRLEN("logging-benchmark:"))) {
+            g_atomic_int_inc(&_logging_benchmark.n_received);
+            break;
+        }
+    }
+    if (writev(_logging_benchmark.fd_null, iov, n) < 0)
+        return -errno;
+    return 0;
+}
+
+static gpointer
+_logging_benchmark_thread(gpointer user_data)
+{
+    guint idx = GPOINTER_TO_UINT(user_data);
+    guint i;
+
+    for (i = 0; i < LOGGING_BENCHMARK_N; i++) {
+        if (nm_logging_enabled_mt(TRUE, LOGL_TRACE, LOGD_PLATFORM)) {
+            _nm_log_mt(TRUE,
+                       LOGL_TRACE,
+                       LOGD_PLATFORM,
+                       0,
+                       NULL,
+                       NULL,
+                       "logging-benchmark: thread %u, message %u of %u",
+                       idx,
+                       i,
+                       LOGGING_BENCHMARK_N);
+        }
+    }
+    return NULL;
+}
+
+static void
+_logging_benchmark_report(void)
+{
+    guint n_sent = LOGGING_BENCHMARK_N_THREADS * LOGGING_BENCHMARK_N;
+    guint n_received;
+
+    /* Runs at exit, after the buffered backend flushed the pending messages. */
+    n_received = g_atomic_int_get(&_logging_benchmark.n_received);
+    g_print(">>> backend %-16s: %u of %u messages delivered, %u dropped\n",
+            _logging_benchmark.backend,
+            n_received,
+            n_sent,
+            n_sent - n_received);
+}
+
+static void
+_test_logging_benchmark_do(const char *backend)
+{
+    int   err;
+    int   exit_status;
+    pid_t child_pid;
+
+    /* nm_logging_init() can only be called once per process. Do that in a
+     * child process. */
+    child_pid = fork();
+    g_assert(child_pid >= 0);
+
+    if (child_pid == 0) {
+        GThread *threads[LOGGING_BENCHMARK_N_THREADS];
+        gint64   start_nsec;
+        gint64   elapsed_nsec;
+        guint    n_sent = LOGGING_BENCHMARK_N_THREADS * LOGGING_BENCHMARK_N;
+        guint    i;
+
+        _logging_benchmark.backend = backend;
+        _logging_benchmark.fd_null = open("/dev/null", O_WRONLY | O_CLOEXEC);
+        g_assert(_logging_benchmark.fd_null >= 0);
+
+        /* Registered before nm_logging_init(), so that it runs after the
+         * writer thread of the buffered backend is gone. */
+        atexit(_logging_benchmark_report);
+
+        _nm_logging_set_journal_sendv(_logging_benchmark_sendv);
+        nm_logging_init(backend, FALSE);
+        if (!nm_logging_setup("TRACE", "ALL", NULL, NULL))
+            g_assert_not_reached();
+
+        start_nsec = nm_utils_get_monotonic_timestamp_nsec();
+        for (i = 0; i < LOGGING_BENCHMARK_N_THREADS; i++)
+            threads[i] = g_thread_new("logging-benchmark",
+                                      _logging_benchmark_thread,
+                                      GUINT_TO_POINTER(i));
+        for (i = 0; i < LOGGING_BENCHMARK_N_THREADS; i++)
+            g_thread_join(threads[i]);
+        elapsed_nsec = nm_utils_get_monotonic_timestamp_nsec() - start_nsec;
+
+        g_print(">>> backend %-16s: %u messages from %d threads in %ld.%09ld seconds (%.0f "
+                "messages/sec)\n",
+                backend,
+                n_sent,
+                LOGGING_BENCHMARK_N_THREADS,
+                (long) (elapsed_nsec / NM_UTILS_NSEC_PER_SEC),
+                (long) (elapsed_nsec % NM_UTILS_NSEC_PER_SEC),
+                ((double) n_sent) * NM_UTILS_NSEC_PER_SEC / ((double) NM_MAX(elapsed_nsec, 1)));
+
+        /* exit() waits for the buffered backend to flush. */
+        exit(0);
+    }
+
+    do {
+        err = waitpid(child_pid, &exit_status, 0);
+    } while (err == -1 && errno == EINTR);
+    g_assert(err == child_pid);
+    g_assert(WIFEXITED(exit_status));
+    g_assert_cmpint(WEXITSTATUS(exit_status), ==, 0);
+}
+
+static void
+test_logging_benchmark(void)
+{
+    if (nmtst_test_quick()) {
+        g_print("Skipping test: don't run long running test %s (NMTST_DEBUG=slow)\n",
+                g_get_prgname() ?: "test-core-with-expect");
+        g_test_skip("Skip long running test");
+        return;
+    }
+
+    if (!SYSTEMD_JOURNAL) {
+        g_test_skip("Built without journal support");
+        return;
+    }
+
+    /* Compares the throughput of the synchronous logging with the buffered
+     * backend, with several threads logging at the same time. The messages
+     * are not sent to journald but to /dev/null, and the buffered backend
+     * reports how many messages it dropped because its buffers were full. */
+    _test_logging_benchmark_do(NM_LOG_CONFIG_BACKEND_JOURNAL);
+    _test_logging_benchmark_do(NM_LOG_CONFIG_BACKEND_JOURNAL_BUFFERED);
+}
+
+/*****************************************************************************/
+
+static void
+test_logging_recorder(void)
+{
+    int   err;
+    int   exit_status;
+    pid_t child_pid;
+
+    /* the flight recorder modifies the global logging state. Test it in a
+     * child process. */
+    child_pid = fork();
+    g_assert(child_pid >= 0);
+
+    if (child_pid == 0) {
+        gs_free char *filename = NULL;
+        gs_free char *contents = NULL;
+        GError       *error    = NULL;
+        guint         i;
+
+        filename = g_strdup_printf("/tmp/nm-test-logging-recorder.%d.log", (int) getpid());
+
+        if (!nm_logging_setup("INFO", "DEFAULT", NULL, NULL))
+            g_assert_not_reached();
+        g_assert(!nm_logging_enabled(LOGL_TRACE, LOGD_PLATFORM));
+
+        g_assert(!nm_logging_recorder_dump(filename, &error));
+        g_clear_error(&error);
+
+        if (!nm_logging_recorder_setup("TRACE", "PLATFORM", 4096, &error))
+            g_assert_not_reached();
+        g_assert(nm_logging_enabled(LOGL_TRACE, LOGD_PLATFORM));
+        g_assert(!nm_logging_enabled(LOGL_TRACE, LOGD_DEVICE));
+        g_assert(!strstr(nm_logging_domains_to_string(), "PLATFORM:TRACE"));
+
+        for (i = 0; i < 500; i++)
+            nm_log_trace(LOGD_PLATFORM, "recorder-test: message #%u", i);
+
+        if (!nm_logging_recorder_dump(filename, &error))
+            g_assert_not_reached();
+        if (!g_file_get_contents(filename, &contents, NULL, &error))
+            g_assert_not_reached();
+        unlink(filename);
+
+        g_assert(g_str_has_prefix(contents, "# NetworkManager flight recorder: 500 lines"));
+        g_assert(strstr(contents, "recorder-test: message #499\n"));
+        g_assert(!strstr(contents, "recorder-test: message #0\n"));
+
+        if (!nm_logging_recorder_setup(NULL, NULL, 0, &error))
+            g_assert_not_reached();
+        g_assert(!nm_logging_enabled(LOGL_TRACE, LOGD_PLATFORM));
+
+        exit(0);
+    }
+
+    do {
+        err = waitpid(child_pid, &exit_status, 0);
+    } while (err == -1 && errno == EINTR);
+    g_assert(err == child_pid);
+    g_assert(WIFEXITED(exit_status));
+    g_assert_cmpint(WEXITSTATUS(exit_status), ==, 0);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -643,6 +862,8 @@ main(int argc, char **argv)
                     test_nm_utils_array_remove_at_indexes);
     g_test_add_func("/general/nm_ethernet_address_is_valid", test_nm_ethernet_address_is_valid);
     g_test_add_func("/general/nmp_utils_new_vlan_name", test_nmp_utils_new_vlan_name);
+    g_test_add_func("/general/logging_benchmark", test_logging_benchmark);
+    g_test_add_func("/general/logging_recorder", test_logging_recorder);
 
     return g_test_run();
 }
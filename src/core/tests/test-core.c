@@ -19,6 +19,7 @@
 #include "dns/nm-dns-manager.h"
 #include "nm-connectivity.h"
 #include "nm-firewall-utils.h"
+#include "settings/nm-settings-utils.h"
 
 #include "nm-test-utils-core.h"
 
@@ -2751,6 +2752,131 @@ test_nm_firewall_nft_stdio_mlag(void)
 
 /*****************************************************************************/
 
+static NMConnection *
+_create_connection_indexed(const char *type, const char *iface, const char *mac)
+{
+    NMConnection        *c;
+    NMSettingConnection *s_con;
+
+    c = nmtst_create_minimal_connection("indexed", NULL, type, &s_con);
+    g_object_set(s_con, NM_SETTING_CONNECTION_INTERFACE_NAME, iface, NULL);
+    if (mac) {
+        g_object_set(nm_connection_get_setting_wired(c),
+                     NM_SETTING_WIRED_MAC_ADDRESS,
+                     mac,
+                     NULL);
+    }
+    return c;
+}
+
+static gboolean
+_candidates_contain(GPtrArray *candidates, NMConnection *c)
+{
+    return g_ptr_array_find(candidates, c, NULL);
+}
+
+static void
+test_sett_util_conn_index(void)
+{
+    nm_auto(nm_sett_util_conn_index_free) NMSettUtilConnIndex *idx = NULL;
+    gs_unref_object NMConnection *c_any    = NULL;
+    gs_unref_object NMConnection *c_eth0   = NULL;
+    gs_unref_object NMConnection *c_eth1   = NULL;
+    gs_unref_object NMConnection *c_mac1   = NULL;
+    gs_unref_object NMConnection *c_mac2   = NULL;
+    gs_unref_object NMConnection *c_mac3   = NULL;
+    gs_unref_object NMConnection *c_bridge = NULL;
+    gs_unref_object NMConnection *c_copy   = NULL;
+    gs_unref_ptrarray GPtrArray  *candidates = NULL;
+    gpointer const               *by_type;
+    guint                         len;
+
+    c_any    = _create_connection_indexed(NM_SETTING_WIRED_SETTING_NAME, NULL, NULL);
+    c_eth0   = _create_connection_indexed(NM_SETTING_WIRED_SETTING_NAME, "eth0", NULL);
+    c_eth1   = _create_connection_indexed(NM_SETTING_WIRED_SETTING_NAME, "eth1", NULL);
+    c_mac1   = _create_connection_indexed(NM_SETTING_WIRED_SETTING_NAME, NULL, "00:11:22:33:44:aa");
+    c_mac2   = _create_connection_indexed(NM_SETTING_WIRED_SETTING_NAME, NULL, "00:11:22:33:44:66");
+    c_mac3   = _create_connection_indexed(NM_SETTING_WIRED_SETTING_NAME, NULL, "00:11:22:33:44:77");
+    c_bridge = _create_connection_indexed(NM_SETTING_BRIDGE_SETTING_NAME, "eth0", NULL);
+
+    idx = nm_sett_util_conn_index_new();
+    nm_sett_util_conn_index_add(idx, c_any, c_any);
+    nm_sett_util_conn_index_add(idx, c_eth0, c_eth0);
+    nm_sett_util_conn_index_add(idx, c_eth1, c_eth1);
+    nm_sett_util_conn_index_add(idx, c_mac1, c_mac1);
+    nm_sett_util_conn_index_add(idx, c_mac2, c_mac2);
+    nm_sett_util_conn_index_add(idx, c_mac3, c_mac3);
+    nm_sett_util_conn_index_add(idx, c_bridge, c_bridge);
+
+    by_type = nm_sett_util_conn_index_get_by_type(idx, NM_SETTING_WIRED_SETTING_NAME, &len);
+    g_assert_cmpint(len, ==, 6);
+    g_assert(!by_type[6]);
+    by_type = nm_sett_util_conn_index_get_by_type(idx, NM_SETTING_VLAN_SETTING_NAME, &len);
+    g_assert_cmpint(len, ==, 0);
+    g_assert(!by_type[0]);
+
+    /* Filtered by interface name. Profiles bound to other interfaces and
+     * profiles of other types are skipped. */
+    candidates = g_ptr_array_new();
+    nm_sett_util_conn_index_get_candidates(idx,
+                                           NM_SETTING_WIRED_SETTING_NAME,
+                                           "eth0",
+                                           NULL,
+                                           candidates);
+    g_assert_cmpint(candidates->len, ==, 5);
+    g_assert(_candidates_contain(candidates, c_any));
+    g_assert(_candidates_contain(candidates, c_eth0));
+    g_assert(_candidates_contain(candidates, c_mac1));
+    g_assert(_candidates_contain(candidates, c_mac2));
+    g_assert(_candidates_contain(candidates, c_mac3));
+    g_assert(!_candidates_contain(candidates, c_eth1));
+    g_assert(!_candidates_contain(candidates, c_bridge));
+
+    /* The MAC address bucket is more selective here. The address is
+     * compared in canonical form. */
+    g_ptr_array_set_size(candidates, 0);
+    nm_sett_util_conn_index_get_candidates(idx,
+                                           NM_SETTING_WIRED_SETTING_NAME,
+                                           "eth0",
+                                           "00:11:22:33:44:AA",
+                                           candidates);
+    g_assert_cmpint(candidates->len, ==, 4);
+    g_assert(_candidates_contain(candidates, c_mac1));
+    g_assert(!_candidates_contain(candidates, c_mac2));
+    g_assert(!_candidates_contain(candidates, c_mac3));
+
+    /* A device without interface name only gets the unbound profiles. */
+    g_ptr_array_set_size(candidates, 0);
+    nm_sett_util_conn_index_get_candidates(idx,
+                                           NM_SETTING_WIRED_SETTING_NAME,
+                                           NULL,
+                                           NULL,
+                                           candidates);
+    g_assert_cmpint(candidates->len, ==, 4);
+    g_assert(!_candidates_contain(candidates, c_eth0));
+    g_assert(!_candidates_contain(candidates, c_eth1));
+
+    g_ptr_array_set_size(candidates, 0);
+    nm_sett_util_conn_index_get_candidates(idx,
+                                           NM_SETTING_BRIDGE_SETTING_NAME,
+                                           "eth1",
+                                           NULL,
+                                           candidates);
+    g_assert_cmpint(candidates->len, ==, 0);
+
+    c_copy = nm_simple_connection_new_clone(c_mac1);
+    g_assert(nm_sett_util_conn_index_keys_equal(c_mac1, c_copy));
+    g_object_set(nm_connection_get_setting_wired(c_copy),
+                 NM_SETTING_WIRED_MAC_ADDRESS,
+                 "00:11:22:33:44:66",
+                 NULL);
+    g_assert(!nm_sett_util_conn_index_keys_equal(c_mac1, c_copy));
+    g_assert(!nm_sett_util_conn_index_keys_equal(c_eth0, c_eth1));
+    g_assert(!nm_sett_util_conn_index_keys_equal(c_eth0, c_bridge));
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -2826,6 +2952,7 @@ main(int argc, char **argv)
                     test_kernel_cmdline_match_check);
 
     g_test_add_func("/core/test_nm_firewall_nft_stdio_mlag", test_nm_firewall_nft_stdio_mlag);
+    g_test_add_func("/core/settings/conn-index", test_sett_util_conn_index);
 
     return g_test_run();
 }
@@ -8,6 +8,8 @@
 #include <arpa/inet.h>
 #include <linux/if_ether.h>
 
+#include "nm-dbus-object.h"
+
 #include "nm-test-utils-core.h"
 
 static void
@@ -262,6 +264,135 @@ test_shorten_hostname(void)
 
 /*****************************************************************************/
 
+static void
+test_stats_refresh(void)
+{
+    /* ticks are aligned to multiples of the refresh rate... */
+    g_assert_cmpint(nm_utils_stats_next_refresh_msec(0, 1000), ==, 1000);
+    g_assert_cmpint(nm_utils_stats_next_refresh_msec(999, 1000), ==, 1000);
+    g_assert_cmpint(nm_utils_stats_next_refresh_msec(1000, 1000), ==, 2000);
+    g_assert_cmpint(nm_utils_stats_next_refresh_msec(123456, 500), ==, 123500);
+
+    /* ... so devices with the same rate are due together, however far apart
+     * they subscribed. And a device with a multiple of that rate joins them. */
+    g_assert_cmpint(nm_utils_stats_next_refresh_msec(10001, 2000),
+                    ==,
+                    nm_utils_stats_next_refresh_msec(11999, 2000));
+    g_assert_cmpint(nm_utils_stats_next_refresh_msec(10001, 4000),
+                    ==,
+                    nm_utils_stats_next_refresh_msec(11999, 2000));
+
+    /* a single link is never dumped. */
+    g_assert(!nm_utils_stats_refresh_use_dump(0, 0));
+    g_assert(!nm_utils_stats_refresh_use_dump(1, 1));
+    g_assert(!nm_utils_stats_refresh_use_dump(1, 100));
+
+    /* dump when at least a quarter of the cached links is due. */
+    g_assert(nm_utils_stats_refresh_use_dump(2, 2));
+    g_assert(nm_utils_stats_refresh_use_dump(2, 8));
+    g_assert(!nm_utils_stats_refresh_use_dump(2, 9));
+    g_assert(!nm_utils_stats_refresh_use_dump(4, 1000));
+    g_assert(nm_utils_stats_refresh_use_dump(250, 1000));
+    g_assert(!nm_utils_stats_refresh_use_dump(249, 1000));
+}
+
+/*****************************************************************************/
+
+static void
+test_call_queue(void)
+{
+    NMUtilsCallQueue queue;
+    CList            calls[5];
+    guint            i;
+
+    nm_utils_call_queue_init(&queue);
+    g_assert(nm_utils_call_queue_is_idle(&queue));
+
+    for (i = 0; i < G_N_ELEMENTS(calls); i++) {
+        c_list_init(&calls[i]);
+        nm_utils_call_queue_push(&queue, &calls[i]);
+    }
+    g_assert(!nm_utils_call_queue_is_idle(&queue));
+
+    /* the first two calls get started, in order. */
+    g_assert(nm_utils_call_queue_pop(&queue, 2) == &calls[0]);
+    g_assert(nm_utils_call_queue_pop(&queue, 2) == &calls[1]);
+    g_assert(!nm_utils_call_queue_pop(&queue, 2));
+    g_assert_cmpint(queue.n_in_flight, ==, 2);
+    g_assert(c_list_is_empty(&calls[0]));
+    g_assert(c_list_is_empty(&calls[1]));
+
+    /* cancelling a queued call does not free a slot... */
+    c_list_unlink(&calls[2]);
+    g_assert_cmpint(queue.n_in_flight, ==, 2);
+    g_assert(!nm_utils_call_queue_pop(&queue, 2));
+
+    /* ... but completing (or cancelling) one in flight does. The cancelled
+     * call is skipped. */
+    nm_utils_call_queue_complete(&queue);
+    g_assert_cmpint(queue.n_in_flight, ==, 1);
+    g_assert(nm_utils_call_queue_pop(&queue, 2) == &calls[3]);
+    g_assert(!nm_utils_call_queue_pop(&queue, 2));
+
+    /* a higher limit starts the rest right away. */
+    g_assert(nm_utils_call_queue_pop(&queue, 3) == &calls[4]);
+    g_assert(!nm_utils_call_queue_pop(&queue, 3));
+    g_assert_cmpint(queue.n_in_flight, ==, 3);
+
+    for (i = 0; i < 3; i++) {
+        g_assert(!nm_utils_call_queue_is_idle(&queue));
+        nm_utils_call_queue_complete(&queue);
+    }
+    g_assert(nm_utils_call_queue_is_idle(&queue));
+}
+
+/*****************************************************************************/
+
+static void
+test_notify_throttle(void)
+{
+    NMDBusNotifyThrottle throttle = {};
+    const guint          limit    = 1000;
+
+    /* nothing is pending. */
+    g_assert_cmpint(nm_dbus_notify_throttle_get_due_msec(&throttle, limit), ==, G_MAXINT64);
+    g_assert(!nm_dbus_notify_throttle_expire(&throttle, limit, 5000));
+
+    /* the first change passes. */
+    g_assert(nm_dbus_notify_throttle_check(&throttle, limit, 5000));
+    g_assert(!throttle.pending);
+
+    /* changes within the interval are coalesced into one pending notification. */
+    g_assert(!nm_dbus_notify_throttle_check(&throttle, limit, 5100));
+    g_assert(throttle.pending);
+    g_assert_cmpint(nm_dbus_notify_throttle_get_due_msec(&throttle, limit), ==, 6000);
+    g_assert(!nm_dbus_notify_throttle_check(&throttle, limit, 5500));
+    g_assert(!nm_dbus_notify_throttle_check(&throttle, limit, 7000));
+    g_assert_cmpint(nm_dbus_notify_throttle_get_due_msec(&throttle, limit), ==, 6000);
+
+    /* the trailing notification is not due before the interval expires... */
+    g_assert(!nm_dbus_notify_throttle_expire(&throttle, limit, 5999));
+    g_assert(throttle.pending);
+
+    /* ... then it is, exactly once, and its notification passes. */
+    g_assert(nm_dbus_notify_throttle_expire(&throttle, limit, 6000));
+    g_assert(!throttle.pending);
+    g_assert(!nm_dbus_notify_throttle_expire(&throttle, limit, 6000));
+    g_assert(nm_dbus_notify_throttle_check(&throttle, limit, 6000));
+
+    /* that notification starts a new interval. */
+    g_assert(!nm_dbus_notify_throttle_check(&throttle, limit, 6999));
+    g_assert_cmpint(nm_dbus_notify_throttle_get_due_msec(&throttle, limit), ==, 7000);
+    g_assert(nm_dbus_notify_throttle_expire(&throttle, limit, 7200));
+    g_assert(nm_dbus_notify_throttle_check(&throttle, limit, 7200));
+
+    /* a change after the interval passes right away. */
+    g_assert(nm_dbus_notify_throttle_check(&throttle, limit, 8200));
+    g_assert(!throttle.pending);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -272,6 +403,9 @@ main(int argc, char **argv)
     g_test_add_func("/utils/stable_privacy", test_stable_privacy);
     g_test_add_func("/utils/hw_addr_gen_stable_eth", test_hw_addr_gen_stable_eth);
     g_test_add_func("/utils/shorten-hostname", test_shorten_hostname);
+    g_test_add_func("/utils/stats-refresh", test_stats_refresh);
+    g_test_add_func("/utils/call-queue", test_call_queue);
+    g_test_add_func("/utils/dbus-notify-throttle", test_notify_throttle);
 
     return g_test_run();
 }
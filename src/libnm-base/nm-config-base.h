@@ -25,8 +25,13 @@
 #define NM_CONFIG_KEYFILE_KEY_MAIN_CONFIGURE_AND_QUIT          "configure-and-quit"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DEBUG                       "debug"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DHCP                        "dhcp"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_SHARED_SOCKET          "dhcp-shared-socket"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_BURST            "dhcp-start-burst"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_JITTER           "dhcp-start-jitter"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_DHCP_START_RATE             "dhcp-start-rate"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_DNS                         "dns"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_FIREWALL_BACKEND            "firewall-backend"
+#define NM_CONFIG_KEYFILE_KEY_MAIN_FIREWALLD_MAX_REQUESTS      "firewalld-max-requests"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_HOSTNAME_MODE               "hostname-mode"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_IGNORE_CARRIER              "ignore-carrier"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_IWD_CONFIG_PATH             "iwd-config-path"
@@ -37,10 +42,13 @@
 #define NM_CONFIG_KEYFILE_KEY_MAIN_RC_MANAGER                  "rc-manager"
 #define NM_CONFIG_KEYFILE_KEY_MAIN_SYSTEMD_RESOLVED            "systemd-resolved"
 
-#define NM_CONFIG_KEYFILE_KEY_LOGGING_AUDIT   "audit"
-#define NM_CONFIG_KEYFILE_KEY_LOGGING_BACKEND "backend"
-#define NM_CONFIG_KEYFILE_KEY_LOGGING_DOMAINS "domains"
-#define NM_CONFIG_KEYFILE_KEY_LOGGING_LEVEL   "level"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_AUDIT            "audit"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_BACKEND          "backend"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_DOMAINS          "domains"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_LEVEL            "level"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_RECORDER_DOMAINS "recorder-domains"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_RECORDER_LEVEL   "recorder-level"
+#define NM_CONFIG_KEYFILE_KEY_LOGGING_RECORDER_SIZE    "recorder-size"
 
 #define NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_ENABLED  "enabled"
 #define NM_CONFIG_KEYFILE_KEY_CONNECTIVITY_INTERVAL "interval"
@@ -72,6 +80,9 @@
     "wifi.scan-generate-mac-address-mask"
 #define NM_CONFIG_KEYFILE_KEY_DEVICE_CARRIER_WAIT_TIMEOUT "carrier-wait-timeout"
 #define NM_CONFIG_KEYFILE_KEY_DEVICE_WIFI_IWD_AUTOCONNECT "wifi.iwd.autoconnect"
+#define NM_CONFIG_KEYFILE_KEY_DEVICE_WIFI_ACCESS_POINTS_CHANGED_SIGNAL \
+    "wifi.access-points-changed-signal"
+#define NM_CONFIG_KEYFILE_KEY_DEVICE_SHARING_DHCP_SERVER  "sharing.dhcp-server"
 
 #define NM_CONFIG_KEYFILE_KEY_MATCH_DEVICE "match-device"
 #define NM_CONFIG_KEYFILE_KEY_STOP_MATCH   "stop-match"
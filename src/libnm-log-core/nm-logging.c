@@ -24,6 +24,7 @@
 
 #include "libnm-glib-aux/nm-logging-base.h"
 #include "libnm-glib-aux/nm-time-utils.h"
+#include "libnm-glib-aux/nm-io-utils.h"
 #include "libnm-glib-aux/nm-str-buf.h"
 
 /*****************************************************************************/
@@ -78,6 +79,7 @@ typedef enum {
     LOG_BACKEND_GLIB,
     LOG_BACKEND_SYSLOG,
     LOG_BACKEND_JOURNAL,
+    LOG_BACKEND_JOURNAL_BUFFERED,
 } LogBackend;
 
 typedef struct {
@@ -110,6 +112,10 @@ typedef struct {
 
 G_LOCK_DEFINE_STATIC(log);
 
+/* Set while the "journal-buffered" backend is active. Then, the other threads
+ * don't take G_LOCK(log) either, see _nm_log_impl(). */
+static int _log_mt_lockfree;
+
 /* This data must only be accessed from the main-thread (and as
  * such does not need any lock). */
 static GlobalMain gl_main = {};
@@ -141,6 +147,32 @@ NMLogDomain _nm_logging_enabled_state[_LOGL_N_REAL] = {
     [LOGL_ERR]  = LOGD_DEFAULT,
 };
 
+/* The domains that actually get sent to the logging backend. Without flight
+ * recorder, this is identical to _nm_logging_enabled_state. Otherwise,
+ * _nm_logging_enabled_state is the union of this and gl_recorder.state.
+ * Protected by G_LOCK(log), like _nm_logging_enabled_state. */
+static NMLogDomain _log_emit_state[_LOGL_N_REAL] = {
+    [LOGL_INFO] = LOGD_DEFAULT,
+    [LOGL_WARN] = LOGD_DEFAULT,
+    [LOGL_ERR]  = LOGD_DEFAULT,
+};
+
+/* The flight recorder keeps the most recent log lines in memory (in a
+ * ring buffer), so that verbose logging can be collected without
+ * flooding the logging backend. It gets dumped on request. */
+static struct {
+    /* The domains to record. Protected by G_LOCK(log). */
+    NMLogDomain state[_LOGL_N_REAL];
+
+    /* Protects the fields below. */
+    GMutex mutex;
+
+    char   *buf;
+    gsize   size;
+    guint64 n_written;
+    guint64 n_lines;
+} gl_recorder;
+
 /*****************************************************************************/
 
 static const LogDesc domain_desc[] = {
@@ -253,47 +285,18 @@ match_log_level(const char *level, NMLogLevel *out_level, GError **error)
     return FALSE;
 }
 
-gboolean
-nm_logging_setup(const char *level, const char *domains, char **bad_domains, GError **error)
+static gboolean
+_log_state_parse(const char        *domains,
+                 NMLogLevel         new_log_level,
+                 gboolean           protect_all,
+                 const NMLogDomain  cur_log_state[static _LOGL_N_REAL],
+                 NMLogDomain        new_log_state[static _LOGL_N_REAL],
+                 GString          **unrecognized,
+                 GError           **error)
 {
-    GString             *unrecognized = NULL;
-    NMLogDomain          cur_log_state[_LOGL_N_REAL];
-    NMLogDomain          new_log_state[_LOGL_N_REAL];
-    NMLogLevel           cur_log_level;
-    NMLogLevel           new_log_level;
     gs_free const char **domains_v = NULL;
     gsize                i_d;
     int                  i;
-    gboolean             had_platform_debug;
-    gs_free char        *domains_free = NULL;
-
-    NM_ASSERT_ON_MAIN_THREAD();
-
-    g_return_val_if_fail(!bad_domains || !*bad_domains, FALSE);
-    g_return_val_if_fail(!error || !*error, FALSE);
-
-    cur_log_level = gl.imm.log_level;
-    memcpy(cur_log_state, _nm_logging_enabled_state, sizeof(cur_log_state));
-
-    new_log_level = cur_log_level;
-
-    if (!domains || !*domains) {
-        domains_free = _domains_to_string(FALSE, cur_log_level, cur_log_state);
-        domains      = domains_free;
-    }
-
-    for (i = 0; i < G_N_ELEMENTS(new_log_state); i++)
-        new_log_state[i] = 0;
-
-    if (level && *level) {
-        if (!match_log_level(level, &new_log_level, error))
-            return FALSE;
-        if (new_log_level == _LOGL_KEEP) {
-            new_log_level = cur_log_level;
-            for (i = 0; i < G_N_ELEMENTS(new_log_state); i++)
-                new_log_state[i] = cur_log_state[i];
-        }
-    }
 
     domains_v = nm_strsplit_set(domains, ", ");
     for (i_d = 0; domains_v && domains_v[i_d]; i_d++) {
@@ -318,7 +321,7 @@ nm_logging_setup(const char *level, const char *domains, char **bad_domains, GEr
 
         bits = 0;
 
-        if (domains_free) {
+        if (protect_all) {
             /* The caller didn't provide any domains to set (`nmcli general logging level DEBUG`).
              * We reset all domains that were previously set, but we still want to protect
              * VPN_PLUGIN domain. */
@@ -352,7 +355,7 @@ nm_logging_setup(const char *level, const char *domains, char **bad_domains, GEr
             }
 
             if (!bits) {
-                if (!bad_domains) {
+                if (!unrecognized) {
                     g_set_error(error,
                                 _NM_MANAGER_ERROR,
                                 _NM_MANAGER_ERROR_UNKNOWN_LOG_DOMAIN,
@@ -361,20 +364,20 @@ nm_logging_setup(const char *level, const char *domains, char **bad_domains, GEr
                     return FALSE;
                 }
 
-                if (unrecognized)
-                    g_string_append(unrecognized, ", ");
+                if (*unrecognized)
+                    g_string_append(*unrecognized, ", ");
                 else
-                    unrecognized = g_string_new(NULL);
-                g_string_append(unrecognized, s);
+                    *unrecognized = g_string_new(NULL);
+                g_string_append(*unrecognized, s);
                 continue;
             }
         }
 
         if (domain_log_level == _LOGL_KEEP) {
-            for (i = 0; i < G_N_ELEMENTS(new_log_state); i++)
+            for (i = 0; i < _LOGL_N_REAL; i++)
                 new_log_state[i] = (new_log_state[i] & ~bits) | (cur_log_state[i] & bits);
         } else {
-            for (i = 0; i < G_N_ELEMENTS(new_log_state); i++) {
+            for (i = 0; i < _LOGL_N_REAL; i++) {
                 if (i < domain_log_level)
                     new_log_state[i] &= ~bits;
                 else {
@@ -386,15 +389,32 @@ nm_logging_setup(const char *level, const char *domains, char **bad_domains, GEr
         }
     }
 
+    return TRUE;
+}
+
+static void
+_log_state_commit(const NMLogLevel *new_log_level,
+                  const NMLogDomain new_emit_state[static _LOGL_N_REAL],
+                  const NMLogDomain new_recorder_state[static _LOGL_N_REAL])
+{
+    gboolean had_platform_debug;
+    int      i;
+
     nm_clear_g_free(&gl_main.logging_domains_to_string);
 
     had_platform_debug = _nm_logging_enabled_lockfree(LOGL_DEBUG, LOGD_PLATFORM);
 
     G_LOCK(log);
 
-    gl.mut.log_level = new_log_level;
-    for (i = 0; i < G_N_ELEMENTS(new_log_state); i++)
-        _nm_logging_enabled_state[i] = new_log_state[i];
+    if (new_log_level)
+        gl.mut.log_level = *new_log_level;
+    for (i = 0; i < _LOGL_N_REAL; i++) {
+        if (new_emit_state)
+            _log_emit_state[i] = new_emit_state[i];
+        if (new_recorder_state)
+            gl_recorder.state[i] = new_recorder_state[i];
+        _nm_logging_enabled_state[i] = _log_emit_state[i] | gl_recorder.state[i];
+    }
 
     G_UNLOCK(log);
 
@@ -407,6 +427,60 @@ nm_logging_setup(const char *level, const char *domains, char **bad_domains, GEr
          * otherwise we might deadlock. */
         _nm_logging_clear_platform_logging_cache();
     }
+}
+
+gboolean
+nm_logging_setup(const char *level, const char *domains, char **bad_domains, GError **error)
+{
+    GString      *unrecognized = NULL;
+    NMLogDomain   cur_log_state[_LOGL_N_REAL];
+    NMLogDomain   new_log_state[_LOGL_N_REAL];
+    NMLogLevel    cur_log_level;
+    NMLogLevel    new_log_level;
+    int           i;
+    gs_free char *domains_free = NULL;
+
+    NM_ASSERT_ON_MAIN_THREAD();
+
+    g_return_val_if_fail(!bad_domains || !*bad_domains, FALSE);
+    g_return_val_if_fail(!error || !*error, FALSE);
+
+    cur_log_level = gl.imm.log_level;
+    memcpy(cur_log_state, _log_emit_state, sizeof(cur_log_state));
+
+    new_log_level = cur_log_level;
+
+    if (!domains || !*domains) {
+        domains_free = _domains_to_string(FALSE, cur_log_level, cur_log_state);
+        domains      = domains_free;
+    }
+
+    for (i = 0; i < G_N_ELEMENTS(new_log_state); i++)
+        new_log_state[i] = 0;
+
+    if (level && *level) {
+        if (!match_log_level(level, &new_log_level, error))
+            return FALSE;
+        if (new_log_level == _LOGL_KEEP) {
+            new_log_level = cur_log_level;
+            for (i = 0; i < G_N_ELEMENTS(new_log_state); i++)
+                new_log_state[i] = cur_log_state[i];
+        }
+    }
+
+    if (!_log_state_parse(domains,
+                          new_log_level,
+                          !!domains_free,
+                          cur_log_state,
+                          new_log_state,
+                          bad_domains ? &unrecognized : NULL,
+                          error)) {
+        if (unrecognized)
+            g_string_free(unrecognized, TRUE);
+        return FALSE;
+    }
+
+    _log_state_commit(&new_log_level, new_log_state, NULL);
 
     if (unrecognized)
         *bad_domains = g_string_free(unrecognized, FALSE);
@@ -448,7 +522,7 @@ nm_logging_domains_to_string(void)
 
     if (G_UNLIKELY(!gl_main.logging_domains_to_string)) {
         gl_main.logging_domains_to_string =
-            _domains_to_string(TRUE, gl.imm.log_level, _nm_logging_enabled_state);
+            _domains_to_string(TRUE, gl.imm.log_level, _log_emit_state);
     }
 
     return gl_main.logging_domains_to_string;
@@ -573,6 +647,9 @@ _nm_logging_enabled_locking(NMLogLevel level, NMLogDomain domain)
 {
     gboolean v;
 
+    if (g_atomic_int_get(&_log_mt_lockfree))
+        return _nm_logging_enabled_lockfree(level, domain);
+
     G_LOCK(log);
     v = _nm_logging_enabled_lockfree(level, domain);
     G_UNLOCK(log);
@@ -648,6 +725,633 @@ _nm_printf(3, 4) static void _iovec_set_format(struct iovec *iov,
 
 #endif
 
+/* We always print the level and the timestamp.
+ *
+ * Timestamps are very useful for understanding logfiles. While journalctl
+ * might record the timestamp, it is not present in plain `journalctl` output.
+ * Users who report a bug would simply send us the `journalctl` output and
+ * requesting an output with timestamps (even if it's stored somewhere inside
+ * journald) is not workable.
+ *
+ * We print the level, because this too, it's to quickly identify the severity
+ * of a message.
+ *
+ * We also do this for all messages (for all levels), because then the logging
+ * lines are formatted and aligned in a consistent way, which aids reading the
+ * logs. */
+#define MESSAGE_FMT "%s%-7s [%" G_GINT64_FORMAT ".%04d] %s"
+#define MESSAGE_ARG(prefix, tv, msg)                                            \
+    prefix, nm_log_level_desc[level].level_str, ((tv) / NM_UTILS_USEC_PER_SEC), \
+        ((int) ((((tv) % NM_UTILS_USEC_PER_SEC)) / ((gint64) 100))), (msg)
+
+#if SYSTEMD_JOURNAL
+static int (*_log_journal_sendv)(const struct iovec *iov, int n) = sd_journal_sendv;
+#endif
+
+void
+_nm_logging_set_journal_sendv(int (*journal_sendv)(const struct iovec *iov, int n))
+{
+#if SYSTEMD_JOURNAL
+    _log_journal_sendv = journal_sendv ?: sd_journal_sendv;
+#endif
+}
+
+#if SYSTEMD_JOURNAL
+static void
+_log_journal_send(const Global *g,
+                  const char   *file,
+                  guint         line,
+                  const char   *func,
+                  NMLogLevel    level,
+                  NMLogDomain   domain,
+                  int           error,
+                  const char   *ifname,
+                  const char   *conn_uuid,
+                  const char   *msg,
+                  gint64        tv,
+                  gint64        now)
+{
+    gint64         boottime;
+    struct iovec   iov_data[15];
+    struct iovec  *iov = iov_data;
+    char          *iov_free_data[5];
+    char         **iov_free = iov_free_data;
+    const LogDesc *diter;
+    NMLogDomain    dom_all;
+    char  s_log_domains_buf[NM_STRLEN("NM_LOG_DOMAINS=") + sizeof(_all_logging_domains_to_str)];
+    char *s_log_domains;
+    gsize l_log_domains;
+
+    boottime = nm_utils_monotonic_timestamp_as_boottime(now, 1);
+
+    _iovec_set_format_a(iov++, 30, "PRIORITY=%d", nm_log_level_desc[level].syslog_level);
+    _iovec_set_format(iov++, iov_free++, "MESSAGE=" MESSAGE_FMT, MESSAGE_ARG(g->prefix, tv, msg));
+    _iovec_set_string(iov++, syslog_identifier_full(g->syslog_identifier));
+    _iovec_set_format_a(iov++, 30, "SYSLOG_PID=%ld", (long) getpid());
+
+    dom_all       = domain;
+    s_log_domains = s_log_domains_buf;
+    l_log_domains = sizeof(s_log_domains_buf);
+
+    nm_strbuf_append_str(&s_log_domains, &l_log_domains, "NM_LOG_DOMAINS=");
+    for (diter = &domain_desc[0]; dom_all != 0 && diter->name; diter++) {
+        if (!NM_FLAGS_ANY(dom_all, diter->num))
+            continue;
+        if (dom_all != domain)
+            nm_strbuf_append_c(&s_log_domains, &l_log_domains, ',');
+        nm_strbuf_append_str(&s_log_domains, &l_log_domains, diter->name);
+        dom_all &= ~diter->num;
+    }
+    nm_assert(l_log_domains > 0);
+    _iovec_set(iov++, s_log_domains_buf, s_log_domains - s_log_domains_buf);
+
+    G_STATIC_ASSERT_EXPR(LOG_FAC(LOG_DAEMON) == 3);
+    _iovec_set_string_literal(iov++, "SYSLOG_FACILITY=3");
+    _iovec_set_format_str_a(iov++, 15, "NM_LOG_LEVEL=%s", nm_log_level_desc[level].name);
+    if (func)
+        _iovec_set_format(iov++, iov_free++, "CODE_FUNC=%s", func);
+    _iovec_set_format(iov++, iov_free++, "CODE_FILE=%s", file ?: "");
+    _iovec_set_format_a(iov++, 20, "CODE_LINE=%u", line);
+    _iovec_set_format_a(iov++,
+                        60,
+                        "TIMESTAMP_MONOTONIC=%lld.%06lld",
+                        (long long) (now / NM_UTILS_NSEC_PER_SEC),
+                        (long long) ((now % NM_UTILS_NSEC_PER_SEC) / 1000));
+    _iovec_set_format_a(iov++,
+                        60,
+                        "TIMESTAMP_BOOTTIME=%lld.%06lld",
+                        (long long) (boottime / NM_UTILS_NSEC_PER_SEC),
+                        (long long) ((boottime % NM_UTILS_NSEC_PER_SEC) / 1000));
+    if (error != 0)
+        _iovec_set_format_a(iov++, 30, "ERRNO=%d", error);
+    if (ifname)
+        _iovec_set_format(iov++, iov_free++, "NM_DEVICE=%s", ifname);
+    if (conn_uuid)
+        _iovec_set_format(iov++, iov_free++, "NM_CONNECTION=%s", conn_uuid);
+
+    nm_assert(iov <= &iov_data[G_N_ELEMENTS(iov_data)]);
+    nm_assert(iov_free <= &iov_free_data[G_N_ELEMENTS(iov_free_data)]);
+
+    _log_journal_sendv(iov_data, iov - iov_data);
+
+    for (; --iov_free >= iov_free_data;)
+        g_free(*iov_free);
+}
+
+/*****************************************************************************/
+
+/* With the "journal-buffered" backend, the logging thread only formats the
+ * message into a ring buffer. A dedicated writer thread drains the rings in
+ * batches and sends the messages to journald.
+ *
+ * Each logging thread has its own ring. A ring has exactly one producer
+ * (the thread that owns it) and one consumer (the writer thread), so it
+ * is lock-free and only uses atomic operations on @head and @tail.
+ * When a ring is full, the message is dropped and counted. The writer
+ * reports the number of dropped messages. */
+
+#define LOG_RING_SIZE       1024u
+#define LOG_RING_MSG_SIZE   256u
+#define LOG_RING_FLUSH_MSEC 100
+#define LOG_RING_WAKEUP_LEN (LOG_RING_SIZE / 2u)
+
+typedef struct {
+    const char *file;
+    const char *func;
+    const char *msg;
+    const char *ifname;
+    const char *conn_uuid;
+    char       *msg_heap;
+    char       *ifname_heap;
+    char       *conn_uuid_heap;
+    gint64      tv;
+    gint64      now;
+    NMLogDomain domain;
+    guint       line;
+    int         error;
+    NMLogLevel  level;
+    char        msg_buf[LOG_RING_MSG_SIZE];
+    char        ifname_buf[32];
+    char        conn_uuid_buf[40];
+} LogRingEntry;
+
+typedef struct _LogRing {
+    struct _LogRing *next;
+
+    /* @head is only written by the producer, @tail only by the writer thread. */
+    int head;
+    int tail;
+
+    guint n_dropped;
+    int   orphaned;
+
+    LogRingEntry entries[LOG_RING_SIZE];
+} LogRing;
+
+static void _log_ring_orphan(gpointer data);
+
+static GPrivate log_ring_private = G_PRIVATE_INIT(_log_ring_orphan);
+
+static struct {
+    GThread *thread;
+    GMutex   mutex;
+    GCond    cond;
+
+    /* Protected by @mutex. New rings are only prepended, and only the writer
+     * thread removes (orphaned) rings. Hence, the writer thread can follow the
+     * @next pointers without lock, but it must unlink rings under the lock. */
+    LogRing *rings;
+    bool     wakeup;
+    bool     quit;
+
+    /* Only accessed by the writer thread. */
+    guint64 n_dropped_total;
+} gl_buffered;
+
+static void
+_log_ring_orphan(gpointer data)
+{
+    LogRing *ring = data;
+
+    /* The thread exits. The writer thread frees the ring after draining it. */
+    g_atomic_int_set(&ring->orphaned, TRUE);
+}
+
+static const char *
+_log_ring_entry_set_str(char *buf, gsize buf_len, char **str_heap, const char *str)
+{
+    gsize l;
+
+    if (!str)
+        return NULL;
+
+    l = strlen(str) + 1u;
+    if (l > buf_len) {
+        *str_heap = g_strdup(str);
+        return *str_heap;
+    }
+    memcpy(buf, str, l);
+    return buf;
+}
+
+static void
+_log_ring_wakeup(void)
+{
+    g_mutex_lock(&gl_buffered.mutex);
+    gl_buffered.wakeup = TRUE;
+    g_cond_signal(&gl_buffered.cond);
+    g_mutex_unlock(&gl_buffered.mutex);
+}
+
+static void
+_log_ring_push(const char *file,
+               guint       line,
+               const char *func,
+               NMLogLevel  level,
+               NMLogDomain domain,
+               int         error,
+               const char *ifname,
+               const char *conn_uuid,
+               const char *msg,
+               char      **msg_heap,
+               gint64      tv)
+{
+    LogRing      *ring;
+    LogRingEntry *entry;
+    guint         head;
+    guint         len;
+
+    ring = g_private_get(&log_ring_private);
+    if (G_UNLIKELY(!ring)) {
+        ring = g_new0(LogRing, 1);
+        g_private_set(&log_ring_private, ring);
+
+        g_mutex_lock(&gl_buffered.mutex);
+        ring->next        = gl_buffered.rings;
+        gl_buffered.rings = ring;
+        g_mutex_unlock(&gl_buffered.mutex);
+    }
+
+    head = (guint) ring->head;
+    len  = head - (guint) g_atomic_int_get(&ring->tail);
+
+    if (len >= LOG_RING_SIZE) {
+        g_atomic_int_inc(&ring->n_dropped);
+        return;
+    }
+
+    entry = &ring->entries[head % LOG_RING_SIZE];
+
+    entry->file   = file;
+    entry->func   = func;
+    entry->tv     = tv;
+    entry->now    = nm_utils_get_monotonic_timestamp_nsec();
+    entry->domain = domain;
+    entry->line   = line;
+    entry->error  = error;
+    entry->level  = level;
+
+    if (*msg_heap) {
+        entry->msg_heap = g_steal_pointer(msg_heap);
+        entry->msg      = entry->msg_heap;
+    } else
+        entry->msg = _log_ring_entry_set_str(entry->msg_buf,
+                                             sizeof(entry->msg_buf),
+                                             &entry->msg_heap,
+                                             msg);
+    entry->ifname    = _log_ring_entry_set_str(entry->ifname_buf,
+                                               sizeof(entry->ifname_buf),
+                                               &entry->ifname_heap,
+                                               ifname);
+    entry->conn_uuid = _log_ring_entry_set_str(entry->conn_uuid_buf,
+                                               sizeof(entry->conn_uuid_buf),
+                                               &entry->conn_uuid_heap,
+                                               conn_uuid);
+
+    /* Publish the entry. */
+    g_atomic_int_set(&ring->head, (int) (head + 1u));
+
+    if (len + 1u == LOG_RING_WAKEUP_LEN || level >= LOGL_WARN)
+        _log_ring_wakeup();
+}
+
+static gboolean
+_log_ring_drain(const Global *g, LogRing *ring)
+{
+    guint tail;
+    guint head;
+    guint n_dropped;
+
+    tail = (guint) ring->tail;
+    head = (guint) g_atomic_int_get(&ring->head);
+
+    for (; tail != head; tail++) {
+        LogRingEntry *entry = &ring->entries[tail % LOG_RING_SIZE];
+
+        _log_journal_send(g,
+                          entry->file,
+                          entry->line,
+                          entry->func,
+                          entry->level,
+                          entry->domain,
+                          entry->error,
+                          entry->ifname,
+                          entry->conn_uuid,
+                          entry->msg,
+                          entry->tv,
+                          entry->now);
+        nm_clear_g_free(&entry->msg_heap);
+        nm_clear_g_free(&entry->ifname_heap);
+        nm_clear_g_free(&entry->conn_uuid_heap);
+    }
+
+    g_atomic_int_set(&ring->tail, (int) tail);
+
+    n_dropped = g_atomic_int_and(&ring->n_dropped, 0u);
+    if (n_dropped > 0) {
+        gs_free char *msg = NULL;
+
+        gl_buffered.n_dropped_total += n_dropped;
+        msg = g_strdup_printf("logging: dropped %u messages because the buffer is full "
+                              "(%" G_GUINT64_FORMAT " in total)",
+                              n_dropped,
+                              gl_buffered.n_dropped_total);
+        _log_journal_send(g,
+                          __FILE__,
+                          __LINE__,
+                          NULL,
+                          LOGL_WARN,
+                          LOGD_CORE,
+                          0,
+                          NULL,
+                          NULL,
+                          msg,
+                          g_get_real_time(),
+                          nm_utils_get_monotonic_timestamp_nsec());
+    }
+
+    return g_atomic_int_get(&ring->orphaned) && (guint) g_atomic_int_get(&ring->head) == tail;
+}
+
+static void
+_log_buffered_flush(void)
+{
+    LogRing **p_ring;
+    LogRing  *ring;
+    LogRing  *next;
+
+    g_mutex_lock(&gl_buffered.mutex);
+    ring = gl_buffered.rings;
+    g_mutex_unlock(&gl_buffered.mutex);
+
+    for (; ring; ring = next) {
+        next = ring->next;
+
+        if (!_log_ring_drain(&gl.imm, ring))
+            continue;
+
+        /* The thread that owned the ring is gone and the ring is empty. Other
+         * threads might have prepended new rings in the meantime, so look up
+         * the predecessor again. */
+        g_mutex_lock(&gl_buffered.mutex);
+        for (p_ring = &gl_buffered.rings; *p_ring != ring; p_ring = &(*p_ring)->next)
+            nm_assert(*p_ring);
+        *p_ring = next;
+        g_mutex_unlock(&gl_buffered.mutex);
+        g_free(ring);
+    }
+}
+
+static gpointer
+_log_buffered_thread(gpointer user_data)
+{
+    gboolean quit;
+
+    do {
+        g_mutex_lock(&gl_buffered.mutex);
+        if (!gl_buffered.wakeup && !gl_buffered.quit) {
+            g_cond_wait_until(&gl_buffered.cond,
+                              &gl_buffered.mutex,
+                              g_get_monotonic_time() + (LOG_RING_FLUSH_MSEC * 1000));
+        }
+        gl_buffered.wakeup = FALSE;
+        quit               = gl_buffered.quit;
+        g_mutex_unlock(&gl_buffered.mutex);
+
+        _log_buffered_flush();
+    } while (!quit);
+
+    return NULL;
+}
+
+static void
+_log_buffered_stop(void)
+{
+    /* Called at exit. Messages that get logged from now on, are sent
+     * synchronously again. */
+    g_atomic_int_set(&_log_mt_lockfree, FALSE);
+
+    G_LOCK(log);
+    gl.mut.log_backend = LOG_BACKEND_JOURNAL;
+    G_UNLOCK(log);
+
+    g_mutex_lock(&gl_buffered.mutex);
+    gl_buffered.quit = TRUE;
+    g_cond_signal(&gl_buffered.cond);
+    g_mutex_unlock(&gl_buffered.mutex);
+
+    g_thread_join(g_steal_pointer(&gl_buffered.thread));
+}
+
+static void
+_log_buffered_start(void)
+{
+    gl_buffered.thread = g_thread_new("nm-logging", _log_buffered_thread, NULL);
+    atexit(_log_buffered_stop);
+
+    g_atomic_int_set(&_log_mt_lockfree, TRUE);
+}
+#endif
+
+/*****************************************************************************/
+
+#define RECORDER_SIZE_MIN ((gsize) (4 * 1024))
+#define RECORDER_SIZE_MAX ((gsize) (64 * 1024 * 1024))
+
+static void
+_log_recorder_write(const char *str, gsize len)
+{
+    gsize pos;
+    gsize n;
+
+    if (len > gl_recorder.size) {
+        gl_recorder.n_written += len - gl_recorder.size;
+        str += len - gl_recorder.size;
+        len = gl_recorder.size;
+    }
+
+    while (len > 0) {
+        pos = gl_recorder.n_written % gl_recorder.size;
+        n   = NM_MIN(len, gl_recorder.size - pos);
+        memcpy(&gl_recorder.buf[pos], str, n);
+        gl_recorder.n_written += n;
+        str += n;
+        len -= n;
+    }
+}
+
+static void
+_log_recorder_append(const char *prefix, NMLogLevel level, gint64 tv, const char *msg)
+{
+    char head[100];
+    int  head_len;
+
+    head_len = g_snprintf(head, sizeof(head), MESSAGE_FMT, MESSAGE_ARG(prefix, tv, ""));
+
+    g_mutex_lock(&gl_recorder.mutex);
+    if (gl_recorder.buf) {
+        _log_recorder_write(head, NM_MIN((gsize) head_len, sizeof(head) - 1u));
+        _log_recorder_write(msg, strlen(msg));
+        _log_recorder_write("\n", 1);
+        gl_recorder.n_lines++;
+    }
+    g_mutex_unlock(&gl_recorder.mutex);
+}
+
+/**
+ * nm_logging_recorder_setup:
+ * @level: (nullable): the most verbose level to record. If %NULL or empty,
+ *   the flight recorder gets disabled and its buffer released.
+ * @domains: (nullable): the domains to record, in the same format as
+ *   for nm_logging_setup(). Defaults to "ALL".
+ * @size: the size of the ring buffer in bytes, or zero for the default.
+ * @error: the error reason.
+ *
+ * Configures the in-memory flight recorder. Recorded messages are not sent
+ * to the logging backend (unless they are also enabled via nm_logging_setup()),
+ * but kept in a ring buffer until nm_logging_recorder_dump() writes them
+ * to a file.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+nm_logging_recorder_setup(const char *level, const char *domains, gsize size, GError **error)
+{
+    NMLogDomain new_recorder_state[_LOGL_N_REAL] = {};
+    NMLogLevel  new_log_level;
+    char       *old_buf = NULL;
+
+    NM_ASSERT_ON_MAIN_THREAD();
+
+    g_return_val_if_fail(!error || !*error, FALSE);
+
+    if (level && *level) {
+        if (!match_log_level(level, &new_log_level, error))
+            return FALSE;
+        if (new_log_level == _LOGL_KEEP) {
+            g_set_error(error,
+                        _NM_MANAGER_ERROR,
+                        _NM_MANAGER_ERROR_UNKNOWN_LOG_LEVEL,
+                        _("Unknown log level '%s'"),
+                        level);
+            return FALSE;
+        }
+
+        if (!_log_state_parse((domains && *domains) ? domains : LOGD_ALL_STRING,
+                              new_log_level,
+                              FALSE,
+                              gl_recorder.state,
+                              new_recorder_state,
+                              NULL,
+                              error))
+            return FALSE;
+
+        if (size == 0)
+            size = NM_LOGGING_RECORDER_DEFAULT_SIZE;
+        size = NM_CLAMP(size, RECORDER_SIZE_MIN, RECORDER_SIZE_MAX);
+    } else
+        size = 0;
+
+    g_mutex_lock(&gl_recorder.mutex);
+    if (size != gl_recorder.size) {
+        old_buf               = g_steal_pointer(&gl_recorder.buf);
+        gl_recorder.buf       = size > 0 ? g_malloc(size) : NULL;
+        gl_recorder.size      = size;
+        gl_recorder.n_written = 0;
+        gl_recorder.n_lines   = 0;
+    }
+    g_mutex_unlock(&gl_recorder.mutex);
+
+    g_free(old_buf);
+
+    _log_state_commit(NULL, NULL, new_recorder_state);
+    return TRUE;
+}
+
+/**
+ * nm_logging_recorder_dump:
+ * @filename: the file to write.
+ * @error: the error reason.
+ *
+ * Writes the content of the flight recorder to @filename. The
+ * recorded messages are kept, so that a later dump contains them
+ * again (unless they were overwritten in the meantime).
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+nm_logging_recorder_dump(const char *filename, GError **error)
+{
+    gs_free char *contents = NULL;
+    gsize         head_len;
+    gsize         len;
+    gsize         start;
+    guint64       n_lines;
+    guint64       n_written;
+    gsize         size;
+    const char   *s;
+
+    g_return_val_if_fail(filename, FALSE);
+    g_return_val_if_fail(!error || !*error, FALSE);
+
+    g_mutex_lock(&gl_recorder.mutex);
+
+    size      = gl_recorder.size;
+    n_written = gl_recorder.n_written;
+    n_lines   = gl_recorder.n_lines;
+
+    if (!gl_recorder.buf) {
+        g_mutex_unlock(&gl_recorder.mutex);
+        g_set_error_literal(error,
+                            NM_UTILS_ERROR,
+                            NM_UTILS_ERROR_UNKNOWN,
+                            "the flight recorder is not enabled");
+        return FALSE;
+    }
+
+    contents = g_malloc(size + 200u);
+    head_len = g_snprintf(contents,
+                          200,
+                          "# NetworkManager flight recorder: %" G_GUINT64_FORMAT
+                          " lines, %" G_GUINT64_FORMAT " bytes recorded, %zu bytes buffer%s\n",
+                          n_lines,
+                          n_written,
+                          size,
+                          n_written > size ? " (oldest messages were overwritten)" : "");
+    head_len = NM_MIN(head_len, (gsize) 199u);
+
+    if (n_written <= size) {
+        len = n_written;
+        memcpy(&contents[head_len], gl_recorder.buf, len);
+    } else {
+        start = n_written % size;
+        len   = size;
+        memcpy(&contents[head_len], &gl_recorder.buf[start], size - start);
+        memcpy(&contents[head_len + (size - start)], gl_recorder.buf, start);
+    }
+
+    g_mutex_unlock(&gl_recorder.mutex);
+
+    if (n_written > size) {
+        /* the oldest line was partly overwritten. Skip it. */
+        s = memchr(&contents[head_len], '\n', len);
+        if (s) {
+            s++;
+            len -= (s - &contents[head_len]);
+            memmove(&contents[head_len], s, len);
+        } else
+            len = 0;
+    }
+
+    return nm_utils_file_set_contents(filename,
+                                      contents,
+                                      head_len + len,
+                                      0600,
+                                      NULL,
+                                      NULL,
+                                      error);
+}
+
 void
 _nm_log_impl(const char *file,
              guint       line,
@@ -666,12 +1370,12 @@ _nm_log_impl(const char *file,
     const char        *msg;
     gint64             tv;
     int                errsv;
-    const NMLogDomain *cur_log_state;
-    NMLogDomain        cur_log_state_copy[_LOGL_N_REAL];
+    gboolean           do_emit;
+    gboolean           do_record;
     Global             g_copy;
     const Global      *g;
 
-    if (G_UNLIKELY(mt_require_locking)) {
+    if (G_UNLIKELY(mt_require_locking) && !g_atomic_int_get(&_log_mt_lockfree)) {
         G_LOCK(log);
         /* we evaluate logging-enabled under lock. There is still a race that
          * we might log the message below *after* logging was disabled. That means,
@@ -680,21 +1384,26 @@ _nm_log_impl(const char *file,
             G_UNLOCK(log);
             return;
         }
-        g_copy = gl.imm;
-        memcpy(cur_log_state_copy, _nm_logging_enabled_state, sizeof(cur_log_state_copy));
+        g_copy    = gl.imm;
+        do_emit   = !!(_log_emit_state[level] & domain);
+        do_record = !!(gl_recorder.state[level] & domain);
         G_UNLOCK(log);
-        g             = &g_copy;
-        cur_log_state = cur_log_state_copy;
+        g = &g_copy;
     } else {
-        NM_ASSERT_ON_MAIN_THREAD();
+        /* Either we are on the main thread, or the buffered backend is active.
+         * In the latter case, other threads read the logging state without lock
+         * too. While the logging configuration changes, that might log or skip a
+         * message, just like the race described above. The other fields of
+         * @gl that we use don't change while the backend is active. */
+        if (!mt_require_locking)
+            NM_ASSERT_ON_MAIN_THREAD();
         if (!_nm_logging_enabled_lockfree(level, domain))
             return;
-        g             = &gl.imm;
-        cur_log_state = _nm_logging_enabled_state;
+        g         = &gl.imm;
+        do_emit   = !!(_log_emit_state[level] & domain);
+        do_record = !!(gl_recorder.state[level] & domain);
     }
 
-    (void) cur_log_state;
-
     errsv = errno;
 
     /* Make sure that %m maps to the specified error */
@@ -706,104 +1415,46 @@ _nm_log_impl(const char *file,
 
     msg = nm_vsprintf_buf_or_alloc(fmt, fmt, msg_stack, &msg_heap, NULL);
 
-    /* We always print the level and the timestamp.
-     *
-     * Timestamps are very useful for understanding logfiles. While journalctl
-     * might record the timestamp, it is not present in plain `journalctl` output.
-     * Users who report a bug would simply send us the `journalctl` output and
-     * requesting an output with timestamps (even if it's stored somewhere inside
-     * journald) is not workable.
-     *
-     * We print the level, because this too, it's to quickly identify the severity
-     * of a message.
-     *
-     * We also do this for all messages (for all levels), because then the logging
-     * lines are formatted and aligned in a consistent way, which aids reading the
-     * logs. */
-#define MESSAGE_FMT "%s%-7s [%" G_GINT64_FORMAT ".%04d] %s"
-#define MESSAGE_ARG(prefix, tv, msg)                                            \
-    prefix, nm_log_level_desc[level].level_str, ((tv) / NM_UTILS_USEC_PER_SEC), \
-        ((int) ((((tv) % NM_UTILS_USEC_PER_SEC)) / ((gint64) 100))), (msg)
-
     tv = g_get_real_time();
 
+    if (do_record)
+        _log_recorder_append(g->prefix, level, tv, msg);
+
+    if (!do_emit)
+        goto out;
+
     if (g->debug_stderr)
         g_printerr(MESSAGE_FMT "\n", MESSAGE_ARG(g->prefix, tv, msg));
 
     switch (g->log_backend) {
 #if SYSTEMD_JOURNAL
     case LOG_BACKEND_JOURNAL:
-    {
-        gint64         now, boottime;
-        struct iovec   iov_data[15];
-        struct iovec  *iov = iov_data;
-        char          *iov_free_data[5];
-        char         **iov_free = iov_free_data;
-        const LogDesc *diter;
-        NMLogDomain    dom_all;
-        char  s_log_domains_buf[NM_STRLEN("NM_LOG_DOMAINS=") + sizeof(_all_logging_domains_to_str)];
-        char *s_log_domains;
-        gsize l_log_domains;
-
-        now      = nm_utils_get_monotonic_timestamp_nsec();
-        boottime = nm_utils_monotonic_timestamp_as_boottime(now, 1);
-
-        _iovec_set_format_a(iov++, 30, "PRIORITY=%d", nm_log_level_desc[level].syslog_level);
-        _iovec_set_format(iov++,
-                          iov_free++,
-                          "MESSAGE=" MESSAGE_FMT,
-                          MESSAGE_ARG(g->prefix, tv, msg));
-        _iovec_set_string(iov++, syslog_identifier_full(g->syslog_identifier));
-        _iovec_set_format_a(iov++, 30, "SYSLOG_PID=%ld", (long) getpid());
-
-        dom_all       = domain;
-        s_log_domains = s_log_domains_buf;
-        l_log_domains = sizeof(s_log_domains_buf);
-
-        nm_strbuf_append_str(&s_log_domains, &l_log_domains, "NM_LOG_DOMAINS=");
-        for (diter = &domain_desc[0]; dom_all != 0 && diter->name; diter++) {
-            if (!NM_FLAGS_ANY(dom_all, diter->num))
-                continue;
-            if (dom_all != domain)
-                nm_strbuf_append_c(&s_log_domains, &l_log_domains, ',');
-            nm_strbuf_append_str(&s_log_domains, &l_log_domains, diter->name);
-            dom_all &= ~diter->num;
-        }
-        nm_assert(l_log_domains > 0);
-        _iovec_set(iov++, s_log_domains_buf, s_log_domains - s_log_domains_buf);
-
-        G_STATIC_ASSERT_EXPR(LOG_FAC(LOG_DAEMON) == 3);
-        _iovec_set_string_literal(iov++, "SYSLOG_FACILITY=3");
-        _iovec_set_format_str_a(iov++, 15, "NM_LOG_LEVEL=%s", nm_log_level_desc[level].name);
-        if (func)
-            _iovec_set_format(iov++, iov_free++, "CODE_FUNC=%s", func);
-        _iovec_set_format(iov++, iov_free++, "CODE_FILE=%s", file ?: "");
-        _iovec_set_format_a(iov++, 20, "CODE_LINE=%u", line);
-        _iovec_set_format_a(iov++,
-                            60,
-                            "TIMESTAMP_MONOTONIC=%lld.%06lld",
-                            (long long) (now / NM_UTILS_NSEC_PER_SEC),
-                            (long long) ((now % NM_UTILS_NSEC_PER_SEC) / 1000));
-        _iovec_set_format_a(iov++,
-                            60,
-                            "TIMESTAMP_BOOTTIME=%lld.%06lld",
-                            (long long) (boottime / NM_UTILS_NSEC_PER_SEC),
-                            (long long) ((boottime % NM_UTILS_NSEC_PER_SEC) / 1000));
-        if (error != 0)
-            _iovec_set_format_a(iov++, 30, "ERRNO=%d", error);
-        if (ifname)
-            _iovec_set_format(iov++, iov_free++, "NM_DEVICE=%s", ifname);
-        if (conn_uuid)
-            _iovec_set_format(iov++, iov_free++, "NM_CONNECTION=%s", conn_uuid);
-
-        nm_assert(iov <= &iov_data[G_N_ELEMENTS(iov_data)]);
-        nm_assert(iov_free <= &iov_free_data[G_N_ELEMENTS(iov_free_data)]);
-
-        sd_journal_sendv(iov_data, iov - iov_data);
-
-        for (; --iov_free >= iov_free_data;)
-            g_free(*iov_free);
-    } break;
+        _log_journal_send(g,
+                          file,
+                          line,
+                          func,
+                          level,
+                          domain,
+                          error,
+                          ifname,
+                          conn_uuid,
+                          msg,
+                          tv,
+                          nm_utils_get_monotonic_timestamp_nsec());
+        break;
+    case LOG_BACKEND_JOURNAL_BUFFERED:
+        _log_ring_push(file,
+                       line,
+                       func,
+                       level,
+                       domain,
+                       error,
+                       ifname,
+                       conn_uuid,
+                       msg,
+                       &msg_heap,
+                       tv);
+        break;
 #endif
     case LOG_BACKEND_SYSLOG:
         syslog(nm_log_level_desc[level].syslog_level, MESSAGE_FMT, MESSAGE_ARG(g->prefix, tv, msg));
@@ -816,6 +1467,7 @@ _nm_log_impl(const char *file,
         break;
     }
 
+out:
     errno = errsv;
 }
 
@@ -883,6 +1535,7 @@ nm_log_handler(const char *log_domain, GLogLevelFlags level, const char *message
     switch (gl.imm.log_backend) {
 #if SYSTEMD_JOURNAL
     case LOG_BACKEND_JOURNAL:
+    case LOG_BACKEND_JOURNAL_BUFFERED:
     {
         gint64 now, boottime;
 
@@ -962,7 +1615,10 @@ nm_logging_init(const char *logging_backend, gboolean debug)
 
 #if SYSTEMD_JOURNAL
     if (!nm_streq(logging_backend, NM_LOG_CONFIG_BACKEND_SYSLOG)) {
-        x_log_backend = LOG_BACKEND_JOURNAL;
+        if (nm_streq(logging_backend, NM_LOG_CONFIG_BACKEND_JOURNAL_BUFFERED))
+            x_log_backend = LOG_BACKEND_JOURNAL_BUFFERED;
+        else
+            x_log_backend = LOG_BACKEND_JOURNAL;
 
         /* We only log the monotonic-timestamp with structured logging (journal).
          * Only in this case, fetch the timestamp. */
@@ -986,6 +1642,11 @@ nm_logging_init(const char *logging_backend, gboolean debug)
 
     G_UNLOCK(log);
 
+#if SYSTEMD_JOURNAL
+    if (x_log_backend == LOG_BACKEND_JOURNAL_BUFFERED)
+        _log_buffered_start();
+#endif
+
     if (fetch_monotonic_timestamp) {
         /* ensure we read a monotonic timestamp. Reading the timestamp the first
          * time causes a logging message. We don't want to do that during _nm_log_impl. */
@@ -999,10 +1660,13 @@ nm_logging_init(const char *logging_backend, gboolean debug)
 
     if (nm_streq(logging_backend, NM_LOG_CONFIG_BACKEND_SYSLOG)) {
         /* good */
-    } else if (nm_streq(logging_backend, NM_LOG_CONFIG_BACKEND_JOURNAL)) {
+    } else if (NM_IN_STRSET(logging_backend,
+                            NM_LOG_CONFIG_BACKEND_JOURNAL,
+                            NM_LOG_CONFIG_BACKEND_JOURNAL_BUFFERED)) {
 #if !SYSTEMD_JOURNAL
         nm_log_warn(LOGD_CORE,
-                    "config: logging backend 'journal' is not available, fallback to 'syslog'");
+                    "config: logging backend '%s' is not available, fallback to 'syslog'",
+                    logging_backend);
 #endif
     } else {
         nm_log_warn(LOGD_CORE,
@@ -17,6 +17,10 @@
 #define NM_LOG_CONFIG_BACKEND_SYSLOG  "syslog"
 #define NM_LOG_CONFIG_BACKEND_JOURNAL "journal"
 
+/* Like "journal", but messages are buffered per thread and sent
+ * to journald from a separate thread. */
+#define NM_LOG_CONFIG_BACKEND_JOURNAL_BUFFERED "journal-buffered"
+
 #define nm_log_err(domain, ...)   nm_log(LOGL_ERR, (domain), NULL, NULL, __VA_ARGS__)
 #define nm_log_warn(domain, ...)  nm_log(LOGL_WARN, (domain), NULL, NULL, __VA_ARGS__)
 #define nm_log_info(domain, ...)  nm_log(LOGL_INFO, (domain), NULL, NULL, __VA_ARGS__)
@@ -147,6 +151,13 @@ nm_logging_setup(const char *level, const char *domains, char **bad_domains, GEr
 
 void nm_logging_init(const char *logging_backend, gboolean debug);
 
+#define NM_LOGGING_RECORDER_DEFAULT_SIZE ((gsize) (1024 * 1024))
+
+gboolean
+nm_logging_recorder_setup(const char *level, const char *domains, gsize size, GError **error);
+
+gboolean nm_logging_recorder_dump(const char *filename, GError **error);
+
 gboolean nm_logging_syslog_enabled(void);
 
 /*****************************************************************************/
@@ -180,4 +191,9 @@ gboolean nm_logging_syslog_enabled(void);
 
 extern void _nm_logging_clear_platform_logging_cache(void);
 
+struct iovec;
+
+/* For tests: replaces sd_journal_sendv() for the journal backends. */
+void _nm_logging_set_journal_sendv(int (*journal_sendv)(const struct iovec *iov, int n));
+
 #endif /* __NETWORKMANAGER_LOGGING_H__ */
@@ -45,6 +45,7 @@
 #include "libnm-platform/wifi/nm-wifi-utils-wext.h"
 #include "libnm-platform/wifi/nm-wifi-utils.h"
 #include "libnm-platform/wpan/nm-wpan-utils.h"
+#include "libnm-std-aux/nm-usdt.h"
 #include "libnm-std-aux/unaligned.h"
 #include "libnm-udev-aux/nm-udev-utils.h"
 #include "nm-platform-private.h"
@@ -6910,6 +6911,8 @@ delayed_action_wait_for_response_complete(NMPlatform             *platform,
 
     _LOGt_delayed_action(ACTION_TYPE, data, "complete");
 
+    NM_USDT(netlink_response, (int) netlink_protocol, data->seq_number, (int) seq_result);
+
     if (priv->delayed_action.list_wait_for_response_x[netlink_protocol]->len <= 1)
         priv->delayed_action.flags &= ~ACTION_TYPE;
     if (data->out_seq_result)
@@ -7271,6 +7274,8 @@ delayed_action_schedule_WAIT_FOR_RESPONSE(NMPlatform                        *pla
 
     nm_assert(!out_seq_result || *out_seq_result == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN);
 
+    NM_USDT(netlink_request, (int) netlink_protocol, seq_number);
+
     delayed_action_schedule(
         platform,
         nmp_netlink_protocol_info(netlink_protocol)->delayed_action_type_wait_for_response,
@@ -8809,6 +8814,18 @@ link_refresh(NMPlatform *platform, int ifindex)
     return !!nm_platform_link_get_obj(platform, ifindex, TRUE);
 }
 
+static void
+refresh_all(NMPlatform *platform, NMPObjectType obj_type)
+{
+    NMPObject obj_needle;
+
+    /* the needle for routing rules would need an address family. */
+    nm_assert(obj_type != NMP_OBJECT_TYPE_ROUTING_RULE);
+
+    do_request_one_type_by_needle_object(platform,
+                                         nmp_object_stackinit(&obj_needle, obj_type, NULL));
+}
+
 static gboolean
 link_set_netns(NMPlatform *platform, int ifindex, int netns_fd)
 {
@@ -10133,6 +10150,14 @@ wifi_get_frequency(NMPlatform *platform, int ifindex)
     return nm_wifi_utils_get_freq(wifi_data);
 }
 
+static int
+wifi_get_phy(NMPlatform *platform, int ifindex)
+{
+    WIFI_GET_WIFI_DATA_NETNS(wifi_data, platform, ifindex, -1);
+
+    return nm_wifi_utils_get_phy(wifi_data);
+}
+
 static gboolean
 wifi_get_station(NMPlatform  *platform,
                  int          ifindex,
@@ -12047,6 +12072,7 @@ nm_linux_platform_class_init(NMLinuxPlatformClass *klass)
     platform_class->link_change = link_change;
 
     platform_class->link_refresh = link_refresh;
+    platform_class->refresh_all  = refresh_all;
 
     platform_class->link_set_netns = link_set_netns;
 
@@ -12087,6 +12113,7 @@ nm_linux_platform_class_init(NMLinuxPlatformClass *klass)
 
     platform_class->wifi_get_capabilities            = wifi_get_capabilities;
     platform_class->wifi_get_frequency               = wifi_get_frequency;
+    platform_class->wifi_get_phy                     = wifi_get_phy;
     platform_class->wifi_get_station                 = wifi_get_station;
     platform_class->wifi_get_mode                    = wifi_get_mode;
     platform_class->wifi_set_mode                    = wifi_set_mode;
@@ -525,6 +525,24 @@ out:
 
 /*****************************************************************************/
 
+/**
+ * nm_platform_refresh_all:
+ * @self: platform instance
+ * @obj_type: the type of objects to refresh
+ *
+ * Dumps all objects of @obj_type from kernel and updates the cache.
+ * Refreshing many objects this way is cheaper than requesting them
+ * one by one.
+ */
+void
+nm_platform_refresh_all(NMPlatform *self, NMPObjectType obj_type)
+{
+    _CHECK_SELF_VOID(self, klass);
+
+    if (klass->refresh_all)
+        klass->refresh_all(self, obj_type);
+}
+
 /**
  * nm_platform_process_events:
  * @self: platform instance
@@ -3354,6 +3372,16 @@ nm_platform_wifi_get_frequency(NMPlatform *self, int ifindex)
     return klass->wifi_get_frequency(self, ifindex);
 }
 
+int
+nm_platform_wifi_get_phy(NMPlatform *self, int ifindex)
+{
+    _CHECK_SELF(self, klass, -1);
+
+    g_return_val_if_fail(ifindex > 0, -1);
+
+    return klass->wifi_get_phy(self, ifindex);
+}
+
 gboolean
 nm_platform_wifi_get_station(NMPlatform  *self,
                              int          ifindex,
@@ -1250,6 +1250,7 @@ typedef struct {
                                  guint32     *out_rate);
     gboolean (*wifi_get_bssid)(NMPlatform *self, int ifindex, guint8 *bssid);
     guint32 (*wifi_get_frequency)(NMPlatform *self, int ifindex);
+    int (*wifi_get_phy)(NMPlatform *self, int ifindex);
     int (*wifi_get_quality)(NMPlatform *self, int ifindex);
     guint32 (*wifi_get_rate)(NMPlatform *self, int ifindex);
     _NM80211Mode (*wifi_get_mode)(NMPlatform *self, int ifindex);
@@ -1980,6 +1981,7 @@ gboolean     nm_platform_link_supports_ports(NMPlatform *self, int ifindex);
 const char  *nm_platform_link_get_type_name(NMPlatform *self, int ifindex);
 
 gboolean nm_platform_link_refresh(NMPlatform *self, int ifindex);
+void     nm_platform_refresh_all(NMPlatform *self, NMPObjectType obj_type);
 void     nm_platform_process_events(NMPlatform *self);
 
 const NMPlatformLink *
@@ -2168,6 +2170,7 @@ gboolean nm_platform_link_tun_get_properties(NMPlatform       *self,
 gboolean
 nm_platform_wifi_get_capabilities(NMPlatform *self, int ifindex, _NMDeviceWifiCapabilities *caps);
 guint32      nm_platform_wifi_get_frequency(NMPlatform *self, int ifindex);
+int          nm_platform_wifi_get_phy(NMPlatform *self, int ifindex);
 gboolean     nm_platform_wifi_get_station(NMPlatform  *self,
                                           int          ifindex,
                                           NMEtherAddr *out_bssid,
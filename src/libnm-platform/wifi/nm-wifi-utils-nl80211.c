@@ -535,6 +535,12 @@ wifi_nl80211_get_station(NMWifiUtils *data,
     return TRUE;
 }
 
+static int
+wifi_nl80211_get_phy(NMWifiUtils *data)
+{
+    return ((NMWifiUtilsNl80211 *) data)->phy;
+}
+
 static gboolean
 wifi_nl80211_indicate_addressing_running(NMWifiUtils *data, gboolean running)
 {
@@ -845,6 +851,7 @@ nm_wifi_utils_nl80211_class_init(NMWifiUtilsNl80211Class *klass)
     wifi_utils_class->get_wake_on_wlan            = wifi_nl80211_get_wake_on_wlan,
     wifi_utils_class->set_wake_on_wlan            = wifi_nl80211_set_wake_on_wlan,
     wifi_utils_class->get_freq                    = wifi_nl80211_get_freq;
+    wifi_utils_class->get_phy                     = wifi_nl80211_get_phy;
     wifi_utils_class->find_freq                   = wifi_nl80211_find_freq;
     wifi_utils_class->get_station                 = wifi_nl80211_get_station;
     wifi_utils_class->indicate_addressing_running = wifi_nl80211_indicate_addressing_running;
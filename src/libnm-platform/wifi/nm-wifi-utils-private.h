@@ -27,6 +27,9 @@ typedef struct {
     /* Return current frequency in MHz (really associated BSS frequency) */
     guint32 (*get_freq)(NMWifiUtils *data);
 
+    /* Return the wiphy index of the interface, or -1 if unknown */
+    int (*get_phy)(NMWifiUtils *data);
+
     /* Return first supported frequency in the zero-terminated list. @ap
      * indicates that the frequency must be suited for AP mode. */
     guint32 (*find_freq)(NMWifiUtils *data, const guint32 *freqs, gboolean ap);
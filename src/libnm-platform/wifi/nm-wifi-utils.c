@@ -210,3 +210,14 @@ nm_wifi_utils_indicate_addressing_running(NMWifiUtils *data, gboolean running)
     return klass->indicate_addressing_running ? klass->indicate_addressing_running(data, running)
                                               : FALSE;
 }
+
+int
+nm_wifi_utils_get_phy(NMWifiUtils *data)
+{
+    NMWifiUtilsClass *klass;
+
+    g_return_val_if_fail(data != NULL, -1);
+
+    klass = NM_WIFI_UTILS_GET_CLASS(data);
+    return klass->get_phy ? klass->get_phy(data) : -1;
+}
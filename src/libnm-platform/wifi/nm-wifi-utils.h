@@ -56,6 +56,8 @@ gboolean nm_wifi_utils_get_station(NMWifiUtils *data,
 /* Tells the driver DHCP or SLAAC is running */
 gboolean nm_wifi_utils_indicate_addressing_running(NMWifiUtils *data, gboolean running);
 
+int nm_wifi_utils_get_phy(NMWifiUtils *data);
+
 gboolean nm_wifi_utils_set_powersave(NMWifiUtils *data, guint32 powersave);
 
 _NMSettingWirelessWakeOnWLan nm_wifi_utils_get_wake_on_wlan(NMWifiUtils *data);
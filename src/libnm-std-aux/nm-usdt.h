@@ -0,0 +1,28 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+
+#ifndef __NM_USDT_H__
+#define __NM_USDT_H__
+
+/*****************************************************************************/
+
+/* Static user space tracepoints (USDT) of the provider "NetworkManager".
+ * They can be attached to with perf, bpftrace or systemtap, see
+ * "tools/nm-activation-timeline.py".
+ *
+ * Without an attached tracer a probe costs a nop instruction, but the
+ * arguments are still computed. Only pass values that are at hand.
+ * Without <sys/sdt.h>, the probes compile to nothing. */
+
+#if HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+
+#define NM_USDT(name, ...) STAP_PROBEV(NetworkManager, name, __VA_ARGS__)
+#else
+#define NM_USDT(name, ...) \
+    do {                   \
+    } while (0)
+#endif
+
+/*****************************************************************************/
+
+#endif /* __NM_USDT_H__ */
@@ -70,6 +70,12 @@
 #define N_ACD_RFC_RATE_LIMIT_INTERVAL_NSEC      (UINT64_C(60000000000)) /* 60s */
 #define N_ACD_RFC_DEFEND_INTERVAL_NSEC          (UINT64_C(10000000000)) /* 10s */
 
+/*
+ * Jittered timeouts are placed on a grid of this many slots per jitter
+ * interval, see n_acd_probe_schedule().
+ */
+#define N_ACD_PROBE_JITTER_SLOTS                (8)
+
 /**
  * n_acd_probe_config_new() - create probe configuration
  * @configp:                    output argument for new probe configuration
@@ -170,10 +176,27 @@ static void n_acd_probe_schedule(NAcdProbe *probe, uint64_t n_timeout, unsigned
          * pseudo-random jitter on top of the real timeout given as @n_timeout.
          */
         if (n_jitter) {
-                uint64_t random;
+                uint64_t random, n_slot;
 
                 random = ((uint64_t)rand_r(&probe->seed) << 32) | (uint64_t)rand_r(&probe->seed);
-                n_time += random % n_jitter;
+
+                /*
+                 * Hosts with many addresses run many probes at the same time,
+                 * and their random timeouts would wake us up for each probe
+                 * separately. Hence, we round the absolute timeout up to the
+                 * next multiple of @n_jitter / N_ACD_PROBE_JITTER_SLOTS, so
+                 * probes that are due in the same slot are all handled in a
+                 * single timer tick. Rounding up adds less than one slot, so
+                 * the random part is reduced by one slot to keep the total
+                 * below the maximum jitter.
+                 */
+                n_slot = n_jitter / N_ACD_PROBE_JITTER_SLOTS;
+                if (n_slot) {
+                        n_time += random % (n_jitter - n_slot);
+                        n_time = (n_time + n_slot - 1) / n_slot * n_slot;
+                } else {
+                        n_time += random % n_jitter;
+                }
         }
 
         timeout_schedule(&probe->timeout, &probe->acd->timer, n_time);
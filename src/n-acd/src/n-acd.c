@@ -586,31 +586,28 @@ static int n_acd_handle_timeout(NAcd *acd) {
          *
          * When there are no more timeouts to handle at the given time, we
          * rearm the timer to potentially wake us up again in the future.
+         * Probes are coalesced into the same timer tick, and each of them
+         * reschedules its timeout. Hence, handle them all as a single batch,
+         * so the timer is only rearmed once at the end.
          */
         timer_now(&acd->timer, &now);
+        timer_batch_begin(&acd->timer);
 
         for (;;) {
                 Timeout *timeout;
 
                 r = timer_pop_timeout(&acd->timer, now, &timeout);
-                if (r < 0) {
-                        return r;
-                } else if (!timeout) {
-                        /*
-                         * There are no more timeouts pending before @now. Rearm
-                         * the timer to fire again at the next timeout.
-                         */
-                        timer_rearm(&acd->timer);
+                if (r || !timeout)
                         break;
-                }
 
                 probe = (void *)timeout - offsetof(NAcdProbe, timeout);
                 r = n_acd_probe_handle_timeout(probe);
                 if (r)
-                        return r;
+                        break;
         }
 
-        return 0;
+        timer_batch_end(&acd->timer);
+        return r;
 }
 
 static int n_acd_handle_packet(NAcd *acd, struct ether_arp *packet) {
@@ -101,6 +101,44 @@ static void test_pop(void) {
         timer_deinit(&timer);
 }
 
+static void test_batch(void) {
+        Timer timer = TIMER_NULL(timer);
+        Timeout t1 = TIMEOUT_INIT(t1), t2 = TIMEOUT_INIT(t2), *t;
+        int r;
+
+        r = timer_init(&timer);
+        c_assert(!r);
+
+        timeout_schedule(&t1, &timer, 2);
+        c_assert(timer.scheduled_timeout == 2);
+
+        /* the timer is only rearmed at the end of the outermost batch */
+        timer_batch_begin(&timer);
+        timer_batch_begin(&timer);
+
+        r = timer_pop_timeout(&timer, 10, &t);
+        c_assert(!r);
+        c_assert(t == &t1);
+
+        timeout_schedule(&t1, &timer, 4);
+        timeout_schedule(&t2, &timer, 3);
+        c_assert(timer.scheduled_timeout == 2);
+
+        timer_batch_end(&timer);
+        c_assert(timer.scheduled_timeout == 2);
+
+        timer_batch_end(&timer);
+        c_assert(timer.scheduled_timeout == 3);
+
+        timeout_unschedule(&t2);
+        c_assert(timer.scheduled_timeout == 4);
+
+        timeout_unschedule(&t1);
+        c_assert(timer.scheduled_timeout == 0);
+
+        timer_deinit(&timer);
+}
+
 void test_arm(void) {
         struct itimerspec spec = {
                 .it_value = {
@@ -173,5 +211,6 @@ int main(int argc, char **argv) {
         test_arm();
         test_api();
         test_pop();
+        test_batch();
         return 0;
 }
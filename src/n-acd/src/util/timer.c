@@ -54,6 +54,12 @@ void timer_rearm(Timer *timer) {
         Timeout *timeout;
         int r;
 
+        /*
+         * While a batch is running, the timer is rearmed once at its end.
+         */
+        if (timer->n_batch)
+                return;
+
         /*
          * A timeout value of 0 clears the timer, we should only set that if
          * no timeout exists in the tree.
@@ -80,6 +86,23 @@ void timer_rearm(Timer *timer) {
         }
 }
 
+/*
+ * Rescheduling many timeouts in a row would update the timer-fd for each of
+ * them, whenever the first timeout changes. Between timer_batch_begin() and
+ * timer_batch_end() the timer is not rearmed, but only once at the end.
+ * Batches can be nested.
+ */
+void timer_batch_begin(Timer *timer) {
+        ++timer->n_batch;
+}
+
+void timer_batch_end(Timer *timer) {
+        c_assert(timer->n_batch > 0);
+
+        if (!--timer->n_batch)
+                timer_rearm(timer);
+}
+
 int timer_read(Timer *timer) {
         uint64_t v;
         int r;
@@ -23,6 +23,7 @@ struct Timer {
         clockid_t clock;
         CRBTree tree;
         uint64_t scheduled_timeout;
+        unsigned int n_batch;
 };
 
 #define TIMER_NULL(_x) {                                                        \
@@ -49,6 +50,9 @@ int timer_pop_timeout(Timer *timer, uint64_t now, Timeout **timerp);
 void timer_rearm(Timer *timer);
 int timer_read(Timer *timer);
 
+void timer_batch_begin(Timer *timer);
+void timer_batch_end(Timer *timer);
+
 void timeout_schedule(Timeout *timeout, Timer *timer, uint64_t time);
 void timeout_unschedule(Timeout *timeout);
 
@@ -15,6 +15,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include "n-dhcp4-private.h"
 #include "util/packet.h"
 
@@ -55,6 +56,7 @@ int n_dhcp4_c_connection_init(NDhcp4CConnection *connection,
         connection->probe_config = probe_config;
         connection->fd_epoll = fd_epoll;
         connection->log_queue = log_queue;
+        connection->hub = client_config->hub;
 
         /*
          * We explicitly allow initializing connections with an invalid
@@ -138,6 +140,69 @@ static void n_dhcp4_c_connection_outgoing_set_secs(NDhcp4Outgoing *message) {
         n_dhcp4_outgoing_set_secs(message, secs);
 }
 
+static void n_dhcp4_c_connection_close_packet(NDhcp4CConnection *connection) {
+        NDhcp4Incoming *message, *t_message;
+
+        if (connection->fd_packet < 0)
+                return;
+
+        epoll_ctl(connection->fd_epoll, EPOLL_CTL_DEL, connection->fd_packet, NULL);
+        connection->fd_packet = c_close(connection->fd_packet);
+        connection->ns_drain_timeout = 0;
+
+        if (connection->hub) {
+                n_dhcp4_c_hub_unlink(connection);
+                c_list_for_each_entry_safe(message, t_message, &connection->hub_queue, hub_link)
+                        n_dhcp4_incoming_free(message);
+                connection->n_hub_queue = 0;
+        }
+}
+
+static int n_dhcp4_c_connection_packet_open(NDhcp4CConnection *connection, int *fdp) {
+        int fd;
+
+        /*
+         * With a hub, packets are received through the shared packet socket
+         * of the hub, which signals us via an eventfd, taking the place of
+         * the packet socket.
+         */
+        if (connection->hub) {
+                fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+                if (fd < 0)
+                        return -errno;
+
+                *fdp = fd;
+                return 0;
+        }
+
+        return n_dhcp4_c_socket_packet_new(fdp, connection->client_config->ifindex);
+}
+
+static int n_dhcp4_c_connection_packet_recv(NDhcp4CConnection *connection,
+                                            uint8_t *buffer,
+                                            size_t n_buffer,
+                                            NDhcp4Incoming **messagep) {
+        NDhcp4Incoming *message;
+        uint64_t v;
+        ssize_t l;
+
+        if (!connection->hub)
+                return n_dhcp4_c_socket_packet_recv(connection->fd_packet, buffer, n_buffer, messagep);
+
+        message = c_list_first_entry(&connection->hub_queue, NDhcp4Incoming, hub_link);
+        if (!message) {
+                /* the queue is drained, reset the eventfd */
+                l = read(connection->fd_packet, &v, sizeof(v));
+                (void)l;
+                return N_DHCP4_E_AGAIN;
+        }
+
+        c_list_unlink(&message->hub_link);
+        --connection->n_hub_queue;
+        *messagep = message;
+        return 0;
+}
+
 int n_dhcp4_c_connection_listen(NDhcp4CConnection *connection) {
         _c_cleanup_(c_closep) int fd_packet = -1;
         int r;
@@ -149,18 +214,14 @@ int n_dhcp4_c_connection_listen(NDhcp4CConnection *connection) {
                  connection->state == N_DHCP4_C_CONNECTION_STATE_DRAINING ||
                  connection->state == N_DHCP4_C_CONNECTION_STATE_UDP);
 
-        if (connection->fd_packet >= 0) {
-                epoll_ctl(connection->fd_epoll, EPOLL_CTL_DEL, connection->fd_packet, NULL);
-                connection->fd_packet = c_close(connection->fd_packet);
-                connection->ns_drain_timeout = 0;
-        }
+        n_dhcp4_c_connection_close_packet(connection);
 
         if (connection->fd_udp >= 0) {
                 epoll_ctl(connection->fd_epoll, EPOLL_CTL_DEL, connection->fd_udp, NULL);
                 connection->fd_udp = c_close(connection->fd_udp);
         }
 
-        r = n_dhcp4_c_socket_packet_new(&fd_packet, connection->client_config->ifindex);
+        r = n_dhcp4_c_connection_packet_open(connection, &fd_packet);
         if (r)
                 return r;
 
@@ -206,10 +267,14 @@ int n_dhcp4_c_connection_connect(NDhcp4CConnection *connection,
         if (r < 0)
                 return -errno;
 
-        r = packet_shutdown(connection->fd_packet);
-        if (r < 0) {
-                epoll_ctl(connection->fd_epoll, EPOLL_CTL_DEL, fd_udp, NULL);
-                return r;
+        if (connection->hub) {
+                n_dhcp4_c_hub_unlink(connection);
+        } else {
+                r = packet_shutdown(connection->fd_packet);
+                if (r < 0) {
+                        epoll_ctl(connection->fd_epoll, EPOLL_CTL_DEL, fd_udp, NULL);
+                        return r;
+                }
         }
 
         connection->state = N_DHCP4_C_CONNECTION_STATE_DRAINING;
@@ -227,10 +292,7 @@ void n_dhcp4_c_connection_close(NDhcp4CConnection *connection) {
                 connection->fd_udp = c_close(connection->fd_udp);
         }
 
-        if (connection->fd_packet >= 0) {
-                epoll_ctl(connection->fd_epoll, EPOLL_CTL_DEL, connection->fd_packet, NULL);
-                connection->fd_packet = c_close(connection->fd_packet);
-        }
+        n_dhcp4_c_connection_close_packet(connection);
 
         connection->fd_epoll = -1;
         connection->state = N_DHCP4_C_CONNECTION_STATE_CLOSED;
@@ -381,11 +443,14 @@ void n_dhcp4_c_connection_get_timeout(NDhcp4CConnection *connection,
 
 static int n_dhcp4_c_connection_packet_broadcast(NDhcp4CConnection *connection,
                                                  NDhcp4Outgoing *message) {
-        int r;
+        int fd, r;
 
         c_assert(connection->state == N_DHCP4_C_CONNECTION_STATE_PACKET);
 
-        r = n_dhcp4_c_socket_packet_send(connection->fd_packet,
+        /* with a hub, the connection has no packet socket of its own */
+        fd = connection->hub ? connection->hub->fd_packet : connection->fd_packet;
+
+        r = n_dhcp4_c_socket_packet_send(fd,
                                          connection->client_config->ifindex,
                                          connection->client_config->broadcast_mac,
                                          connection->client_config->n_broadcast_mac,
@@ -1043,6 +1108,15 @@ static int n_dhcp4_c_connection_send_request(NDhcp4CConnection *connection,
                 c_assert(0);
         }
 
+        if (connection->hub && connection->state == N_DHCP4_C_CONNECTION_STATE_PACKET) {
+                uint32_t xid;
+
+                n_dhcp4_outgoing_get_xid(request, &xid);
+                r = n_dhcp4_c_hub_link(connection->hub, connection, xid);
+                if (r)
+                        return r;
+        }
+
         request->userdata.send_time = timestamp;
         request->userdata.send_jitter = (n_dhcp4_client_probe_config_get_random(connection->probe_config) % 1000000000ULL);
         n_dhcp4_c_connection_outgoing_set_secs(request);
@@ -1133,10 +1207,8 @@ int n_dhcp4_c_connection_dispatch_timer(NDhcp4CConnection *connection,
         int r;
 
         if (connection->ns_drain_timeout != 0 && connection->ns_drain_timeout < timestamp) {
-                epoll_ctl(connection->fd_epoll, EPOLL_CTL_DEL, connection->fd_packet, NULL);
-                connection->fd_packet = c_close(connection->fd_packet);
+                n_dhcp4_c_connection_close_packet(connection);
                 connection->state = N_DHCP4_C_CONNECTION_STATE_UDP;
-                connection->ns_drain_timeout = 0;
         }
 
         if (!connection->request)
@@ -1176,20 +1248,20 @@ int n_dhcp4_c_connection_dispatch_io(NDhcp4CConnection *connection,
 
         switch (connection->state) {
         case N_DHCP4_C_CONNECTION_STATE_PACKET:
-                r = n_dhcp4_c_socket_packet_recv(connection->fd_packet,
-                                                 buffer,
-                                                 UINT16_MAX,
-                                                 &message);
+                r = n_dhcp4_c_connection_packet_recv(connection,
+                                                     buffer,
+                                                     UINT16_MAX,
+                                                     &message);
                 if (!r)
                         break;
                 else if (r == N_DHCP4_E_MALFORMED)
                         return r;
                 return N_DHCP4_E_AGAIN;
         case N_DHCP4_C_CONNECTION_STATE_DRAINING:
-                r = n_dhcp4_c_socket_packet_recv(connection->fd_packet,
-                                                 buffer,
-                                                 UINT16_MAX,
-                                                 &message);
+                r = n_dhcp4_c_connection_packet_recv(connection,
+                                                     buffer,
+                                                     UINT16_MAX,
+                                                     &message);
                 if (!r)
                         break;
                 else if (r == N_DHCP4_E_MALFORMED)
@@ -1202,11 +1274,8 @@ int n_dhcp4_c_connection_dispatch_io(NDhcp4CConnection *connection,
                  * and drained, clean up the packet socket and fall through to
                  * dispatching the UDP socket.
                  */
-                r = epoll_ctl(connection->fd_epoll, EPOLL_CTL_DEL, connection->fd_packet, NULL);
-                c_assert(!r);
-                connection->fd_packet = c_close(connection->fd_packet);
+                n_dhcp4_c_connection_close_packet(connection);
                 connection->state = N_DHCP4_C_CONNECTION_STATE_UDP;
-                connection->ns_drain_timeout = 0;
 
                 /* fall-through */
         case N_DHCP4_C_CONNECTION_STATE_UDP:
@@ -0,0 +1,315 @@
+/*
+ * DHCPv4 Client Hub
+ *
+ * A hub owns a single packet socket that is not bound to any interface, and
+ * is shared by many clients in the same network namespace. Instead of each
+ * client running its own packet socket with its own kernel filter, the hub
+ * reads all incoming DHCP replies, looks up the listening connection by
+ * the receiving interface and transaction id, and queues the reply on that
+ * connection. Each connection owns an eventfd in place of its packet socket,
+ * which the hub signals, so only the client a reply is destined for is woken
+ * up.
+ *
+ * Once a connection switches to its UDP socket, it leaves the hub and no
+ * longer receives packets from it.
+ */
+
+#include <assert.h>
+#include <c-list.h>
+#include <c-siphash.h>
+#include <c-stdaux.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/auxv.h>
+#include <sys/eventfd.h>
+#include "n-dhcp4.h"
+#include "n-dhcp4-private.h"
+
+static void n_dhcp4_client_hub_initialize_hash_seed(NDhcp4ClientHub *hub) {
+        const uint8_t *p;
+
+        /*
+         * Transaction ids are chosen randomly by the clients, but replies are
+         * sent by whatever is on the network. Seed the hash from AT_RANDOM so
+         * the network cannot force collisions. The hub address is mixed in
+         * to avoid identical seeds for hubs within the same process.
+         */
+        p = (const uint8_t *)getauxval(AT_RANDOM);
+        if (p)
+                memcpy(hub->hash_seed, p, sizeof(hub->hash_seed));
+
+        for (size_t i = 0; i < sizeof(hub); ++i)
+                hub->hash_seed[i] ^= ((const uint8_t *)&hub)[i];
+}
+
+/**
+ * n_dhcp4_client_hub_new() - allocate new client hub
+ * @hubp:                       output argument for new hub
+ *
+ * This creates a new client hub with a packet socket in the current network
+ * namespace. Pass it to n_dhcp4_client_config_set_hub() to make clients use
+ * it. The caller must dispatch the hub whenever its file-descriptor, see
+ * n_dhcp4_client_hub_get_fd(), is readable.
+ *
+ * Return: 0 on success, negative error code on failure.
+ */
+_c_public_ int n_dhcp4_client_hub_new(NDhcp4ClientHub **hubp) {
+        _c_cleanup_(n_dhcp4_client_hub_unrefp) NDhcp4ClientHub *hub = NULL;
+        int r;
+
+        c_assert(hubp);
+
+        hub = malloc(sizeof(*hub));
+        if (!hub)
+                return -ENOMEM;
+
+        *hub = (NDhcp4ClientHub)N_DHCP4_CLIENT_HUB_NULL(*hub);
+
+        hub->n_buckets = 16;
+        hub->buckets = malloc(hub->n_buckets * sizeof(*hub->buckets));
+        if (!hub->buckets)
+                return -ENOMEM;
+
+        for (size_t i = 0; i < hub->n_buckets; ++i)
+                c_list_init(&hub->buckets[i]);
+
+        n_dhcp4_client_hub_initialize_hash_seed(hub);
+
+        r = n_dhcp4_c_socket_packet_new(&hub->fd_packet, 0);
+        if (r)
+                return r;
+
+        *hubp = hub;
+        hub = NULL;
+        return 0;
+}
+
+static void n_dhcp4_client_hub_free(NDhcp4ClientHub *hub) {
+        /* connections are pinned by their client configuration */
+        c_assert(!hub->n_connections);
+
+        if (hub->fd_packet >= 0)
+                close(hub->fd_packet);
+
+        free(hub->buckets);
+        free(hub);
+}
+
+/**
+ * n_dhcp4_client_hub_ref() - acquire hub reference
+ * @hub:                        hub to operate on, or NULL
+ *
+ * This acquires a reference to the hub given as @hub. If @hub is NULL, this
+ * function is a no-op.
+ *
+ * Return: @hub is returned.
+ */
+_c_public_ NDhcp4ClientHub *n_dhcp4_client_hub_ref(NDhcp4ClientHub *hub) {
+        if (hub)
+                ++hub->n_refs;
+        return hub;
+}
+
+/**
+ * n_dhcp4_client_hub_unref() - release hub reference
+ * @hub:                        hub to operate on, or NULL
+ *
+ * This releases a reference to the hub given as @hub. If @hub is NULL, this
+ * function is a no-op.
+ *
+ * Return: NULL is returned.
+ */
+_c_public_ NDhcp4ClientHub *n_dhcp4_client_hub_unref(NDhcp4ClientHub *hub) {
+        if (hub && !--hub->n_refs)
+                n_dhcp4_client_hub_free(hub);
+        return NULL;
+}
+
+/**
+ * n_dhcp4_client_hub_get_fd() - retrieve hub file-descriptor
+ * @hub:                        hub to operate on
+ * @fdp:                        output argument to store file-descriptor
+ *
+ * This retrieves the file-descriptor of the shared packet socket. The caller
+ * must call n_dhcp4_client_hub_dispatch() whenever it is readable.
+ */
+_c_public_ void n_dhcp4_client_hub_get_fd(NDhcp4ClientHub *hub, int *fdp) {
+        *fdp = hub->fd_packet;
+}
+
+static uint64_t n_dhcp4_client_hub_hash(NDhcp4ClientHub *hub, int ifindex, uint32_t xid) {
+        CSipHash state = C_SIPHASH_NULL;
+
+        c_siphash_init(&state, hub->hash_seed);
+        c_siphash_append(&state, (const uint8_t *)&ifindex, sizeof(ifindex));
+        c_siphash_append(&state, (const uint8_t *)&xid, sizeof(xid));
+        return c_siphash_finalize(&state);
+}
+
+static NDhcp4CConnection *n_dhcp4_client_hub_find(NDhcp4ClientHub *hub, int ifindex, uint32_t xid) {
+        NDhcp4CConnection *connection;
+        uint64_t hash;
+
+        hash = n_dhcp4_client_hub_hash(hub, ifindex, xid);
+
+        c_list_for_each_entry(connection,
+                              &hub->buckets[hash & (hub->n_buckets - 1)],
+                              hub_bucket_link) {
+                if (connection->hub_hash == hash &&
+                    connection->hub_xid == xid &&
+                    connection->client_config->ifindex == ifindex)
+                        return connection;
+        }
+
+        return NULL;
+}
+
+static int n_dhcp4_client_hub_rehash(NDhcp4ClientHub *hub) {
+        NDhcp4CConnection *connection, *t_connection;
+        CList *buckets;
+        size_t n_buckets;
+
+        /* keep the load factor of the connection table at or below 1 */
+        if (hub->n_connections < hub->n_buckets)
+                return 0;
+
+        n_buckets = hub->n_buckets * 2;
+        buckets = malloc(n_buckets * sizeof(*buckets));
+        if (!buckets)
+                return -ENOMEM;
+
+        for (size_t i = 0; i < n_buckets; ++i)
+                c_list_init(&buckets[i]);
+
+        for (size_t i = 0; i < hub->n_buckets; ++i) {
+                c_list_for_each_entry_safe(connection, t_connection, &hub->buckets[i], hub_bucket_link) {
+                        c_list_unlink(&connection->hub_bucket_link);
+                        c_list_link_tail(&buckets[connection->hub_hash & (n_buckets - 1)],
+                                         &connection->hub_bucket_link);
+                }
+        }
+
+        free(hub->buckets);
+        hub->buckets = buckets;
+        hub->n_buckets = n_buckets;
+        return 0;
+}
+
+/**
+ * n_dhcp4_c_hub_link() - make hub deliver replies to a connection
+ * @hub:                        hub to operate on
+ * @connection:                 connection to link
+ * @xid:                        transaction id to deliver replies for
+ *
+ * This links @connection into @hub, so replies received on the interface of
+ * @connection with transaction id @xid are queued on @connection. If the
+ * connection is already linked, it is re-keyed to @xid.
+ *
+ * Return: 0 on success, negative error code on failure.
+ */
+int n_dhcp4_c_hub_link(NDhcp4ClientHub *hub, NDhcp4CConnection *connection, uint32_t xid) {
+        int r;
+
+        if (c_list_is_linked(&connection->hub_bucket_link)) {
+                if (connection->hub_xid == xid)
+                        return 0;
+
+                n_dhcp4_c_hub_unlink(connection);
+        }
+
+        r = n_dhcp4_client_hub_rehash(hub);
+        if (r)
+                return r;
+
+        connection->hub_xid = xid;
+        connection->hub_hash = n_dhcp4_client_hub_hash(hub, connection->client_config->ifindex, xid);
+        c_list_link_tail(&hub->buckets[connection->hub_hash & (hub->n_buckets - 1)],
+                         &connection->hub_bucket_link);
+        ++hub->n_connections;
+        return 0;
+}
+
+/**
+ * n_dhcp4_c_hub_unlink() - stop delivering replies to a connection
+ * @connection:                 connection to unlink
+ *
+ * This unlinks @connection from its hub. Replies that are already queued on
+ * the connection stay queued. If the connection is not linked, this is a
+ * no-op.
+ */
+void n_dhcp4_c_hub_unlink(NDhcp4CConnection *connection) {
+        if (!c_list_is_linked(&connection->hub_bucket_link))
+                return;
+
+        c_list_unlink(&connection->hub_bucket_link);
+        --connection->hub->n_connections;
+}
+
+static void n_dhcp4_client_hub_deliver(NDhcp4ClientHub *hub, NDhcp4Incoming *message, int ifindex) {
+        NDhcp4CConnection *connection;
+        uint32_t xid;
+        uint64_t one = 1;
+        ssize_t l;
+
+        n_dhcp4_incoming_get_xid(message, &xid);
+
+        connection = n_dhcp4_client_hub_find(hub, ifindex, xid);
+        if (!connection || connection->n_hub_queue >= N_DHCP4_C_HUB_QUEUE_MAX) {
+                n_dhcp4_incoming_free(message);
+                return;
+        }
+
+        c_list_link_tail(&connection->hub_queue, &message->hub_link);
+        ++connection->n_hub_queue;
+
+        /* the eventfd cannot overflow, it is reset once the queue is empty */
+        l = write(connection->fd_packet, &one, sizeof(one));
+        c_assert(l == sizeof(one));
+}
+
+/**
+ * n_dhcp4_client_hub_dispatch() - dispatch hub
+ * @hub:                        hub to operate on
+ *
+ * This reads incoming packets from the shared packet socket and queues them
+ * on the clients they are destined for. Packets that no client is waiting
+ * for are dropped. The affected clients become readable and must be
+ * dispatched by the caller as usual.
+ *
+ * This function never blocks.
+ *
+ * If there are more packets to dispatch, than would be reasonable to do in a
+ * single dispatch, this will return N_DHCP4_E_PREEMPTED. In this case the
+ * caller is expected to call into this function again when it is ready to
+ * dispatch more packets.
+ *
+ * Return: 0 on success, negative error code on failure, N_DHCP4_E_PREEMPTED if
+ *         there is more data to dispatch.
+ */
+_c_public_ int n_dhcp4_client_hub_dispatch(NDhcp4ClientHub *hub) {
+        NDhcp4Incoming *message;
+        int ifindex;
+        int r;
+
+        for (unsigned int i = 0; i < N_DHCP4_C_HUB_DISPATCH_MAX; ++i) {
+                message = NULL;
+                ifindex = 0;
+
+                r = n_dhcp4_c_socket_packet_recvfrom(hub->fd_packet,
+                                                     hub->buf,
+                                                     sizeof(hub->buf),
+                                                     &message,
+                                                     &ifindex);
+                if (r == N_DHCP4_E_AGAIN)
+                        return 0;
+                else if (r == N_DHCP4_E_MALFORMED || r == N_DHCP4_E_DOWN)
+                        continue;
+                else if (r)
+                        return r;
+
+                n_dhcp4_client_hub_deliver(hub, message, ifindex);
+        }
+
+        return N_DHCP4_E_PREEMPTED;
+}
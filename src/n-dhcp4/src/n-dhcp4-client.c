@@ -63,6 +63,7 @@ _c_public_ NDhcp4ClientConfig *n_dhcp4_client_config_free(NDhcp4ClientConfig *co
         if (!config)
                 return NULL;
 
+        n_dhcp4_client_hub_unref(config->hub);
         free(config->client_id);
         free(config);
 
@@ -94,6 +95,7 @@ int n_dhcp4_client_config_dup(NDhcp4ClientConfig *config, NDhcp4ClientConfig **d
         dup->n_mac = config->n_mac;
         memcpy(dup->broadcast_mac, config->broadcast_mac, sizeof(dup->broadcast_mac));
         dup->n_broadcast_mac = config->n_broadcast_mac;
+        dup->hub = n_dhcp4_client_hub_ref(config->hub);
 
         r = n_dhcp4_client_config_set_client_id(dup,
                                                 config->client_id,
@@ -259,6 +261,25 @@ _c_public_ int n_dhcp4_client_config_set_client_id(NDhcp4ClientConfig *config, c
         return 0;
 }
 
+/**
+ * n_dhcp4_client_config_set_hub() - set hub property
+ * @config:                     client configuration to operate on
+ * @hub:                        hub to use, or NULL
+ *
+ * This sets the hub property of @config. If set, clients created with this
+ * configuration do not open their own packet socket, but receive and send
+ * packets through the shared packet socket of @hub. The hub must have been
+ * created in the same network namespace as the client. The configuration,
+ * and every client created from it, holds a reference to @hub.
+ *
+ * By default no hub is used.
+ */
+_c_public_ void n_dhcp4_client_config_set_hub(NDhcp4ClientConfig *config, NDhcp4ClientHub *hub) {
+        n_dhcp4_client_hub_ref(hub);
+        n_dhcp4_client_hub_unref(config->hub);
+        config->hub = hub;
+}
+
 /**
  * n_dhcp4_client_set_log_level() - set the logging level of the client
  * @client:                         the client to operate on
@@ -234,6 +234,7 @@ NDhcp4Incoming *n_dhcp4_incoming_free(NDhcp4Incoming *incoming) {
         if (!incoming)
                 return NULL;
 
+        c_list_unlink(&incoming->hub_link);
         free(incoming);
 
         return NULL;
@@ -25,6 +25,7 @@ typedef struct NDhcp4Outgoing NDhcp4Outgoing;
 typedef struct NDhcp4SConnection NDhcp4SConnection;
 typedef struct NDhcp4SConnectionIp NDhcp4SConnectionIp;
 typedef struct NDhcp4SEventNode NDhcp4SEventNode;
+typedef struct NDhcp4ServerOption NDhcp4ServerOption;
 typedef struct NDhcp4LogQueue NDhcp4LogQueue;
 
 /* specs */
@@ -217,6 +218,8 @@ struct NDhcp4Outgoing {
         }
 
 struct NDhcp4Incoming {
+        CList hub_link;
+
         struct {
                 uint8_t *value;
                 size_t size;
@@ -234,6 +237,7 @@ struct NDhcp4Incoming {
 };
 
 #define N_DHCP4_INCOMING_NULL(_x) {                                             \
+                .hub_link = C_LIST_INIT((_x).hub_link),                         \
         }
 
 struct NDhcp4ClientConfig {
@@ -246,6 +250,7 @@ struct NDhcp4ClientConfig {
         size_t n_broadcast_mac;
         uint8_t *client_id;
         size_t n_client_id;
+        NDhcp4ClientHub *hub;
 };
 
 #define N_DHCP4_CLIENT_CONFIG_NULL(_x) {                                        \
@@ -330,9 +335,16 @@ struct NDhcp4CConnection {
         int fd_epoll;
 
         unsigned int state;             /* current connection state */
-        int fd_packet;                  /* packet socket */
+        int fd_packet;                  /* packet socket, or eventfd with a hub */
         int fd_udp;                     /* udp socket */
 
+        NDhcp4ClientHub *hub;           /* shared packet socket, or NULL */
+        CList hub_bucket_link;          /* linked into the hub while listening */
+        uint64_t hub_hash;              /* hash of ifindex and xid */
+        uint32_t hub_xid;               /* xid the hub delivers replies for */
+        CList hub_queue;                /* replies delivered by the hub */
+        size_t n_hub_queue;
+
         NDhcp4Outgoing *request;        /* current request */
 
         uint64_t ns_drain_timeout;      /* timeout for closing packet socket */
@@ -344,6 +356,32 @@ struct NDhcp4CConnection {
 #define N_DHCP4_C_CONNECTION_NULL(_x) {                                         \
                 .fd_packet = -1,                                                \
                 .fd_udp = -1,                                                   \
+                .hub_bucket_link = C_LIST_INIT((_x).hub_bucket_link),           \
+                .hub_queue = C_LIST_INIT((_x).hub_queue),                       \
+        }
+
+/* maximum number of replies queued on a connection by the hub */
+#define N_DHCP4_C_HUB_QUEUE_MAX (16)
+
+/* maximum number of packets read by a single hub dispatch */
+#define N_DHCP4_C_HUB_DISPATCH_MAX (128)
+
+struct NDhcp4ClientHub {
+        unsigned long n_refs;
+        int fd_packet;                  /* packet socket for all interfaces */
+
+        /* listening connections, hashed by ifindex and xid */
+        CList *buckets;
+        size_t n_buckets;
+        size_t n_connections;
+        uint8_t hash_seed[16];
+
+        uint8_t buf[UINT16_MAX];        /* scratch receive buffer */
+};
+
+#define N_DHCP4_CLIENT_HUB_NULL(_x) {                                           \
+                .n_refs = 1,                                                    \
+                .fd_packet = -1,                                                \
         }
 
 struct NDhcp4Client {
@@ -413,11 +451,40 @@ struct NDhcp4ClientLease {
                 .probe_link = C_LIST_INIT((_x).probe_link),                     \
         }
 
+/* maximum number of addresses in the address pool of a server */
+#define N_DHCP4_SERVER_RANGE_MAX (UINT32_C(65536))
+
+/* default lease lifetime, in seconds */
+#define N_DHCP4_SERVER_LIFETIME_DEFAULT (UINT32_C(3600))
+
+/* how long an address is held back for a client after it was offered */
+#define N_DHCP4_SERVER_OFFER_TIMEOUT (UINT64_C(60) * UINT64_C(1000000000))
+
+/* how long an address is quarantined after a client declined it */
+#define N_DHCP4_SERVER_DECLINE_TIMEOUT (UINT64_C(600) * UINT64_C(1000000000))
+
+enum {
+        N_DHCP4_SERVER_LEASE_STATE_OFFERED,
+        N_DHCP4_SERVER_LEASE_STATE_BOUND,
+        N_DHCP4_SERVER_LEASE_STATE_DECLINED,
+};
+
+struct NDhcp4ServerOption {
+        uint8_t option;
+        uint8_t n_data;
+        uint8_t data[];
+};
+
 struct NDhcp4ServerConfig {
         int ifindex;
+        struct in_addr range_start;
+        struct in_addr range_end;
+        uint32_t lifetime;
+        NDhcp4ServerOption *options[UINT8_MAX + 1];
 };
 
 #define N_DHCP4_SERVER_CONFIG_NULL(_x) {                                        \
+                .lifetime = N_DHCP4_SERVER_LIFETIME_DEFAULT,                    \
         }
 
 struct NDhcp4SEventNode {
@@ -461,6 +528,19 @@ struct NDhcp4Server {
         bool preempted : 1;
 
         NDhcp4SConnection connection;
+
+        uint32_t range_start;           /* first pool address, host order */
+        uint32_t n_range;               /* number of pool addresses */
+        uint32_t i_range;               /* allocation cursor into the pool */
+        uint32_t lifetime;
+        NDhcp4ServerOption *options[UINT8_MAX + 1];
+
+        /* leases indexed by pool offset and hashed by client identifier */
+        NDhcp4ServerLease **lease_map;
+        CList *lease_buckets;
+        size_t n_lease_buckets;
+        size_t n_leases;
+        uint8_t hash_seed[16];
 };
 
 #define N_DHCP4_SERVER_NULL(_x) {                                               \
@@ -483,14 +563,23 @@ struct NDhcp4ServerLease {
 
         NDhcp4Server *server;
         CList server_link;
+        CList bucket_link;
 
         NDhcp4Incoming *request;
         NDhcp4Incoming *reply;
+
+        unsigned int state;
+        uint64_t hash;
+        struct in_addr address;
+        uint64_t lifetime;              /* expiry, CLOCK_BOOTTIME nsecs */
+        size_t n_client_id;
+        uint8_t client_id[];
 };
 
 #define N_DHCP4_SERVER_LEASE_NULL(_x) {                                         \
                 .n_refs = 1,                                                    \
                 .server_link = C_LIST_INIT((_x).server_link),                   \
+                .bucket_link = C_LIST_INIT((_x).bucket_link),                   \
         }
 
 /* outgoing messages */
@@ -573,6 +662,11 @@ int n_dhcp4_c_socket_packet_recv(int sockfd,
                                  uint8_t *buf,
                                  size_t n_buf,
                                  NDhcp4Incoming **messagep);
+int n_dhcp4_c_socket_packet_recvfrom(int sockfd,
+                                     uint8_t *buf,
+                                     size_t n_buf,
+                                     NDhcp4Incoming **messagep,
+                                     int *ifindexp);
 int n_dhcp4_c_socket_udp_recv(int sockfd,
                               uint8_t *buf,
                               size_t n_buf,
@@ -594,6 +688,11 @@ int n_dhcp4_client_probe_config_dup(NDhcp4ClientProbeConfig *config,
                                     NDhcp4ClientProbeConfig **dupp);
 uint32_t n_dhcp4_client_probe_config_get_random(NDhcp4ClientProbeConfig *config);
 
+/* client hubs */
+
+int n_dhcp4_c_hub_link(NDhcp4ClientHub *hub, NDhcp4CConnection *connection, uint32_t xid);
+void n_dhcp4_c_hub_unlink(NDhcp4CConnection *connection);
+
 /* client events */
 
 int n_dhcp4_c_event_node_new(NDhcp4CEventNode **nodep);
@@ -703,6 +802,16 @@ int n_dhcp4_s_connection_send_reply(NDhcp4SConnection *connection,
                                     const struct in_addr *server_addr,
                                     NDhcp4Outgoing *reply);
 
+/* server leases */
+
+int n_dhcp4_server_lease_new(NDhcp4ServerLease **leasep,
+                             const uint8_t *client_id,
+                             size_t n_client_id,
+                             uint64_t hash);
+void n_dhcp4_server_lease_link(NDhcp4ServerLease *lease, NDhcp4Server *server, uint32_t offset);
+void n_dhcp4_server_lease_unlink(NDhcp4ServerLease *lease);
+void n_dhcp4_server_lease_set_request(NDhcp4ServerLease *lease, NDhcp4Incoming *request);
+
 /* server connection ips */
 
 void n_dhcp4_s_connection_ip_init(NDhcp4SConnectionIp *ip, struct in_addr addr);
@@ -12,20 +12,35 @@
 #include "n-dhcp4-private.h"
 
 /**
- * n_dhcp4_server_lease_new() - XXX
+ * n_dhcp4_server_lease_new() - allocate new server lease
+ * @leasep:             output argument for new lease
+ * @client_id:          client identifier the lease is bound to
+ * @n_client_id:        length of @client_id in bytes
+ * @hash:               hash of @client_id, as used by the server
+ *
+ * This allocates a new, unlinked lease for the client identified by
+ * @client_id. The caller is responsible for assigning an address and
+ * linking the lease into a server.
+ *
+ * Return: 0 on success, negative error code on failure.
  */
-int n_dhcp4_server_lease_new(NDhcp4ServerLease **leasep, NDhcp4Incoming *message) {
+int n_dhcp4_server_lease_new(NDhcp4ServerLease **leasep,
+                             const uint8_t *client_id,
+                             size_t n_client_id,
+                             uint64_t hash) {
         _c_cleanup_(n_dhcp4_server_lease_unrefp) NDhcp4ServerLease *lease = NULL;
 
         c_assert(leasep);
 
-        lease = malloc(sizeof(*lease));
+        lease = malloc(sizeof(*lease) + n_client_id);
         if (!lease)
                 return -ENOMEM;
 
         *lease = (NDhcp4ServerLease)N_DHCP4_SERVER_LEASE_NULL(*lease);
 
-        lease->request = message;
+        lease->hash = hash;
+        lease->n_client_id = n_client_id;
+        memcpy(lease->client_id, client_id, n_client_id);
 
         *leasep = lease;
         lease = NULL;
@@ -35,12 +50,77 @@ int n_dhcp4_server_lease_new(NDhcp4ServerLease **leasep, NDhcp4Incoming *message
 static void n_dhcp4_server_lease_free(NDhcp4ServerLease *lease) {
         c_assert(!lease->server);
 
+        c_list_unlink(&lease->bucket_link);
         c_list_unlink(&lease->server_link);
 
         n_dhcp4_incoming_free(lease->request);
         free(lease);
 }
 
+/**
+ * n_dhcp4_server_lease_link() - link lease into server
+ * @lease:              lease to operate on
+ * @server:             server to link to
+ * @offset:             offset of the lease address in the server pool
+ *
+ * This links an unlinked lease into the lease tables of @server. The lease
+ * address must already be set and its pool slot must be free. The server
+ * takes its own reference to the lease.
+ */
+void n_dhcp4_server_lease_link(NDhcp4ServerLease *lease, NDhcp4Server *server, uint32_t offset) {
+        c_assert(!lease->server);
+        c_assert(offset < server->n_range);
+        c_assert(!server->lease_map[offset]);
+
+        lease->server = server;
+        c_list_link_tail(&server->lease_list, &lease->server_link);
+        server->lease_map[offset] = n_dhcp4_server_lease_ref(lease);
+        ++server->n_leases;
+
+        if (lease->state != N_DHCP4_SERVER_LEASE_STATE_DECLINED)
+                c_list_link_tail(&server->lease_buckets[lease->hash & (server->n_lease_buckets - 1)],
+                                 &lease->bucket_link);
+}
+
+/**
+ * n_dhcp4_server_lease_unlink() - unlink lease from its server
+ * @lease:              lease to operate on
+ *
+ * This removes a lease from the lease tables of its server and drops the
+ * reference the server held. If the lease is not linked, this is a no-op.
+ */
+void n_dhcp4_server_lease_unlink(NDhcp4ServerLease *lease) {
+        NDhcp4Server *server = lease->server;
+        uint32_t offset;
+
+        if (!server)
+                return;
+
+        offset = ntohl(lease->address.s_addr) - server->range_start;
+        c_assert(server->lease_map[offset] == lease);
+
+        server->lease_map[offset] = NULL;
+        --server->n_leases;
+        c_list_unlink(&lease->bucket_link);
+        c_list_unlink(&lease->server_link);
+        lease->server = NULL;
+
+        n_dhcp4_server_lease_unref(lease);
+}
+
+/**
+ * n_dhcp4_server_lease_set_request() - remember the last client request
+ * @lease:              lease to operate on
+ * @request:            request to take ownership of, or NULL
+ *
+ * The last request of a client is kept with the lease, so the owner can
+ * query client options via n_dhcp4_server_lease_query().
+ */
+void n_dhcp4_server_lease_set_request(NDhcp4ServerLease *lease, NDhcp4Incoming *request) {
+        n_dhcp4_incoming_free(lease->request);
+        lease->request = request;
+}
+
 /**
  * n_dhcp4_server_lease_ref() - XXX
  */
@@ -59,10 +139,51 @@ _c_public_ NDhcp4ServerLease *n_dhcp4_server_lease_unref(NDhcp4ServerLease *leas
         return NULL;
 }
 
+/**
+ * n_dhcp4_server_lease_get_yiaddr() - get the address of a lease
+ * @lease:              lease to operate on
+ * @yiaddr:             output argument for the leased address
+ */
+_c_public_ void n_dhcp4_server_lease_get_yiaddr(NDhcp4ServerLease *lease, struct in_addr *yiaddr) {
+        *yiaddr = lease->address;
+}
+
+/**
+ * n_dhcp4_server_lease_get_lifetime() - get the expiry time of a lease
+ * @lease:              lease to operate on
+ * @lifetime:           output argument for the expiry time
+ *
+ * The expiry time is an absolute timestamp in nanoseconds, based on
+ * CLOCK_BOOTTIME, like for client leases.
+ */
+_c_public_ void n_dhcp4_server_lease_get_lifetime(NDhcp4ServerLease *lease, uint64_t *lifetime) {
+        *lifetime = lease->lifetime;
+}
+
+/**
+ * n_dhcp4_server_lease_get_client_id() - get the client identifier of a lease
+ * @lease:              lease to operate on
+ * @idp:                output argument for the client identifier
+ * @n_idp:              output argument for the length of the identifier
+ *
+ * If the client did not send a client identifier option, the identifier is
+ * derived from its hardware type and address, as suggested by RFC-2132.
+ * The returned data is owned by the lease.
+ */
+_c_public_ void n_dhcp4_server_lease_get_client_id(NDhcp4ServerLease *lease,
+                                                   const uint8_t **idp,
+                                                   size_t *n_idp) {
+        *idp = lease->client_id;
+        *n_idp = lease->n_client_id;
+}
+
 /**
  * n_dhcp4_server_lease_query() - XXX
  */
 _c_public_ int n_dhcp4_server_lease_query(NDhcp4ServerLease *lease, uint8_t option, uint8_t **datap, size_t *n_datap) {
+        if (!lease->request)
+                return N_DHCP4_E_UNSET;
+
         switch (option) {
         case N_DHCP4_OPTION_PAD:
         case N_DHCP4_OPTION_REQUESTED_IP_ADDRESS:
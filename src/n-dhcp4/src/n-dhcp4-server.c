@@ -6,10 +6,12 @@
 
 #include <assert.h>
 #include <c-list.h>
+#include <c-siphash.h>
 #include <c-stdaux.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/auxv.h>
 #include <sys/epoll.h>
 #include <sys/time.h>
 #include <sys/timerfd.h>
@@ -43,6 +45,9 @@ _c_public_ NDhcp4ServerConfig *n_dhcp4_server_config_free(NDhcp4ServerConfig *co
         if (!config)
                 return NULL;
 
+        for (unsigned int i = 0; i <= UINT8_MAX; ++i)
+                free(config->options[i]);
+
         free(config);
 
         return NULL;
@@ -55,10 +60,105 @@ _c_public_ void n_dhcp4_server_config_set_ifindex(NDhcp4ServerConfig *config, in
         config->ifindex = ifindex;
 }
 
+/**
+ * n_dhcp4_server_config_set_range() - set the address pool
+ * @config:                     configuration to operate on
+ * @start:                      first address of the pool
+ * @end:                        last address of the pool
+ *
+ * This sets the range of addresses the server hands out to clients. Both
+ * @start and @end are inclusive. The server never hands out its own
+ * address, even if it is part of the range. The pool may contain at most
+ * 65536 addresses. Without a pool, the server does not answer any requests.
+ *
+ * Return: 0 on success, N_DHCP4_E_INVALID_ADDRESS if the range is invalid.
+ */
+_c_public_ int n_dhcp4_server_config_set_range(NDhcp4ServerConfig *config,
+                                               struct in_addr start,
+                                               struct in_addr end) {
+        uint32_t u_start = ntohl(start.s_addr), u_end = ntohl(end.s_addr);
+
+        if (!u_start || u_end < u_start || u_end - u_start >= N_DHCP4_SERVER_RANGE_MAX)
+                return N_DHCP4_E_INVALID_ADDRESS;
+
+        config->range_start = start;
+        config->range_end = end;
+        return 0;
+}
+
+/**
+ * n_dhcp4_server_config_set_lifetime() - set the lease lifetime
+ * @config:                     configuration to operate on
+ * @lifetime:                   lifetime in seconds
+ *
+ * This sets the lifetime of leases granted to clients. Renewal and rebinding
+ * times are derived from it as suggested by RFC-2131. A value of 0 selects
+ * the default of one hour.
+ */
+_c_public_ void n_dhcp4_server_config_set_lifetime(NDhcp4ServerConfig *config, uint32_t lifetime) {
+        config->lifetime = lifetime ? lifetime : N_DHCP4_SERVER_LIFETIME_DEFAULT;
+}
+
+/**
+ * n_dhcp4_server_config_append_option() - append option to outgoing replies
+ * @config:                     configuration to operate on
+ * @option:                     DHCP option number
+ * @data:                       payload
+ * @n_data:                     number of bytes in payload
+ *
+ * This sets extra options, like the subnet mask, routers or name servers,
+ * that are appended verbatim to all OFFER and ACK messages of the server.
+ * Options that do not fit into a reply are silently skipped.
+ *
+ * No option may be appended more than once. Options considered internal
+ * to the DHCP protocol may not be appended.
+ *
+ * Return: 0 on success, N_DHCP4_E_DUPLICATE_OPTION if an option has already been
+ *         appended, N_DHCP4_E_INTERNAL if the option is not configurable, or
+ *         a negative error code on failure.
+ */
+_c_public_ int n_dhcp4_server_config_append_option(NDhcp4ServerConfig *config,
+                                                   uint8_t option,
+                                                   const void *data,
+                                                   uint8_t n_data) {
+        NDhcp4ServerOption *op;
+
+        switch (option) {
+        case N_DHCP4_OPTION_PAD:
+        case N_DHCP4_OPTION_REQUESTED_IP_ADDRESS:
+        case N_DHCP4_OPTION_IP_ADDRESS_LEASE_TIME:
+        case N_DHCP4_OPTION_OVERLOAD:
+        case N_DHCP4_OPTION_MESSAGE_TYPE:
+        case N_DHCP4_OPTION_SERVER_IDENTIFIER:
+        case N_DHCP4_OPTION_PARAMETER_REQUEST_LIST:
+        case N_DHCP4_OPTION_ERROR_MESSAGE:
+        case N_DHCP4_OPTION_MAXIMUM_MESSAGE_SIZE:
+        case N_DHCP4_OPTION_RENEWAL_T1_TIME:
+        case N_DHCP4_OPTION_REBINDING_T2_TIME:
+        case N_DHCP4_OPTION_CLIENT_IDENTIFIER:
+        case N_DHCP4_OPTION_END:
+                return N_DHCP4_E_INTERNAL;
+        }
+
+        if (config->options[option])
+                return N_DHCP4_E_DUPLICATE_OPTION;
+
+        op = malloc(sizeof(*op) + n_data);
+        if (!op)
+                return -ENOMEM;
+
+        op->option = option;
+        op->n_data = n_data;
+        memcpy(op->data, data, n_data);
+
+        config->options[option] = op;
+        return 0;
+}
+
 /**
  * n_dhcp4_s_event_node_new() - XXX
  */
-int n_dhcp4_s_event_node_new(NDhcp4SEventNode **nodep) {
+static int n_dhcp4_s_event_node_new(NDhcp4SEventNode **nodep) {
         NDhcp4SEventNode *node;
 
         node = calloc(1, sizeof(*node));
@@ -74,16 +174,44 @@ int n_dhcp4_s_event_node_new(NDhcp4SEventNode **nodep) {
 /**
  * n_dhcp4_s_event_node_free() - XXX
  */
-NDhcp4SEventNode *n_dhcp4_s_event_node_free(NDhcp4SEventNode *node) {
+static NDhcp4SEventNode *n_dhcp4_s_event_node_free(NDhcp4SEventNode *node) {
         if (!node)
                 return NULL;
 
+        switch (node->event.event) {
+        case N_DHCP4_SERVER_EVENT_DISCOVER:
+        case N_DHCP4_SERVER_EVENT_REQUEST:
+        case N_DHCP4_SERVER_EVENT_RENEW:
+        case N_DHCP4_SERVER_EVENT_DECLINE:
+        case N_DHCP4_SERVER_EVENT_RELEASE:
+                /* all lease events share the same layout */
+                n_dhcp4_server_lease_unref(node->event.request.lease);
+                break;
+        }
+
         c_list_unlink(&node->server_link);
         free(node);
 
         return NULL;
 }
 
+static void n_dhcp4_server_initialize_hash_seed(NDhcp4Server *server) {
+        const uint8_t *p;
+
+        /*
+         * The lease table is keyed by client identifiers, which are chosen
+         * by the clients. Seed the hash from AT_RANDOM so clients on the
+         * network cannot force collisions. The server address is mixed in
+         * to avoid identical seeds for servers within the same process.
+         */
+        p = (const uint8_t *)getauxval(AT_RANDOM);
+        if (p)
+                memcpy(server->hash_seed, p, sizeof(server->hash_seed));
+
+        for (size_t i = 0; i < sizeof(server); ++i)
+                server->hash_seed[i] ^= ((const uint8_t *)&server)[i];
+}
+
 /**
  * n_dhcp4_server_new() - XXX
  */
@@ -99,6 +227,38 @@ _c_public_ int n_dhcp4_server_new(NDhcp4Server **serverp, NDhcp4ServerConfig *co
 
         *server = (NDhcp4Server)N_DHCP4_SERVER_NULL(*server);
 
+        server->lifetime = config->lifetime;
+        if (config->range_start.s_addr) {
+                server->range_start = ntohl(config->range_start.s_addr);
+                server->n_range = ntohl(config->range_end.s_addr) - server->range_start + 1;
+
+                server->lease_map = calloc(server->n_range, sizeof(*server->lease_map));
+                if (!server->lease_map)
+                        return -ENOMEM;
+        }
+
+        server->n_lease_buckets = 16;
+        server->lease_buckets = malloc(server->n_lease_buckets * sizeof(*server->lease_buckets));
+        if (!server->lease_buckets)
+                return -ENOMEM;
+        for (size_t i = 0; i < server->n_lease_buckets; ++i)
+                c_list_init(&server->lease_buckets[i]);
+
+        for (unsigned int i = 0; i <= UINT8_MAX; ++i) {
+                const NDhcp4ServerOption *op = config->options[i];
+
+                if (!op)
+                        continue;
+
+                server->options[i] = malloc(sizeof(*op) + op->n_data);
+                if (!server->options[i])
+                        return -ENOMEM;
+
+                memcpy(server->options[i], op, sizeof(*op) + op->n_data);
+        }
+
+        n_dhcp4_server_initialize_hash_seed(server);
+
         r = n_dhcp4_s_connection_init(&server->connection, config->ifindex);
         if (r)
                 return r;
@@ -110,10 +270,20 @@ _c_public_ int n_dhcp4_server_new(NDhcp4Server **serverp, NDhcp4ServerConfig *co
 
 static void n_dhcp4_server_free(NDhcp4Server *server) {
         NDhcp4SEventNode *node, *t_node;
+        NDhcp4ServerLease *lease, *t_lease;
 
         c_list_for_each_entry_safe(node, t_node, &server->event_list, server_link)
                 n_dhcp4_s_event_node_free(node);
 
+        c_list_for_each_entry_safe(lease, t_lease, &server->lease_list, server_link)
+                n_dhcp4_server_lease_unlink(lease);
+
+        for (unsigned int i = 0; i <= UINT8_MAX; ++i)
+                free(server->options[i]);
+
+        n_dhcp4_s_connection_deinit(&server->connection);
+        free(server->lease_buckets);
+        free(server->lease_map);
         free(server);
 }
 
@@ -138,7 +308,7 @@ _c_public_ NDhcp4Server *n_dhcp4_server_unref(NDhcp4Server *server) {
 /**
  * n_dhcp4_server_raise() - XXX
  */
-int n_dhcp4_server_raise(NDhcp4Server *server, NDhcp4SEventNode **nodep, unsigned int event) {
+static int n_dhcp4_server_raise(NDhcp4Server *server, NDhcp4SEventNode **nodep, unsigned int event) {
         NDhcp4SEventNode *node;
         int r;
 
@@ -161,6 +331,492 @@ _c_public_ void n_dhcp4_server_get_fd(NDhcp4Server *server, int *fdp) {
         n_dhcp4_s_connection_get_fd(&server->connection, fdp);
 }
 
+static int n_dhcp4_server_raise_lease(NDhcp4Server *server, unsigned int event, NDhcp4ServerLease *lease) {
+        NDhcp4SEventNode *node;
+        int r;
+
+        r = n_dhcp4_server_raise(server, &node, event);
+        if (r)
+                return r;
+
+        /* all lease events share the same layout */
+        node->event.request.lease = n_dhcp4_server_lease_ref(lease);
+        return 0;
+}
+
+static bool n_dhcp4_server_lease_is_expired(NDhcp4ServerLease *lease, uint64_t now) {
+        return lease->lifetime <= now;
+}
+
+static bool n_dhcp4_server_get_offset(NDhcp4Server *server, struct in_addr addr, uint32_t *offsetp) {
+        uint32_t offset = ntohl(addr.s_addr) - server->range_start;
+
+        /* relies on unsigned wrap-around for addresses below the pool */
+        if (offset >= server->n_range)
+                return false;
+
+        if (server->connection.ip && server->connection.ip->ip.s_addr == addr.s_addr)
+                return false;
+
+        *offsetp = offset;
+        return true;
+}
+
+static void n_dhcp4_server_get_client_id(NDhcp4Incoming *message,
+                                         uint8_t *buf,
+                                         const uint8_t **idp,
+                                         size_t *n_idp) {
+        NDhcp4Header *header = n_dhcp4_incoming_get_header(message);
+        uint8_t *id;
+        size_t n_id;
+        int r;
+
+        r = n_dhcp4_incoming_query(message, N_DHCP4_OPTION_CLIENT_IDENTIFIER, &id, &n_id);
+        if (!r && n_id > 0) {
+                *idp = id;
+                *n_idp = n_id;
+                return;
+        }
+
+        /*
+         * Without a client identifier, clients are identified by their
+         * hardware type and address, which is the format RFC-2132 suggests
+         * for client identifiers in the first place.
+         */
+        n_id = header->hlen < sizeof(header->chaddr) ? header->hlen : sizeof(header->chaddr);
+        buf[0] = header->htype;
+        memcpy(buf + 1, header->chaddr, n_id);
+
+        *idp = buf;
+        *n_idp = n_id + 1;
+}
+
+static uint64_t n_dhcp4_server_hash_client_id(NDhcp4Server *server, const uint8_t *id, size_t n_id) {
+        return c_siphash_hash(server->hash_seed, id, n_id);
+}
+
+static NDhcp4ServerLease *n_dhcp4_server_find_lease(NDhcp4Server *server,
+                                                    const uint8_t *id,
+                                                    size_t n_id,
+                                                    uint64_t hash) {
+        NDhcp4ServerLease *lease;
+
+        c_list_for_each_entry(lease,
+                              &server->lease_buckets[hash & (server->n_lease_buckets - 1)],
+                              bucket_link) {
+                if (lease->hash == hash &&
+                    lease->n_client_id == n_id &&
+                    !memcmp(lease->client_id, id, n_id))
+                        return lease;
+        }
+
+        return NULL;
+}
+
+static int n_dhcp4_server_rehash(NDhcp4Server *server) {
+        NDhcp4ServerLease *lease;
+        CList *buckets;
+        size_t n_buckets;
+
+        /* keep the load factor of the client table at or below 1 */
+        if (server->n_leases < server->n_lease_buckets)
+                return 0;
+
+        n_buckets = server->n_lease_buckets * 2;
+        buckets = malloc(n_buckets * sizeof(*buckets));
+        if (!buckets)
+                return -ENOMEM;
+
+        for (size_t i = 0; i < n_buckets; ++i)
+                c_list_init(&buckets[i]);
+
+        c_list_for_each_entry(lease, &server->lease_list, server_link) {
+                if (!c_list_is_linked(&lease->bucket_link))
+                        continue;
+
+                c_list_unlink(&lease->bucket_link);
+                c_list_link_tail(&buckets[lease->hash & (n_buckets - 1)], &lease->bucket_link);
+        }
+
+        free(server->lease_buckets);
+        server->lease_buckets = buckets;
+        server->n_lease_buckets = n_buckets;
+        return 0;
+}
+
+/*
+ * Returns true if the pool slot at @offset is free, reclaiming an expired lease
+ * occupying it, if any.
+ */
+static bool n_dhcp4_server_reclaim(NDhcp4Server *server, uint32_t offset, uint64_t now) {
+        NDhcp4ServerLease *lease = server->lease_map[offset];
+
+        if (!lease)
+                return true;
+
+        if (!n_dhcp4_server_lease_is_expired(lease, now))
+                return false;
+
+        n_dhcp4_server_lease_unlink(lease);
+        return true;
+}
+
+static int n_dhcp4_server_insert_lease(NDhcp4Server *server,
+                                       NDhcp4ServerLease **leasep,
+                                       const uint8_t *id,
+                                       size_t n_id,
+                                       uint64_t hash,
+                                       uint32_t offset,
+                                       unsigned int state,
+                                       uint64_t lifetime) {
+        _c_cleanup_(n_dhcp4_server_lease_unrefp) NDhcp4ServerLease *lease = NULL;
+        int r;
+
+        r = n_dhcp4_server_rehash(server);
+        if (r)
+                return r;
+
+        r = n_dhcp4_server_lease_new(&lease, id, n_id, hash);
+        if (r)
+                return r;
+
+        lease->state = state;
+        lease->lifetime = lifetime;
+        lease->address.s_addr = htonl(server->range_start + offset);
+
+        n_dhcp4_server_lease_link(lease, server, offset);
+
+        /* the server holds a reference now */
+        *leasep = lease;
+        return 0;
+}
+
+/*
+ * Moves @lease of a client to the slot at @offset, or creates a new lease for
+ * the client if it has none. The slot must be free.
+ */
+static int n_dhcp4_server_assign(NDhcp4Server *server,
+                                 NDhcp4ServerLease **leasep,
+                                 NDhcp4ServerLease *lease,
+                                 const uint8_t *id,
+                                 size_t n_id,
+                                 uint64_t hash,
+                                 uint32_t offset,
+                                 unsigned int state,
+                                 uint64_t lifetime) {
+        if (lease)
+                n_dhcp4_server_lease_unlink(lease);
+
+        return n_dhcp4_server_insert_lease(server, leasep, id, n_id, hash, offset, state, lifetime);
+}
+
+static int n_dhcp4_server_allocate(NDhcp4Server *server, uint32_t *offsetp, uint64_t now) {
+        uint32_t offset;
+
+        /*
+         * Scan the pool starting at the allocation cursor. Addresses are thus
+         * handed out round-robin, which keeps recently released addresses
+         * unused for as long as possible, and reclaims expired leases on the
+         * way. The first pass only takes free slots, so expired leases stay
+         * available to returning clients while the pool is not exhausted.
+         */
+        for (unsigned int pass = 0; pass < 2; ++pass) {
+                for (uint32_t i = 0; i < server->n_range; ++i) {
+                        struct in_addr addr;
+
+                        offset = (server->i_range + i) % server->n_range;
+                        addr.s_addr = htonl(server->range_start + offset);
+                        if (!n_dhcp4_server_get_offset(server, addr, &offset))
+                                continue;
+
+                        if (pass == 0 ? !!server->lease_map[offset]
+                                      : !n_dhcp4_server_reclaim(server, offset, now))
+                                continue;
+
+                        server->i_range = (offset + 1) % server->n_range;
+                        *offsetp = offset;
+                        return 0;
+                }
+        }
+
+        return N_DHCP4_E_NO_SPACE;
+}
+
+static int n_dhcp4_server_send(NDhcp4Server *server,
+                               NDhcp4Incoming *request,
+                               NDhcp4ServerLease *lease,
+                               uint8_t type) {
+        _c_cleanup_(n_dhcp4_outgoing_freep) NDhcp4Outgoing *reply = NULL;
+        const struct in_addr *server_addr = &server->connection.ip->ip;
+        int r;
+
+        switch (type) {
+        case N_DHCP4_MESSAGE_OFFER:
+                r = n_dhcp4_s_connection_offer_new(&server->connection,
+                                                   &reply,
+                                                   request,
+                                                   server_addr,
+                                                   &lease->address,
+                                                   server->lifetime);
+                break;
+        case N_DHCP4_MESSAGE_ACK:
+                r = n_dhcp4_s_connection_ack_new(&server->connection,
+                                                 &reply,
+                                                 request,
+                                                 server_addr,
+                                                 &lease->address,
+                                                 server->lifetime);
+                break;
+        default:
+                c_assert(type == N_DHCP4_MESSAGE_NAK);
+                r = n_dhcp4_s_connection_nak_new(&server->connection,
+                                                 &reply,
+                                                 request,
+                                                 server_addr);
+                break;
+        }
+        if (r)
+                return r;
+
+        if (type != N_DHCP4_MESSAGE_NAK) {
+                for (unsigned int i = 0; i <= UINT8_MAX; ++i) {
+                        const NDhcp4ServerOption *op = server->options[i];
+
+                        if (!op)
+                                continue;
+
+                        r = n_dhcp4_outgoing_append(reply, op->option, op->data, op->n_data);
+                        if (r && r != N_DHCP4_E_NO_SPACE)
+                                return r;
+                }
+        }
+
+        r = n_dhcp4_s_connection_send_reply(&server->connection, server_addr, reply);
+        if (r) {
+                if (r == N_DHCP4_E_DROPPED || r == N_DHCP4_E_DOWN)
+                        return 0;
+                return r;
+        }
+
+        return 0;
+}
+
+static int n_dhcp4_server_handle_discover(NDhcp4Server *server,
+                                          NDhcp4Incoming *message,
+                                          const uint8_t *id,
+                                          size_t n_id,
+                                          uint64_t hash,
+                                          uint64_t now) {
+        NDhcp4ServerLease *lease;
+        struct in_addr requested;
+        uint32_t offset;
+        int r;
+
+        lease = n_dhcp4_server_find_lease(server, id, n_id, hash);
+        if (lease) {
+                /*
+                 * Returning clients get their previous address. An unbound
+                 * offer is refreshed, a binding stays untouched until the
+                 * client confirms it with a REQUEST.
+                 */
+                if (lease->state == N_DHCP4_SERVER_LEASE_STATE_OFFERED)
+                        lease->lifetime = now + N_DHCP4_SERVER_OFFER_TIMEOUT;
+        } else {
+                r = n_dhcp4_incoming_query_requested_ip(message, &requested);
+                if (r || !n_dhcp4_server_get_offset(server, requested, &offset) ||
+                    !n_dhcp4_server_reclaim(server, offset, now)) {
+                        r = n_dhcp4_server_allocate(server, &offset, now);
+                        if (r) {
+                                if (r == N_DHCP4_E_NO_SPACE)
+                                        return 0;
+                                return r;
+                        }
+                }
+
+                r = n_dhcp4_server_insert_lease(server,
+                                                &lease,
+                                                id,
+                                                n_id,
+                                                hash,
+                                                offset,
+                                                N_DHCP4_SERVER_LEASE_STATE_OFFERED,
+                                                now + N_DHCP4_SERVER_OFFER_TIMEOUT);
+                if (r)
+                        return r;
+        }
+
+        return n_dhcp4_server_send(server, message, lease, N_DHCP4_MESSAGE_OFFER);
+}
+
+static int n_dhcp4_server_handle_request(NDhcp4Server *server,
+                                         NDhcp4Incoming **messagep,
+                                         const uint8_t *id,
+                                         size_t n_id,
+                                         uint64_t hash,
+                                         uint64_t now) {
+        NDhcp4Incoming *message = *messagep;
+        NDhcp4Header *header = n_dhcp4_incoming_get_header(message);
+        NDhcp4ServerLease *lease;
+        struct in_addr requested;
+        unsigned int event;
+        uint32_t offset;
+        int r;
+
+        if (message->userdata.type == N_DHCP4_C_MESSAGE_RENEW ||
+            message->userdata.type == N_DHCP4_C_MESSAGE_REBIND) {
+                requested.s_addr = header->ciaddr;
+        } else {
+                r = n_dhcp4_incoming_query_requested_ip(message, &requested);
+                if (r)
+                        return 0;
+        }
+
+        lease = n_dhcp4_server_find_lease(server, id, n_id, hash);
+        if (message->userdata.type == N_DHCP4_C_MESSAGE_SELECT) {
+                /* a client may only select what it was offered */
+                if (!lease || lease->address.s_addr != requested.s_addr)
+                        return n_dhcp4_server_send(server, message, NULL, N_DHCP4_MESSAGE_NAK);
+        } else if (!lease || lease->address.s_addr != requested.s_addr) {
+                /*
+                 * The client has a lease we do not know about. We are
+                 * authoritative for the pool, so accept it if the address is
+                 * free, as happens if the lease database was lost. Otherwise
+                 * tell the client to restart.
+                 */
+                if (!n_dhcp4_server_get_offset(server, requested, &offset) ||
+                    !n_dhcp4_server_reclaim(server, offset, now))
+                        return n_dhcp4_server_send(server, message, NULL, N_DHCP4_MESSAGE_NAK);
+
+                r = n_dhcp4_server_assign(server,
+                                          &lease,
+                                          lease,
+                                          id,
+                                          n_id,
+                                          hash,
+                                          offset,
+                                          N_DHCP4_SERVER_LEASE_STATE_OFFERED,
+                                          now);
+                if (r)
+                        return r;
+        }
+
+        if (lease->state == N_DHCP4_SERVER_LEASE_STATE_BOUND)
+                event = N_DHCP4_SERVER_EVENT_RENEW;
+        else
+                event = N_DHCP4_SERVER_EVENT_REQUEST;
+
+        lease->state = N_DHCP4_SERVER_LEASE_STATE_BOUND;
+        lease->lifetime = now + (uint64_t)server->lifetime * UINT64_C(1000000000);
+
+        r = n_dhcp4_server_send(server, message, lease, N_DHCP4_MESSAGE_ACK);
+        if (r)
+                return r;
+
+        n_dhcp4_server_lease_set_request(lease, message);
+        *messagep = NULL;
+
+        return n_dhcp4_server_raise_lease(server, event, lease);
+}
+
+static int n_dhcp4_server_handle_ignore(NDhcp4Server *server,
+                                        const uint8_t *id,
+                                        size_t n_id,
+                                        uint64_t hash) {
+        NDhcp4ServerLease *lease;
+
+        /* the client selected another server, drop our offer */
+        lease = n_dhcp4_server_find_lease(server, id, n_id, hash);
+        if (lease && lease->state == N_DHCP4_SERVER_LEASE_STATE_OFFERED)
+                n_dhcp4_server_lease_unlink(lease);
+
+        return 0;
+}
+
+static int n_dhcp4_server_handle_decline(NDhcp4Server *server,
+                                         NDhcp4Incoming *message,
+                                         const uint8_t *id,
+                                         size_t n_id,
+                                         uint64_t hash,
+                                         uint64_t now) {
+        NDhcp4ServerLease *lease;
+        struct in_addr requested;
+        int r;
+
+        r = n_dhcp4_incoming_query_requested_ip(message, &requested);
+        if (r)
+                return 0;
+
+        lease = n_dhcp4_server_find_lease(server, id, n_id, hash);
+        if (!lease || lease->address.s_addr != requested.s_addr)
+                return 0;
+
+        /*
+         * The address is in use by someone else. Quarantine it, detached
+         * from the client, so the client gets a new address on its next
+         * DISCOVER.
+         */
+        c_list_unlink(&lease->bucket_link);
+        lease->state = N_DHCP4_SERVER_LEASE_STATE_DECLINED;
+        lease->lifetime = now + N_DHCP4_SERVER_DECLINE_TIMEOUT;
+
+        return n_dhcp4_server_raise_lease(server, N_DHCP4_SERVER_EVENT_DECLINE, lease);
+}
+
+static int n_dhcp4_server_handle_release(NDhcp4Server *server,
+                                         NDhcp4Incoming *message,
+                                         const uint8_t *id,
+                                         size_t n_id,
+                                         uint64_t hash) {
+        NDhcp4Header *header = n_dhcp4_incoming_get_header(message);
+        NDhcp4ServerLease *lease;
+        int r;
+
+        lease = n_dhcp4_server_find_lease(server, id, n_id, hash);
+        if (!lease || lease->address.s_addr != header->ciaddr)
+                return 0;
+
+        r = n_dhcp4_server_raise_lease(server, N_DHCP4_SERVER_EVENT_RELEASE, lease);
+        if (r)
+                return r;
+
+        n_dhcp4_server_lease_unlink(lease);
+        return 0;
+}
+
+static int n_dhcp4_server_handle(NDhcp4Server *server, NDhcp4Incoming **messagep) {
+        uint8_t buf[1 + sizeof(((NDhcp4Header *)NULL)->chaddr)];
+        NDhcp4Incoming *message = *messagep;
+        const uint8_t *id;
+        uint64_t hash, now;
+        size_t n_id;
+
+        /* we cannot answer without an address to send from */
+        if (!server->connection.ip || !server->n_range)
+                return 0;
+
+        n_dhcp4_server_get_client_id(message, buf, &id, &n_id);
+        hash = n_dhcp4_server_hash_client_id(server, id, n_id);
+        now = n_dhcp4_gettime(CLOCK_BOOTTIME);
+
+        switch (message->userdata.type) {
+        case N_DHCP4_C_MESSAGE_DISCOVER:
+                return n_dhcp4_server_handle_discover(server, message, id, n_id, hash, now);
+        case N_DHCP4_C_MESSAGE_SELECT:
+        case N_DHCP4_C_MESSAGE_REBOOT:
+        case N_DHCP4_C_MESSAGE_RENEW:
+        case N_DHCP4_C_MESSAGE_REBIND:
+                return n_dhcp4_server_handle_request(server, messagep, id, n_id, hash, now);
+        case N_DHCP4_C_MESSAGE_IGNORE:
+                return n_dhcp4_server_handle_ignore(server, id, n_id, hash);
+        case N_DHCP4_C_MESSAGE_DECLINE:
+                return n_dhcp4_server_handle_decline(server, message, id, n_id, hash, now);
+        case N_DHCP4_C_MESSAGE_RELEASE:
+                return n_dhcp4_server_handle_release(server, message, id, n_id, hash);
+        default:
+                return 0;
+        }
+}
+
 /**
  * n_dhcp4_server_dispatch() - XXX
  */
@@ -176,6 +832,13 @@ _c_public_ int n_dhcp4_server_dispatch(NDhcp4Server *server) {
                                 return 0;
                         return r;
                 }
+
+                if (!message)
+                        continue;
+
+                r = n_dhcp4_server_handle(server, &message);
+                if (r)
+                        return r;
         }
 
         return N_DHCP4_E_PREEMPTED;
@@ -239,3 +902,84 @@ _c_public_ NDhcp4ServerIp *n_dhcp4_server_ip_free(NDhcp4ServerIp *ip) {
         free(ip);
         return NULL;
 }
+
+/**
+ * n_dhcp4_server_add_lease() - restore a lease
+ * @server:                     server to operate on
+ * @client_id:                  client identifier of the lease
+ * @n_client_id:                length of @client_id in bytes
+ * @address:                    leased address
+ * @lifetime:                   expiry time, CLOCK_BOOTTIME nsecs
+ *
+ * This adds a bound lease to the lease table of the server, as previously
+ * obtained from n_dhcp4_server_next_lease() and the lease accessors. It is
+ * meant to restore persisted leases when a server is restarted, so clients
+ * keep their addresses. Any lease the client holds already is replaced.
+ *
+ * Return: 0 on success, N_DHCP4_E_INVALID_ADDRESS if @address is not part of
+ *         the address pool, N_DHCP4_E_INVALID_CLIENT_ID if @client_id is
+ *         empty, -EBUSY if the address is leased to another client, or a
+ *         negative error code on failure.
+ */
+_c_public_ int n_dhcp4_server_add_lease(NDhcp4Server *server,
+                                        const uint8_t *client_id,
+                                        size_t n_client_id,
+                                        struct in_addr address,
+                                        uint64_t lifetime) {
+        NDhcp4ServerLease *lease;
+        uint64_t hash, now;
+        uint32_t offset;
+
+        if (!n_client_id)
+                return N_DHCP4_E_INVALID_CLIENT_ID;
+
+        if (!n_dhcp4_server_get_offset(server, address, &offset))
+                return N_DHCP4_E_INVALID_ADDRESS;
+
+        now = n_dhcp4_gettime(CLOCK_BOOTTIME);
+        hash = n_dhcp4_server_hash_client_id(server, client_id, n_client_id);
+        lease = n_dhcp4_server_find_lease(server, client_id, n_client_id, hash);
+
+        if (lease != server->lease_map[offset] && !n_dhcp4_server_reclaim(server, offset, now))
+                return -EBUSY;
+
+        return n_dhcp4_server_assign(server,
+                                     &lease,
+                                     lease,
+                                     client_id,
+                                     n_client_id,
+                                     hash,
+                                     offset,
+                                     N_DHCP4_SERVER_LEASE_STATE_BOUND,
+                                     lifetime);
+}
+
+/**
+ * n_dhcp4_server_next_lease() - iterate bound leases
+ * @server:                     server to operate on
+ * @lease:                      previous lease, or NULL to start iterating
+ *
+ * This iterates over all leases that are currently bound to a client and not
+ * expired. Offered and declined addresses are skipped. The returned lease is
+ * owned by the server and stays valid until the next call into the server.
+ *
+ * Return: The next bound lease, or NULL at the end of the table.
+ */
+_c_public_ NDhcp4ServerLease *n_dhcp4_server_next_lease(NDhcp4Server *server, NDhcp4ServerLease *lease) {
+        uint64_t now = n_dhcp4_gettime(CLOCK_BOOTTIME);
+        CList *iter;
+
+        c_assert(!lease || lease->server == server);
+
+        for (iter = lease ? lease->server_link.next : server->lease_list.next;
+             iter != &server->lease_list;
+             iter = iter->next) {
+                lease = c_list_entry(iter, NDhcp4ServerLease, server_link);
+
+                if (lease->state == N_DHCP4_SERVER_LEASE_STATE_BOUND &&
+                    !n_dhcp4_server_lease_is_expired(lease, now))
+                        return lease;
+        }
+
+        return NULL;
+}
@@ -29,7 +29,8 @@
  * packets before an IP address has been configured.
  *
  * Only unfragmented DHCP packets from a server to a client destined for the given
- * ifindex is returned.
+ * ifindex is returned. If @ifindex is 0, packets from all interfaces are
+ * returned, see n_dhcp4_c_socket_packet_recvfrom().
  *
  * Return: 0 on success, or a negative error code on failure.
  */
@@ -562,11 +563,19 @@ int n_dhcp4_c_socket_packet_recv(int sockfd,
                                  uint8_t *buf,
                                  size_t n_buf,
                                  NDhcp4Incoming **messagep) {
+        return n_dhcp4_c_socket_packet_recvfrom(sockfd, buf, n_buf, messagep, NULL);
+}
+
+int n_dhcp4_c_socket_packet_recvfrom(int sockfd,
+                                     uint8_t *buf,
+                                     size_t n_buf,
+                                     NDhcp4Incoming **messagep,
+                                     int *ifindexp) {
         _c_cleanup_(n_dhcp4_incoming_freep) NDhcp4Incoming *message = NULL;
         size_t len;
         int r;
 
-        r = packet_recv_udp(sockfd, buf, n_buf, &len);
+        r = packet_recvfrom_udp(sockfd, buf, n_buf, &len, NULL, ifindexp);
         if (r < 0) {
                 if (r == -ENETDOWN)
                         return N_DHCP4_E_DOWN;
@@ -20,6 +20,7 @@ extern "C" {
 typedef struct NDhcp4Client NDhcp4Client;
 typedef struct NDhcp4ClientConfig NDhcp4ClientConfig;
 typedef struct NDhcp4ClientEvent NDhcp4ClientEvent;
+typedef struct NDhcp4ClientHub NDhcp4ClientHub;
 typedef struct NDhcp4ClientLease NDhcp4ClientLease;
 typedef struct NDhcp4ClientProbe NDhcp4ClientProbe;
 typedef struct NDhcp4ClientProbeConfig NDhcp4ClientProbeConfig;
@@ -105,7 +106,7 @@ struct NDhcp4ServerEvent {
                 } down;
                 struct {
                         NDhcp4ServerLease *lease;
-                } discover, request, decline, release;
+                } discover, request, renew, decline, release;
         };
 };
 
@@ -120,6 +121,16 @@ void n_dhcp4_client_config_set_request_broadcast(NDhcp4ClientConfig *config, boo
 void n_dhcp4_client_config_set_mac(NDhcp4ClientConfig *config, const uint8_t *mac, size_t n_mac);
 void n_dhcp4_client_config_set_broadcast_mac(NDhcp4ClientConfig *config, const uint8_t *mac, size_t n_mac);
 int n_dhcp4_client_config_set_client_id(NDhcp4ClientConfig *config, const uint8_t *id, size_t n_id);
+void n_dhcp4_client_config_set_hub(NDhcp4ClientConfig *config, NDhcp4ClientHub *hub);
+
+/* client hubs */
+
+int n_dhcp4_client_hub_new(NDhcp4ClientHub **hubp);
+NDhcp4ClientHub *n_dhcp4_client_hub_ref(NDhcp4ClientHub *hub);
+NDhcp4ClientHub *n_dhcp4_client_hub_unref(NDhcp4ClientHub *hub);
+
+void n_dhcp4_client_hub_get_fd(NDhcp4ClientHub *hub, int *fdp);
+int n_dhcp4_client_hub_dispatch(NDhcp4ClientHub *hub);
 
 /* client-probe configs */
 
@@ -186,6 +197,9 @@ int n_dhcp4_server_config_new(NDhcp4ServerConfig **configp);
 NDhcp4ServerConfig *n_dhcp4_server_config_free(NDhcp4ServerConfig *config);
 
 void n_dhcp4_server_config_set_ifindex(NDhcp4ServerConfig *config, int ifindex);
+int n_dhcp4_server_config_set_range(NDhcp4ServerConfig *config, struct in_addr start, struct in_addr end);
+void n_dhcp4_server_config_set_lifetime(NDhcp4ServerConfig *config, uint32_t lifetime);
+int n_dhcp4_server_config_append_option(NDhcp4ServerConfig *config, uint8_t option, const void *data, uint8_t n_data);
 
 /* servers */
 
@@ -198,6 +212,12 @@ int n_dhcp4_server_dispatch(NDhcp4Server *server);
 int n_dhcp4_server_pop_event(NDhcp4Server *server, NDhcp4ServerEvent **eventp);
 
 int n_dhcp4_server_add_ip(NDhcp4Server *server, NDhcp4ServerIp **ipp, struct in_addr ip);
+int n_dhcp4_server_add_lease(NDhcp4Server *server,
+                             const uint8_t *client_id,
+                             size_t n_client_id,
+                             struct in_addr address,
+                             uint64_t lifetime);
+NDhcp4ServerLease *n_dhcp4_server_next_lease(NDhcp4Server *server, NDhcp4ServerLease *lease);
 
 /* server ip addresses */
 
@@ -208,6 +228,9 @@ NDhcp4ServerIp *n_dhcp4_server_ip_free(NDhcp4ServerIp *ip);
 NDhcp4ServerLease *n_dhcp4_server_lease_ref(NDhcp4ServerLease *lease);
 NDhcp4ServerLease *n_dhcp4_server_lease_unref(NDhcp4ServerLease *lease);
 
+void n_dhcp4_server_lease_get_yiaddr(NDhcp4ServerLease *lease, struct in_addr *yiaddr);
+void n_dhcp4_server_lease_get_lifetime(NDhcp4ServerLease *lease, uint64_t *lifetime);
+void n_dhcp4_server_lease_get_client_id(NDhcp4ServerLease *lease, const uint8_t **idp, size_t *n_idp);
 int n_dhcp4_server_lease_query(NDhcp4ServerLease *lease, uint8_t option, uint8_t **datap, size_t *n_datap);
 int n_dhcp4_server_lease_append(NDhcp4ServerLease *lease, uint8_t option, uint8_t *data, size_t n_data);
 
@@ -235,6 +258,15 @@ static inline void n_dhcp4_client_probe_config_freev(NDhcp4ClientProbeConfig *p)
         n_dhcp4_client_probe_config_free(p);
 }
 
+static inline void n_dhcp4_client_hub_unrefp(NDhcp4ClientHub **p) {
+        if (*p)
+                n_dhcp4_client_hub_unref(*p);
+}
+
+static inline void n_dhcp4_client_hub_unrefv(NDhcp4ClientHub *p) {
+        n_dhcp4_client_hub_unref(p);
+}
+
 static inline void n_dhcp4_client_unrefp(NDhcp4Client **p) {
         if (*p)
                 n_dhcp4_client_unref(*p);
@@ -49,6 +49,7 @@ static void test_api_types(void) {
         assert(sizeof(NDhcp4ClientProbeConfig*) > 0);
         assert(sizeof(NDhcp4Client*) > 0);
         assert(sizeof(NDhcp4ClientEvent) > 0);
+        assert(sizeof(NDhcp4ClientHub*) > 0);
         assert(sizeof(NDhcp4ClientProbe*) > 0);
         assert(sizeof(NDhcp4ClientLease*) > 0);
         assert(sizeof(NDhcp4Server*) > 0);
@@ -70,6 +71,15 @@ static void test_api_functions(void) {
                 (void *)n_dhcp4_client_config_set_mac,
                 (void *)n_dhcp4_client_config_set_broadcast_mac,
                 (void *)n_dhcp4_client_config_set_client_id,
+                (void *)n_dhcp4_client_config_set_hub,
+
+                (void *)n_dhcp4_client_hub_new,
+                (void *)n_dhcp4_client_hub_ref,
+                (void *)n_dhcp4_client_hub_unref,
+                (void *)n_dhcp4_client_hub_unrefp,
+                (void *)n_dhcp4_client_hub_unrefv,
+                (void *)n_dhcp4_client_hub_get_fd,
+                (void *)n_dhcp4_client_hub_dispatch,
 
                 (void *)n_dhcp4_client_probe_config_new,
                 (void *)n_dhcp4_client_probe_config_free,
@@ -118,6 +128,9 @@ static void test_api_functions(void) {
                 (void *)n_dhcp4_server_config_freep,
                 (void *)n_dhcp4_server_config_freev,
                 (void *)n_dhcp4_server_config_set_ifindex,
+                (void *)n_dhcp4_server_config_set_range,
+                (void *)n_dhcp4_server_config_set_lifetime,
+                (void *)n_dhcp4_server_config_append_option,
 
                 (void *)n_dhcp4_server_new,
                 (void *)n_dhcp4_server_ref,
@@ -128,6 +141,8 @@ static void test_api_functions(void) {
                 (void *)n_dhcp4_server_dispatch,
                 (void *)n_dhcp4_server_pop_event,
                 (void *)n_dhcp4_server_add_ip,
+                (void *)n_dhcp4_server_add_lease,
+                (void *)n_dhcp4_server_next_lease,
 
                 (void *)n_dhcp4_server_ip_free,
                 (void *)n_dhcp4_server_ip_freep,
@@ -137,6 +152,9 @@ static void test_api_functions(void) {
                 (void *)n_dhcp4_server_lease_unref,
                 (void *)n_dhcp4_server_lease_unrefp,
                 (void *)n_dhcp4_server_lease_unrefv,
+                (void *)n_dhcp4_server_lease_get_yiaddr,
+                (void *)n_dhcp4_server_lease_get_lifetime,
+                (void *)n_dhcp4_server_lease_get_client_id,
                 (void *)n_dhcp4_server_lease_query,
                 (void *)n_dhcp4_server_lease_append,
                 (void *)n_dhcp4_server_lease_offer,
@@ -0,0 +1,248 @@
+/*
+ * Tests for DHCP4 Client Hubs
+ *
+ * This runs many n-dhcp4 clients sharing a single hub against one n-dhcp4
+ * server per link. Each client lives on its own veth pair, and all client
+ * ends are in the same network namespace. Every client must be granted a
+ * lease from the server on its own link, which verifies that the hub
+ * demultiplexes replies by interface and transaction id.
+ */
+
+#undef NDEBUG
+#include <assert.h>
+#include <c-stdaux.h>
+#include <errno.h>
+#include <net/ethernet.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include "n-dhcp4.h"
+#include "n-dhcp4-private.h"
+#include "test.h"
+#include "util/link.h"
+#include "util/netns.h"
+
+#define TEST_N_LINKS (32)
+
+typedef struct TestPair {
+        Link link_server;
+        Link link_client;
+        struct in_addr addr_server;
+        NDhcp4Server *server;
+        NDhcp4ServerIp *ip;
+        NDhcp4Client *client;
+        NDhcp4ClientProbe *probe;
+        struct in_addr yiaddr;
+        bool granted;
+} TestPair;
+
+#define TEST_PAIR_NULL(_x) {                                                    \
+                .link_server = LINK_NULL((_x).link_server),                     \
+                .link_client = LINK_NULL((_x).link_client),                     \
+        }
+
+static void test_pair_deinit(TestPair *pair) {
+        n_dhcp4_client_probe_free(pair->probe);
+        n_dhcp4_client_unref(pair->client);
+        n_dhcp4_server_ip_free(pair->ip);
+        n_dhcp4_server_unref(pair->server);
+        link_deinit(&pair->link_client);
+        link_deinit(&pair->link_server);
+}
+
+static void test_pair_start_server(TestPair *pair, int ns_server, unsigned int i) {
+        _c_cleanup_(n_dhcp4_server_config_freep) NDhcp4ServerConfig *config = NULL;
+        int r, oldns;
+
+        /* each link gets its own 10.i.0.0/24 subnet */
+        pair->addr_server = (struct in_addr){ htonl(10 << 24 | i << 16 | 1) };
+        link_add_ip4(&pair->link_server, &pair->addr_server, 24);
+
+        r = n_dhcp4_server_config_new(&config);
+        c_assert(!r);
+
+        n_dhcp4_server_config_set_ifindex(config, pair->link_server.ifindex);
+        r = n_dhcp4_server_config_set_range(config,
+                                            (struct in_addr){ htonl(10 << 24 | i << 16 | 2) },
+                                            (struct in_addr){ htonl(10 << 24 | i << 16 | 9) });
+        c_assert(!r);
+
+        netns_get(&oldns);
+        netns_set(ns_server);
+
+        r = n_dhcp4_server_new(&pair->server, config);
+        c_assert(!r);
+
+        netns_set(oldns);
+
+        r = n_dhcp4_server_add_ip(pair->server, &pair->ip, pair->addr_server);
+        c_assert(!r);
+}
+
+static void test_pair_start_client(TestPair *pair, int ns_client, NDhcp4ClientHub *hub) {
+        _c_cleanup_(n_dhcp4_client_config_freep) NDhcp4ClientConfig *config = NULL;
+        _c_cleanup_(n_dhcp4_client_probe_config_freep) NDhcp4ClientProbeConfig *probe_config = NULL;
+        int r, oldns;
+
+        r = n_dhcp4_client_config_new(&config);
+        c_assert(!r);
+
+        n_dhcp4_client_config_set_ifindex(config, pair->link_client.ifindex);
+        n_dhcp4_client_config_set_transport(config, N_DHCP4_TRANSPORT_ETHERNET);
+        n_dhcp4_client_config_set_mac(config, pair->link_client.mac.ether_addr_octet, ETH_ALEN);
+        n_dhcp4_client_config_set_broadcast_mac(config,
+                                                (const uint8_t[]){
+                                                        0xff, 0xff, 0xff,
+                                                        0xff, 0xff, 0xff,
+                                                },
+                                                ETH_ALEN);
+        n_dhcp4_client_config_set_hub(config, hub);
+
+        r = n_dhcp4_client_probe_config_new(&probe_config);
+        c_assert(!r);
+
+        n_dhcp4_client_probe_config_set_start_delay(probe_config, 10);
+
+        netns_get(&oldns);
+        netns_set(ns_client);
+
+        r = n_dhcp4_client_new(&pair->client, config);
+        c_assert(!r);
+
+        r = n_dhcp4_client_probe(pair->client, &pair->probe, probe_config);
+        c_assert(!r);
+
+        netns_set(oldns);
+}
+
+static void test_pair_dispatch_client(TestPair *pair, int ns_client) {
+        NDhcp4ClientEvent *event;
+        int r, oldns;
+
+        netns_get(&oldns);
+        netns_set(ns_client);
+
+        r = n_dhcp4_client_dispatch(pair->client);
+        c_assert(!r || r == N_DHCP4_E_PREEMPTED);
+
+        netns_set(oldns);
+
+        for (;;) {
+                r = n_dhcp4_client_pop_event(pair->client, &event);
+                c_assert(!r);
+
+                if (!event)
+                        break;
+
+                switch (event->event) {
+                case N_DHCP4_CLIENT_EVENT_OFFER:
+                        r = n_dhcp4_client_lease_select(event->offer.lease);
+                        c_assert(!r);
+                        break;
+                case N_DHCP4_CLIENT_EVENT_GRANTED:
+                        n_dhcp4_client_lease_get_yiaddr(event->granted.lease, &pair->yiaddr);
+                        pair->granted = true;
+                        break;
+                case N_DHCP4_CLIENT_EVENT_LOG:
+                        break;
+                default:
+                        c_assert(0);
+                        break;
+                }
+        }
+}
+
+static void test_pair_dispatch_server(TestPair *pair) {
+        NDhcp4ServerEvent *event;
+        int r;
+
+        r = n_dhcp4_server_dispatch(pair->server);
+        c_assert(!r);
+
+        do {
+                r = n_dhcp4_server_pop_event(pair->server, &event);
+                c_assert(!r);
+        } while (event);
+}
+
+static void test_hub(void) {
+        _c_cleanup_(netns_closep) int ns_server = -1, ns_client = -1;
+        _c_cleanup_(n_dhcp4_client_hub_unrefp) NDhcp4ClientHub *hub = NULL;
+        struct pollfd pfds[1 + 2 * TEST_N_LINKS];
+        TestPair pairs[TEST_N_LINKS];
+        unsigned int i, n_granted = 0;
+        int r, oldns;
+
+        netns_new(&ns_server);
+        netns_new(&ns_client);
+
+        netns_get(&oldns);
+        netns_set(ns_client);
+
+        r = n_dhcp4_client_hub_new(&hub);
+        c_assert(!r);
+
+        netns_set(oldns);
+
+        for (i = 0; i < TEST_N_LINKS; ++i) {
+                pairs[i] = (TestPair)TEST_PAIR_NULL(pairs[i]);
+
+                link_new_veth(&pairs[i].link_server, &pairs[i].link_client, ns_server, ns_client);
+                test_pair_start_server(&pairs[i], ns_server, i);
+                test_pair_start_client(&pairs[i], ns_client, hub);
+
+                /* clients have no packet socket of their own */
+                c_assert(pairs[i].probe->connection.hub == hub);
+        }
+
+        while (n_granted < TEST_N_LINKS) {
+                pfds[0] = (struct pollfd){ .events = POLLIN };
+                n_dhcp4_client_hub_get_fd(hub, &pfds[0].fd);
+
+                for (i = 0; i < TEST_N_LINKS; ++i) {
+                        pfds[1 + 2 * i] = (struct pollfd){ .events = POLLIN };
+                        pfds[2 + 2 * i] = (struct pollfd){ .events = POLLIN };
+                        n_dhcp4_server_get_fd(pairs[i].server, &pfds[1 + 2 * i].fd);
+                        n_dhcp4_client_get_fd(pairs[i].client, &pfds[2 + 2 * i].fd);
+                }
+
+                r = poll(pfds, sizeof(pfds) / sizeof(*pfds), 10000);
+                c_assert(r > 0);
+
+                if (pfds[0].revents & POLLIN) {
+                        r = n_dhcp4_client_hub_dispatch(hub);
+                        c_assert(!r || r == N_DHCP4_E_PREEMPTED);
+                }
+
+                n_granted = 0;
+                for (i = 0; i < TEST_N_LINKS; ++i) {
+                        if (pfds[1 + 2 * i].revents & POLLIN)
+                                test_pair_dispatch_server(&pairs[i]);
+                        if (pfds[2 + 2 * i].revents & POLLIN)
+                                test_pair_dispatch_client(&pairs[i], ns_client);
+                        if (pairs[i].granted)
+                                ++n_granted;
+                }
+        }
+
+        for (i = 0; i < TEST_N_LINKS; ++i) {
+                /* the lease must come from the server on the same link */
+                c_assert((ntohl(pairs[i].yiaddr.s_addr) & 0xffffff00) ==
+                         (ntohl(pairs[i].addr_server.s_addr) & 0xffffff00));
+                c_assert(pairs[i].yiaddr.s_addr != pairs[i].addr_server.s_addr);
+
+                link_del_ip4(&pairs[i].link_server, &pairs[i].addr_server, 24);
+                test_pair_deinit(&pairs[i]);
+        }
+
+        /* all connections left the hub */
+        c_assert(!hub->n_connections);
+}
+
+int main(int argc, char **argv) {
+        test_setup();
+
+        test_hub();
+
+        return 0;
+}
@@ -0,0 +1,387 @@
+/*
+ * Tests for DHCP4 Server
+ *
+ * This runs the n-dhcp4 client against the n-dhcp4 server across a veth
+ * pair, each end in its own network namespace, and verifies address
+ * assignment, lease events, restoring of persisted leases and clients
+ * re-acquiring their persisted lease through INIT-REBOOT.
+ */
+
+#undef NDEBUG
+#include <assert.h>
+#include <c-stdaux.h>
+#include <errno.h>
+#include <net/ethernet.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include "n-dhcp4.h"
+#include "n-dhcp4-private.h"
+#include "test.h"
+#include "util/link.h"
+#include "util/netns.h"
+
+typedef struct TestClient {
+        int netns;
+        NDhcp4Client *client;
+        NDhcp4ClientProbe *probe;
+        struct in_addr yiaddr;
+        unsigned int n_offers;
+        unsigned int n_retracted;
+} TestClient;
+
+#define TEST_CLIENT_NULL(_x) {                                                  \
+        }
+
+static void test_client_deinit(TestClient *client) {
+        n_dhcp4_client_probe_free(client->probe);
+        n_dhcp4_client_unref(client->client);
+}
+
+static void test_server_new(NDhcp4Server **serverp,
+                            NDhcp4ServerIp **ipp,
+                            int netns,
+                            Link *link,
+                            const struct in_addr *addr) {
+        _c_cleanup_(n_dhcp4_server_config_freep) NDhcp4ServerConfig *config = NULL;
+        const struct in_addr mask = { htonl(0xffffff00) };
+        int r, oldns;
+
+        r = n_dhcp4_server_config_new(&config);
+        c_assert(!r);
+
+        n_dhcp4_server_config_set_ifindex(config, link->ifindex);
+        n_dhcp4_server_config_set_lifetime(config, 120);
+
+        /* the pool contains the server address, which must never be handed out */
+        r = n_dhcp4_server_config_set_range(config,
+                                            (struct in_addr){ htonl(10 << 24 | 1) },
+                                            (struct in_addr){ htonl(10 << 24 | 3) });
+        c_assert(!r);
+
+        r = n_dhcp4_server_config_set_range(config,
+                                            (struct in_addr){ htonl(10 << 24 | 3) },
+                                            (struct in_addr){ htonl(10 << 24 | 1) });
+        c_assert(r == N_DHCP4_E_INVALID_ADDRESS);
+
+        r = n_dhcp4_server_config_append_option(config, N_DHCP4_OPTION_SUBNET_MASK, &mask, sizeof(mask));
+        c_assert(!r);
+        r = n_dhcp4_server_config_append_option(config, N_DHCP4_OPTION_ROUTER, addr, sizeof(*addr));
+        c_assert(!r);
+        r = n_dhcp4_server_config_append_option(config, N_DHCP4_OPTION_ROUTER, addr, sizeof(*addr));
+        c_assert(r == N_DHCP4_E_DUPLICATE_OPTION);
+        r = n_dhcp4_server_config_append_option(config, N_DHCP4_OPTION_SERVER_IDENTIFIER, addr, sizeof(*addr));
+        c_assert(r == N_DHCP4_E_INTERNAL);
+
+        netns_get(&oldns);
+        netns_set(netns);
+
+        r = n_dhcp4_server_new(serverp, config);
+        c_assert(!r);
+
+        netns_set(oldns);
+
+        r = n_dhcp4_server_add_ip(*serverp, ipp, *addr);
+        c_assert(!r);
+}
+
+static void test_client_start(TestClient *client,
+                              int netns,
+                              Link *link,
+                              const char *client_id,
+                              const struct in_addr *init_reboot) {
+        _c_cleanup_(n_dhcp4_client_config_freep) NDhcp4ClientConfig *config = NULL;
+        _c_cleanup_(n_dhcp4_client_probe_config_freep) NDhcp4ClientProbeConfig *probe_config = NULL;
+        int r, oldns;
+
+        r = n_dhcp4_client_config_new(&config);
+        c_assert(!r);
+
+        n_dhcp4_client_config_set_ifindex(config, link->ifindex);
+        n_dhcp4_client_config_set_transport(config, N_DHCP4_TRANSPORT_ETHERNET);
+        n_dhcp4_client_config_set_mac(config, link->mac.ether_addr_octet, ETH_ALEN);
+        n_dhcp4_client_config_set_broadcast_mac(config,
+                                                (const uint8_t[]){
+                                                        0xff, 0xff, 0xff,
+                                                        0xff, 0xff, 0xff,
+                                                },
+                                                ETH_ALEN);
+        r = n_dhcp4_client_config_set_client_id(config, (void *)client_id, strlen(client_id));
+        c_assert(!r);
+
+        r = n_dhcp4_client_probe_config_new(&probe_config);
+        c_assert(!r);
+
+        n_dhcp4_client_probe_config_set_start_delay(probe_config, 10);
+        n_dhcp4_client_probe_config_request_option(probe_config, N_DHCP4_OPTION_ROUTER);
+        n_dhcp4_client_probe_config_request_option(probe_config, N_DHCP4_OPTION_SUBNET_MASK);
+
+        if (init_reboot) {
+                n_dhcp4_client_probe_config_set_requested_ip(probe_config, *init_reboot);
+                n_dhcp4_client_probe_config_set_init_reboot(probe_config, true);
+        }
+
+        client->netns = netns;
+
+        netns_get(&oldns);
+        netns_set(netns);
+
+        r = n_dhcp4_client_new(&client->client, config);
+        c_assert(!r);
+
+        r = n_dhcp4_client_probe(client->client, &client->probe, probe_config);
+        c_assert(!r);
+
+        netns_set(oldns);
+}
+
+static bool test_client_dispatch(TestClient *client) {
+        NDhcp4ClientEvent *event;
+        struct in_addr router;
+        uint8_t *data;
+        size_t n_data;
+        bool granted = false;
+        int r, oldns;
+
+        netns_get(&oldns);
+        netns_set(client->netns);
+
+        r = n_dhcp4_client_dispatch(client->client);
+        c_assert(!r || r == N_DHCP4_E_PREEMPTED);
+
+        netns_set(oldns);
+
+        for (;;) {
+                r = n_dhcp4_client_pop_event(client->client, &event);
+                c_assert(!r);
+
+                if (!event)
+                        break;
+
+                switch (event->event) {
+                case N_DHCP4_CLIENT_EVENT_OFFER:
+                        ++client->n_offers;
+
+                        r = n_dhcp4_client_lease_query(event->offer.lease, N_DHCP4_OPTION_ROUTER, &data, &n_data);
+                        c_assert(!r);
+                        c_assert(n_data == sizeof(router));
+
+                        r = n_dhcp4_client_lease_select(event->offer.lease);
+                        c_assert(!r);
+                        break;
+                case N_DHCP4_CLIENT_EVENT_GRANTED:
+                        /*
+                         * Accepting would require configuring the address on
+                         * the link, the server side is done at this point.
+                         */
+                        n_dhcp4_client_lease_get_yiaddr(event->granted.lease, &client->yiaddr);
+                        granted = true;
+                        break;
+                case N_DHCP4_CLIENT_EVENT_RETRACTED:
+                        /* the server refused the requested address */
+                        ++client->n_retracted;
+                        break;
+                case N_DHCP4_CLIENT_EVENT_LOG:
+                        break;
+                default:
+                        c_assert(0);
+                        break;
+                }
+        }
+
+        return granted;
+}
+
+static NDhcp4ServerLease *test_server_dispatch(NDhcp4Server *server) {
+        NDhcp4ServerLease *lease = NULL;
+        NDhcp4ServerEvent *event;
+        int r;
+
+        r = n_dhcp4_server_dispatch(server);
+        c_assert(!r);
+
+        for (;;) {
+                r = n_dhcp4_server_pop_event(server, &event);
+                c_assert(!r);
+
+                if (!event)
+                        break;
+
+                /* restored leases are already bound, and thus renewed */
+                c_assert(event->event == N_DHCP4_SERVER_EVENT_REQUEST ||
+                         event->event == N_DHCP4_SERVER_EVENT_RENEW);
+                lease = event->request.lease;
+        }
+
+        return lease;
+}
+
+/*
+ * Runs client and server until the client is granted a lease, and returns the
+ * address the server reported as bound.
+ */
+static void test_run(NDhcp4Server *server, TestClient *client, struct in_addr *boundp) {
+        bool granted = false, bound = false;
+        NDhcp4ServerLease *lease;
+        int r;
+
+        while (!granted || !bound) {
+                struct pollfd pfds[2] = {
+                        { .events = POLLIN },
+                        { .events = POLLIN },
+                };
+
+                n_dhcp4_server_get_fd(server, &pfds[0].fd);
+                n_dhcp4_client_get_fd(client->client, &pfds[1].fd);
+
+                r = poll(pfds, 2, 10000);
+                c_assert(r > 0);
+
+                if (pfds[0].revents & POLLIN) {
+                        lease = test_server_dispatch(server);
+                        if (lease) {
+                                n_dhcp4_server_lease_get_yiaddr(lease, boundp);
+                                bound = true;
+                        }
+                }
+
+                if (pfds[1].revents & POLLIN)
+                        granted = test_client_dispatch(client) || granted;
+        }
+
+        c_assert(client->yiaddr.s_addr == boundp->s_addr);
+}
+
+static void test_server(void) {
+        const struct in_addr addr_server = (struct in_addr){ htonl(10 << 24 | 1) };
+        _c_cleanup_(netns_closep) int ns_server = -1, ns_client = -1;
+        _c_cleanup_(link_deinit) Link link_server = LINK_NULL(link_server);
+        _c_cleanup_(link_deinit) Link link_client = LINK_NULL(link_client);
+        struct in_addr addr_a = {}, addr_b = {}, addr;
+        uint8_t *client_id_a = NULL;
+        size_t n_client_id_a = 0;
+        uint64_t lifetime_a = 0;
+        int r;
+
+        netns_new(&ns_server);
+        netns_new(&ns_client);
+
+        link_new_veth(&link_server, &link_client, ns_server, ns_client);
+        link_add_ip4(&link_server, &addr_server, 8);
+
+        /* two clients get distinct addresses, never the server's */
+        {
+                _c_cleanup_(n_dhcp4_server_unrefp) NDhcp4Server *server = NULL;
+                _c_cleanup_(n_dhcp4_server_ip_freep) NDhcp4ServerIp *ip = NULL;
+                TestClient client_a = TEST_CLIENT_NULL(client_a);
+                TestClient client_b = TEST_CLIENT_NULL(client_b);
+                NDhcp4ServerLease *lease;
+                const uint8_t *id;
+                size_t n_id, n_leases = 0;
+
+                test_server_new(&server, &ip, ns_server, &link_server, &addr_server);
+
+                test_client_start(&client_a, ns_client, &link_client, "client-a", NULL);
+                test_run(server, &client_a, &addr_a);
+                test_client_deinit(&client_a);
+
+                test_client_start(&client_b, ns_client, &link_client, "client-b", NULL);
+                test_run(server, &client_b, &addr_b);
+                test_client_deinit(&client_b);
+
+                c_assert(addr_a.s_addr != addr_server.s_addr);
+                c_assert(addr_b.s_addr != addr_server.s_addr);
+                c_assert(addr_a.s_addr != addr_b.s_addr);
+
+                /* save the leases, as a persistent lease database would */
+                for (lease = n_dhcp4_server_next_lease(server, NULL);
+                     lease;
+                     lease = n_dhcp4_server_next_lease(server, lease)) {
+                        n_dhcp4_server_lease_get_client_id(lease, &id, &n_id);
+                        n_dhcp4_server_lease_get_yiaddr(lease, &addr);
+                        ++n_leases;
+
+                        if (n_id == strlen("client-a") && !memcmp(id, "client-a", n_id)) {
+                                c_assert(addr.s_addr == addr_a.s_addr);
+                                client_id_a = malloc(n_id);
+                                c_assert(client_id_a);
+                                memcpy(client_id_a, id, n_id);
+                                n_client_id_a = n_id;
+                                n_dhcp4_server_lease_get_lifetime(lease, &lifetime_a);
+                        }
+                }
+                c_assert(n_leases == 2);
+                c_assert(client_id_a);
+                c_assert(lifetime_a > n_dhcp4_gettime(CLOCK_BOOTTIME));
+        }
+
+        /* a restarted server with restored leases keeps addresses stable */
+        {
+                _c_cleanup_(n_dhcp4_server_unrefp) NDhcp4Server *server = NULL;
+                _c_cleanup_(n_dhcp4_server_ip_freep) NDhcp4ServerIp *ip = NULL;
+                TestClient client_b = TEST_CLIENT_NULL(client_b);
+                TestClient client_a = TEST_CLIENT_NULL(client_a);
+
+                test_server_new(&server, &ip, ns_server, &link_server, &addr_server);
+
+                r = n_dhcp4_server_add_lease(server, client_id_a, n_client_id_a, addr_server, lifetime_a);
+                c_assert(r == N_DHCP4_E_INVALID_ADDRESS);
+
+                r = n_dhcp4_server_add_lease(server, client_id_a, n_client_id_a, addr_a, lifetime_a);
+                c_assert(!r);
+
+                r = n_dhcp4_server_add_lease(server, (void *)"client-c", strlen("client-c"), addr_a, lifetime_a);
+                c_assert(r == -EBUSY);
+
+                /* a new client must not be handed the restored address */
+                test_client_start(&client_b, ns_client, &link_client, "client-b2", NULL);
+                test_run(server, &client_b, &addr);
+                test_client_deinit(&client_b);
+                c_assert(addr.s_addr != addr_a.s_addr);
+
+                test_client_start(&client_a, ns_client, &link_client, "client-a", NULL);
+                test_run(server, &client_a, &addr);
+                test_client_deinit(&client_a);
+                c_assert(addr.s_addr == addr_a.s_addr);
+        }
+
+        /* a restarted client re-acquires its persisted lease with INIT-REBOOT */
+        {
+                _c_cleanup_(n_dhcp4_server_unrefp) NDhcp4Server *server = NULL;
+                _c_cleanup_(n_dhcp4_server_ip_freep) NDhcp4ServerIp *ip = NULL;
+                TestClient client_a = TEST_CLIENT_NULL(client_a);
+                TestClient client_c = TEST_CLIENT_NULL(client_c);
+
+                test_server_new(&server, &ip, ns_server, &link_server, &addr_server);
+
+                r = n_dhcp4_server_add_lease(server, client_id_a, n_client_id_a, addr_a, lifetime_a);
+                c_assert(!r);
+
+                /* the lease is granted without a discovery */
+                test_client_start(&client_a, ns_client, &link_client, "client-a", &addr_a);
+                test_run(server, &client_a, &addr);
+                c_assert(addr.s_addr == addr_a.s_addr);
+                c_assert(!client_a.n_offers);
+                c_assert(!client_a.n_retracted);
+                test_client_deinit(&client_a);
+
+                /* the address of another client is refused, and a new one discovered */
+                test_client_start(&client_c, ns_client, &link_client, "client-c", &addr_a);
+                test_run(server, &client_c, &addr);
+                c_assert(addr.s_addr != addr_a.s_addr);
+                c_assert(client_c.n_offers);
+                c_assert(client_c.n_retracted == 1);
+                test_client_deinit(&client_c);
+        }
+
+        free(client_id_a);
+        link_del_ip4(&link_server, &addr_server, 8);
+}
+
+int main(int argc, char **argv) {
+        test_setup();
+
+        test_server();
+
+        return 0;
+}
@@ -96,10 +96,21 @@ static void link_move(const char *ifname, int netns) {
  * This creates a new veth pair in the specified namespaces.
  */
 void link_new_veth(Link *veth_parentp, Link *veth_childp, int netns_parent, int netns_child) {
+        static unsigned int counter;
+        char name_parent[IF_NAMESIZE], name_child[IF_NAMESIZE];
         int oldns;
 
+        /*
+         * Use fresh interface names for every pair, so multiple pairs can be
+         * moved into the same namespace.
+         */
+        snprintf(name_parent, sizeof(name_parent), "veth-p%u", counter);
+        snprintf(name_child, sizeof(name_child), "veth-c%u", counter);
+        ++counter;
+
         netns_get(&oldns);
         {
+                char *p;
                 int r;
 
                 /*
@@ -108,32 +119,33 @@ void link_new_veth(Link *veth_parentp, Link *veth_childp, int netns_parent, int
                  */
                 netns_set_anonymous();
 
-                r = system("ip link add veth-parent type veth peer name veth-child");
+                r = asprintf(&p, "ip link add %s type veth peer name %s", name_parent, name_child);
+                c_assert(r > 0);
+                r = system(p);
                 c_assert(r == 0);
-                r = system("ip link set veth-parent up addrgenmode none");
+                free(p);
+
+                r = asprintf(&p, "ip link set %s up addrgenmode none", name_parent);
+                c_assert(r > 0);
+                r = system(p);
                 c_assert(r == 0);
-                r = system("ip link set veth-child up addrgenmode none");
+                free(p);
+
+                r = asprintf(&p, "ip link set %s up addrgenmode none", name_child);
+                c_assert(r > 0);
+                r = system(p);
                 c_assert(r == 0);
+                free(p);
 
-                link_move("veth-parent", netns_parent);
-                link_move("veth-child", netns_child);
+                link_move(name_parent, netns_parent);
+                link_move(name_child, netns_child);
         }
         netns_set(oldns);
 
         netns_new_dup(&veth_parentp->netns, netns_parent);
         netns_new_dup(&veth_childp->netns, netns_child);
-        link_query(netns_parent, "veth-parent", &veth_parentp->ifindex, &veth_parentp->mac);
-        link_query(netns_child, "veth-child", &veth_childp->ifindex, &veth_childp->mac);
-
-        /*
-         * XXX: After moving a link both its name and ifindex might have
-         *      changed. Hence, link_query() might check the wrong interface.
-         *      One way to fix this would be to rename the interfaces after
-         *      they have been moved and queried based on their final ifindex.
-         *      This way, we reserve the internal names for the constructor,
-         *      and guarantee the final names will never conflict (disallowing
-         *      parallel calls to this function).
-         */
+        link_query(netns_parent, name_parent, &veth_parentp->ifindex, &veth_parentp->mac);
+        link_query(netns_child, name_child, &veth_childp->ifindex, &veth_childp->mac);
 }
 
 /**
@@ -247,19 +247,24 @@ int packet_sendto_udp(int sockfd,
  * @n_buf:              max length of payload in bytes
  * @n_transmittedp:     output argument for number transmitted bytes
  * @src:                return argument for source address, or NULL, see ip(7)
+ * @ifindexp:           return argument for the receiving interface, or NULL
  *
  * Receives an UDP packet on a AF_PACKET socket. The difference between
  * this and recvfrom() on an AF_INET socket is that the packet will be
  * received even if the destination IP address has not been configured
  * on the interface.
  *
+ * The interface index is only useful for sockets that are not bound to a
+ * specific interface.
+ *
  * Return: 0 on success, negative error code on failure.
  */
 int packet_recvfrom_udp(int sockfd,
                         void *buf,
                         size_t n_buf,
                         size_t *n_transmittedp,
-                        struct sockaddr_in *src) {
+                        struct sockaddr_in *src,
+                        int *ifindexp) {
         union {
                 struct iphdr hdr;
                 /*
@@ -284,7 +289,10 @@ int packet_recvfrom_udp(int sockfd,
                 },
         };
         uint8_t cmsgbuf[CMSG_LEN(sizeof(struct tpacket_auxdata))];
+        struct sockaddr_ll sll = {};
         struct msghdr msg = {
+                .msg_name = &sll,
+                .msg_namelen = sizeof(sll),
                 .msg_iov = iov,
                 .msg_iovlen = sizeof(iov) / sizeof(iov[0]),
                 .msg_control = cmsgbuf,
@@ -416,6 +424,9 @@ int packet_recvfrom_udp(int sockfd,
                 src->sin_port = udp_hdr.source;
         }
 
+        if (ifindexp)
+                *ifindexp = sll.sll_ifindex;
+
         /* Return length of UDP payload (i.e., data written to @buf). */
         *n_transmittedp = pktlen;
         return 0;
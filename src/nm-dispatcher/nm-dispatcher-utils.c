@@ -613,3 +613,144 @@ done:
     g_ptr_array_add(items, NULL);
     return (char **) g_ptr_array_free(g_steal_pointer(&items), FALSE);
 }
+
+/*****************************************************************************/
+
+typedef struct {
+    guint    n_remaining;
+    guint    n_jobs;
+    gpointer jobs[];
+} LaneGroup;
+
+void
+nm_dispatcher_lanes_init(NMDispatcherLanes *lanes, guint max)
+{
+    *lanes = (NMDispatcherLanes){
+        .pending = G_QUEUE_INIT,
+        .max     = max,
+    };
+}
+
+static void
+_lane_free(GQueue *lane)
+{
+    g_queue_free_full(lane, g_free);
+}
+
+void
+nm_dispatcher_lanes_clear(NMDispatcherLanes *lanes)
+{
+    nm_clear_pointer(&lanes->lanes, g_hash_table_unref);
+    g_queue_clear(&lanes->pending);
+    lanes->n_running = 0;
+}
+
+static void
+_lane_group_start(NMDispatcherLanes *lanes, LaneGroup *group)
+{
+    guint i;
+
+    for (i = 0; i < group->n_jobs; i++)
+        g_queue_push_tail(&lanes->pending, group->jobs[i]);
+}
+
+/**
+ * nm_dispatcher_lanes_add:
+ * @lanes: the scheduler
+ * @lane_name: the name of the lane
+ * @jobs: (array length=n_jobs): the jobs to add.
+ * @n_jobs: the number of jobs. Must be positive.
+ *
+ * Adds a group of jobs at the tail of the lane. If the lane was idle, the jobs are
+ * ready to run right away, otherwise only once all jobs of the previous groups
+ * of the lane are done.
+ */
+void
+nm_dispatcher_lanes_add(NMDispatcherLanes *lanes,
+                        const char        *lane_name,
+                        gpointer const    *jobs,
+                        guint              n_jobs)
+{
+    LaneGroup *group;
+    GQueue    *lane;
+
+    g_return_if_fail(lanes);
+    g_return_if_fail(lane_name);
+    g_return_if_fail(jobs && n_jobs > 0);
+
+    group              = g_malloc(sizeof(LaneGroup) + (sizeof(gpointer) * n_jobs));
+    group->n_remaining = n_jobs;
+    group->n_jobs      = n_jobs;
+    memcpy(group->jobs, jobs, sizeof(gpointer) * n_jobs);
+
+    if (!lanes->lanes)
+        lanes->lanes =
+            g_hash_table_new_full(nm_str_hash, g_str_equal, g_free, (GDestroyNotify) _lane_free);
+
+    lane = g_hash_table_lookup(lanes->lanes, lane_name);
+    if (!lane) {
+        lane = g_queue_new();
+        g_hash_table_insert(lanes->lanes, g_strdup(lane_name), lane);
+    }
+
+    g_queue_push_tail(lane, group);
+    if (lane->length == 1)
+        _lane_group_start(lanes, group);
+}
+
+/**
+ * nm_dispatcher_lanes_next:
+ * @lanes: the scheduler
+ *
+ * Returns: the next job to run, or %NULL if there is no job ready or the
+ *   maximum number of jobs are already running. The returned job counts as
+ *   running and must be completed with nm_dispatcher_lanes_done().
+ */
+gpointer
+nm_dispatcher_lanes_next(NMDispatcherLanes *lanes)
+{
+    gpointer job;
+
+    if (lanes->n_running >= lanes->max)
+        return NULL;
+
+    job = g_queue_pop_head(&lanes->pending);
+    if (job)
+        lanes->n_running++;
+    return job;
+}
+
+/**
+ * nm_dispatcher_lanes_done:
+ * @lanes: the scheduler
+ * @lane_name: the lane of the job
+ *
+ * Completes a job that was returned by nm_dispatcher_lanes_next(). When
+ * this was the last job of its group, the next group of the same lane becomes
+ * ready to run.
+ */
+void
+nm_dispatcher_lanes_done(NMDispatcherLanes *lanes, const char *lane_name)
+{
+    LaneGroup *group;
+    GQueue    *lane;
+
+    g_return_if_fail(lanes->n_running > 0);
+
+    lanes->n_running--;
+
+    lane = lanes->lanes ? g_hash_table_lookup(lanes->lanes, lane_name) : NULL;
+    g_return_if_fail(lane);
+
+    group = g_queue_peek_head(lane);
+    nm_assert(group && group->n_remaining > 0);
+
+    if (--group->n_remaining > 0)
+        return;
+
+    g_free(g_queue_pop_head(lane));
+    if (lane->length == 0)
+        g_hash_table_remove(lanes->lanes, lane_name);
+    else
+        _lane_group_start(lanes, g_queue_peek_head(lane));
+}
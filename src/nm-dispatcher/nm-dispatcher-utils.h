@@ -23,4 +23,29 @@ char **nm_dispatcher_utils_construct_envp(const char  *action,
                                           char       **out_iface,
                                           const char **out_error_message);
 
+/*****************************************************************************/
+
+/* Schedules "parallel" jobs. Jobs are added in groups to a named lane. The jobs of
+ * the group at the head of each lane are ready to run, the following groups of the
+ * same lane only once all jobs of the previous group are done. At most @max jobs
+ * run at the same time. */
+typedef struct {
+    GHashTable *lanes;
+    GQueue      pending;
+    guint       n_running;
+    guint       max;
+} NMDispatcherLanes;
+
+void nm_dispatcher_lanes_init(NMDispatcherLanes *lanes, guint max);
+void nm_dispatcher_lanes_clear(NMDispatcherLanes *lanes);
+
+void nm_dispatcher_lanes_add(NMDispatcherLanes *lanes,
+                             const char        *lane_name,
+                             gpointer const    *jobs,
+                             guint              n_jobs);
+
+gpointer nm_dispatcher_lanes_next(NMDispatcherLanes *lanes);
+
+void nm_dispatcher_lanes_done(NMDispatcherLanes *lanes, const char *lane_name);
+
 #endif /* __NETWORKMANAGER_DISPATCHER_UTILS_H__ */
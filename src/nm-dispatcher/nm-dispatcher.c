@@ -30,6 +30,8 @@
  * the application. You can search for this macro, and find what options are supported. */
 #define _ENV(var) ("" var "")
 
+#define NM_DISPATCHER_MAX_PARALLEL_MAX 64
+
 /*****************************************************************************/
 
 typedef struct Request Request;
@@ -54,6 +56,12 @@ typedef struct {
     GQueue  *requests_waiting;
     int      num_requests_pending;
 
+    /* Scripts linked into "parallel.d" don't take part in the global ordering
+     * of the "wait" scripts. Instead, requests with such scripts are queued per
+     * interface, so that a script still sees the events of one interface
+     * in order. */
+    NMDispatcherLanes parallel;
+
     bool exit_with_failure;
 
     bool name_requested;
@@ -72,7 +80,9 @@ typedef struct {
     GPid           pid;
     DispatchResult result;
     char          *error;
+    gint64         start_msec;
     gboolean       wait;
+    gboolean       parallel;
     gboolean       dispatched;
     GSource       *watch_source;
     GSource       *timeout_source;
@@ -97,6 +107,7 @@ struct Request {
     guint      idx;
     int        num_scripts_done;
     int        num_scripts_nowait;
+    int        num_scripts_parallel;
 };
 
 /*****************************************************************************/
@@ -191,6 +202,7 @@ struct Request {
 /*****************************************************************************/
 
 static gboolean dispatch_one_script(Request *request);
+static gboolean script_dispatch(ScriptInfo *script);
 
 /*****************************************************************************/
 
@@ -215,6 +227,7 @@ request_free(Request *request)
 {
     g_assert_cmpuint(request->num_scripts_done, ==, request->scripts->len);
     g_assert_cmpuint(request->num_scripts_nowait, ==, 0);
+    g_assert_cmpuint(request->num_scripts_parallel, ==, 0);
 
     g_free(request->action);
     g_free(request->iface);
@@ -432,6 +445,73 @@ complete_request(Request *request)
     }
 }
 
+static const char *
+parallel_lane_key(const Request *request)
+{
+    return request->iface ?: "";
+}
+
+/**
+ * parallel_lane_add:
+ * @request: the request with "parallel" scripts.
+ *
+ * Enqueues the "parallel" scripts of @request to the lane of its interface.
+ * If there is no other request with pending "parallel" scripts for the
+ * interface, the scripts are ready to run right away. Call parallel_pump()
+ * afterwards to start them.
+ */
+static void
+parallel_lane_add(Request *request)
+{
+    gs_free gpointer *jobs   = NULL;
+    guint             n_jobs = 0;
+    guint             i;
+
+    nm_assert(request->num_scripts_parallel > 0);
+
+    jobs = g_new(gpointer, request->num_scripts_parallel);
+    for (i = 0; i < request->scripts->len; i++) {
+        ScriptInfo *script = g_ptr_array_index(request->scripts, i);
+
+        if (script->parallel)
+            jobs[n_jobs++] = script;
+    }
+    nm_assert(n_jobs == request->num_scripts_parallel);
+
+    _LOG_R_D(request, "queue %u parallel scripts", n_jobs);
+    nm_dispatcher_lanes_add(&gl.parallel, parallel_lane_key(request), jobs, n_jobs);
+}
+
+static void
+parallel_script_done(ScriptInfo *script)
+{
+    Request *request = script->request;
+
+    nm_assert(script->parallel);
+    nm_assert(request->num_scripts_parallel > 0);
+
+    request->num_scripts_parallel--;
+    nm_dispatcher_lanes_done(&gl.parallel, parallel_lane_key(request));
+}
+
+static void
+parallel_pump(void)
+{
+    ScriptInfo *script;
+
+    while ((script = nm_dispatcher_lanes_next(&gl.parallel))) {
+        Request *request = script->request;
+
+        if (script_dispatch(script))
+            continue;
+
+        /* failed to spawn the process. script_dispatch() already
+         * accounted the script as done. */
+        parallel_script_done(script);
+        complete_request(request);
+    }
+}
+
 static void
 complete_script(ScriptInfo *script)
 {
@@ -444,6 +524,17 @@ complete_script(ScriptInfo *script)
     }
 
     script->request->num_scripts_done++;
+
+    if (script->parallel) {
+        parallel_script_done(script);
+
+        /* Try to complete the request. @request will be possibly free'd,
+         * making @script and @request a dangling pointer. */
+        complete_request(request);
+        parallel_pump();
+        return;
+    }
+
     if (!script->wait)
         script->request->num_scripts_nowait--;
 
@@ -452,9 +543,12 @@ complete_script(ScriptInfo *script)
          * If that is successful, return (as we must wait for its completion). */
         if (dispatch_one_script(request))
             return;
-    }
 
-    nm_assert(!wait || gl.current_request == request);
+        /* All ordered scripts of @request are done. There might still be
+         * "parallel" scripts pending, but they don't block the next request. */
+        if (gl.current_request == request)
+            gl.current_request = NULL;
+    }
 
     /* Try to complete the request. @request will be possibly free'd,
      * making @script and @request a dangling pointer. */
@@ -508,6 +602,7 @@ script_watch_cb(GPid pid, int status, gpointer user_data)
 {
     ScriptInfo   *script      = user_data;
     gs_free char *status_desc = NULL;
+    gint64        elapsed_msec;
 
     g_assert(pid == script->pid);
 
@@ -522,11 +617,20 @@ script_watch_cb(GPid pid, int status, gpointer user_data)
         script->error = g_strdup_printf("Script '%s' %s", script->script, status_desc);
     }
 
+    elapsed_msec = nm_utils_get_monotonic_timestamp_msec() - script->start_msec;
+
     if (script->result == DISPATCH_RESULT_SUCCESS) {
-        _LOG_S_T(script, "complete: process succeeded");
+        _LOG_S_T(script,
+                 "complete: process succeeded (after %ld.%03d sec)",
+                 (long int) (elapsed_msec / 1000),
+                 (int) (elapsed_msec % 1000));
     } else {
         script->result = DISPATCH_RESULT_FAILED;
-        _LOG_S_W(script, "complete: process failed with %s", script->error);
+        _LOG_S_W(script,
+                 "complete: process failed with %s (after %ld.%03d sec)",
+                 script->error,
+                 (long int) (elapsed_msec / 1000),
+                 (int) (elapsed_msec % 1000));
     }
 
     script->pid = -1;
@@ -672,7 +776,11 @@ script_dispatch(ScriptInfo *script)
     argv[2] = request->action;
     argv[3] = NULL;
 
-    _LOG_S_T(script, "run script%s", script->wait ? "" : " (no-wait)");
+    _LOG_S_T(script,
+             "run script%s",
+             script->parallel ? " (parallel)" : (script->wait ? "" : " (no-wait)"));
+
+    script->start_msec = nm_utils_get_monotonic_timestamp_msec();
 
     if (!g_spawn_async_with_pipes("/",
                                   argv,
@@ -723,6 +831,8 @@ dispatch_one_script(Request *request)
         ScriptInfo *script;
 
         script = g_ptr_array_index(request->scripts, request->idx++);
+        if (script->parallel)
+            continue;
         if (script_dispatch(script))
             return TRUE;
     }
@@ -860,8 +970,14 @@ find_scripts(Request *request, const char *device_handler)
     return g_slist_sort(script_list, _compare_basenames);
 }
 
-static gboolean
-script_must_wait(const char *path)
+typedef enum {
+    SCRIPT_KIND_WAIT,
+    SCRIPT_KIND_NO_WAIT,
+    SCRIPT_KIND_PARALLEL,
+} ScriptKind;
+
+static ScriptKind
+script_get_kind(const char *path)
 {
     gs_free char *link = NULL;
 
@@ -883,10 +999,12 @@ script_must_wait(const char *path)
         dir  = g_path_get_dirname(link);
         real = realpath(dir, NULL);
         if (NM_STR_HAS_SUFFIX(real, "/no-wait.d"))
-            return FALSE;
+            return SCRIPT_KIND_NO_WAIT;
+        if (NM_STR_HAS_SUFFIX(real, "/parallel.d"))
+            return SCRIPT_KIND_PARALLEL;
     }
 
-    return TRUE;
+    return SCRIPT_KIND_WAIT;
 }
 
 static char *
@@ -934,7 +1052,7 @@ _handle_action(GDBusMethodInvocation *invocation, GVariant *parameters, gboolean
     GSList                    *iter;
     Request                   *request;
     char                     **p;
-    guint                      i, num_nowait = 0;
+    guint                      i, num_ordered = 0;
     const char                *error_message = NULL;
 
     if (is_action2) {
@@ -1044,15 +1162,26 @@ _handle_action(GDBusMethodInvocation *invocation, GVariant *parameters, gboolean
         sorted_scripts = find_scripts(request, device_handler);
         for (iter = sorted_scripts; iter; iter = g_slist_next(iter)) {
             ScriptInfo *s;
+            ScriptKind  kind;
+
+            kind = script_get_kind(iter->data);
+
+            /* Device-handlers report their result, they always wait. */
+            if (request->is_device_handler || gl.parallel.max == 0)
+                kind = SCRIPT_KIND_WAIT;
 
             s                = g_slice_new0(ScriptInfo);
             s->request       = request;
             s->script        = iter->data;
-            s->wait          = script_must_wait(s->script);
+            s->wait          = (kind != SCRIPT_KIND_NO_WAIT);
+            s->parallel      = (kind == SCRIPT_KIND_PARALLEL);
             s->stdout_fd     = -1;
             s->pid           = -1;
             s->stdout_buffer = NM_STR_BUF_INIT(0, FALSE);
             g_ptr_array_add(request->scripts, s);
+
+            if (s->parallel)
+                request->num_scripts_parallel++;
         }
         g_slist_free(sorted_scripts);
 
@@ -1079,16 +1208,21 @@ _handle_action(GDBusMethodInvocation *invocation, GVariant *parameters, gboolean
     gl.shutdown_timeout = FALSE;
     nm_clear_g_source_inst(&gl.source_idle_timeout);
 
+    /* Enqueue the "parallel" scripts first, so that the request cannot
+     * complete before we are done here. They get started at the end. */
+    if (request->num_scripts_parallel > 0)
+        parallel_lane_add(request);
+
     for (i = 0; i < request->scripts->len; i++) {
         ScriptInfo *s = g_ptr_array_index(request->scripts, i);
 
-        if (!s->wait) {
+        if (!s->wait)
             script_dispatch(s);
-            num_nowait++;
-        }
+        else if (!s->parallel)
+            num_ordered++;
     }
 
-    if (num_nowait < request->scripts->len) {
+    if (num_ordered > 0) {
         /* The request has at least one wait script.
          * Try next_request() to schedule the request for
          * execution. This either enqueues the request or
@@ -1110,7 +1244,7 @@ _handle_action(GDBusMethodInvocation *invocation, GVariant *parameters, gboolean
             }
         }
     } else {
-        /* The request contains only no-wait scripts. Try to complete
+        /* The request contains only no-wait (or parallel) scripts. Try to complete
          * the request right away (we might have failed to schedule any
          * of the scripts). It will be either completed now, or later
          * when the pending scripts return.
@@ -1120,6 +1254,8 @@ _handle_action(GDBusMethodInvocation *invocation, GVariant *parameters, gboolean
          * that have any "wait" scripts. */
         complete_request(request);
     }
+
+    parallel_pump();
 }
 
 static void
@@ -1416,7 +1552,8 @@ static gboolean
 _initial_setup(int *p_argc, char ***p_argv, GError **error)
 {
     GOptionContext *opt_ctx;
-    gboolean        arg_debug = FALSE;
+    gboolean        arg_debug        = FALSE;
+    int             arg_max_parallel = -1;
     GOptionEntry    entries[] = {{
                                   "debug",
                                   0,
@@ -1434,6 +1571,15 @@ _initial_setup(int *p_argc, char ***p_argv, GError **error)
                                   &gl.persist,
                                   "Don't quit after a short timeout",
                                   NULL,
+                              },
+                                 {
+                                  "max-parallel",
+                                  0,
+                                  0,
+                                  G_OPTION_ARG_INT,
+                                  &arg_max_parallel,
+                                  "Maximum number of parallel.d scripts to run at the same time",
+                                  "N",
                               },
                                  {
                                   NULL,
@@ -1451,6 +1597,20 @@ _initial_setup(int *p_argc, char ***p_argv, GError **error)
 
     g_option_context_free(opt_ctx);
 
+    /* The maximum number of "parallel" scripts to run at the same time. With zero,
+     * they are treated like regular scripts. The command line option takes
+     * precedence over the environment variable. */
+    if (arg_max_parallel < 0) {
+        arg_max_parallel =
+            _nm_utils_ascii_str_to_int64(g_getenv(_ENV("NM_DISPATCHER_MAX_PARALLEL")),
+                                         10,
+                                         0,
+                                         NM_DISPATCHER_MAX_PARALLEL_MAX,
+                                         4);
+    }
+    nm_dispatcher_lanes_init(&gl.parallel,
+                             NM_MIN(arg_max_parallel, NM_DISPATCHER_MAX_PARALLEL_MAX));
+
     if (success && arg_debug) {
         gl.log_stdout  = TRUE;
         gl.log_verbose = TRUE;
@@ -1552,6 +1712,7 @@ done:
     }
 
     nm_clear_pointer(&gl.requests_waiting, g_queue_free);
+    nm_dispatcher_lanes_clear(&gl.parallel);
 
     nm_clear_g_source_inst(&gl.source_idle_timeout);
 
@@ -628,6 +628,73 @@ test_gdbus_codegen(void)
 
 /*****************************************************************************/
 
+#define JOB(x) GINT_TO_POINTER(x)
+
+static void
+_lanes_next_check(NMDispatcherLanes *lanes, int expected)
+{
+    g_assert_cmpint(GPOINTER_TO_INT(nm_dispatcher_lanes_next(lanes)), ==, expected);
+}
+
+static void
+test_lanes(void)
+{
+    NMDispatcherLanes lanes;
+    gpointer          eth0_a[] = {JOB(1), JOB(2), JOB(3)};
+    gpointer          eth0_b[] = {JOB(4)};
+    gpointer          eth1_a[] = {JOB(5), JOB(6)};
+
+    nm_dispatcher_lanes_init(&lanes, 2);
+
+    nm_dispatcher_lanes_add(&lanes, "eth0", eth0_a, G_N_ELEMENTS(eth0_a));
+    nm_dispatcher_lanes_add(&lanes, "eth0", eth0_b, G_N_ELEMENTS(eth0_b));
+    nm_dispatcher_lanes_add(&lanes, "eth1", eth1_a, G_N_ELEMENTS(eth1_a));
+
+    /* At most two jobs run at the same time. */
+    _lanes_next_check(&lanes, 1);
+    _lanes_next_check(&lanes, 2);
+    _lanes_next_check(&lanes, 0);
+    g_assert_cmpuint(lanes.n_running, ==, 2);
+
+    /* The second group of eth0 waits for the first one, eth1 doesn't. */
+    nm_dispatcher_lanes_done(&lanes, "eth0");
+    _lanes_next_check(&lanes, 3);
+    _lanes_next_check(&lanes, 0);
+    nm_dispatcher_lanes_done(&lanes, "eth0");
+    _lanes_next_check(&lanes, 5);
+    _lanes_next_check(&lanes, 0);
+
+    /* job 3 completes the first group of eth0. */
+    nm_dispatcher_lanes_done(&lanes, "eth0");
+    _lanes_next_check(&lanes, 6);
+    _lanes_next_check(&lanes, 0);
+    nm_dispatcher_lanes_done(&lanes, "eth1");
+    _lanes_next_check(&lanes, 4);
+    _lanes_next_check(&lanes, 0);
+
+    nm_dispatcher_lanes_done(&lanes, "eth1");
+    nm_dispatcher_lanes_done(&lanes, "eth0");
+    g_assert_cmpuint(lanes.n_running, ==, 0);
+    g_assert_cmpuint(g_hash_table_size(lanes.lanes), ==, 0);
+    _lanes_next_check(&lanes, 0);
+
+    nm_dispatcher_lanes_clear(&lanes);
+}
+
+static void
+test_lanes_disabled(void)
+{
+    NMDispatcherLanes lanes;
+    gpointer          jobs[] = {JOB(1)};
+
+    nm_dispatcher_lanes_init(&lanes, 0);
+    nm_dispatcher_lanes_add(&lanes, "eth0", jobs, G_N_ELEMENTS(jobs));
+    _lanes_next_check(&lanes, 0);
+    nm_dispatcher_lanes_clear(&lanes);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE();
 
 int
@@ -646,5 +713,8 @@ main(int argc, char **argv)
 
     g_test_add_func("/dispatcher/gdbus-codegen", test_gdbus_codegen);
 
+    g_test_add_func("/dispatcher/lanes", test_lanes);
+    g_test_add_func("/dispatcher/lanes-disabled", test_lanes_disabled);
+
     return g_test_run();
 }
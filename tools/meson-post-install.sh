@@ -23,12 +23,14 @@ fi
 for dir in "${nm_pkgconfdir}/conf.d" \
            "${nm_pkgconfdir}/system-connections" \
            "${nm_pkgconfdir}/dispatcher.d/no-wait.d" \
+           "${nm_pkgconfdir}/dispatcher.d/parallel.d" \
            "${nm_pkgconfdir}/dispatcher.d/pre-down.d" \
            "${nm_pkgconfdir}/dispatcher.d/pre-up.d" \
            "${nm_pkgconfdir}/dnsmasq.d" \
            "${nm_pkgconfdir}/dnsmasq-shared.d" \
            "${nm_pkglibdir}/conf.d" \
            "${nm_pkglibdir}/dispatcher.d/no-wait.d" \
+           "${nm_pkglibdir}/dispatcher.d/parallel.d" \
            "${nm_pkglibdir}/dispatcher.d/pre-down.d" \
            "${nm_pkglibdir}/dispatcher.d/pre-up.d" \
            "${nm_pkglibdir}/system-connections" \
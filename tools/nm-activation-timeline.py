@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: LGPL-2.1-or-later
+
+# Build per-device activation timelines from the USDT probes of NetworkManager
+# (see "src/libnm-std-aux/nm-usdt.h").
+#
+# With bpftrace:
+#
+#   $ tools/nm-activation-timeline.py --bpftrace-script > nm.bt
+#   $ bpftrace nm.bt > nm-trace.txt
+#   $ tools/nm-activation-timeline.py nm-trace.txt
+#
+# With perf (string arguments are not resolved, devices are then
+# identified by their ifindex):
+#
+#   $ perf buildid-cache --add /usr/sbin/NetworkManager
+#   $ perf probe 'sdt_NetworkManager:*'
+#   $ perf record -e 'sdt_NetworkManager:*' -p "$(pidof NetworkManager)"
+#   $ perf script | tools/nm-activation-timeline.py -
+
+import argparse
+import collections
+import re
+import sys
+
+PROBES = [
+    ("device_state_change", "%d %s %d %d %d", "arg0, str(arg1), arg2, arg3, arg4"),
+    ("l3cfg_commit_start", "%d %d", "arg0, arg1"),
+    ("l3cfg_commit_end", "%d %d", "arg0, arg1"),
+    ("netlink_request", "%d %u", "arg0, arg1"),
+    ("netlink_response", "%d %u %d", "arg0, arg1, arg2"),
+    ("dbus_method_call", "%s %s %s", "str(arg0), str(arg1), str(arg2)"),
+]
+
+# NMDeviceState
+STATES = {
+    0: "unknown",
+    10: "unmanaged",
+    20: "unavailable",
+    30: "disconnected",
+    40: "prepare",
+    50: "config",
+    60: "need-auth",
+    70: "ip-config",
+    80: "ip-check",
+    90: "secondaries",
+    100: "activated",
+    110: "deactivating",
+    120: "failed",
+}
+STATE_DISCONNECTED = 30
+STATE_PREPARE = 40
+STATE_ACTIVATED = 100
+
+NETLINK_PROTOCOLS = {0: "genl", 1: "route"}
+
+RE_PERF = re.compile(
+    r"\s(\d+\.\d+):\s+sdt_NetworkManager:(\w+):.*?((?:\s+arg\d+=\S+)*)\s*$"
+)
+
+
+def bpftrace_script(binary):
+    lines = []
+    for name, fmt, args in PROBES:
+        lines.append("usdt:%s:NetworkManager:%s" % (binary, name))
+        lines.append("{")
+        lines.append('    printf("%%lu %s %s\\n", nsecs, %s);' % (name, fmt, args))
+        lines.append("}")
+    return "\n".join(lines)
+
+
+def parse_line(line):
+    m = RE_PERF.search(line)
+    if m:
+        args = [a.split("=", 1)[1] for a in m.group(3).split()]
+        return int(float(m.group(1)) * 1e9), m.group(2), args
+    fields = line.split()
+    if len(fields) < 2 or not fields[0].isdigit():
+        return None
+    return int(fields[0]), fields[1], fields[2:]
+
+
+def to_int(value):
+    try:
+        return int(value, 0)
+    except ValueError:
+        return None
+
+
+def fmt_msec(nsec):
+    return "%.1fms" % (nsec / 1e6)
+
+
+class Activation:
+    def __init__(self, ts):
+        self.start = ts
+        self.states = []
+        self.l3cfg_commits = 0
+        self.l3cfg_nsec = 0
+        self.end = None
+        self.result = None
+
+    def enter(self, ts, state):
+        self.states.append((ts, state))
+
+    def finish(self, ts, state):
+        self.end = ts
+        self.result = STATES.get(state, str(state))
+
+    def format(self, t0):
+        parts = []
+        for i, (ts, state) in enumerate(self.states):
+            until = self.states[i + 1][0] if i + 1 < len(self.states) else self.end
+            state_name = STATES.get(state, str(state))
+            if until is None:
+                parts.append("%s ..." % (state_name))
+            else:
+                parts.append("%s %s" % (state_name, fmt_msec(until - ts)))
+        s = "+%.3fs: %s" % ((self.start - t0) / 1e9, ", ".join(parts))
+        if self.end is not None:
+            s += " => %s after %s" % (self.result, fmt_msec(self.end - self.start))
+        else:
+            s += " => incomplete"
+        if self.l3cfg_commits:
+            s += " (%d l3cfg commits, %s)" % (
+                self.l3cfg_commits,
+                fmt_msec(self.l3cfg_nsec),
+            )
+        return s
+
+
+def analyze(events):
+    t0 = None
+    names = {}
+    activations = collections.defaultdict(list)
+    current = {}
+    l3cfg_started = {}
+    netlink_pending = {}
+    netlink_stats = collections.defaultdict(list)
+    dbus_calls = collections.Counter()
+
+    for ts, name, args in events:
+        if t0 is None:
+            t0 = ts
+        if name == "device_state_change" and len(args) >= 4:
+            ifindex, new = to_int(args[0]), to_int(args[3])
+            # perf reports the address of the interface name.
+            if to_int(args[1]) is None:
+                names[ifindex] = args[1]
+            act = current.get(ifindex)
+            if new == STATE_PREPARE and act is None:
+                act = Activation(ts)
+                current[ifindex] = act
+                activations[ifindex].append(act)
+            if act is None:
+                continue
+            if new >= STATE_ACTIVATED or new <= STATE_DISCONNECTED:
+                act.finish(ts, new)
+                del current[ifindex]
+            else:
+                act.enter(ts, new)
+        elif name == "l3cfg_commit_start" and args:
+            l3cfg_started[to_int(args[0])] = ts
+        elif name == "l3cfg_commit_end" and args:
+            ifindex = to_int(args[0])
+            start = l3cfg_started.pop(ifindex, None)
+            act = current.get(ifindex)
+            if start is not None and act is not None:
+                act.l3cfg_commits += 1
+                act.l3cfg_nsec += ts - start
+        elif name == "netlink_request" and len(args) >= 2:
+            netlink_pending[(to_int(args[0]), to_int(args[1]))] = ts
+        elif name == "netlink_response" and len(args) >= 2:
+            key = (to_int(args[0]), to_int(args[1]))
+            start = netlink_pending.pop(key, None)
+            if start is not None:
+                netlink_stats[key[0]].append(ts - start)
+        elif name == "dbus_method_call" and len(args) >= 3:
+            dbus_calls["%s.%s" % (args[1], args[2])] += 1
+
+    for ifindex in sorted(activations, key=lambda i: (i is None, i)):
+        print("%s (ifindex %s):" % (names.get(ifindex, "?"), ifindex))
+        for act in activations[ifindex]:
+            print("  " + act.format(t0))
+
+    for protocol, latencies in sorted(netlink_stats.items()):
+        print(
+            "netlink %s: %d requests, avg %s, max %s"
+            % (
+                NETLINK_PROTOCOLS.get(protocol, str(protocol)),
+                len(latencies),
+                fmt_msec(sum(latencies) / len(latencies)),
+                fmt_msec(max(latencies)),
+            )
+        )
+
+    for method, count in dbus_calls.most_common():
+        print("dbus %s: %d calls" % (method, count))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Build per-device activation timelines from USDT traces."
+    )
+    parser.add_argument(
+        "--bpftrace-script",
+        action="store_true",
+        help="print a bpftrace script that produces the input for this tool",
+    )
+    parser.add_argument(
+        "--binary",
+        default="/usr/sbin/NetworkManager",
+        help="path of the NetworkManager binary for the bpftrace script",
+    )
+    parser.add_argument(
+        "file",
+        nargs="?",
+        default="-",
+        help="bpftrace or 'perf script' output",
+    )
+    args = parser.parse_args()
+
+    if args.bpftrace_script:
+        print(bpftrace_script(args.binary))
+        return
+
+    f = sys.stdin if args.file == "-" else open(args.file)
+    events = [e for e in (parse_line(line) for line in f) if e]
+    events.sort(key=lambda e: e[0])
+    analyze(events)
+
+
+if __name__ == "__main__":
+    main()